@@ -0,0 +1,206 @@
+// src/host/analytics_check.c
+
+#include "config.h"
+#include "analytics.h"
+#include "bare.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+/*
+ * Verificação das estatísticas (alvo panel_analytics, só na build nativa).
+ *
+ *  - 1M de eventos sintéticos (passeio aleatório da ocupação, com pausas de
+ *    horas): em pontos de controle, os totais e o pico das três janelas são
+ *    comparados com uma contagem direta sobre a lista de eventos, e o tempo
+ *    por analytics_record() é informado.
+ *  - Volta do relógio de ms (49,7 dias): as janelas continuam deslizando.
+ *  - Ocupação restaurada no boot: as saídas de quem já estava dentro não
+ *    entram no histograma de permanência nem consomem as entradas novas.
+ *
+ *   ./build-host/panel_analytics
+ *
+ * Sai com 1 se algum agregado diferir da referência.
+ */
+
+#define N_EVENTS        1000000u
+#define N_CHECKPOINTS   20u
+#define MS_WRAP_US      (((uint64_t)1 << 32) * 1000u)   // to_ms_since_boot() volta a 0 aqui
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t event;       // analytics_event_t
+    uint16_t occupancy;  // Após o evento
+} event_t;
+
+static const struct {
+    const char *name;
+    uint32_t width_us;
+    uint32_t n;
+} windows[ANALYTICS_NUM_WINDOWS] = {
+    { "1 min", 1000000u, 60 },
+    { "1 h", 60 * 1000000u, 60 },
+    { "24 h", 15 * 60 * 1000000u, 96 },
+};
+
+static event_t *events;
+static int failures;
+
+static void fail(const char *fmt, uint64_t a, uint64_t b, const char *what) {
+    printf("DIFERENTE ");
+    printf(fmt, what);
+    printf(": %" PRIu64 " (referencia %" PRIu64 ")\n", a, b);
+    failures++;
+}
+
+/**
+ * @brief Totais da janela w em now_us por contagem direta: a janela são os
+ *        n baldes que terminam no balde de now_us, e o pico é a maior
+ *        ocupação nesse intervalo, incluindo a que vinha de antes dele.
+ */
+static void reference(uint w, uint64_t now_us, size_t n_events, analytics_window_summary_t *out) {
+    uint64_t cur = now_us / windows[w].width_us;
+    uint64_t start = cur + 1 >= windows[w].n ? (cur + 1 - windows[w].n) * windows[w].width_us : 0;
+
+    memset(out, 0, sizeof(*out));
+    size_t i = n_events;
+    while (i > 0 && events[i - 1].t_us >= start) {
+        const event_t *e = &events[--i];
+        if (e->event == ANALYTICS_EVT_ENTRY) out->entries++;
+        if (e->event == ANALYTICS_EVT_EXIT) out->exits++;
+        if (e->event == ANALYTICS_EVT_REJECT) out->rejects++;
+        if (e->occupancy > out->peak) out->peak = e->occupancy;
+    }
+    uint16_t before = i > 0 ? events[i - 1].occupancy : 0;
+    if (before > out->peak) out->peak = before;
+}
+
+static void compare(uint64_t now_us, size_t n_events) {
+    analytics_summary_t got;
+    analytics_get_summary(now_us, &got);
+
+    for (uint w = 0; w < ANALYTICS_NUM_WINDOWS; ++w) {
+        analytics_window_summary_t ref;
+        reference(w, now_us, n_events, &ref);
+        const analytics_window_summary_t *g = &got.window[w];
+        if (g->entries != ref.entries) fail("[%s] entradas", g->entries, ref.entries, windows[w].name);
+        if (g->exits != ref.exits) fail("[%s] saidas", g->exits, ref.exits, windows[w].name);
+        if (g->rejects != ref.rejects) fail("[%s] recusas", g->rejects, ref.rejects, windows[w].name);
+        if (g->peak != ref.peak) fail("[%s] pico", g->peak, ref.peak, windows[w].name);
+    }
+}
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * @brief Passeio aleatório da ocupação com intervalos de até ~2 s e, de vez
+ *        em quando, pausas de horas (expiram janelas inteiras). Começa pouco
+ *        antes da volta do relógio de ms, para cruzá-la no meio do caminho.
+ */
+static void run_synthetic(void) {
+    uint64_t t = MS_WRAP_US - (uint64_t)5 * 24 * 3600 * 1000000u;
+    uint16_t occ = 0;
+    uint64_t spent_ns = 0;
+    uint32_t rng = 12345;
+
+    events = malloc(N_EVENTS * sizeof(event_t));
+    if (!events) exit(2);
+    analytics_init(t, 0);
+
+    for (uint32_t i = 0; i < N_EVENTS; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        t += (rng >> 8) % 2000000u;
+        if ((rng & 0xFFF) == 0) t += (uint64_t)((rng >> 12) % 30) * 3600 * 1000000u;
+
+        analytics_event_t e;
+        if ((rng >> 28) < 7 && occ < MAX_USERS) {
+            e = ANALYTICS_EVT_ENTRY;
+            occ++;
+        } else if ((rng >> 28) < 7) {
+            e = ANALYTICS_EVT_REJECT;
+        } else if (occ > 0) {
+            e = ANALYTICS_EVT_EXIT;
+            occ--;
+        } else {
+            e = ANALYTICS_EVT_REJECT;
+        }
+        events[i] = (event_t){ t, (uint8_t)e, occ };
+
+        uint64_t t0 = wall_ns();
+        analytics_record(e, occ, t);
+        spent_ns += wall_ns() - t0;
+
+        if ((i + 1) % (N_EVENTS / N_CHECKPOINTS) == 0) {
+            compare(t, i + 1);
+            compare(t + 30 * 1000000u, i + 1);  // Consulta depois de um intervalo sem eventos
+        }
+    }
+    printf("%s sinteticos: %u eventos, %" PRIu64 " ns por evento, ate %" PRIu64 " dias de relogio\n",
+           failures ? "DIFERENTE" : "ok       ", N_EVENTS, spent_ns / N_EVENTS, t / 1000000u / 86400u);
+    free(events);
+}
+
+/**
+ * @brief Eventos dos dois lados da volta do relógio de ms: a janela de 1 min
+ *        esvazia depois dela em vez de ficar parada.
+ */
+static void run_wrap(void) {
+    analytics_summary_t s;
+    uint64_t t = MS_WRAP_US - 10 * 1000000u;
+    int before = failures;
+
+    analytics_init(t, 0);
+    analytics_record(ANALYTICS_EVT_ENTRY, 1, t);
+    analytics_record(ANALYTICS_EVT_ENTRY, 2, MS_WRAP_US + 5 * 1000000u);
+    analytics_get_summary(MS_WRAP_US + 5 * 1000000u, &s);
+    if (s.window[ANALYTICS_WINDOW_1MIN].entries != 2) fail("%s", s.window[0].entries, 2, "volta: entradas em 1 min");
+
+    analytics_get_summary(MS_WRAP_US + 3 * 60 * 1000000u, &s);
+    if (s.window[ANALYTICS_WINDOW_1MIN].entries != 0) fail("%s", s.window[0].entries, 0, "volta: 1 min expirado");
+    if (s.window[ANALYTICS_WINDOW_1H].entries != 2) fail("%s", s.window[1].entries, 2, "volta: entradas em 1 h");
+    printf("%s volta do relogio de ms\n", failures == before ? "ok       " : "DIFERENTE");
+}
+
+/**
+ * @brief Boot com 2 pessoas restauradas: as duas primeiras saídas são delas,
+ *        a terceira casa com a entrada feita depois do boot (permanência de
+ *        40 s, balde [32, 64) s).
+ */
+static void run_restore(void) {
+    analytics_summary_t s;
+    uint64_t t = 1000000u;
+    int before = failures;
+
+    analytics_init(t, 2);
+    analytics_record(ANALYTICS_EVT_ENTRY, 3, t + 10 * 1000000u);
+    analytics_record(ANALYTICS_EVT_EXIT, 2, t + 20 * 1000000u);
+    analytics_record(ANALYTICS_EVT_EXIT, 1, t + 30 * 1000000u);
+    analytics_get_summary(t + 30 * 1000000u, &s);
+    uint64_t total = 0;
+    for (uint k = 0; k < ANALYTICS_DWELL_BINS; ++k) total += s.dwell_hist[k];
+    if (total != 0) fail("%s", total, 0, "restauro: permanencias das pessoas restauradas");
+
+    analytics_record(ANALYTICS_EVT_EXIT, 0, t + 50 * 1000000u);
+    analytics_get_summary(t + 50 * 1000000u, &s);
+    if (s.dwell_hist[6] != 1) fail("%s", s.dwell_hist[6], 1, "restauro: permanencia de 40 s");
+    printf("%s ocupacao restaurada\n", failures == before ? "ok       " : "DIFERENTE");
+}
+
+int main(void) {
+    run_synthetic();
+    run_wrap();
+    run_restore();
+
+    if (failures) {
+        printf("%d agregado(s) diferente(s)\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "bare.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdarg.h>
+#include <stdlib.h>
+
+#define BARE_CLK_SYS_HZ 125000000u
+
+static uint64_t now_us;
+
+static watchdog_hw_t watchdog_regs;
+watchdog_hw_t *const watchdog_hw = &watchdog_regs;
+static systick_hw_t systick_regs = { .rvr = 0x00FFFFFF };
+systick_hw_t *const systick_hw = &systick_regs;
+
+void bare_set_time_us(uint64_t us) {
+    now_us = us;
+}
+
+uint64_t time_us_64(void) {
+    return now_us;
+}
+
+uint32_t clock_get_hz(enum clock_index clk) {
+    return clk == clk_sys ? BARE_CLK_SYS_HZ : (clk == clk_usb || clk == clk_adc) ? 48000000u : 12000000u;
+}
+
+bool watchdog_caused_reboot(void) {
+    return false;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+void panic(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    abort();
+}
+
+// Seções críticas do port POSIX (portmacro.h), sem o escalonador
+void vPortEnterCritical(void) {}
+void vPortExitCritical(void) {}
+UBaseType_t xPortSetInterruptMask(void) { return 0; }
+void vPortClearInterruptMask(UBaseType_t mask) { (void)mask; }
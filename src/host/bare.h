@@ -0,0 +1,15 @@
+#ifndef BARE_H
+#define BARE_H
+
+#include "pico_host.h"
+
+// Runtime mínimo das verificações da build nativa que testam um módulo
+// sozinho (panel_kbench e os testes do ctest), sem o kernel do FreeRTOS nem
+// os periféricos de sim.c. Uma única thread: as seções críticas e as
+// interrupções mascaradas não fazem nada, e o relógio só anda quando o
+// teste manda.
+
+// Relógio de time_us_64(): o teste fixa o instante
+void bare_set_time_us(uint64_t us);
+
+#endif // BARE_H
@@ -0,0 +1,94 @@
+// src/host/beam_replay.c
+
+#include "config.h"
+#include "beam_counter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/*
+ * Reprodução de um trace de bordas dos feixes (alvo panel_beam, só na build
+ * nativa). Lê o formato de beam_counter_dump_trace() ("t_us,porta,sensor,
+ * bloqueado", linhas com # são comentários) e passa cada borda por
+ * beam_counter_feed_edge(), sem a ISR. Uma linha
+ *
+ *   #= porta,entradas,saidas,caronas,desistencias
+ *
+ * confere os contadores acumulados da porta naquele ponto; o comentário
+ * anterior a ela dá nome ao caso. Um trace tirado da placa, sem essas
+ * linhas, só imprime os contadores finais.
+ *
+ *   ./build-host/panel_beam tools/beam_trace.csv
+ *
+ * Sai com 1 se algum contador diferir do esperado.
+ */
+
+#define LINE_LEN 160
+
+static int failures;
+
+static void check_case(const char *name, const char *line) {
+    unsigned door, entries, exits, tailgates, aborted;
+    beam_door_stats_t st = { 0 };
+
+    if (sscanf(line, "#= %u,%u,%u,%u,%u", &door, &entries, &exits, &tailgates, &aborted) != 5) {
+        printf("FALHOU    linha de conferencia invalida: %s", line);
+        failures++;
+        return;
+    }
+    beam_counter_get_stats((uint8_t)door, &st);
+    if (st.entries == entries && st.exits == exits && st.tailgates == tailgates && st.aborted == aborted) {
+        printf("ok        %s\n", name);
+        return;
+    }
+    printf("DIFERENTE %s: entradas %" PRIu32 "/%u, saidas %" PRIu32 "/%u, caronas %" PRIu32 "/%u, "
+           "desistencias %" PRIu32 "/%u (obtido/esperado)\n",
+           name, st.entries, entries, st.exits, exits, st.tailgates, tailgates, st.aborted, aborted);
+    failures++;
+}
+
+int main(int argc, char **argv) {
+    char line[LINE_LEN];
+    char name[LINE_LEN] = "";
+    uint32_t edges = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "uso: %s trace.csv\n", argv[0]);
+        return 2;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (!f) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' && line[1] == '=') {
+            check_case(name, line);
+        } else if (line[0] == '#') {
+            snprintf(name, sizeof(name), "%s", line + 1 + (line[1] == ' '));
+            name[strcspn(name, "\r\n")] = '\0';
+        } else {
+            uint64_t t_us;
+            unsigned door, sensor, blocked;
+            if (sscanf(line, "%" SCNu64 ",%u,%u,%u", &t_us, &door, &sensor, &blocked) != 4) continue;
+            beam_edge_t edge = { t_us, (uint8_t)door, (uint8_t)sensor, (uint8_t)blocked };
+            beam_counter_feed_edge(&edge);
+            edges++;
+        }
+    }
+    fclose(f);
+
+    beam_door_stats_t st;
+    beam_counter_get_stats(0, &st);
+    printf("%" PRIu32 " bordas; porta 0: %" PRIu32 " entradas, %" PRIu32 " saidas, %" PRIu32 " caronas, "
+           "%" PRIu32 " desistencias\n", edges, st.entries, st.exits, st.tailgates, st.aborted);
+
+    if (failures) {
+        printf("%d caso(s) do trace diferente(s)\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+// src/host/frames.c
+
+#include "config.h"
+#include "display.h"
+#include "led_matrix.h"
+#include "occupancy_band.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/*
+ * Quadros de referência do display e da matriz (alvo panel_frames, só na
+ * build nativa). Roda display_update(), display_startup_screen() e
+ * led_matrix_ocupacao() de verdade para um catálogo de estados, com I2C e PIO
+ * trocados por contadores, e compara o framebuffer do SSD1306 e o buffer de
+ * pixels da matriz com as imagens gravadas em um diretório (palavra a
+ * palavra). Cada atualização também precisa caber em DISPLAY_BUS_MAX_* e
+ * MATRIX_BUS_MAX_WORDS.
+ *
+ *   ./build-host/panel_frames tools/frames_golden            # compara
+ *   ./build-host/panel_frames tools/frames_golden --update   # regrava
+ *
+ * Sai com 1 se algum quadro mudou ou passou do orçamento.
+ */
+
+#define FRAME_WORDS       ((SSD1306_BUFSIZE - 1) / 4)   // Framebuffer sem o byte de controle
+#define MATRIX_STEPS      256                           // Todos os passos (uint8_t) da animação
+#define PATH_LEN          512
+
+// --- Periféricos de contagem (substituem sim.c) ---
+
+typedef struct {
+    uint32_t i2c_transactions;
+    uint32_t i2c_bytes;
+    uint32_t pio_words;
+} bus_count_t;
+
+static bus_count_t bus;
+
+i2c_inst_t i2c0_inst = { 0, 0 }, i2c1_inst = { 1, 0 };
+pio_hw_t pio0_hw_inst = { .index = 0 }, pio1_hw_inst = { .index = 1 };
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us) {
+    (void)i2c; (void)addr; (void)src; (void)nostop; (void)timeout_us;
+    bus.i2c_transactions++;
+    bus.i2c_bytes += len;
+    return (int)len;
+}
+
+// Recuperação do barramento do display: as escritas acima nunca falham
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) { (void)i2c; return baudrate; }
+void i2c_deinit(i2c_inst_t *i2c) { (void)i2c; }
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) { (void)i2c; return baudrate; }
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_put(uint gpio, bool value) { (void)gpio; (void)value; }
+bool gpio_get(uint gpio) { (void)gpio; return true; }
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    (void)pio; (void)sm; (void)data;
+    bus.pio_words++;
+}
+
+void busy_wait_us(uint64_t us) {
+    (void)us;
+}
+
+// Avança 1 ms a cada leitura: a espera pelo reset entre quadros da matriz termina logo
+uint64_t time_us_64(void) {
+    static uint64_t now_us;
+    return now_us += 1000;
+}
+
+#if TRACE_ENABLED
+void trace_record(trace_event_t event, uint16_t arg) {
+    (void)event; (void)arg;
+}
+#endif
+
+// --- Catálogo ---
+
+typedef struct {
+    const char *name;
+    uint16_t users;
+    const char *message;    // NULL: mensagem padrão da contagem
+    uint16_t capacity;      // Limite rígido da política (0: MAX_USERS)
+} display_case_t;
+
+static const display_case_t display_cases[] = {
+    { "display_livre",            0,             NULL },
+    { "display_entrada_ok",       MAX_USERS / 2, NULL },
+    { "display_ultima_vaga",      MAX_USERS - 1, NULL },
+    { "display_lotado",           MAX_USERS,     NULL },
+    { "display_reset",            0,             "Sistema Resetado" },
+    { "display_negado_horario",   MAX_USERS / 2, "Fora do horario" },
+    { "display_negado_taxa",      MAX_USERS / 2, "Aguarde" },
+    { "display_negado_reserva",   MAX_USERS - 1, "Vaga reservada" },
+    { "display_saida_vazio",      0,             "Vazio" },
+    { "display_saida_erro",       MAX_USERS / 2, "Erro Saida!" },
+    { "display_limite_reduzido",  MAX_USERS / 2, NULL,             MAX_USERS / 2 },
+};
+
+static const struct {
+    const char *name;
+    MatrixOccupationState_t state;
+} matrix_cases[] = {
+    { "matrix_vazio",        MATRIX_STATE_VAZIO },
+    { "matrix_vagas_livres", MATRIX_STATE_VAGAS_LIVRES },
+    { "matrix_quase_cheio",  MATRIX_STATE_QUASE_CHEIO },
+    { "matrix_cheio",        MATRIX_STATE_CHEIO },
+};
+
+static ssd1306_t ssd;
+static uint32_t frame[FRAME_WORDS];
+static uint32_t steps[MATRIX_STEPS * MATRIX_SIZE];
+static uint32_t golden[MATRIX_STEPS * MATRIX_SIZE];
+static const char *golden_dir;
+static bool update;
+static int failures;
+
+/**
+ * @brief Compara duas imagens palavra a palavra.
+ * @param first Recebe a primeira palavra diferente.
+ * @return Número de palavras diferentes.
+ */
+static size_t diff_words(const uint32_t *a, const uint32_t *b, size_t words, size_t *first) {
+    size_t n = 0;
+    for (size_t i = 0; i < words; ++i) {
+        if (a[i] != b[i]) {
+            if (!n) *first = i;
+            n++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Compara a captura com <golden_dir>/<name>.bin, ou a grava com --update.
+ * @return Número de palavras diferentes; SIZE_MAX se a referência não existe.
+ */
+static size_t check_golden(const char *name, const uint32_t *words, size_t count, size_t *first) {
+    char path[PATH_LEN];
+    snprintf(path, sizeof(path), "%s/%s.bin", golden_dir, name);
+
+    if (update) {
+        FILE *f = fopen(path, "wb");
+        if (!f || fwrite(words, 4, count, f) != count) {
+            printf("erro gravando %s\n", path);
+            exit(2);
+        }
+        fclose(f);
+        return 0;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return SIZE_MAX;
+    size_t got = fread(golden, 4, count, f);
+    bool longer = fgetc(f) != EOF;
+    fclose(f);
+    if (got != count || longer) return SIZE_MAX;
+    return diff_words(words, golden, count, first);
+}
+
+static bool check_bus(const char *name, const bus_count_t *max) {
+    bool ok = max->i2c_transactions <= DISPLAY_BUS_MAX_TRANSACTIONS &&
+              max->i2c_bytes <= DISPLAY_BUS_MAX_BYTES &&
+              max->pio_words <= MATRIX_BUS_MAX_WORDS;
+    if (!ok) {
+        printf("ORCAMENTO %s: %" PRIu32 " transacoes I2C (max %u), %" PRIu32
+               " bytes I2C (max %u), %" PRIu32 " palavras PIO (max %u)\n",
+               name, max->i2c_transactions, DISPLAY_BUS_MAX_TRANSACTIONS, max->i2c_bytes,
+               DISPLAY_BUS_MAX_BYTES, max->pio_words, MATRIX_BUS_MAX_WORDS);
+        failures++;
+    }
+    return ok;
+}
+
+static void report(const char *name, size_t diff, const char *where, size_t a, size_t b) {
+    if (update) {
+        printf("gravado   %s\n", name);
+    } else if (diff == SIZE_MAX) {
+        printf("SEM REF   %s\n", name);
+        failures++;
+    } else if (diff) {
+        printf("DIFERENTE %s: %zu palavras, a primeira em %s %zu/%zu\n", name, diff, where, a, b);
+        failures++;
+    } else {
+        printf("ok        %s\n", name);
+    }
+}
+
+static void check_display(const char *name) {
+    size_t first = 0;
+    memcpy(frame, ssd.ram_buffer + 1, sizeof(frame));
+    size_t diff = check_golden(name, frame, FRAME_WORDS, &first);
+    // Framebuffer em ordem de coluna: 8 bytes (uma coluna de 64 px) por coluna
+    report(name, diff, "coluna/pagina", first * 4 / 8, first * 4 % 8);
+}
+
+static void run_display(void) {
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, DISPLAY_ADDR, I2C_PORT);
+
+    bus = (bus_count_t){ 0 };
+    display_startup_screen(&ssd);
+    if (check_bus("display_tela_inicial", &bus)) check_display("display_tela_inicial");
+
+    for (uint i = 0; i < count_of(display_cases); ++i) {
+        const display_case_t *c = &display_cases[i];
+        bus = (bus_count_t){ 0 };
+        uint16_t capacity = c->capacity ? c->capacity : MAX_USERS;
+        occupancy_band_t band = occupancy_band_classify(OCCUPANCY_BAND_EMPTY, c->users, capacity);
+        display_update(&ssd, c->users, capacity, band, c->message);
+        if (check_bus(c->name, &bus)) check_display(c->name);
+    }
+}
+
+static void run_matrix(void) {
+    for (uint i = 0; i < count_of(matrix_cases); ++i) {
+        bus_count_t max = { 0 };
+        for (uint s = 0; s < MATRIX_STEPS; ++s) {
+            bus = (bus_count_t){ 0 };
+            led_matrix_ocupacao(matrix_cases[i].state, (uint8_t)s);
+            if (bus.pio_words > max.pio_words) max = bus;
+            memcpy(&steps[s * MATRIX_SIZE], led_matrix_pixels(), MATRIX_SIZE * 4);
+        }
+        if (!check_bus(matrix_cases[i].name, &max)) continue;
+
+        size_t first = 0;
+        size_t diff = check_golden(matrix_cases[i].name, steps, count_of(steps), &first);
+        report(matrix_cases[i].name, diff, "passo/led", first / MATRIX_SIZE, first % MATRIX_SIZE);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("uso: %s <diretorio das referencias> [--update]\n", argv[0]);
+        return 2;
+    }
+    golden_dir = argv[1];
+    update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+    run_display();
+    run_matrix();
+
+    if (failures) {
+        printf("%d quadro(s) diferente(s) ou acima do orcamento\n", failures);
+        return 1;
+    }
+    return 0;
+}
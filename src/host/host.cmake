@@ -0,0 +1,172 @@
+# Build nativa da aplicação (cmake -DPANEL_HOST=ON): as mesmas fontes do
+# firmware contra os periféricos simulados de src/host (sim.h) e o port POSIX
+# do FreeRTOS-Kernel mainline (V11 ou mais novo), de FREERTOS_KERNEL_PATH.
+#
+#   cmake -S src -B build-host -DPANEL_HOST=ON -DFREERTOS_KERNEL_PATH=~/FreeRTOS-Kernel
+#   cmake --build build-host
+#   ctest --test-dir build-host --output-on-failure
+#   PANEL_SIM_SCRIPT=roteiro.txt ./build-host/panel_host
+
+project(main C)
+enable_testing()
+
+set(PANEL_HOST_TIME_SCALE 1 CACHE STRING "Aceleracao do relogio simulado (ticks por ms de tempo real)")
+
+set(FREERTOS_POSIX_PORT ${FREERTOS_KERNEL_PATH}/portable/ThirdParty/GCC/Posix)
+
+# panel_host só é gerado com o port POSIX do kernel presente: é a aplicação
+# inteira e precisa do escalonador de verdade para ligar. panel_kbench e
+# panel_frames abaixo não usam o kernel (só os cabeçalhos).
+if(NOT EXISTS ${FREERTOS_POSIX_PORT}/port.c)
+    message(STATUS "panel_host desativado: ${FREERTOS_POSIX_PORT}/port.c nao encontrado")
+else()
+    set(FREERTOS_HOST_SOURCES
+            ${FREERTOS_KERNEL_PATH}/event_groups.c
+            ${FREERTOS_KERNEL_PATH}/list.c
+            ${FREERTOS_KERNEL_PATH}/queue.c
+            ${FREERTOS_KERNEL_PATH}/tasks.c
+            ${FREERTOS_KERNEL_PATH}/timers.c
+            ${FREERTOS_KERNEL_PATH}/portable/MemMang/heap_4.c
+            ${FREERTOS_POSIX_PORT}/port.c
+            ${FREERTOS_POSIX_PORT}/utils/wait_for_event.c
+            )
+
+    add_executable(panel_host ${PANEL_SOURCES} host/sim.c host/wiegand_sim.c ${FREERTOS_HOST_SOURCES})
+
+    # host/include antes de include/: FreeRTOSConfig.h, cabeçalhos do SDK e dos programas PIO
+    target_include_directories(panel_host BEFORE PRIVATE
+            host
+            host/include
+            include
+            ${FREERTOS_KERNEL_PATH}/include
+            ${FREERTOS_POSIX_PORT}
+            ${FREERTOS_POSIX_PORT}/utils
+            )
+
+    target_compile_definitions(panel_host PRIVATE
+            PANEL_HOST
+            PANEL_HOST_TIME_SCALE=${PANEL_HOST_TIME_SCALE}
+            _GNU_SOURCE
+            )
+
+    target_compile_options(panel_host PRIVATE -Wall -Wno-unused-function)
+
+    # Saída sem o stdio da libc (ver sim.c)
+    target_link_options(panel_host PRIVATE
+            -Wl,--wrap=printf -Wl,--wrap=vprintf -Wl,--wrap=puts -Wl,--wrap=putchar)
+
+    find_package(Threads REQUIRED)
+    target_link_libraries(panel_host Threads::Threads m)
+endif()
+
+# Microbenchmarks dos kernels sem HAL: nem sim.c nem o kernel do FreeRTOS, só
+# os cabeçalhos e o runtime mínimo de bare.c; o código dos periféricos sai no
+# --gc-sections. -O3 como a build Release do SDK. Aqui entram também a
+# avaliação da política, com teto de POLICY_EVAL_BUDGET_US por chamada, e o
+# registro de eventos das estatísticas.
+add_executable(panel_kbench ${KBENCH_SOURCES} host/bare.c include/policy.c include/analytics.c)
+target_include_directories(panel_kbench BEFORE PRIVATE
+        host
+        host/include
+        include
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_POSIX_PORT}
+        )
+target_compile_definitions(panel_kbench PRIVATE PANEL_HOST _GNU_SOURCE)
+target_compile_options(panel_kbench PRIVATE -O3 -Wall -Wno-unused-function
+        -ffunction-sections -fdata-sections)
+target_link_options(panel_kbench PRIVATE -Wl,--gc-sections)
+target_link_libraries(panel_kbench m)
+
+# Quadros de referência e orçamento de barramento (host/frames.c): o display e
+# a matriz de verdade, com I2C e PIO trocados por contadores.
+add_executable(panel_frames
+        host/frames.c
+        include/display.c
+        include/led_matrix.c
+        include/occupancy_band.c
+        include/lib/ssd1306/ssd1306.c
+        )
+target_include_directories(panel_frames BEFORE PRIVATE
+        host/include
+        include
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_POSIX_PORT}
+        )
+target_compile_definitions(panel_frames PRIVATE PANEL_HOST _GNU_SOURCE)
+target_compile_options(panel_frames PRIVATE -Wall -Wno-unused-function
+        -ffunction-sections -fdata-sections)
+target_link_options(panel_frames PRIVATE -Wl,--gc-sections)
+target_link_libraries(panel_frames m)
+
+# Estatísticas (host/analytics_check.c): 1M de eventos sintéticos contra uma
+# contagem direta, volta do relógio de ms e ocupação restaurada.
+add_executable(panel_analytics host/analytics_check.c host/bare.c include/analytics.c)
+target_include_directories(panel_analytics BEFORE PRIVATE
+        host
+        host/include
+        include
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_POSIX_PORT}
+        )
+target_compile_definitions(panel_analytics PRIVATE PANEL_HOST _GNU_SOURCE)
+target_compile_options(panel_analytics PRIVATE -O2 -Wall -Wno-unused-function)
+
+# Diário na flash (host/journal_check.c): gravações e apagamentos com falha
+# injetada, seguidos da recuperação de um novo boot.
+add_executable(panel_journal host/journal_check.c host/bare.c include/event_journal.c)
+target_include_directories(panel_journal BEFORE PRIVATE
+        host
+        host/include
+        include
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_POSIX_PORT}
+        )
+target_compile_definitions(panel_journal PRIVATE PANEL_HOST _GNU_SOURCE)
+target_compile_options(panel_journal PRIVATE -Wall -Wno-unused-function)
+
+# Contador por feixes (host/beam_replay.c): reproduz um trace de bordas e
+# confere entradas, saídas e caronas. A ISR e os pinos saem no --gc-sections.
+add_executable(panel_beam host/beam_replay.c host/bare.c include/beam_counter.c)
+target_include_directories(panel_beam BEFORE PRIVATE
+        host
+        host/include
+        include
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_POSIX_PORT}
+        )
+target_compile_definitions(panel_beam PRIVATE PANEL_HOST _GNU_SOURCE)
+target_compile_options(panel_beam PRIVATE -Wall -Wno-unused-function
+        -ffunction-sections -fdata-sections)
+target_link_options(panel_beam PRIVATE -Wl,--gc-sections)
+
+# Leitor Wiegand (host/wiegand_check.c): trens de pulsos D0/D1 pelo programa
+# de pio/wiegand.pio (interpretador de host/wiegand_sim.c) e pelo
+# decodificador. A ISR e a fila saem no --gc-sections.
+add_executable(panel_wiegand host/wiegand_check.c host/wiegand_sim.c host/bare.c include/wiegand.c)
+target_include_directories(panel_wiegand BEFORE PRIVATE
+        host
+        host/include
+        include
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_POSIX_PORT}
+        )
+target_compile_definitions(panel_wiegand PRIVATE PANEL_HOST _GNU_SOURCE)
+target_compile_options(panel_wiegand PRIVATE -O2 -Wall -Wno-unused-function
+        -ffunction-sections -fdata-sections)
+target_link_options(panel_wiegand PRIVATE -Wl,--gc-sections)
+
+# Verificações da build nativa (ctest --test-dir build-host)
+add_test(NAME frames_golden
+        COMMAND panel_frames ${CMAKE_CURRENT_SOURCE_DIR}/../tools/frames_golden)
+add_test(NAME kbench_budget COMMAND panel_kbench)
+add_test(NAME analytics COMMAND panel_analytics)
+add_test(NAME journal COMMAND panel_journal)
+add_test(NAME wiegand COMMAND panel_wiegand)
+add_test(NAME beam_replay
+        COMMAND panel_beam ${CMAKE_CURRENT_SOURCE_DIR}/../tools/beam_trace.csv)
+find_package(Python3 COMPONENTS Interpreter)
+if(Python3_Interpreter_FOUND)
+    add_test(NAME pio_sim_ws2812
+            COMMAND ${Python3_EXECUTABLE} ${CMAKE_CURRENT_SOURCE_DIR}/../tools/pio_sim.py)
+endif()
@@ -0,0 +1,128 @@
+/*
+ * Configuração do FreeRTOS da build nativa (PANEL_HOST): port POSIX do
+ * FreeRTOS-Kernel (portable/ThirdParty/GCC/Posix), um núcleo. Acompanha
+ * src/include/FreeRTOSConfig.h no que a aplicação usa; o que é do RP2040
+ * (SMP, afinidade, interop com o SDK) fica de fora.
+ */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Aceleração do relógio simulado: cada tick dura 1/PANEL_HOST_TIME_SCALE ms
+   de tempo real, mas a aplicação continua vendo 1 tick = 1 ms (pdMS_TO_TICKS
+   e time_us_64() do sim contam ticks, não o configTICK_RATE_HZ do port). */
+#ifndef PANEL_HOST_TIME_SCALE
+#define PANEL_HOST_TIME_SCALE                   1
+#endif
+
+/* Scheduler Related */
+#define configUSE_PREEMPTION                    1
+#define configUSE_TICKLESS_IDLE                 1   /* sim.c: relógio virtual (PANEL_SIM_VIRTUAL) */
+#define configUSE_IDLE_HOOK                     1
+#define configUSE_TICK_HOOK                     1   /* sim.c: instante de cada tick */
+#define configTICK_RATE_HZ                      ( ( TickType_t ) ( 1000 * PANEL_HOST_TIME_SCALE ) )
+#define pdMS_TO_TICKS( xTimeInMs )              ( ( TickType_t ) ( xTimeInMs ) )
+#define pdTICKS_TO_MS( xTicks )                 ( ( uint32_t ) ( xTicks ) )
+#define configMAX_PRIORITIES                    32
+#define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 8192 /* Threads POSIX: printf e sinais */
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+
+/* Synchronization Related */
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_APPLICATION_TASK_TAG          0
+#define configUSE_COUNTING_SEMAPHORES           1
+#define configQUEUE_REGISTRY_SIZE               8
+#define configUSE_QUEUE_SETS                    1
+#define configUSE_TIME_SLICING                  1
+#define configUSE_NEWLIB_REENTRANT              0
+#define configENABLE_BACKWARD_COMPATIBILITY     0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+
+/* System */
+#define configSTACK_DEPTH_TYPE                  uint32_t
+#define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
+
+/* Memory allocation related definitions. */
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configTOTAL_HEAP_SIZE                   ( 16 * 1024 )  /* Queue sets com ponteiros de 64 bits */
+#define configAPPLICATION_ALLOCATED_HEAP        0
+
+/* Hook function related definitions. A pilha de cada tarefa é a da thread
+   POSIX, sem o padrão de fim de stack do kernel. */
+#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configUSE_MALLOC_FAILED_HOOK            1
+#define configUSE_DAEMON_TASK_STARTUP_HOOK      0
+
+/* Run time and task stats gathering related definitions. */
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
+#define configUSE_STATS_FORMATTING_FUNCTIONS    0
+
+/* Mesmos ganchos do RP2040 (profiler.c e trace.c), com um só núcleo */
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+extern volatile uint32_t profiler_context_switches[];
+uint32_t profiler_run_time_counter( void );
+void trace_task_switched_in( uint32_t task_number );
+int sim_in_isr( void );
+void sim_idle_skip( uint32_t idle_ticks );
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        profiler_run_time_counter()
+#define traceTASK_SWITCHED_IN()                                     \
+    do {                                                            \
+        profiler_context_switches[ 0 ]++;                           \
+        trace_task_switched_in( pxCurrentTCB->uxTCBNumber );        \
+    } while( 0 )
+
+/* Co-routine related definitions. */
+#define configUSE_CO_ROUTINES                   0
+#define configMAX_CO_ROUTINE_PRIORITIES         1
+
+/* Software timer related definitions. */
+#define configUSE_TIMERS                        1
+#define configTIMER_TASK_PRIORITY               ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH                10
+#define configTIMER_TASK_STACK_DEPTH            configMINIMAL_STACK_SIZE
+
+/* Um núcleo: a aplicação dimensiona os vetores por núcleo com configNUM_CORES
+   e cria os workers com afinidade, que aqui é ignorada. */
+#define configNUMBER_OF_CORES                   1
+#define configNUM_CORES                         1
+#define configTICK_CORE                         0
+#define configUSE_CORE_AFFINITY                 0
+#define xTaskCreateStaticAffinitySet( fn, name, depth, param, prio, stack, tcb, affinity ) \
+    xTaskCreateStatic( ( fn ), ( name ), ( depth ), ( param ), ( prio ), ( stack ), ( tcb ) )
+
+/* Chamado pela aplicação para saber se está numa ISR (sim.c marca as
+   interrupções simuladas) */
+#define portCHECK_IF_IN_ISR()                   sim_in_isr()
+
+/* Idle com todas as tarefas bloqueadas: com PANEL_SIM_VIRTUAL, sim.c avança os
+   ticks até o próximo desbloqueio sem esperar o relógio real; sem ele, volta
+   e o tick periódico segue normal. */
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )  sim_idle_skip( xExpectedIdleTime )
+
+#include <assert.h>
+#define configASSERT(x)                         assert(x)
+
+#define INCLUDE_vTaskPrioritySet                1
+#define INCLUDE_uxTaskPriorityGet               1
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_eTaskGetState                   1
+#define INCLUDE_xTimerPendFunctionCall          1
+#define INCLUDE_xTaskAbortDelay                 1
+#define INCLUDE_xTaskGetHandle                  1
+#define INCLUDE_xTaskResumeFromISR              1
+#define INCLUDE_xQueueGetMutexHolder            1
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,2 @@
+// Build nativa: ver pico_host.h
+#include "pico_host.h"
@@ -0,0 +1,26 @@
+// Build nativa: substitui o cabeçalho gerado pelo pioasm a partir de
+// pio/led_matrix.pio. O programa não é executado; as palavras enviadas à
+// máquina de estados viram os pixels da matriz simulada (sim.h).
+#pragma once
+
+#include "pico_host.h"
+
+static const pio_program_t led_matrix_program = { NULL, 0, -1 };
+
+static inline pio_sm_config led_matrix_program_get_default_config(uint offset) {
+    (void)offset;
+    return pio_get_default_sm_config();
+}
+
+static inline float led_matrix_program_clkdiv(uint32_t sys_hz) {
+    return (float)sys_hz / 8000000.0f;
+}
+
+static inline void led_matrix_program_init(PIO pio, uint sm, uint offset, uint pin) {
+    pio_sm_config c = led_matrix_program_get_default_config(offset);
+    sm_config_set_set_pins(&c, pin, 1);
+    pio_gpio_init(pio, pin);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, true);
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_set_enabled(pio, sm, true);
+}
@@ -0,0 +1,223 @@
+#ifndef PICO_HOST_H
+#define PICO_HOST_H
+
+// Subconjunto do Pico SDK usado pela aplicação, implementado por src/host/sim.c
+// sobre periféricos simulados. Todos os cabeçalhos "pico/..." e "hardware/..."
+// da build nativa incluem este arquivo: o código dos drivers é o mesmo da placa.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef unsigned int uint;
+
+#define PICO_OK             0
+#define PICO_ERROR_TIMEOUT  (-1)
+#define PICO_ERROR_GENERIC  (-2)
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#define __not_in_flash_func(name) name
+#define __time_critical_func(name) name
+#define __compiler_memory_barrier() __asm__ volatile("" ::: "memory")
+#define __dmb() __sync_synchronize()
+#define __sev() do { } while (0)
+#define __wfe() do { } while (0)
+#define __wfi() do { } while (0)
+
+void panic(const char *fmt, ...) __attribute__((noreturn));
+static inline void tight_loop_contents(void) {}
+static inline uint get_core_num(void) { return 0; } // Port POSIX: um núcleo
+
+// --- Tempo (relógio simulado: 1 tick do FreeRTOS = 1 ms) ---
+typedef uint64_t absolute_time_t;
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+static inline void busy_wait_us_32(uint32_t us) { busy_wait_us(us); }
+static inline void busy_wait_ms(uint32_t ms) { busy_wait_us((uint64_t)ms * 1000); }
+
+// --- stdio (stdin/stdout do processo no lugar do CDC USB) ---
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+bool stdio_usb_connected(void);
+
+// --- Interrupções ---
+typedef void (*irq_handler_t)(void);
+enum irq_num_rp2040 {
+    TIMER_IRQ_0 = 0, PWM_IRQ_WRAP = 4, PIO0_IRQ_0 = 7, PIO0_IRQ_1 = 8, PIO1_IRQ_0 = 9, PIO1_IRQ_1 = 10,
+    DMA_IRQ_0 = 11, IO_IRQ_BANK0 = 13, SIO_IRQ_PROC0 = 15, SIO_IRQ_PROC1 = 16, I2C0_IRQ = 23, I2C1_IRQ = 24,
+    SIM_NUM_IRQS = 32,
+};
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_priority(uint num, uint8_t priority);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+// --- GPIO ---
+#define SIM_NUM_GPIOS 30
+enum gpio_dir { GPIO_IN = 0, GPIO_OUT = 1 };
+enum gpio_function {
+    GPIO_FUNC_XIP = 0, GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7, GPIO_FUNC_NULL = 0x1f,
+};
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1, GPIO_IRQ_LEVEL_HIGH = 0x2, GPIO_IRQ_EDGE_FALL = 0x4, GPIO_IRQ_EDGE_RISE = 0x8,
+};
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_input_enabled(uint gpio, bool enabled);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void gpio_set_dormant_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler);
+uint32_t gpio_get_irq_event_mask(uint gpio);
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask);
+
+// --- PWM ---
+enum { PWM_CHAN_A = 0, PWM_CHAN_B = 1 };
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+static inline uint pwm_gpio_to_channel(uint gpio) { return gpio & 1; }
+void pwm_set_wrap(uint slice, uint16_t wrap);
+void pwm_set_chan_level(uint slice, uint chan, uint16_t level);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_clkdiv_int_frac(uint slice, uint8_t integer, uint8_t fract);
+void pwm_set_clkdiv(uint slice, float divider);
+void pwm_set_enabled(uint slice, bool enabled);
+void pwm_set_irq_enabled(uint slice, bool enabled);
+void pwm_clear_irq(uint slice);
+uint32_t pwm_get_irq_status_mask(void);
+
+// --- I2C ---
+typedef struct i2c_inst {
+    uint index;
+    uint baudrate;
+} i2c_inst_t;
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+// --- PIO (só as FIFOs e as flags de IRQ; só o programa Wiegand é executado, em wiegand_sim.c) ---
+#define SIM_PIO_FIFO_DEPTH 8
+typedef struct pio_hw {
+    uint index;
+    uint32_t irq;                  // Flags de IRQ das máquinas de estado
+    uint32_t inte0;                // Fontes habilitadas na linha IRQ0
+    uint32_t rx[4][SIM_PIO_FIFO_DEPTH];
+    uint8_t rx_head[4], rx_count[4];
+    bool enabled[4];
+    uint pin[4];
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+extern pio_hw_t pio0_hw_inst, pio1_hw_inst;
+#define pio0 (&pio0_hw_inst)
+#define pio1 (&pio1_hw_inst)
+
+typedef struct {
+    uint32_t clkdiv, execctrl, shiftctrl, pinctrl;
+} pio_sm_config;
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+enum pio_interrupt_source { pis_interrupt0 = 8, pis_interrupt1, pis_interrupt2, pis_interrupt3 };
+
+static inline pio_sm_config pio_get_default_sm_config(void) { pio_sm_config c = { 0 }; return c; }
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint base, uint count) { c->pinctrl = base | (count << 8); }
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint base) { c->pinctrl = base; }
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint base, uint count) { c->pinctrl = base | (count << 8); }
+static inline void sm_config_set_jmp_pin(pio_sm_config *c, uint pin) { (void)c; (void)pin; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv = (uint32_t)(div * 256); }
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { (void)c; (void)join; }
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool right, bool autopull, uint threshold) {
+    (void)c; (void)right; (void)autopull; (void)threshold;
+}
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool right, bool autopush, uint threshold) {
+    (void)c; (void)right; (void)autopush; (void)threshold;
+}
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_sm_claim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool is_out);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_interrupt_get(PIO pio, uint n);
+void pio_interrupt_clear(PIO pio, uint n);
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+
+// --- Clocks ---
+enum clock_index { clk_gpout0 = 0, clk_ref = 4, clk_sys = 5, clk_peri = 6, clk_usb = 7, clk_adc = 8, clk_rtc = 9 };
+uint32_t clock_get_hz(enum clock_index clk);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+// --- Regulador do núcleo (só registrado no log da simulação) ---
+enum vreg_voltage { VREG_VOLTAGE_1_10 = 0b1011, VREG_VOLTAGE_1_15 = 0b1100, VREG_VOLTAGE_DEFAULT = VREG_VOLTAGE_1_10 };
+void vreg_set_voltage(enum vreg_voltage voltage);
+
+// --- Watchdog (os scratch sobrevivem só dentro do processo) ---
+typedef struct {
+    volatile uint32_t ctrl, load, reason;
+    volatile uint32_t scratch[8];
+    volatile uint32_t tick;
+} watchdog_hw_t;
+extern watchdog_hw_t *const watchdog_hw;
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+
+// --- SysTick (parado: as medições de ciclos dão 0 no host) ---
+typedef struct {
+    volatile uint32_t csr, rvr, cvr, calib;
+} systick_hw_t;
+extern systick_hw_t *const systick_hw;
+
+// --- Flash (XIP mapeado em memória; ver PANEL_SIM_FLASH em sim.h) ---
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define FLASH_PAGE_SIZE       (1u << 8)
+#define FLASH_SECTOR_SIZE     (1u << 12)
+extern uint8_t *sim_flash;
+#define XIP_BASE ((uintptr_t)sim_flash)
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+
+#endif // PICO_HOST_H
@@ -0,0 +1,64 @@
+// Build nativa: substitui o cabeçalho gerado pelo pioasm a partir de
+// pio/wiegand.pio, com as mesmas palavras de instrução. sim_wiegand_frame()
+// (sim.h) executa o programa sobre o trem de pulsos D0/D1 com o interpretador
+// de wiegand_sim.c; manter as duas listagens em sincronia.
+#pragma once
+
+#include "pico_host.h"
+
+#define wiegand_wrap_target 0
+#define wiegand_wrap 21
+
+#define wiegand_offset_frame_start 9u
+
+static const uint16_t wiegand_program_instructions[] = {
+    0x0003, //  0: jmp    3
+    0x0012, //  1: jmp    18
+    0x000f, //  2: jmp    15
+    0x074d, //  3: jmp    x--, 13            [7]
+    0xa02a, //  4: mov    x, ~y
+    0x0029, //  5: jmp    !x, 9
+    0x8020, //  6: push   block
+    0x4020, //  7: in     x, 32
+    0xc010, //  8: irq    nowait 0 rel
+    0xa04b, //  9: mov    y, ~null
+    0xa0c3, // 10: mov    isr, null
+    0xa0eb, // 11: mov    osr, ~null
+    0x602b, // 12: out    x, 11
+    0xa0e0, // 13: mov    osr, pins
+    0x60a2, // 14: out    pc, 2
+    0x4061, // 15: in     null, 1
+    0x20a0, // 16: wait   1 pin, 0
+    0x008b, // 17: jmp    y--, 11
+    0xa0eb, // 18: mov    osr, ~null
+    0x40e1, // 19: in     osr, 1
+    0x20a1, // 20: wait   1 pin, 1
+    0x008b, // 21: jmp    y--, 11
+};
+
+static const pio_program_t wiegand_program = {
+    wiegand_program_instructions,
+    sizeof(wiegand_program_instructions) / sizeof(wiegand_program_instructions[0]),
+    0,
+};
+
+static inline pio_sm_config wiegand_program_get_default_config(uint offset) {
+    (void)offset;
+    return pio_get_default_sm_config();
+}
+
+static inline float wiegand_program_clkdiv(uint32_t sys_hz) {
+    return (float)sys_hz / 1000000.0f;
+}
+
+static inline void wiegand_program_init(PIO pio, uint sm, uint offset, uint d0_pin) {
+    pio_sm_config c = wiegand_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, d0_pin);
+    pio_sm_set_consecutive_pindirs(pio, sm, d0_pin, 2, false);
+    pio_gpio_init(pio, d0_pin);
+    pio_gpio_init(pio, d0_pin + 1);
+    gpio_pull_up(d0_pin);
+    gpio_pull_up(d0_pin + 1);
+    pio_sm_init(pio, sm, offset + wiegand_offset_frame_start, &c);
+    pio_sm_set_enabled(pio, sm, true);
+}
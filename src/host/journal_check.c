@@ -0,0 +1,260 @@
+// src/host/journal_check.c
+
+#include "config.h"
+#include "event_journal.h"
+#include "bare.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+/*
+ * Verificação do diário na flash com falhas injetadas (alvo panel_journal,
+ * só na build nativa). A flash é um vetor em RAM com a semântica da NOR
+ * (gravar só zera bits, apagar volta o setor a 0xFF); cada cenário grava,
+ * falha onde pede e então recupera o diário com journal_init(), como num
+ * boot, conferindo que nenhum registro aceito se perdeu sem ser contado.
+ * Por fim enche as JOURNAL_NUM_SECTORS do diário por journal_log() e
+ * journal_commit() e mede, no relógio do host (o de bare.c fica parado), a
+ * vazão em registros/s e o tempo de journal_init() sobre a região cheia.
+ *
+ *   ./build-host/panel_journal
+ *
+ * Sai com 1 se algum cenário falhar.
+ */
+
+#define REGION_OFFSET   (PICO_FLASH_SIZE_BYTES - JOURNAL_NUM_SECTORS * FLASH_SECTOR_SIZE)
+#define RECORDS_PER_SECTOR (FLASH_SECTOR_SIZE / sizeof(journal_record_t) - 1)
+
+// --- Flash com falhas injetadas (substitui sim.c) ---
+
+static uint8_t flash_mem[PICO_FLASH_SIZE_BYTES];
+uint8_t *sim_flash = flash_mem;
+
+static uint fail_programs;      // Próximas gravações de página que falham
+static uint fail_erases;        // Próximos apagamentos que falham
+static int stuck_sector = -1;   // Setor do diário que "apaga" sem mudar (falha silenciosa)
+static bool op_failed;
+
+void flash_range_erase(uint32_t offs, size_t count) {
+    if (fail_erases) {
+        fail_erases--;
+        op_failed = true;
+        return;
+    }
+    if (stuck_sector >= 0 && offs == REGION_OFFSET + (uint32_t)stuck_sector * FLASH_SECTOR_SIZE) return;
+    memset(&flash_mem[offs], 0xFF, count);
+}
+
+void flash_range_program(uint32_t offs, const uint8_t *data, size_t count) {
+    if (fail_programs) {
+        fail_programs--;
+        op_failed = true;
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        flash_mem[offs + i] &= data[i];
+    }
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t timeout_ms) {
+    (void)timeout_ms;
+    op_failed = false;
+    func(param);
+    return op_failed ? PICO_ERROR_TIMEOUT : PICO_OK;
+}
+
+// --- Cenários ---
+
+static int failures;
+static uint32_t logged;         // Registros aceitos pelo anel em todos os cenários
+
+static void check(bool ok, const char *what, uint64_t got, uint64_t want) {
+    if (!ok) {
+        printf("FALHOU    %s: %" PRIu64 " (esperado %" PRIu64 ")\n", what, got, want);
+        failures++;
+    }
+}
+
+static void format_flash(void) {
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    fail_programs = fail_erases = 0;
+    stuck_sector = -1;
+    logged = 0;
+    journal_init();
+}
+
+static void log_n(uint n) {
+    for (uint i = 0; i < n; ++i) {
+        journal_log(JOURNAL_EVT_ENTRY, JOURNAL_ZONE_BUTTON, logged, (uint16_t)logged);
+        logged++;
+    }
+}
+
+// Novo boot: recupera da flash e confere quantos registros e qual o último
+static void reboot_and_check(const char *name, int before) {
+    journal_record_t last;
+    journal_stats_t st;
+
+    journal_init();
+    journal_get_stats(&st);
+    check(st.recovered == logged, "registros recuperados", st.recovered, logged);
+    check(st.corrupt == 0, "registros corrompidos", st.corrupt, 0);
+    check(journal_get_last(&last) && last.badge == logged - 1, "ultimo registro", last.badge, logged - 1);
+    printf("%s %s\n", failures == before ? "ok       " : "FALHOU   ", name);
+}
+
+/**
+ * @brief Gravação de página falha: os registros ficam no anel, a falha é
+ *        contada e a próxima chamada os grava.
+ */
+static void run_program_failure(void) {
+    int before = failures;
+    journal_stats_t st;
+    journal_record_t last;
+
+    format_flash();
+    log_n(3);
+    check(journal_commit(), "primeiro lote", 0, 1);
+
+    log_n(5);
+    fail_programs = 1;
+    check(!journal_commit(), "commit com falha retorna false", 1, 0);
+    journal_get_stats(&st);
+    check(st.program_failed == 1, "paginas com falha", st.program_failed, 1);
+    check(st.committed == 3, "gravados antes da nova tentativa", st.committed, 3);
+    check(journal_get_last(&last) && last.badge == 2, "ultimo registro antes da nova tentativa", last.badge, 2);
+
+    check(journal_commit(), "nova tentativa", 0, 1);
+    journal_get_stats(&st);
+    check(st.committed == 8 && st.dropped == 0, "gravados apos a nova tentativa", st.committed, 8);
+    reboot_and_check("gravacao de pagina com falha", before);
+}
+
+/**
+ * @brief Falha na primeira página de um setor novo: o cabeçalho vai junto na
+ *        nova tentativa.
+ */
+static void run_header_failure(void) {
+    int before = failures;
+
+    format_flash();
+    log_n(1);
+    fail_programs = 1;
+    check(!journal_commit(), "primeira pagina com falha", 1, 0);
+    check(journal_commit(), "nova tentativa com o cabecalho", 0, 1);
+    reboot_and_check("cabecalho com falha", before);
+}
+
+/**
+ * @brief Flash falhando por mais tempo que o anel aguenta: o excesso é
+ *        descartado e contado, nunca perdido em silêncio.
+ */
+static void run_ring_overflow(void) {
+    int before = failures;
+    journal_stats_t st;
+
+    format_flash();
+    fail_programs = 1000;
+    log_n(JOURNAL_RAM_RING_LEN);
+    check(!journal_commit(), "commit com a flash falhando", 1, 0);
+    journal_log(JOURNAL_EVT_ENTRY, JOURNAL_ZONE_BUTTON, 0, 0);
+    journal_get_stats(&st);
+    check(st.dropped == 1, "descartados com o anel cheio", st.dropped, 1);
+
+    fail_programs = 0;
+    check(journal_commit(), "commit com a flash de volta", 0, 1);
+    reboot_and_check("anel cheio com a flash falhando", before);
+}
+
+/**
+ * @brief Rotação com o próximo setor que não apaga (falha relatada e falha
+ *        silenciosa com conteúdo antigo): o setor é pulado e contado, e nada
+ *        é gravado por cima de dados velhos.
+ */
+static void run_erase_failure(bool silent) {
+    int before = failures;
+    journal_stats_t st;
+
+    format_flash();
+    memset(&flash_mem[REGION_OFFSET + FLASH_SECTOR_SIZE], 0x00, FLASH_SECTOR_SIZE);  // Setor 1 sujo
+    for (uint n = 0; n < RECORDS_PER_SECTOR; n += JOURNAL_RAM_RING_LEN / 2) {
+        log_n(RECORDS_PER_SECTOR - n < JOURNAL_RAM_RING_LEN / 2 ? RECORDS_PER_SECTOR - n : JOURNAL_RAM_RING_LEN / 2);
+        check(journal_commit(), "enchendo o setor 0", 0, 1);
+    }
+
+    if (silent) {
+        stuck_sector = 1;
+    } else {
+        fail_erases = 1;
+    }
+    log_n(10);
+    check(journal_commit(), "rotacao pulando o setor 1", 0, 1);
+    journal_get_stats(&st);
+    check(st.erase_failed == 1, "setores que nao apagaram", st.erase_failed, 1);
+    check(st.sector_seq == 2, "sequencia do setor aberto", st.sector_seq, 2);
+    stuck_sector = -1;
+    reboot_and_check(silent ? "setor que nao apaga (silencioso)" : "setor que nao apaga", before);
+}
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * @brief Vazão sustentada e recuperação com a região inteira gravada: lotes
+ *        de meio anel, cada um seguido de um commit (como aoDiarioFlash num
+ *        pico de movimento), até encher todos os setores; depois um boot.
+ *        Mede o custo de CPU do caminho, não os tempos da NOR.
+ */
+static void run_full_region(void) {
+    const uint32_t total = JOURNAL_NUM_SECTORS * RECORDS_PER_SECTOR;
+    int before = failures;
+    journal_stats_t st;
+
+    format_flash();
+    uint64_t t0 = wall_ns();
+    while (logged < total) {
+        log_n(total - logged < JOURNAL_RAM_RING_LEN / 2 ? total - logged : JOURNAL_RAM_RING_LEN / 2);
+        if (!journal_commit()) {
+            check(false, "commit enchendo a regiao", logged, total);
+            return;
+        }
+    }
+    uint64_t write_ns = wall_ns() - t0;
+    journal_get_stats(&st);
+    check(st.sector_seq == JOURNAL_NUM_SECTORS, "setores gravados", st.sector_seq, JOURNAL_NUM_SECTORS);
+    check(st.erase_failed == 0 && st.program_failed == 0, "falhas da flash", st.erase_failed + st.program_failed, 0);
+
+    t0 = wall_ns();
+    journal_init();
+    uint64_t init_ns = wall_ns() - t0;
+    journal_get_stats(&st);
+    check(st.recovered == total, "registros recuperados", st.recovered, total);
+    check(st.corrupt == 0, "registros corrompidos", st.corrupt, 0);
+
+    printf("%s regiao cheia: %" PRIu32 " registros a %.0f registros/s; recuperacao de %u setores em %.1f us\n",
+           failures == before ? "ok       " : "FALHOU   ", total, total * 1e9 / (write_ns ? write_ns : 1),
+           JOURNAL_NUM_SECTORS, init_ns / 1e3);
+}
+
+int main(void) {
+    bare_set_time_us(1000000u);
+
+    run_program_failure();
+    run_header_failure();
+    run_ring_overflow();
+    run_erase_failure(false);
+    run_erase_failure(true);
+    run_full_region();
+
+    if (failures) {
+        printf("%d verificacao(oes) do diario falharam\n", failures);
+        return 1;
+    }
+    return 0;
+}
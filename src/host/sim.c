@@ -0,0 +1,1144 @@
+#include "sim.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "config.h"
+#include "buttons.h"   // buttons_inject(), para a ação inject do roteiro
+#include "low_power.h" // Cada salto do relógio virtual conta como um sono
+#include "wiegand_sim.h" // Programa de pio/wiegand.pio sobre os pulsos D0/D1
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OLED_PAGES        8
+#define OLED_COLUMNS      128
+#define CONSOLE_RX_LEN    256
+#define OUT_BUFFER_LEN    1024
+#define MAX_RAW_HANDLERS  4
+#define MAX_RELEASES      8
+#define SIM_CLK_SYS_HZ    125000000u
+
+// --- Estado dos periféricos ---
+typedef struct {
+    bool out;              // Direção
+    bool out_level;
+    bool ext_level;        // Nível externo (sim_gpio_drive)
+    bool driven;
+    bool pull_up, pull_down;
+    uint8_t function;
+    uint32_t irq_mask;     // Eventos habilitados
+    uint32_t pending;      // Eventos aguardando o handler
+} sim_gpio_t;
+
+typedef struct {
+    irq_handler_t handler;
+    uint32_t mask;
+} raw_handler_t;
+
+static sim_gpio_t gpios[SIM_NUM_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+static raw_handler_t raw_handlers[MAX_RAW_HANDLERS];
+static irq_handler_t irq_handlers[SIM_NUM_IRQS];
+static bool irq_enabled[SIM_NUM_IRQS];
+static sim_pwm_slice_t pwm_slices[8];
+static uint8_t pwm_irq_mask, pwm_irq_status;   // IRQ de wrap habilitada / pendente por slice
+static uint64_t pwm_next_wrap_us[8];
+static uint32_t clk_sys_hz = SIM_CLK_SYS_HZ;
+static uint32_t i2c_fail_left;      // Próximas escritas I2C que falham (roteiro: i2c_fail)
+static uint32_t i2c_max_hz;         // Baud acima do qual toda escrita falha (roteiro: i2c_max)
+
+i2c_inst_t i2c0_inst = { 0, 0 }, i2c1_inst = { 1, 0 };
+pio_hw_t pio0_hw_inst = { .index = 0 }, pio1_hw_inst = { .index = 1 };
+
+static watchdog_hw_t watchdog_regs;
+watchdog_hw_t *const watchdog_hw = &watchdog_regs;
+static systick_hw_t systick_regs = { .rvr = 0x00FFFFFF };
+systick_hw_t *const systick_hw = &systick_regs;
+
+static uint8_t flash_mem[PICO_FLASH_SIZE_BYTES];
+uint8_t *sim_flash = flash_mem;
+
+// SSD1306: GDDRAM e ponteiro de escrita conforme o modo de endereçamento
+static struct {
+    uint8_t gddram[OLED_PAGES][OLED_COLUMNS];
+    uint8_t mode;                  // 0 horizontal, 1 vertical, 2 página
+    uint8_t col, col_start, col_end;
+    uint8_t page, page_start, page_end;
+    uint8_t cmd, args_left, args[2];
+    bool on;
+    uint32_t frames;
+} oled = { .mode = 2, .col_end = OLED_COLUMNS - 1, .page_end = OLED_PAGES - 1 };
+
+// WS2812 da matriz: a palavra n de cada quadro é o LED n % MATRIX_SIZE
+static uint32_t matrix_pixels[MATRIX_SIZE];
+static uint32_t matrix_words;
+
+// Terminal: bytes recebidos (roteiro ou stdin) e saída em write() único
+static uint8_t console_rx[CONSOLE_RX_LEN];
+static uint16_t console_head, console_count;
+static void (*chars_available)(void *);
+static void *chars_available_param;
+static bool stdin_open = true;
+static char out_buffer[OUT_BUFFER_LEN];
+static size_t out_len;
+
+// Relógio: o tick do FreeRTOS vale 1 ms simulado; entre ticks interpola pelo
+// relógio real escalado. Antes do escalonador, as esperas só somam boot_us.
+static uint64_t boot_us;
+static volatile uint32_t tick_seq;
+static volatile TickType_t tick_count;
+static volatile uint64_t tick_wall_ns;
+static bool virtual_clock;     // PANEL_SIM_VIRTUAL
+
+static uint32_t watchdog_timeout_ms;
+static uint32_t watchdog_fed_ms;
+
+static FILE *log_file;
+static TaskHandle_t sim_task;
+static volatile bool dispatching;
+
+// Roteiro
+typedef struct {
+    uint32_t at_ms;
+    char *line;
+} sim_action_t;
+
+static sim_action_t *actions;
+static size_t n_actions, next_action;
+static struct {
+    uint gpio;
+    uint32_t at_ms;
+} releases[MAX_RELEASES];
+
+static StaticTask_t sim_tcb;
+static StackType_t sim_stack[configMINIMAL_STACK_SIZE];
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool scheduler_running(void) {
+    return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+}
+
+// --- Saída sem stdio: o port POSIX suspende threads por sinal, e uma tarefa
+// suspensa dentro do printf da libc prenderia o lock do stdout. As funções
+// abaixo substituem printf/puts/putchar (-Wl,--wrap) e só chamam write().
+
+static void write_all(const char *data, size_t len) {
+    while (len) {
+        ssize_t n = write(STDOUT_FILENO, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void out_flush(void) {
+    write_all(out_buffer, out_len);
+    out_len = 0;
+}
+
+static void out_bytes(const char *data, size_t len) {
+    if (out_len + len > sizeof(out_buffer)) out_flush();
+    if (len > sizeof(out_buffer)) {
+        write_all(data, len);
+        return;
+    }
+    memcpy(&out_buffer[out_len], data, len);
+    out_len += len;
+}
+
+int __wrap_vprintf(const char *fmt, va_list ap) {
+    char text[512];
+    int n = vsnprintf(text, sizeof(text), fmt, ap);
+    if (n < 0) return n;
+    taskENTER_CRITICAL();
+    out_bytes(text, (size_t)n < sizeof(text) ? (size_t)n : sizeof(text) - 1);
+    out_flush();
+    taskEXIT_CRITICAL();
+    return n;
+}
+
+int __wrap_printf(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = __wrap_vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+int __wrap_puts(const char *s) {
+    return __wrap_printf("%s\n", s);
+}
+
+int __wrap_putchar(int c) {
+    return __wrap_printf("%c", c);
+}
+
+int putchar_raw(int c) {
+    char b = (char)c;
+    taskENTER_CRITICAL();
+    out_bytes(&b, 1);
+    if (b == 0 && out_len > 1) out_flush(); // Fim de um quadro do protocolo USB
+    taskEXIT_CRITICAL();
+    return c;
+}
+
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation) {
+    (void)cr_translation;
+    taskENTER_CRITICAL();
+    out_bytes(s, (size_t)len);
+    if (newline) out_bytes("\n", 1);
+    out_flush();
+    taskEXIT_CRITICAL();
+    return len;
+}
+
+static void sim_log(const char *fmt, ...) {
+    if (!log_file) return;
+    va_list ap;
+    va_start(ap, fmt);
+    taskENTER_CRITICAL();
+    fprintf(log_file, "%llu ", (unsigned long long)time_us_64());
+    vfprintf(log_file, fmt, ap);
+    fputc('\n', log_file);
+    taskEXIT_CRITICAL();
+    va_end(ap);
+}
+
+static void sim_log_hex(const char *prefix, const uint8_t *data, size_t len) {
+    if (!log_file) return;
+    taskENTER_CRITICAL();
+    fprintf(log_file, "%llu %s ", (unsigned long long)time_us_64(), prefix);
+    for (size_t i = 0; i < len; ++i) fprintf(log_file, "%02x", data[i]);
+    fputc('\n', log_file);
+    taskEXIT_CRITICAL();
+}
+
+void panic(const char *fmt, ...) {
+    char text[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+    out_flush();
+    write_all("\n*** PANIC ***\n", 15);
+    if (n > 0) write_all(text, (size_t)n < sizeof(text) ? (size_t)n : sizeof(text) - 1);
+    write_all("\n", 1);
+    if (log_file) fflush(log_file);
+    _exit(SIM_EXIT_PANIC);
+}
+
+// --- Tempo ---
+
+static void publish_tick(TickType_t ticks) {
+    tick_seq++;
+    __sync_synchronize();
+    tick_count = ticks;
+    tick_wall_ns = wall_ns();
+    __sync_synchronize();
+    tick_seq++;
+}
+
+void vApplicationTickHook(void) {
+    publish_tick(xTaskGetTickCountFromISR());
+}
+
+/**
+ * @brief Relógio virtual: chamada pelo idle com o escalonador suspenso e
+ *        todas as tarefas bloqueadas por idle_ticks. Avança o contador de
+ *        ticks de uma vez (o último tick fica pendente e desbloqueia a
+ *        tarefa ao retomar o escalonador).
+ */
+void sim_idle_skip(uint32_t idle_ticks) {
+    if (!virtual_clock) return;
+    TickType_t target = xTaskGetTickCount() + idle_ticks;
+    vTaskStepTick(idle_ticks);
+    publish_tick(target);
+    low_power_record_sleep(idle_ticks * 1000, LOW_POWER_WAKE_TIMER);
+    // No RP2040 o idle hook alimentaria o watchdog durante todo o intervalo
+    watchdog_fed_ms = (uint32_t)(time_us_64() / 1000);
+}
+
+uint64_t time_us_64(void) {
+    if (!scheduler_running()) return boot_us;
+
+    uint32_t seq;
+    TickType_t ticks;
+    uint64_t wall;
+    do {
+        seq = tick_seq;
+        __sync_synchronize();
+        ticks = tick_count;
+        wall = tick_wall_ns;
+        __sync_synchronize();
+    } while ((seq & 1) || seq != tick_seq);
+
+    uint64_t sub = (wall_ns() - wall) * PANEL_HOST_TIME_SCALE / 1000;
+    if (sub > 999) sub = 999;
+    return boot_us + (uint64_t)ticks * 1000 + sub;
+}
+
+void busy_wait_us(uint64_t us) {
+    if (!scheduler_running()) {
+        boot_us += us;
+        return;
+    }
+    // A tarefa segura a CPU simulada pelo tempo da espera, como no RP2040
+    uint64_t ns = us * 1000 / PANEL_HOST_TIME_SCALE;
+    struct timespec req = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) }, rem;
+    while (nanosleep(&req, &rem) != 0 && errno == EINTR) req = rem;
+}
+
+void sleep_us(uint64_t us) {
+    if (scheduler_running() && us >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(us / 1000));
+    } else {
+        busy_wait_us(us);
+    }
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+// --- Interrupções ---
+
+int sim_in_isr(void) {
+    return dispatching && xTaskGetCurrentTaskHandle() == sim_task;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    irq_handlers[num] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    irq_enabled[num] = enabled;
+}
+
+void irq_set_priority(uint num, uint8_t priority) {
+    (void)num;
+    (void)priority;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    return (uint32_t)taskENTER_CRITICAL_FROM_ISR();
+}
+
+void restore_interrupts(uint32_t status) {
+    taskEXIT_CRITICAL_FROM_ISR((UBaseType_t)status);
+}
+
+static void raise_irq(uint num) {
+    if (!irq_enabled[num] || !irq_handlers[num]) return;
+    dispatching = true;
+    irq_handlers[num]();
+    dispatching = false;
+}
+
+// --- GPIO ---
+
+void gpio_init(uint gpio) {
+    gpios[gpio].out = false;
+    gpios[gpio].out_level = false;
+    gpios[gpio].function = GPIO_FUNC_SIO;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    gpios[gpio].out = out;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpios[gpio].out_level != value) sim_log("gpio %u %u", gpio, value);
+    gpios[gpio].out_level = value;
+}
+
+bool gpio_get(uint gpio) {
+    const sim_gpio_t *g = &gpios[gpio];
+    if (g->out) return g->out_level;
+    if (g->driven) return g->ext_level;
+    return g->pull_up;
+}
+
+void gpio_pull_up(uint gpio) {
+    gpios[gpio].pull_up = true;
+    gpios[gpio].pull_down = false;
+}
+
+void gpio_pull_down(uint gpio) {
+    gpios[gpio].pull_up = false;
+    gpios[gpio].pull_down = true;
+}
+
+void gpio_disable_pulls(uint gpio) {
+    gpios[gpio].pull_up = false;
+    gpios[gpio].pull_down = false;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    gpios[gpio].function = (uint8_t)fn;
+}
+
+void gpio_set_input_enabled(uint gpio, bool enabled) {
+    (void)gpio;
+    (void)enabled;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (enabled) {
+        gpios[gpio].irq_mask |= event_mask;
+    } else {
+        gpios[gpio].irq_mask &= ~event_mask;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    gpio_callback = callback;
+    irq_enabled[IO_IRQ_BANK0] = true;
+}
+
+void gpio_set_dormant_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler) {
+    for (uint i = 0; i < MAX_RAW_HANDLERS; ++i) {
+        if (!raw_handlers[i].handler) {
+            raw_handlers[i].handler = handler;
+            raw_handlers[i].mask = gpio_mask;
+            return;
+        }
+    }
+    panic("sim: handlers de GPIO esgotados");
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+    return gpios[gpio].pending;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask) {
+    gpios[gpio].pending &= ~event_mask;
+}
+
+/**
+ * @brief Despacha as bordas pendentes como o handler de IO_IRQ_BANK0 do SDK:
+ *        primeiro os handlers crus dos pinos deles, depois o callback único.
+ */
+static void dispatch_gpio_irq(void) {
+    if (!irq_enabled[IO_IRQ_BANK0]) return;
+    dispatching = true;
+    for (uint i = 0; i < MAX_RAW_HANDLERS && raw_handlers[i].handler; ++i) {
+        bool hit = false;
+        for (uint pin = 0; pin < SIM_NUM_GPIOS; ++pin) {
+            if ((raw_handlers[i].mask & (1u << pin)) && gpios[pin].pending) hit = true;
+        }
+        if (hit) raw_handlers[i].handler();
+    }
+    for (uint pin = 0; pin < SIM_NUM_GPIOS; ++pin) {
+        uint32_t events = gpios[pin].pending;
+        if (events && gpio_callback) {
+            gpios[pin].pending = 0;
+            gpio_callback(pin, events);
+        }
+    }
+    dispatching = false;
+}
+
+void sim_gpio_drive(uint gpio, bool level) {
+    bool before = gpio_get(gpio);
+    gpios[gpio].driven = true;
+    gpios[gpio].ext_level = level;
+    bool after = gpio_get(gpio);
+    if (before == after) return;
+
+    uint32_t event = after ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (gpios[gpio].irq_mask & event) {
+        gpios[gpio].pending |= event;
+        dispatch_gpio_irq();
+    }
+}
+
+// --- PWM ---
+
+static void pwm_changed(uint slice) {
+    const sim_pwm_slice_t *s = &pwm_slices[slice];
+    sim_log("pwm %u %s %u %u %u %u", slice, s->enabled ? "on" : "off", s->wrap, s->div16, s->level[0], s->level[1]);
+}
+
+void pwm_set_wrap(uint slice, uint16_t wrap) {
+    pwm_slices[slice].wrap = wrap;
+}
+
+void pwm_set_chan_level(uint slice, uint chan, uint16_t level) {
+    bool changed = pwm_slices[slice].level[chan] != level;
+    pwm_slices[slice].level[chan] = level;
+    if (changed && pwm_slices[slice].enabled) pwm_changed(slice);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_clkdiv_int_frac(uint slice, uint8_t integer, uint8_t fract) {
+    pwm_slices[slice].div16 = (uint16_t)(integer * 16 + fract);
+}
+
+void pwm_set_clkdiv(uint slice, float divider) {
+    pwm_slices[slice].div16 = (uint16_t)(divider * 16);
+}
+
+// Período de wrap do slice no clk_sys simulado
+static uint64_t pwm_period_us(uint slice) {
+    const sim_pwm_slice_t *s = &pwm_slices[slice];
+    uint64_t us = (uint64_t)s->div16 * (s->wrap + 1u) * 1000000 / 16 / clk_sys_hz;
+    return us ? us : 1;
+}
+
+void pwm_set_enabled(uint slice, bool enabled) {
+    bool changed = pwm_slices[slice].enabled != enabled;
+    pwm_slices[slice].enabled = enabled;
+    if (changed && enabled) pwm_next_wrap_us[slice] = time_us_64() + pwm_period_us(slice);
+    if (changed) pwm_changed(slice);
+}
+
+void pwm_set_irq_enabled(uint slice, bool enabled) {
+    if (enabled) {
+        pwm_irq_mask |= 1u << slice;
+    } else {
+        pwm_irq_mask &= ~(1u << slice);
+    }
+}
+
+void pwm_clear_irq(uint slice) {
+    pwm_irq_status &= ~(1u << slice);
+}
+
+uint32_t pwm_get_irq_status_mask(void) {
+    return pwm_irq_status;
+}
+
+/**
+ * @brief Entrega a IRQ de wrap dos slices ligados com a IRQ habilitada. Os
+ *        wraps perdidos entre duas voltas da tarefa Sim viram um só, como
+ *        uma IRQ pendente no NVIC.
+ * @return Próximo wrap com IRQ (UINT64_MAX sem nenhum).
+ */
+static uint64_t pwm_deliver_wraps(uint64_t now_us) {
+    uint64_t next = UINT64_MAX;
+    for (uint i = 0; i < count_of(pwm_slices); ++i) {
+        if (!(pwm_irq_mask & (1u << i)) || !pwm_slices[i].enabled) continue;
+        if (now_us >= pwm_next_wrap_us[i]) {
+            pwm_irq_status |= 1u << i;
+            uint64_t period = pwm_period_us(i);
+            pwm_next_wrap_us[i] += period;
+            if (pwm_next_wrap_us[i] <= now_us) pwm_next_wrap_us[i] = now_us + period;
+        }
+    }
+    if (pwm_irq_status) raise_irq(PWM_IRQ_WRAP);
+    for (uint i = 0; i < count_of(pwm_slices); ++i) {
+        if ((pwm_irq_mask & (1u << i)) && pwm_slices[i].enabled && pwm_next_wrap_us[i] < next) {
+            next = pwm_next_wrap_us[i];
+        }
+    }
+    return next;
+}
+
+const sim_pwm_slice_t *sim_pwm(uint slice) {
+    return &pwm_slices[slice];
+}
+
+// --- I2C e SSD1306 ---
+
+static uint oled_cmd_args(uint8_t cmd) {
+    switch (cmd) {
+        case 0x21: case 0x22: return 2;                                    // Colunas, páginas
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5:
+        case 0xD9: case 0xDA: case 0xDB: return 1;
+        default: return 0;
+    }
+}
+
+static void oled_command(uint8_t byte) {
+    if (oled.args_left) {
+        oled.args[oled_cmd_args(oled.cmd) - oled.args_left] = byte;
+        if (--oled.args_left) return;
+        switch (oled.cmd) {
+            case 0x20: oled.mode = oled.args[0] & 3; break;
+            case 0x21:
+                oled.col = oled.col_start = oled.args[0] & 0x7F;
+                oled.col_end = oled.args[1] & 0x7F;
+                break;
+            case 0x22:
+                oled.page = oled.page_start = oled.args[0] & 7;
+                oled.page_end = oled.args[1] & 7;
+                break;
+        }
+        return;
+    }
+    oled.cmd = byte;
+    oled.args_left = (uint8_t)oled_cmd_args(byte);
+    if (byte == 0xAE || byte == 0xAF) {
+        oled.on = byte & 1;
+    } else if (oled.mode == 2 && byte >= 0xB0 && byte <= 0xB7) {
+        oled.page = byte & 7;
+    } else if (oled.mode == 2 && byte < 0x10) {
+        oled.col = (oled.col & 0xF0) | byte;
+    } else if (oled.mode == 2 && byte < 0x20) {
+        oled.col = (uint8_t)(((byte & 0x07) << 4) | (oled.col & 0x0F));
+    }
+}
+
+static void oled_data(uint8_t byte) {
+    oled.gddram[oled.page][oled.col] = byte;
+    if (oled.mode == 1) {
+        if (oled.page++ >= oled.page_end) {
+            oled.page = oled.page_start;
+            oled.col = oled.col >= oled.col_end ? oled.col_start : oled.col + 1;
+        }
+    } else if (oled.col++ >= oled.col_end) {
+        oled.col = oled.col_start;
+        if (oled.mode == 0) oled.page = oled.page >= oled.page_end ? oled.page_start : oled.page + 1;
+    }
+}
+
+/**
+ * @brief Interpreta uma transação para o SSD1306: byte de controle (Co, D/C)
+ *        seguido de comandos ou dados.
+ */
+static void oled_write(const uint8_t *b, size_t len) {
+    size_t i = 0;
+    bool data = false;
+    while (i < len) {
+        uint8_t control = b[i++];
+        data = control & 0x40;
+        if (!(control & 0x80)) {
+            for (; i < len; ++i) data ? oled_data(b[i]) : oled_command(b[i]);
+        } else if (i < len) {
+            data ? oled_data(b[i]) : oled_command(b[i]);
+            i++;
+        }
+    }
+    if (data) {
+        oled.frames++;
+        sim_log("oled %u", oled.frames);
+    }
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *i2c) {
+    i2c->baudrate = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    char prefix[24];
+    (void)nostop;
+    if (!i2c->baudrate) return PICO_ERROR_GENERIC;
+    if (i2c_fail_left || (i2c_max_hz && i2c->baudrate > i2c_max_hz)) {
+        if (i2c_fail_left) i2c_fail_left--;
+        sim_log("i2c %u %02x falha", i2c->index, addr);
+        return PICO_ERROR_TIMEOUT;
+    }
+    snprintf(prefix, sizeof(prefix), "i2c %u %02x", i2c->index, addr);
+    sim_log_hex(prefix, src, len);
+    if (addr != DISPLAY_ADDR) return PICO_ERROR_GENERIC; // Sem ACK
+    oled_write(src, len);
+    return (int)len;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)nostop;
+    if (!i2c->baudrate || addr != DISPLAY_ADDR) return PICO_ERROR_GENERIC;
+    memset(dst, 0, len); // Status do SSD1306: pronto, display ligado
+    return (int)len;
+}
+
+const uint8_t *sim_oled_gddram(void) {
+    return &oled.gddram[0][0];
+}
+
+bool sim_oled_on(void) {
+    return oled.on;
+}
+
+uint32_t sim_oled_frames(void) {
+    return oled.frames;
+}
+
+// --- PIO ---
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+    (void)pio;
+    return program->origin >= 0 ? (uint)program->origin : 0;
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    for (uint sm = 0; sm < 4; ++sm) {
+        if (!pio->enabled[sm]) return (int)sm;
+    }
+    if (required) panic("sim: sem máquinas de estado livres");
+    return -1;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio->index ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool is_out) {
+    pio->pin[sm] = pin;
+    for (uint i = 0; i < count; ++i) gpios[pin + i].out = is_out;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+    (void)initial_pc;
+    (void)config;
+    pio->rx_head[sm] = pio->rx_count[sm] = 0;
+    pio->irq &= ~(1u << sm);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    pio->enabled[sm] = enabled;
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+    (void)pio;
+    (void)sm;
+    (void)div;
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+    if (pio != MATRIX_PIO_INSTANCE || sm != MATRIX_PIO_SM) return;
+    matrix_pixels[matrix_words % MATRIX_SIZE] = data;
+    if (++matrix_words % MATRIX_SIZE == 0 && log_file) {
+        uint8_t grb[MATRIX_SIZE * 3];
+        for (uint i = 0; i < MATRIX_SIZE; ++i) {
+            grb[3 * i] = (uint8_t)(matrix_pixels[i] >> 24);
+            grb[3 * i + 1] = (uint8_t)(matrix_pixels[i] >> 16);
+            grb[3 * i + 2] = (uint8_t)(matrix_pixels[i] >> 8);
+        }
+        char prefix[24];
+        snprintf(prefix, sizeof(prefix), "ws2812 %u %u", pio->index, sm);
+        sim_log_hex(prefix, grb, sizeof(grb));
+    }
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    if (!pio->rx_count[sm]) return 0;
+    uint32_t word = pio->rx[sm][pio->rx_head[sm]];
+    pio->rx_head[sm] = (pio->rx_head[sm] + 1) % SIM_PIO_FIFO_DEPTH;
+    pio->rx_count[sm]--;
+    return word;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    return pio->rx_count[sm] == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+    return false;
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+    return true;
+}
+
+bool pio_interrupt_get(PIO pio, uint n) {
+    return pio->irq & (1u << n);
+}
+
+void pio_interrupt_clear(PIO pio, uint n) {
+    pio->irq &= ~(1u << n);
+}
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled) {
+    if (enabled) {
+        pio->inte0 |= 1u << source;
+    } else {
+        pio->inte0 &= ~(1u << source);
+    }
+}
+
+/**
+ * @brief Passa o trem de pulsos D0/D1 do quadro pelo programa pio/wiegand.pio
+ *        (wiegand_sim.c), coloca no FIFO RX as palavras que ele produz e
+ *        levanta a IRQ da máquina de estados do leitor. O quadro inteiro é
+ *        executado de uma vez, no instante da ação do roteiro.
+ */
+void sim_wiegand_frame(uint reader, uint bits, uint64_t frame) {
+    PIO pio = WIEGAND_PIO_INSTANCE;
+    wiegand_pulses_t pulses = { bits, frame, WIEGAND_SIM_PULSE_US, WIEGAND_SIM_PERIOD_US };
+    uint32_t words[WIEGAND_SIM_RX_WORDS];
+
+    if (bits == 0 || bits > 64 || !pio->enabled[reader]) return;
+    uint n = wiegand_sim_run(&pulses, words);
+    if (n == 0) return;  // Sem IRQ de fim de quadro
+
+    for (uint i = 0; i < n && pio->rx_count[reader] < SIM_PIO_FIFO_DEPTH; ++i) {
+        pio->rx[reader][(pio->rx_head[reader] + pio->rx_count[reader]) % SIM_PIO_FIFO_DEPTH] = words[i];
+        pio->rx_count[reader]++;
+    }
+    pio->irq |= 1u << reader;
+    if (pio->inte0 & (1u << (pis_interrupt0 + reader))) {
+        raise_irq(pio->index ? PIO1_IRQ_0 : PIO0_IRQ_0);
+    }
+}
+
+const uint32_t *sim_matrix_pixels(void) {
+    return matrix_pixels;
+}
+
+// --- Clocks, watchdog e flash ---
+
+uint32_t clock_get_hz(enum clock_index clk) {
+    return clk == clk_sys ? clk_sys_hz : (clk == clk_usb || clk == clk_adc) ? 48000000u : 12000000u;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void)required;
+    clk_sys_hz = freq_khz * 1000;
+    sim_log("clk_sys %u", freq_khz);
+    return true;
+}
+
+void vreg_set_voltage(enum vreg_voltage voltage) {
+    sim_log("vreg %u", (unsigned)voltage);
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+    (void)pause_on_debug;
+    watchdog_timeout_ms = delay_ms;
+    watchdog_fed_ms = (uint32_t)(time_us_64() / 1000);
+    sim_log("watchdog enable %u", delay_ms);
+}
+
+void watchdog_update(void) {
+    watchdog_fed_ms = (uint32_t)(time_us_64() / 1000);
+}
+
+bool watchdog_caused_reboot(void) {
+    return false;
+}
+
+bool watchdog_enable_caused_reboot(void) {
+    return false;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    memset(&sim_flash[flash_offs], 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    // NOR: a gravação só leva bits de 1 para 0
+    for (size_t i = 0; i < count; ++i) sim_flash[flash_offs + i] &= data[i];
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    taskENTER_CRITICAL();
+    func(param);
+    taskEXIT_CRITICAL();
+    return PICO_OK;
+}
+
+static void flash_open(void) {
+    const char *path = getenv("PANEL_SIM_FLASH");
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    if (!path) return;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return;
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < PICO_FLASH_SIZE_BYTES && (ftruncate(fd, PICO_FLASH_SIZE_BYTES) != 0 ||
+        pwrite(fd, flash_mem + size, PICO_FLASH_SIZE_BYTES - size, size) != PICO_FLASH_SIZE_BYTES - size)) {
+        close(fd);
+        return;
+    }
+    void *map = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map != MAP_FAILED) sim_flash = map;
+}
+
+// --- Terminal ---
+
+void sim_console_input(const uint8_t *data, size_t len) {
+    taskENTER_CRITICAL();
+    for (size_t i = 0; i < len && console_count < CONSOLE_RX_LEN; ++i) {
+        console_rx[(console_head + console_count++) % CONSOLE_RX_LEN] = data[i];
+    }
+    taskEXIT_CRITICAL();
+    if (chars_available) {
+        dispatching = true;
+        chars_available(chars_available_param);
+        dispatching = false;
+    }
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    int c = PICO_ERROR_TIMEOUT;
+    (void)timeout_us; // Só usado com 0 (leitura sem espera)
+    taskENTER_CRITICAL();
+    if (console_count) {
+        c = console_rx[console_head];
+        console_head = (console_head + 1) % CONSOLE_RX_LEN;
+        console_count--;
+    }
+    taskEXIT_CRITICAL();
+    return c;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+    chars_available = fn;
+    chars_available_param = param;
+}
+
+bool stdio_usb_connected(void) {
+    return true;
+}
+
+static void poll_stdin(void) {
+    struct pollfd p = { STDIN_FILENO, POLLIN, 0 };
+    uint8_t data[64];
+
+    if (!stdin_open || poll(&p, 1, 0) <= 0) return;
+    ssize_t n = read(STDIN_FILENO, data, sizeof(data));
+    if (n <= 0) {
+        stdin_open = false; // EOF: só o roteiro alimenta o terminal
+        return;
+    }
+    sim_console_input(data, (size_t)n);
+}
+
+// --- Estado ---
+
+void sim_dump(FILE *out) {
+    taskENTER_CRITICAL();
+    fprintf(out, "--- %llu us: display %s, %u quadros ---\n", (unsigned long long)time_us_64(),
+            oled.on ? "ligado" : "desligado", oled.frames);
+    for (uint y = 0; y < OLED_PAGES * 8; y += 2) {
+        for (uint x = 0; x < OLED_COLUMNS; ++x) {
+            bool top = (oled.gddram[y / 8][x] >> (y % 8)) & 1;
+            bool bottom = (oled.gddram[(y + 1) / 8][x] >> ((y + 1) % 8)) & 1;
+            fputs(top ? (bottom ? "█" : "▀") : (bottom ? "▄" : " "), out);
+        }
+        fputc('\n', out);
+    }
+    fprintf(out, "Matriz (GRB, ordem do buffer):");
+    for (uint i = 0; i < MATRIX_SIZE; ++i) {
+        fprintf(out, "%s%06x", i % MATRIX_DIM ? " " : "\n  ", matrix_pixels[i] >> 8);
+    }
+    const sim_pwm_slice_t *buzzer = &pwm_slices[pwm_gpio_to_slice_num(BUZZER_PIN_MAIN)];
+    const sim_pwm_slice_t *red = &pwm_slices[pwm_gpio_to_slice_num(LED_RED_PIN)];
+    const sim_pwm_slice_t *green = &pwm_slices[pwm_gpio_to_slice_num(LED_GREEN_PIN)];
+    const sim_pwm_slice_t *blue = &pwm_slices[pwm_gpio_to_slice_num(LED_BLUE_PIN)];
+    fprintf(out, "\nLED RGB (PWM nivel/wrap): R=%u/%u G=%u/%u B=%u/%u  Buzzer: ",
+            red->level[pwm_gpio_to_channel(LED_RED_PIN)], red->wrap,
+            green->level[pwm_gpio_to_channel(LED_GREEN_PIN)], green->wrap,
+            blue->level[pwm_gpio_to_channel(LED_BLUE_PIN)], blue->wrap);
+    if (buzzer->enabled && buzzer->div16 && buzzer->wrap) {
+        fprintf(out, "%u Hz\n", (unsigned)((uint64_t)clk_sys_hz * 16 / buzzer->div16 / (buzzer->wrap + 1u)));
+    } else {
+        fprintf(out, "desligado\n");
+    }
+    fflush(out);
+    taskEXIT_CRITICAL();
+}
+
+// --- Roteiro e tarefa de estímulos ---
+
+static void script_load(void) {
+    const char *path = getenv("PANEL_SIM_SCRIPT");
+    char line[256];
+    size_t cap = 0;
+
+    if (!path) return;
+    FILE *f = fopen(path, "r");
+    if (!f) panic("sim: roteiro %s nao encontrado", path);
+    while (fgets(line, sizeof(line), f)) {
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char *rest;
+        unsigned long at = strtoul(line, &rest, 10);
+        while (*rest == ' ' || *rest == '\t') rest++;
+        rest[strcspn(rest, "\r\n")] = '\0';
+        if (rest == line || !*rest) continue;
+        if (n_actions == cap) {
+            cap = cap ? cap * 2 : 64;
+            actions = realloc(actions, cap * sizeof(*actions));
+        }
+        actions[n_actions].at_ms = (uint32_t)at;
+        actions[n_actions].line = strdup(rest);
+        n_actions++;
+    }
+    fclose(f);
+}
+
+static void sim_exit(int code) {
+    taskENTER_CRITICAL();
+    out_flush();
+    if (log_file) fflush(log_file);
+    _exit(code);
+}
+
+/**
+ * @brief Crachá H10301: paridade par, 8 bits de instalação, 16 de cartão e
+ *        paridade ímpar (mesmo formato de WIEGAND_FORMATS em wiegand.c).
+ */
+static uint64_t h10301_frame(uint32_t facility, uint32_t card) {
+    uint32_t data = ((facility & 0xFF) << 16) | (card & 0xFFFF);
+    uint32_t even = __builtin_popcount(data >> 12) & 1;
+    uint32_t odd = !(__builtin_popcount(data & 0xFFF) & 1);
+    return ((uint64_t)even << 25) | ((uint64_t)data << 1) | odd;
+}
+
+static void script_run(const char *line, uint32_t now_ms) {
+    char verb[16];
+    unsigned a = 0, b = 0, c = 0;
+    unsigned long long hex = 0;
+    int n = 0;
+
+    if (sscanf(line, "%15s%n", verb, &n) != 1) return;
+    const char *args = line + n;
+
+    if (!strcmp(verb, "gpio") && sscanf(args, "%u %u", &a, &b) == 2) {
+        sim_gpio_drive(a, b);
+    } else if (!strcmp(verb, "press") && sscanf(args, "%u %u", &a, &b) >= 1) {
+        sim_gpio_drive(a, false);
+        for (uint i = 0; i < MAX_RELEASES; ++i) {
+            if (!releases[i].at_ms) {
+                releases[i].gpio = a;
+                releases[i].at_ms = now_ms + (b ? b : SIM_PRESS_MS);
+                break;
+            }
+        }
+    } else if (!strcmp(verb, "inject") && sscanf(args, "%u", &a) == 1) {
+        dispatching = true;
+        buttons_inject(a);
+        dispatching = false;
+    } else if (!strcmp(verb, "badge") && sscanf(args, "%u %u %u", &a, &b, &c) == 3) {
+        sim_wiegand_frame(a, 26, h10301_frame(b, c));
+    } else if (!strcmp(verb, "wiegand") && sscanf(args, "%u %u %llx", &a, &b, &hex) == 3) {
+        sim_wiegand_frame(a, b, hex);
+    } else if (!strcmp(verb, "text")) {
+        while (*args == ' ') args++;
+        sim_console_input((const uint8_t *)args, strlen(args));
+        sim_console_input((const uint8_t *)"\n", 1);
+    } else if (!strcmp(verb, "i2c_fail") && sscanf(args, "%u", &a) == 1) {
+        i2c_fail_left = a;
+    } else if (!strcmp(verb, "i2c_max") && sscanf(args, "%u", &a) == 1) {
+        i2c_max_hz = a * 1000;
+    } else if (!strcmp(verb, "dump")) {
+        sim_dump(stderr);
+    } else if (!strcmp(verb, "quit")) {
+        sscanf(args, "%u", &a);
+        sim_exit((int)a);
+    } else {
+        fprintf(stderr, "sim: acao invalida: %s\n", line);
+    }
+}
+
+static void sim_task_fn(void *param) {
+    (void)param;
+    for (;;) {
+        uint32_t now_ms = (uint32_t)(time_us_64() / 1000);
+
+        for (uint i = 0; i < MAX_RELEASES; ++i) {
+            if (releases[i].at_ms && now_ms >= releases[i].at_ms) {
+                releases[i].at_ms = 0;
+                sim_gpio_drive(releases[i].gpio, true);
+            }
+        }
+        while (next_action < n_actions && now_ms >= actions[next_action].at_ms) {
+            script_run(actions[next_action++].line, now_ms);
+        }
+        poll_stdin();
+        uint64_t next_wrap_us = pwm_deliver_wraps(time_us_64());
+
+        if (watchdog_timeout_ms && now_ms - watchdog_fed_ms > watchdog_timeout_ms) {
+            sim_log("watchdog reset");
+            fprintf(stderr, "sim: watchdog expirou (%u ms sem watchdog_update)\n", now_ms - watchdog_fed_ms);
+            sim_dump(stderr);
+            sim_exit(SIM_EXIT_WATCHDOG);
+        }
+
+        // Relógio virtual: dorme até a próxima ação, para o idle poder saltar o intervalo
+        TickType_t wait = 1;
+        if (virtual_clock) {
+            uint32_t next_ms = now_ms + SIM_VIRTUAL_MAX_SLEEP_MS;
+            for (uint i = 0; i < MAX_RELEASES; ++i) {
+                if (releases[i].at_ms && releases[i].at_ms < next_ms) next_ms = releases[i].at_ms;
+            }
+            if (next_action < n_actions && actions[next_action].at_ms < next_ms) {
+                next_ms = actions[next_action].at_ms;
+            }
+            if (next_wrap_us / 1000 < next_ms) next_ms = (uint32_t)(next_wrap_us / 1000);
+            wait = next_ms > now_ms ? next_ms - now_ms : 1;
+        }
+        vTaskDelay(wait);
+    }
+}
+
+/**
+ * @brief Primeira chamada da aplicação: prepara a flash, o registro e o
+ *        roteiro, e cria a tarefa que entrega as interrupções simuladas.
+ */
+bool stdio_init_all(void) {
+    const char *log_path = getenv("PANEL_SIM_LOG");
+
+    const char *virtual_env = getenv("PANEL_SIM_VIRTUAL");
+
+    virtual_clock = virtual_env && atoi(virtual_env);
+    flash_open();
+    if (log_path) log_file = fopen(log_path, "w");
+    script_load();
+    tick_wall_ns = wall_ns();
+    sim_task = xTaskCreateStatic(sim_task_fn, "Sim", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1,
+                                 sim_stack, &sim_tcb);
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "pico_host.h"
+
+// Periféricos simulados da build nativa (PANEL_HOST). Implementam o
+// subconjunto do Pico SDK declarado em pico_host.h e guardam o que a
+// aplicação escreveu: níveis dos GPIOs, PWM, tráfego I2C, GDDRAM do SSD1306
+// e os pixels enviados à matriz WS2812 pelo PIO.
+//
+// As interrupções (bordas de GPIO, quadros Wiegand, bytes no terminal) são
+// entregues pela tarefa "Sim", criada em stdio_init_all() com a maior
+// prioridade: os handlers rodam como ISRs, com portCHECK_IF_IN_ISR() = 1.
+//
+// Variáveis de ambiente:
+//   PANEL_SIM_SCRIPT  Roteiro de estímulos (formato abaixo)
+//   PANEL_SIM_LOG     Registro do tráfego dos periféricos, uma linha por evento:
+//                     "<us> gpio <pino> <nível>", "<us> pwm <slice> <on|off> <wrap> <div16> <A> <B>",
+//                     "<us> i2c <bus> <end> <bytes hex>", "<us> ws2812 <pio> <sm> <pixels hex>",
+//                     "<us> i2c <bus> <end> falha", "<us> oled <quadro>", "<us> watchdog <evento>",
+//                     "<us> clk_sys <kHz>", "<us> vreg <código VREG_VOLTAGE_*>"
+//   PANEL_SIM_FLASH   Arquivo de PICO_FLASH_SIZE_BYTES com a flash (o diário
+//                     persiste entre execuções); sem ele, a flash começa apagada
+//   PANEL_SIM_VIRTUAL 1 = relógio virtual: quando todas as tarefas estão
+//                     bloqueadas, o tempo salta até o próximo desbloqueio (ou a
+//                     próxima ação do roteiro) sem esperar o relógio real. Só o
+//                     tempo com CPU ocupada custa tempo real; 24 h de roteiro
+//                     rodam em segundos (tools/panel_load.py)
+//
+// Roteiro: uma ação por linha, "<ms> <ação> [args]", com ms desde o boot
+// simulado e em ordem crescente; '#' inicia um comentário.
+//   gpio <pino> <0|1>             Nível externo de um pino de entrada
+//   press <pino> [ms]             Nível 0 por ms (padrão SIM_PRESS_MS) e volta a 1
+//   inject <pino>                 Acionamento de botão já aceito (buttons_inject: sem
+//                                 borda nem debounce), na ISR simulada
+//   badge <leitor> <inst> <cart>  Crachá H10301 (26 bits) no leitor
+//   wiegand <leitor> <bits> <hex> Quadro Wiegand bruto (bit 0 = mais significativo), em
+//                                 pulsos D0/D1 pelo programa PIO (wiegand_sim.h)
+//   text <texto>                  Bytes no terminal, seguidos de '\n'
+//   i2c_fail <n>                  As próximas n escritas I2C falham por prazo esgotado
+//   i2c_max <kHz>                 Escritas com baud acima de kHz falham (0 = sem limite);
+//                                 em 0 ms (antes da sondagem do display), simula fiação
+//                                 que não aguenta FM+
+//   dump                          Estado do display, matriz, LED RGB e buzzer (stderr)
+//   quit [código]                 Encerra o processo
+#define SIM_PRESS_MS          50
+#define SIM_EXIT_PANIC        2
+#define SIM_EXIT_WATCHDOG     3
+#define SIM_VIRTUAL_MAX_SLEEP_MS 100   // Relógio virtual: a tarefa Sim acorda ao menos a cada 100 ms (watchdog)
+
+/**
+ * @struct sim_pwm_slice_t
+ * @brief Estado de um slice de PWM.
+ */
+typedef struct {
+    uint16_t wrap;
+    uint16_t level[2];     // Canais A e B
+    uint16_t div16;        // Divisor de clock em 1/16
+    bool enabled;
+} sim_pwm_slice_t;
+
+// Estímulos (também usados pelo roteiro)
+void sim_gpio_drive(uint gpio, bool level);
+void sim_wiegand_frame(uint reader, uint bits, uint64_t frame);
+void sim_console_input(const uint8_t *data, size_t len);
+
+// Estado registrado
+const uint8_t *sim_oled_gddram(void);       // 8 páginas x 128 colunas, bit 0 = linha de cima
+bool sim_oled_on(void);
+uint32_t sim_oled_frames(void);             // Escritas de dados no display
+const uint32_t *sim_matrix_pixels(void);    // GRB << 8, na ordem do buffer do PIO
+const sim_pwm_slice_t *sim_pwm(uint slice);
+void sim_dump(FILE *out);
+
+// true dentro de um handler de interrupção entregue pela tarefa Sim
+int sim_in_isr(void);
+
+// portSUPPRESS_TICKS_AND_SLEEP do port nativo (FreeRTOSConfig.h)
+void sim_idle_skip(uint32_t idle_ticks);
+
+#endif // SIM_H
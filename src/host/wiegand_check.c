@@ -0,0 +1,130 @@
+// src/host/wiegand_check.c
+
+#include "config.h"
+#include "wiegand.h"
+#include "wiegand_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/*
+ * Verificação do leitor Wiegand (alvo panel_wiegand, só na build nativa).
+ * Cada quadro vira um trem de pulsos D0/D1, passa pelo programa de
+ * pio/wiegand.pio (interpretador de wiegand_sim.c) e as palavras da FIFO RX
+ * vão para wiegand_decode_frame(). Os quadros válidos de 26, 34 e 37 bits,
+ * em várias larguras de pulso e intervalos, precisam voltar com a mesma
+ * instalação e o mesmo cartão; os com paridade errada, curtos, longos ou de
+ * tamanho desconhecido precisam ser recusados.
+ *
+ *   ./build-host/panel_wiegand
+ *
+ * Sai com 1 se algum quadro for decodificado errado.
+ */
+
+/**
+ * @struct format_t
+ * @brief Formato de referência, escrito de novo aqui para não conferir o
+ *        decodificador contra a própria tabela.
+ */
+typedef struct {
+    uint bits;
+    uint even_bits;     // Paridade par cobre os bits 1..even_bits
+    uint odd_bits;      // Paridade ímpar cobre os últimos odd_bits antes dela
+    uint facility_bits;
+    uint card_bits;
+} format_t;
+
+static const format_t H10301 = { 26, 12, 12, 8, 16 };
+static const format_t W34 = { 34, 16, 16, 16, 16 };
+static const format_t H10304 = { 37, 18, 18, 16, 19 };
+
+static const struct {
+    uint pulse_us, period_us;
+} timings[] = {
+    { 50, 1000 },   // Leitor típico
+    { 100, 2000 },  // Pulso e intervalo mais longos
+    { 20, 200 },    // Limite rápido do padrão
+};
+
+static int failures;
+
+// Quadro com as duas paridades corretas (bit 0 = paridade par = mais significativo)
+static uint64_t encode(const format_t *f, uint32_t facility, uint32_t card) {
+    uint data_bits = f->bits - 2;
+    uint64_t data = ((uint64_t)facility << f->card_bits) | card;
+    uint64_t even_span = data >> (data_bits - f->even_bits);
+    uint64_t odd_span = data & ((1ull << f->odd_bits) - 1);
+    uint64_t even = __builtin_popcountll(even_span) & 1;
+    uint64_t odd = !(__builtin_popcountll(odd_span) & 1);
+    return (even << (f->bits - 1)) | (data << 1) | odd;
+}
+
+static bool run(uint bits, uint64_t frame, uint pulse_us, uint period_us, wiegand_badge_t *badge) {
+    wiegand_pulses_t p = { bits, frame, pulse_us, period_us };
+    uint32_t rx[WIEGAND_SIM_RX_WORDS];
+    uint n = wiegand_sim_run(&p, rx);
+    return n > 0 && wiegand_decode_frame(rx, n, 0, badge);
+}
+
+static void expect_badge(const char *name, const format_t *f, uint32_t facility, uint32_t card) {
+    int before = failures;
+    uint64_t frame = encode(f, facility, card);
+
+    for (uint t = 0; t < sizeof(timings) / sizeof(timings[0]); ++t) {
+        wiegand_badge_t b;
+        memset(&b, 0, sizeof(b));
+        if (!run(f->bits, frame, timings[t].pulse_us, timings[t].period_us, &b)) {
+            printf("FALHOU    %s (%u/%u us): recusado\n", name, timings[t].pulse_us, timings[t].period_us);
+            failures++;
+        } else if (b.bit_count != f->bits || b.facility != facility || b.card_number != card) {
+            printf("FALHOU    %s (%u/%u us): %u bits, %" PRIu32 ":%" PRIu32 " (esperado %u bits, %" PRIu32
+                   ":%" PRIu32 ")\n", name, timings[t].pulse_us, timings[t].period_us, b.bit_count, b.facility,
+                   b.card_number, f->bits, facility, card);
+            failures++;
+        }
+    }
+    if (failures == before) printf("ok        %s\n", name);
+}
+
+static void expect_reject(const char *name, uint bits, uint64_t frame) {
+    wiegand_badge_t b;
+
+    if (run(bits, frame, WIEGAND_SIM_PULSE_US, WIEGAND_SIM_PERIOD_US, &b)) {
+        printf("FALHOU    %s: aceito como %u bits, %" PRIu32 ":%" PRIu32 "\n", name, b.bit_count, b.facility,
+               b.card_number);
+        failures++;
+        return;
+    }
+    printf("ok        %s\n", name);
+}
+
+int main(void) {
+    expect_badge("26 bits (H10301)", &H10301, 123, 45678);
+    expect_badge("26 bits, campos extremos", &H10301, 0xFF, 0);
+    expect_badge("34 bits", &W34, 0xBEEF, 0x1234);
+    expect_badge("34 bits, campos extremos", &W34, 0, 0xFFFF);
+    expect_badge("37 bits (H10304)", &H10304, 4242, 0x7FFFF);
+
+    uint64_t h26 = encode(&H10301, 123, 45678);
+    uint64_t w34 = encode(&W34, 0xBEEF, 0x1234);
+    uint64_t h37 = encode(&H10304, 4242, 300000);
+    expect_reject("26 bits com paridade par errada", 26, h26 ^ (1ull << 25));
+    expect_reject("26 bits com paridade impar errada", 26, h26 ^ 1);
+    expect_reject("26 bits com um bit de dado trocado", 26, h26 ^ (1ull << 10));
+    expect_reject("34 bits com paridade par errada", 34, w34 ^ (1ull << 33));
+    expect_reject("34 bits com paridade impar errada", 34, w34 ^ 1);
+    expect_reject("37 bits com paridade impar errada", 37, h37 ^ 1);
+    expect_reject("26 bits cortado em 20 (quadro curto)", 20, h26 >> 6);
+    expect_reject("34 bits cortado em 33", 33, w34 >> 1);
+    expect_reject("26 bits com um bit a mais", 27, h26 << 1);
+    expect_reject("um pulso so", 1, 1);
+    expect_reject("64 bits (formato desconhecido)", 64, 0x0123456789ABCDEFull);
+
+    if (failures) {
+        printf("%d quadro(s) Wiegand decodificado(s) errado\n", failures);
+        return 1;
+    }
+    return 0;
+}
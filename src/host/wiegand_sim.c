@@ -0,0 +1,158 @@
+// src/host/wiegand_sim.c
+
+#include "wiegand_sim.h"
+#include "wiegand.pio.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#define LEAD_US         100                     // Repouso antes do primeiro pulso
+#define TIMEOUT_US      (2048u * 10u + 1000u)   // out x, 11 amostras de 10 ciclos, com folga
+
+/**
+ * @struct sm_t
+ * @brief Registradores de uma máquina de estados.
+ */
+typedef struct {
+    uint pc;
+    uint32_t x, y;
+    uint32_t isr, osr;
+    uint isr_count, osr_count;
+    uint delay;
+    bool irq;
+    bool rx_full;       // push com a FIFO RX cheia: a máquina travaria
+    uint32_t *rx;
+    uint n_rx;
+} sm_t;
+
+// Nível das linhas no ciclo t: bit 0 = D0, bit 1 = D1 (IN_BASE = D0)
+static uint32_t pins_at(const wiegand_pulses_t *p, uint64_t t) {
+    if (t < LEAD_US) return 3;
+    uint64_t i = (t - LEAD_US) / p->period_us;
+    if (i >= p->bits || (t - LEAD_US) % p->period_us >= p->pulse_us) return 3;
+    bool one = (p->frame >> (p->bits - 1 - i)) & 1;
+    return one ? 1 : 2;  // Bit 1 baixa D1, bit 0 baixa D0
+}
+
+static bool push(sm_t *sm) {
+    if (sm->n_rx >= WIEGAND_SIM_RX_WORDS) {
+        sm->rx_full = true;
+        return false;
+    }
+    sm->rx[sm->n_rx++] = sm->isr;
+    sm->isr = 0;
+    sm->isr_count = 0;
+    return true;
+}
+
+static uint32_t source(const sm_t *sm, uint src, uint32_t pins) {
+    switch (src) {
+        case 0: return pins;
+        case 1: return sm->x;
+        case 2: return sm->y;
+        case 6: return sm->isr;
+        case 7: return sm->osr;
+        default: return 0;  // null
+    }
+}
+
+/**
+ * @brief Executa uma instrução (ou um ciclo de atraso ou de espera).
+ * @return false para uma instrução fora do subconjunto suportado ou um push
+ *         com a FIFO RX cheia (ninguém a esvazia durante o quadro).
+ */
+static bool step(sm_t *sm, uint32_t pins) {
+    if (sm->delay) {
+        sm->delay--;
+        return true;
+    }
+
+    uint16_t ins = wiegand_program_instructions[sm->pc];
+    uint op = ins >> 13, arg = ins & 0xFF;
+    uint delay = (ins >> 8) & 0x1F;
+    uint bits = arg & 0x1F ? arg & 0x1F : 32;
+    uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    uint next = sm->pc + 1 > wiegand_wrap ? wiegand_wrap_target : sm->pc + 1;
+
+    switch (op) {
+        case 0: {  // jmp
+            bool take;
+            switch (arg >> 5) {
+                case 0: take = true; break;
+                case 1: take = sm->x == 0; break;
+                case 2: take = sm->x-- != 0; break;
+                case 3: take = sm->y == 0; break;
+                case 4: take = sm->y-- != 0; break;
+                default: return false;
+            }
+            next = take ? (arg & 0x1F) : next;
+            break;
+        }
+        case 1:  // wait
+            if (((arg >> 5) & 3) != 1) return false;
+            if (((pins >> (arg & 0x1F)) & 1) != (arg >> 7)) return true;  // Trava sem aplicar o atraso
+            break;
+        case 2:  // in (para a esquerda, autopush em 32)
+            sm->isr = bits == 32 ? source(sm, arg >> 5, pins) : (sm->isr << bits) | (source(sm, arg >> 5, pins) & mask);
+            sm->isr_count = sm->isr_count + bits > 32 ? 32 : sm->isr_count + bits;
+            if (sm->isr_count >= 32 && !push(sm)) return false;
+            break;
+        case 3: {  // out (para a direita)
+            uint32_t data = sm->osr & mask;
+            sm->osr = bits == 32 ? 0 : sm->osr >> bits;
+            sm->osr_count = sm->osr_count + bits > 32 ? 32 : sm->osr_count + bits;
+            switch (arg >> 5) {
+                case 1: sm->x = data; break;
+                case 2: sm->y = data; break;
+                case 3: break;
+                case 5: next = data; break;
+                default: return false;
+            }
+            break;
+        }
+        case 4:  // push block
+            if (arg & 0x80) return false;  // pull
+            if (!push(sm)) return false;
+            break;
+        case 5: {  // mov
+            uint32_t v = source(sm, arg & 7, pins);
+            if (((arg >> 3) & 3) == 1) v = ~v;
+            if (((arg >> 3) & 3) > 1) return false;  // Inversão da ordem dos bits
+            switch (arg >> 5) {
+                case 1: sm->x = v; break;
+                case 2: sm->y = v; break;
+                case 6: sm->isr = v; sm->isr_count = 0; break;
+                case 7: sm->osr = v; sm->osr_count = 0; break;
+                default: return false;
+            }
+            break;
+        }
+        case 6:  // irq nowait (SM 0: "0 rel" é a flag 0)
+            if (arg & 0x60) return false;
+            sm->irq = true;
+            break;
+        default:
+            return false;
+    }
+    sm->pc = next;
+    sm->delay = delay;
+    return true;
+}
+
+uint wiegand_sim_run(const wiegand_pulses_t *pulses, uint32_t rx[WIEGAND_SIM_RX_WORDS]) {
+    sm_t sm = { .pc = wiegand_offset_frame_start, .rx = rx };
+    uint64_t end = LEAD_US + (uint64_t)pulses->bits * pulses->period_us + TIMEOUT_US;
+
+    for (uint64_t t = 0; t < end && !sm.irq; ++t) {
+        if (!step(&sm, pins_at(pulses, t))) {
+            if (sm.rx_full) {
+                fprintf(stderr, "wiegand_sim: FIFO RX cheia em %" PRIu64 " us\n", t);
+                return 0;
+            }
+            fprintf(stderr, "wiegand_sim: instrucao 0x%04x em %u nao suportada\n",
+                    wiegand_program_instructions[sm.pc], sm.pc);
+            return 0;
+        }
+    }
+    return sm.irq ? sm.n_rx : 0;
+}
@@ -0,0 +1,38 @@
+#ifndef WIEGAND_SIM_H
+#define WIEGAND_SIM_H
+
+#include "pico_host.h"
+
+// Execução do programa de pio/wiegand.pio na build nativa: um interpretador
+// do subconjunto de instruções que ele usa, com a configuração de
+// wiegand_program_init() (1 ciclo = 1 us, ISR para a esquerda com autopush a
+// cada 32 bits, OSR para a direita, FIFO RX juntada em 8 palavras). Os pinos
+// são um trem de pulsos D0/D1 gerado aqui, com as linhas em repouso alto.
+
+/**
+ * @struct wiegand_pulses_t
+ * @brief Trem de pulsos de um quadro. O bit i (o primeiro recebido é o mais
+ *        significativo de frame) baixa D0 (bit 0) ou D1 (bit 1) por pulse_us,
+ *        começando em i * period_us.
+ */
+typedef struct {
+    uint bits;
+    uint64_t frame;
+    uint pulse_us;     // Largura do pulso (50-100 us nos leitores comuns)
+    uint period_us;    // Intervalo entre o início de dois bits
+} wiegand_pulses_t;
+
+#define WIEGAND_SIM_PULSE_US    50
+#define WIEGAND_SIM_PERIOD_US   1000
+#define WIEGAND_SIM_RX_WORDS    8
+
+/**
+ * @brief Roda a máquina de estados desde frame_start sobre o trem de pulsos
+ *        até a IRQ de fim de quadro (ou o tempo dos pulsos mais o timeout do
+ *        programa, sem IRQ).
+ * @param rx Palavras que chegaram à FIFO RX, na ordem.
+ * @return Número de palavras em rx; 0 se a IRQ não subiu.
+ */
+uint wiegand_sim_run(const wiegand_pulses_t *pulses, uint32_t rx[WIEGAND_SIM_RX_WORDS]);
+
+#endif // WIEGAND_SIM_H
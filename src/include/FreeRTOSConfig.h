@@ -42,8 +42,11 @@
  
  /* Scheduler Related */
  #define configUSE_PREEMPTION                    1
- #define configUSE_TICKLESS_IDLE                 0
- #define configUSE_IDLE_HOOK                     0
+ #define configUSE_TICKLESS_IDLE                 1   /* vPortSuppressTicksAndSleep em low_power.c */
+ #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+ #define configUSE_IDLE_HOOK                     1
+ #define configUSE_PASSIVE_IDLE_HOOK             1   /* Idle do outro núcleo (V11): WFI em low_power.c */
+ #define configUSE_MINIMAL_IDLE_HOOK             1   /* O mesmo no ramo smp anterior ao V11 */
  #define configUSE_TICK_HOOK                     0
  #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
  #define configMAX_PRIORITIES                    32
@@ -69,21 +72,38 @@
  #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
  
  /* Memory allocation related definitions. */
- #define configSUPPORT_STATIC_ALLOCATION         0
- #define configSUPPORT_DYNAMIC_ALLOCATION        1
- #define configTOTAL_HEAP_SIZE                   (128*1024)
+ #define configSUPPORT_STATIC_ALLOCATION         1
+ #define configSUPPORT_DYNAMIC_ALLOCATION        1   /* Só para os queue sets (sem versão estática) */
+ #define configTOTAL_HEAP_SIZE                   (1*1024)
  #define configAPPLICATION_ALLOCATED_HEAP        0
  
  /* Hook function related definitions. */
- #define configCHECK_FOR_STACK_OVERFLOW          0
- #define configUSE_MALLOC_FAILED_HOOK            0
+ #define configCHECK_FOR_STACK_OVERFLOW          2
+ #define configUSE_MALLOC_FAILED_HOOK            1
  #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
  
  /* Run time and task stats gathering related definitions. */
- #define configGENERATE_RUN_TIME_STATS           0
+ #define configGENERATE_RUN_TIME_STATS           1
  #define configUSE_TRACE_FACILITY                1
  #define configUSE_STATS_FORMATTING_FUNCTIONS    0
  
+ /* Contador de 1 MHz (timer do RP2040, já ativo desde o boot) e trocas de
+    contexto por núcleo: ver profiler.c. Cada troca também vai para o trace
+    (trace.c); pxCurrentTCBs é o vetor de tarefas correntes do kernel SMP. */
+ #ifndef __ASSEMBLER__
+ #include <stdint.h>
+ extern volatile uint32_t profiler_context_switches[];
+ uint32_t profiler_run_time_counter( void );
+ void trace_task_switched_in( uint32_t task_number );
+ #endif
+ #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ #define portGET_RUN_TIME_COUNTER_VALUE()        profiler_run_time_counter()
+ #define traceTASK_SWITCHED_IN()                                                  \
+    do {                                                                         \
+        profiler_context_switches[ portGET_CORE_ID() ]++;                       \
+        trace_task_switched_in( pxCurrentTCBs[ portGET_CORE_ID() ]->uxTCBNumber ); \
+    } while( 0 )
+
  /* Co-routine related definitions. */
  #define configUSE_CO_ROUTINES                   0
  #define configMAX_CO_ROUTINE_PRIORITIES         1
@@ -92,7 +112,7 @@
  #define configUSE_TIMERS                        1
  #define configTIMER_TASK_PRIORITY               ( configMAX_PRIORITIES - 1 )
  #define configTIMER_QUEUE_LENGTH                10
- #define configTIMER_TASK_STACK_DEPTH            1024
+ #define configTIMER_TASK_STACK_DEPTH            configMINIMAL_STACK_SIZE /* Sem timers da aplicação */
  
  /* Interrupt nesting behaviour configuration. */
  /*
@@ -102,9 +122,10 @@
  */
  
  /* SMP port only */
- #define configNUM_CORES                         1
- #define configTICK_CORE                         1
+ #define configNUM_CORES                         2
+ #define configTICK_CORE                         0
  #define configRUN_MULTIPLE_PRIORITIES           1
+ #define configUSE_CORE_AFFINITY                 1
  
  /* RP2040 specific */
  #define configSUPPORT_PICO_SYNC_INTEROP         1
@@ -0,0 +1,153 @@
+#include "active_object.h"
+#include <inttypes.h>
+
+void ao_init(ao_t *ao, const char *name, ao_handler_t handler) {
+    ao->name = name;
+    ao->handler = handler;
+    ao->queue = xQueueCreateStatic(AO_QUEUE_LEN, sizeof(ao_event_t), (uint8_t *)ao->queue_storage, &ao->queue_cb);
+    ao->state = 0;
+    ao->timer_armed = false;
+    ao->dispatched = 0;
+    configASSERT(ao->queue != NULL);
+}
+
+bool ao_post(ao_t *ao, uint16_t sig, uint16_t arg) {
+    ao_event_t e = { sig, arg };
+    return xQueueSend(ao->queue, &e, 0) == pdTRUE;
+}
+
+bool ao_post_from_isr(ao_t *ao, uint16_t sig, uint16_t arg, BaseType_t *higher_priority_woken) {
+    ao_event_t e = { sig, arg };
+    return xQueueSendFromISR(ao->queue, &e, higher_priority_woken) == pdTRUE;
+}
+
+void ao_arm_timer(ao_t *ao, uint32_t ms) {
+    ao->deadline = xTaskGetTickCount() + pdMS_TO_TICKS(ms);
+    ao->timer_armed = true;
+}
+
+void ao_disarm_timer(ao_t *ao) {
+    ao->timer_armed = false;
+}
+
+static void ao_dispatch(ao_t *ao, const ao_event_t *e) {
+    ao->dispatched++;
+    ao->handler(ao, e);
+}
+
+/**
+ * @brief Despacha AO_SIG_TIMEOUT para os objetos vencidos.
+ *
+ * @param w Worker.
+ * @return Ticks até o próximo temporizador, ou portMAX_DELAY se não há
+ *         nenhum armado (o worker bloqueia sem acordar até chegar um evento).
+ */
+static TickType_t ao_run_timers(ao_worker_t *w) {
+    TickType_t wait = portMAX_DELAY;
+    TickType_t now = xTaskGetTickCount();
+
+    for (uint i = 0; i < w->n_aos; ++i) {
+        ao_t *ao = w->aos[i];
+        if (!ao->timer_armed) continue;
+
+        int32_t remaining = (int32_t)(ao->deadline - now);
+        if (remaining <= 0) {
+            static const ao_event_t timeout = { AO_SIG_TIMEOUT, 0 };
+            ao->timer_armed = false; // O handler pode rearmar
+            ao_dispatch(ao, &timeout);
+            now = xTaskGetTickCount();
+            if (ao->timer_armed) {
+                remaining = (int32_t)(ao->deadline - now);
+                if (remaining < 0) remaining = 0;
+            } else {
+                continue;
+            }
+        }
+        if ((TickType_t)remaining < wait) wait = (TickType_t)remaining;
+    }
+    return wait;
+}
+
+/**
+ * @brief Laço do worker: um evento por vez, até o fim (run-to-completion).
+ *        Bloqueia no queue set até chegar um evento ou vencer o temporizador
+ *        mais próximo.
+ */
+static void ao_worker_task(void *pvParameters) {
+    ao_worker_t *w = (ao_worker_t *)pvParameters;
+    ao_event_t e;
+
+    while (true) {
+        TickType_t wait = ao_run_timers(w);
+        QueueSetMemberHandle_t member = xQueueSelectFromSet(w->set, wait);
+        w->wakeups++;
+        if (member == NULL) continue; // Temporizador vencido
+
+        for (uint i = 0; i < w->n_aos; ++i) {
+            if (w->aos[i]->queue == member) {
+                if (xQueueReceive(member, &e, 0) == pdTRUE) {
+                    ao_dispatch(w->aos[i], &e);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Cria o worker que executa os objetos ativos dados.
+ *
+ * @param worker Estrutura do worker (deve permanecer válida).
+ * @param name Nome da tarefa.
+ * @param aos Objetos já inicializados com ao_init().
+ * @param n_aos Número de objetos (até AO_MAX_PER_WORKER).
+ * @param stack Stack estática da tarefa.
+ * @param stack_words Tamanho da stack em palavras.
+ * @param priority Prioridade da tarefa.
+ * @param core_affinity Máscara de núcleos (CORE_AFFINITY_*).
+ */
+void ao_worker_start(ao_worker_t *worker, const char *name, ao_t *const *aos, uint n_aos,
+                     StackType_t *stack, uint32_t stack_words, UBaseType_t priority, UBaseType_t core_affinity) {
+    UBaseType_t set_len = 0;
+
+    configASSERT(n_aos <= AO_MAX_PER_WORKER);
+    worker->name = name;
+    worker->n_aos = (uint8_t)n_aos;
+    worker->stack_words = stack_words;
+    worker->wakeups = 0;
+
+    for (uint i = 0; i < n_aos; ++i) {
+        worker->aos[i] = aos[i];
+        set_len += uxQueueSpacesAvailable(aos[i]->queue) + uxQueueMessagesWaiting(aos[i]->queue);
+    }
+
+    // Um queue set só aceita filas vazias: AO_SIG_START entra depois do cadastro.
+    // Único objeto do heap: o kernel não tem xQueueCreateSetStatic nesta versão.
+    worker->set = xQueueCreateSet(set_len);
+    configASSERT(worker->set != NULL);
+    for (uint i = 0; i < n_aos; ++i) {
+        xQueueAddToSet(aos[i]->queue, worker->set);
+        ao_post(aos[i], AO_SIG_START, 0);
+    }
+
+    worker->task = xTaskCreateStaticAffinitySet(ao_worker_task, name, stack_words, worker, priority,
+                                                stack, &worker->tcb, core_affinity);
+}
+
+void ao_print_stats(const ao_worker_t *const *workers, uint n_workers) {
+    for (uint i = 0; i < n_workers; ++i) {
+        const ao_worker_t *w = workers[i];
+        uint32_t folga = uxTaskGetStackHighWaterMark(w->task);
+        printf("[%s] acordadas: %" PRIu32 ", folga de stack: %" PRIu32 " palavras\n", w->name, w->wakeups, folga);
+#if STACK_MEASURE_ENABLED
+        // Uso máximo + STACK_MEASURE_MARGIN_PCT, arredondado para 16 palavras
+        uint32_t usado = w->stack_words - folga;
+        uint32_t sugerido = (usado * (100 + STACK_MEASURE_MARGIN_PCT) / 100 + 15) & ~15u;
+        printf("  stack: %" PRIu32 " de %" PRIu32 " palavras usadas, sugerido: %" PRIu32
+               " palavras\n", usado, w->stack_words, sugerido);
+#endif
+        for (uint j = 0; j < w->n_aos; ++j) {
+            printf("  %s: %" PRIu32 " eventos\n", w->aos[j]->name, w->aos[j]->dispatched);
+        }
+    }
+}
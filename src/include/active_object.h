@@ -0,0 +1,81 @@
+#ifndef ACTIVE_OBJECT_H
+#define ACTIVE_OBJECT_H
+
+#include "pico/stdlib.h"
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sinais reservados pelo runtime; os sinais da aplicação começam em AO_SIG_USER
+enum {
+    AO_SIG_START,     // Primeiro evento de todo objeto ativo, antes de qualquer outro
+    AO_SIG_TIMEOUT,   // Temporizador do objeto (ao_arm_timer) expirou
+    AO_SIG_USER = 8,
+};
+
+/**
+ * @struct ao_event_t
+ * @brief Evento de 4 bytes copiado na fila do objeto ativo.
+ */
+typedef struct {
+    uint16_t sig;
+    uint16_t arg;
+} ao_event_t;
+
+typedef struct ao ao_t;
+typedef void (*ao_handler_t)(ao_t *me, const ao_event_t *e);
+
+/**
+ * @struct ao
+ * @brief Objeto ativo: máquina de estados com fila própria, executada por um
+ *        worker compartilhado. Objetos com estado extra embutem ao_t como
+ *        primeiro membro e convertem o ponteiro no handler. A fila é estática,
+ *        dentro do próprio objeto.
+ */
+struct ao {
+    const char *name;
+    ao_handler_t handler;
+    QueueHandle_t queue;
+    StaticQueue_t queue_cb;
+    ao_event_t queue_storage[AO_QUEUE_LEN];
+    uint8_t state;            // Estado da máquina (livre para o handler)
+    bool timer_armed;
+    TickType_t deadline;      // Válido com timer_armed
+    uint32_t dispatched;      // Eventos despachados
+};
+
+/**
+ * @struct ao_worker_t
+ * @brief Tarefa que multiplexa as filas dos seus objetos ativos em um queue set.
+ */
+typedef struct {
+    const char *name;
+    ao_t *aos[AO_MAX_PER_WORKER];
+    uint8_t n_aos;
+    QueueSetHandle_t set;
+    TaskHandle_t task;
+    StaticTask_t tcb;
+    uint32_t stack_words;
+    uint32_t wakeups;         // Vezes que o worker desbloqueou
+} ao_worker_t;
+
+// Cria a fila do objeto ativo (AO_QUEUE_LEN eventos, sem heap)
+void ao_init(ao_t *ao, const char *name, ao_handler_t handler);
+
+// Cria o worker com os objetos dados e enfileira AO_SIG_START para cada um
+void ao_worker_start(ao_worker_t *worker, const char *name, ao_t *const *aos, uint n_aos,
+                     StackType_t *stack, uint32_t stack_words, UBaseType_t priority, UBaseType_t core_affinity);
+
+// Publica um evento (de tarefa, não bloqueia). false = fila cheia, evento descartado
+bool ao_post(ao_t *ao, uint16_t sig, uint16_t arg);
+bool ao_post_from_isr(ao_t *ao, uint16_t sig, uint16_t arg, BaseType_t *higher_priority_woken);
+
+// Temporizador único por objeto; só pode ser usado pelo próprio handler
+void ao_arm_timer(ao_t *ao, uint32_t ms);
+void ao_disarm_timer(ao_t *ao);
+
+// Imprime acordadas dos workers, eventos por objeto e folga de stack
+// (com STACK_MEASURE_ENABLED, também o tamanho de stack sugerido)
+void ao_print_stats(const ao_worker_t *const *workers, uint n_workers);
+
+#endif // ACTIVE_OBJECT_H
@@ -0,0 +1,272 @@
+#include "analytics.h"
+#include "config.h"
+#include "mem_budget.h"
+#include <inttypes.h>
+
+#define WINDOW_1MIN_BUCKETS 60
+#define WINDOW_1H_BUCKETS   60
+#define WINDOW_24H_BUCKETS  96
+
+/**
+ * @struct analytics_bucket_t
+ * @brief Contadores de um intervalo fixo de tempo.
+ */
+typedef struct {
+    uint16_t entries;
+    uint16_t exits;
+    uint16_t rejects;
+    uint16_t peak;
+} analytics_bucket_t;
+
+/**
+ * @struct analytics_window_t
+ * @brief Janela deslizante em baldes circulares.
+ *
+ * Os totais são atualizados de forma incremental: ao avançar um balde, o
+ * balde que expira é subtraído. O pico usa uma fila monotônica de índices de
+ * baldes com picos decrescentes, então o máximo da janela é sempre a frente.
+ */
+typedef struct {
+    analytics_bucket_t *buckets;
+    uint32_t *deque;           // Índices absolutos de balde, picos decrescentes
+    uint16_t n;                // Número de baldes
+    uint16_t dq_head;
+    uint16_t dq_len;
+    uint32_t width_us;         // Duração de cada balde
+    uint32_t cur;              // Índice absoluto (now_us / width_us) do balde corrente
+    uint64_t next_us;          // Início do balde seguinte: antes dele, nada a avançar
+    uint32_t entries;
+    uint32_t exits;
+    uint32_t rejects;
+} analytics_window_t;
+
+// Todo o estado em uma única estrutura: sizeof() é o orçamento de RAM do módulo
+static struct {
+    analytics_bucket_t buckets_1min[WINDOW_1MIN_BUCKETS];
+    analytics_bucket_t buckets_1h[WINDOW_1H_BUCKETS];
+    analytics_bucket_t buckets_24h[WINDOW_24H_BUCKETS];
+    uint32_t deque_1min[WINDOW_1MIN_BUCKETS];
+    uint32_t deque_1h[WINDOW_1H_BUCKETS];
+    uint32_t deque_24h[WINDOW_24H_BUCKETS];
+    analytics_window_t window[ANALYTICS_NUM_WINDOWS];
+    uint32_t entry_ts[MAX_USERS];   // Instantes de entrada (ms) de quem está dentro (FIFO)
+    uint16_t entry_head;
+    uint16_t entry_count;
+    uint16_t unknown;               // Dentro desde antes do boot: saídas sem instante de entrada
+    uint16_t occupancy;
+    uint32_t dwell_hist[ANALYTICS_DWELL_BINS];
+} state;
+
+MEM_BUDGET_ENTRY(analytics, "Estatisticas", sizeof(state), ANALYTICS_RAM_BUDGET_BYTES);
+
+static inline uint16_t bucket_peak(const analytics_window_t *w, uint32_t idx) {
+    return w->buckets[idx % w->n].peak;
+}
+
+static inline uint32_t deque_back(const analytics_window_t *w) {
+    return w->deque[(w->dq_head + w->dq_len - 1) % w->n];
+}
+
+/**
+ * @brief Insere o balde idx no fim da fila monotônica, removendo antes
+ *        os baldes que nunca mais serão o máximo da janela.
+ */
+static void deque_push(analytics_window_t *w, uint32_t idx) {
+    uint16_t peak = bucket_peak(w, idx);
+    while (w->dq_len > 0 && bucket_peak(w, deque_back(w)) <= peak) {
+        w->dq_len--;
+    }
+    w->deque[(w->dq_head + w->dq_len) % w->n] = idx;
+    w->dq_len++;
+}
+
+static void window_reset(analytics_window_t *w, uint32_t idx, uint16_t occupancy) {
+    memset(w->buckets, 0, w->n * sizeof(analytics_bucket_t));
+    w->entries = w->exits = w->rejects = 0;
+    w->dq_head = w->dq_len = 0;
+    w->cur = idx;
+    w->next_us = ((uint64_t)idx + 1) * w->width_us;
+    w->buckets[idx % w->n].peak = occupancy;
+    deque_push(w, idx);
+}
+
+/**
+ * @brief Avança a janela até o balde de now_us, expirando os baldes antigos.
+ *        Custo proporcional aos baldes avançados, limitado a n. O relógio é
+ *        o de 64 bits (time_us_64): sem a volta dos 49,7 dias do relógio de
+ *        ms, e a divisão só acontece quando um balde termina.
+ */
+static void window_advance(analytics_window_t *w, uint64_t now_us, uint16_t occupancy) {
+    if (now_us < w->next_us) return;
+    uint32_t target = (uint32_t)(now_us / w->width_us);
+
+    if (target - w->cur >= w->n) {
+        window_reset(w, target, occupancy);
+        return;
+    }
+
+    w->next_us = ((uint64_t)target + 1) * w->width_us;
+    while (w->cur != target) {
+        w->cur++;
+        analytics_bucket_t *b = &w->buckets[w->cur % w->n];
+        // O balde reaproveitado é o que sai da janela
+        w->entries -= b->entries;
+        w->exits -= b->exits;
+        w->rejects -= b->rejects;
+        b->entries = b->exits = b->rejects = 0;
+        b->peak = occupancy; // Quem já está dentro conta para o pico do novo balde
+
+        while (w->dq_len > 0 && w->cur - w->deque[w->dq_head] >= w->n) {
+            w->dq_head = (w->dq_head + 1) % w->n;
+            w->dq_len--;
+        }
+        deque_push(w, w->cur);
+    }
+}
+
+static void window_record(analytics_window_t *w, analytics_event_t event, uint16_t occupancy) {
+    analytics_bucket_t *b = &w->buckets[w->cur % w->n];
+
+    switch (event) {
+        case ANALYTICS_EVT_ENTRY:  b->entries++; w->entries++; break;
+        case ANALYTICS_EVT_EXIT:   b->exits++;   w->exits++;   break;
+        case ANALYTICS_EVT_REJECT: b->rejects++; w->rejects++; break;
+        default: break;
+    }
+
+    if (occupancy > b->peak) {
+        b->peak = occupancy;
+        w->dq_len--;          // O balde corrente é sempre o último da fila
+        deque_push(w, w->cur);
+    }
+}
+
+/**
+ * @brief Índice do balde do histograma de permanência.
+ * @param dwell_ms Tempo de permanência em ms.
+ * @return 0 para menos de 1 s; k para [2^(k-1), 2^k) s; saturado no último balde.
+ */
+static inline uint dwell_bin(uint32_t dwell_ms) {
+    uint32_t seconds = dwell_ms / 1000;
+    uint bin = seconds ? 32 - __builtin_clz(seconds) : 0;
+    return bin < ANALYTICS_DWELL_BINS ? bin : ANALYTICS_DWELL_BINS - 1;
+}
+
+/**
+ * @brief Inicializa as janelas e o histograma.
+ *
+ * @param now_us Instante atual (time_us_64).
+ * @param occupancy Ocupação atual (ex: restaurada no boot). Os instantes de
+ *        entrada dessas pessoas são desconhecidos: as primeiras saídas são
+ *        delas e não entram no histograma nem consomem entradas novas.
+ */
+void analytics_init(uint64_t now_us, uint16_t occupancy) {
+    memset(&state, 0, sizeof(state));
+
+    analytics_bucket_t *buckets[ANALYTICS_NUM_WINDOWS] = { state.buckets_1min, state.buckets_1h, state.buckets_24h };
+    uint32_t *deques[ANALYTICS_NUM_WINDOWS] = { state.deque_1min, state.deque_1h, state.deque_24h };
+    const uint16_t sizes[ANALYTICS_NUM_WINDOWS] = { WINDOW_1MIN_BUCKETS, WINDOW_1H_BUCKETS, WINDOW_24H_BUCKETS };
+    const uint32_t widths[ANALYTICS_NUM_WINDOWS] = { 1000000u, 60 * 1000000u, 15 * 60 * 1000000u };
+
+    for (uint i = 0; i < ANALYTICS_NUM_WINDOWS; ++i) {
+        analytics_window_t *w = &state.window[i];
+        w->buckets = buckets[i];
+        w->deque = deques[i];
+        w->n = sizes[i];
+        w->width_us = widths[i];
+        window_reset(w, (uint32_t)(now_us / w->width_us), occupancy);
+    }
+    state.occupancy = occupancy;
+    state.unknown = occupancy;
+}
+
+/**
+ * @brief Registra um evento de ocupação.
+ *
+ * @param event Tipo do evento.
+ * @param occupancy Ocupação resultante após o evento.
+ * @param now_us Instante do evento (time_us_64).
+ */
+void analytics_record(analytics_event_t event, uint16_t occupancy, uint64_t now_us) {
+    uint32_t now_ms = (uint32_t)(now_us / 1000);  // Permanências: diferenças de 32 bits bastam
+
+    taskENTER_CRITICAL();
+
+    for (uint i = 0; i < ANALYTICS_NUM_WINDOWS; ++i) {
+        window_advance(&state.window[i], now_us, state.occupancy);
+        window_record(&state.window[i], event, occupancy);
+    }
+
+    // Permanência: as saídas casam com as entradas mais antigas (FIFO)
+    if (event == ANALYTICS_EVT_ENTRY) {
+        if (state.entry_count < MAX_USERS) {
+            state.entry_ts[(state.entry_head + state.entry_count) % MAX_USERS] = now_ms;
+            state.entry_count++;
+        }
+    } else if (event == ANALYTICS_EVT_EXIT) {
+        if (state.unknown > 0) {
+            state.unknown--;
+        } else if (state.entry_count > 0) {
+            uint32_t dwell_ms = now_ms - state.entry_ts[state.entry_head];
+            state.entry_head = (state.entry_head + 1) % MAX_USERS;
+            state.entry_count--;
+            state.dwell_hist[dwell_bin(dwell_ms)]++;
+        }
+    } else if (event == ANALYTICS_EVT_RESET) {
+        state.entry_head = 0;
+        state.entry_count = 0;
+        state.unknown = 0;
+    }
+
+    state.occupancy = occupancy;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Lê os agregados pré-calculados de todas as janelas.
+ *
+ * @param now_us Instante da consulta (expira os baldes vencidos antes de ler).
+ * @param summary Saída com os totais e o histograma.
+ */
+void analytics_get_summary(uint64_t now_us, analytics_summary_t *summary) {
+    taskENTER_CRITICAL();
+    for (uint i = 0; i < ANALYTICS_NUM_WINDOWS; ++i) {
+        analytics_window_t *w = &state.window[i];
+        window_advance(w, now_us, state.occupancy);
+        summary->window[i].entries = w->entries;
+        summary->window[i].exits = w->exits;
+        summary->window[i].rejects = w->rejects;
+        summary->window[i].peak = bucket_peak(w, w->deque[w->dq_head]);
+    }
+    memcpy(summary->dwell_hist, state.dwell_hist, sizeof(state.dwell_hist));
+    taskEXIT_CRITICAL();
+}
+
+uint16_t analytics_rejection_permille(const analytics_window_summary_t *window) {
+    uint32_t attempts = window->entries + window->rejects;
+    return attempts ? (uint16_t)((window->rejects * 1000u) / attempts) : 0;
+}
+
+/**
+ * @brief Imprime o resumo das três janelas e o histograma de permanência.
+ */
+void analytics_print_summary(uint64_t now_us) {
+    static const char *names[ANALYTICS_NUM_WINDOWS] = { "1 min", "1 h", "24 h" };
+    analytics_summary_t summary;
+    analytics_get_summary(now_us, &summary);
+
+    for (uint i = 0; i < ANALYTICS_NUM_WINDOWS; ++i) {
+        const analytics_window_summary_t *w = &summary.window[i];
+        printf("[%s] entradas: %" PRIu32 ", saidas: %" PRIu32 ", recusas: %" PRIu32 " (%u/1000), pico: %u\n",
+               names[i], w->entries, w->exits, w->rejects, analytics_rejection_permille(w), w->peak);
+    }
+    printf("Permanencia (s):");
+    for (uint k = 0; k < ANALYTICS_DWELL_BINS; ++k) {
+        if (summary.dwell_hist[k]) printf(" <%" PRIu32 ":%" PRIu32, (uint32_t)1 << k, summary.dwell_hist[k]);
+    }
+    printf("\n");
+}
+
+size_t analytics_ram_bytes(void) {
+    return sizeof(state);
+}
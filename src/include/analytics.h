@@ -0,0 +1,67 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Eventos de ocupação que alimentam as estatísticas
+typedef enum {
+    ANALYTICS_EVT_ENTRY,
+    ANALYTICS_EVT_EXIT,
+    ANALYTICS_EVT_REJECT,
+    ANALYTICS_EVT_RESET,
+} analytics_event_t;
+
+// Janelas deslizantes mantidas
+typedef enum {
+    ANALYTICS_WINDOW_1MIN,   // 60 baldes de 1 s
+    ANALYTICS_WINDOW_1H,     // 60 baldes de 1 min
+    ANALYTICS_WINDOW_24H,    // 96 baldes de 15 min
+    ANALYTICS_NUM_WINDOWS,
+} analytics_window_id_t;
+
+// Histograma de permanência: o balde k conta permanências em [2^(k-1), 2^k) s
+#define ANALYTICS_DWELL_BINS 18 // Último balde: 2^16 s (~18 h) ou mais
+
+/**
+ * @struct analytics_window_summary_t
+ * @brief Totais de uma janela deslizante.
+ */
+typedef struct {
+    uint32_t entries;
+    uint32_t exits;
+    uint32_t rejects;
+    uint16_t peak;            // Pico de ocupação dentro da janela
+} analytics_window_summary_t;
+
+/**
+ * @struct analytics_summary_t
+ * @brief Resultado de uma consulta: todos os agregados já pré-calculados.
+ */
+typedef struct {
+    analytics_window_summary_t window[ANALYTICS_NUM_WINDOWS];
+    uint32_t dwell_hist[ANALYTICS_DWELL_BINS];
+} analytics_summary_t;
+
+// Os instantes (now_us) são de time_us_64(): 64 bits, sem volta em 49,7 dias
+
+// Inicializa as janelas a partir do instante e ocupação atuais
+void analytics_init(uint64_t now_us, uint16_t occupancy);
+
+// Registra um evento com a ocupação resultante (O(1) amortizado)
+void analytics_record(analytics_event_t event, uint16_t occupancy, uint64_t now_us);
+
+// Consulta os agregados sem percorrer o histórico
+void analytics_get_summary(uint64_t now_us, analytics_summary_t *summary);
+
+// Taxa de recusa da janela em milésimos (recusas / tentativas de entrada)
+uint16_t analytics_rejection_permille(const analytics_window_summary_t *window);
+
+// Imprime o resumo no terminal serial
+void analytics_print_summary(uint64_t now_us);
+
+// Memória ocupada pelo módulo (conhecida em tempo de compilação)
+size_t analytics_ram_bytes(void);
+
+#endif // ANALYTICS_H
@@ -0,0 +1,330 @@
+#include "beam_counter.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "profiler.h"
+#include "trace.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include <inttypes.h>
+
+static const uint8_t door_pins[][2] = BEAM_DOOR_PINS;
+#define BEAM_NUM_DOORS (sizeof(door_pins) / sizeof(door_pins[0]))
+
+// Sentido de uma passagem em curso
+typedef enum {
+    DIR_ENTERING,   // Começa em A, termina em B
+    DIR_EXITING,    // Começa em B, termina em A
+} beam_dir_t;
+
+/**
+ * @struct passage_t
+ * @brief Uma pessoa no vão da porta, com a passagem ainda não decidida.
+ */
+typedef struct {
+    uint8_t dir;          // beam_dir_t
+    bool reached;         // Já interrompeu o feixe do fim da passagem
+    bool provisional;     // Liberou o feixe do fim com o do começo ainda ocupado (ver beam_cleared)
+} passage_t;
+
+/**
+ * @struct door_state_t
+ * @brief Estado da máquina de estados de uma porta.
+ *
+ * Os sensores ficam mais próximos que o comprimento de um corpo, então uma
+ * pessoa sempre interrompe o segundo feixe antes de liberar o primeiro, e
+ * quem está no vão ocupa pelo menos um feixe. As pessoas no vão ficam numa
+ * fila por ordem de chegada (ninguém ultrapassa ninguém numa porta): a
+ * primeira é a mais adiantada. Um feixe pode ficar ocupado direto por duas
+ * pessoas seguidas, então as bordas de um feixe não dizem quantas passaram;
+ * a fila diz.
+ */
+typedef struct {
+    bool blocked[2];
+    uint8_t count;
+    passage_t queue[BEAM_QUEUE_LEN];
+    beam_door_stats_t stats;
+} door_state_t;
+
+static door_state_t doors[BEAM_NUM_DOORS];
+static volatile uint16_t entries_pending = 0;
+static volatile uint16_t exits_pending = 0;
+static beam_listener_t listener = NULL;
+
+// Trace circular das últimas bordas (potência de 2)
+static beam_edge_t trace[BEAM_TRACE_LEN];
+static volatile uint32_t trace_head = 0;
+
+MEM_BUDGET_ENTRY(beam, "Feixes", sizeof(doors) + sizeof(trace), MEM_BUDGET_BEAM_BYTES);
+
+// Sentido da passagem que começa no sensor s
+static inline beam_dir_t dir_starting_at(beam_sensor_t s) {
+    return s == BEAM_SENSOR_A ? DIR_ENTERING : DIR_EXITING;
+}
+
+static void count_passage(door_state_t *d, beam_dir_t dir) {
+    if (dir == DIR_ENTERING) {
+        d->stats.entries++;
+        entries_pending++;
+    } else {
+        d->stats.exits++;
+        exits_pending++;
+    }
+}
+
+static void queue_remove(door_state_t *d, uint8_t i) {
+    for (uint8_t j = i + 1; j < d->count; ++j) {
+        d->queue[j - 1] = d->queue[j];
+    }
+    d->count--;
+}
+
+// Há alguém no sentido dir na fila depois da posição i
+static bool queue_has_after(const door_state_t *d, uint8_t i, beam_dir_t dir) {
+    for (uint8_t j = i + 1; j < d->count; ++j) {
+        if (d->queue[j].dir == dir) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Um feixe foi interrompido.
+ *
+ * Se alguém vindo do outro sensor ainda não o alcançou, é ele chegando ao fim
+ * da passagem. Senão começa uma passagem nova no fim da fila, e é carona se
+ * já havia alguém no vão no mesmo sentido.
+ *
+ * @param d Estado da porta.
+ * @param s Sensor que mudou.
+ */
+static void beam_blocked(door_state_t *d, beam_sensor_t s) {
+    beam_dir_t starting = dir_starting_at(s);
+    beam_dir_t arriving = starting == DIR_ENTERING ? DIR_EXITING : DIR_ENTERING;
+
+    for (uint8_t i = 0; i < d->count; ++i) {
+        passage_t *p = &d->queue[i];
+        if (p->dir != arriving || p->reached) continue;
+        if (p->provisional) {
+            // Quem liberou este feixe tinha passado: esta é a pessoa de trás
+            count_passage(d, arriving);
+            d->stats.tailgates++;
+            p->provisional = false;
+        }
+        p->reached = true;
+        return;
+    }
+
+    for (uint8_t i = 0; i < d->count; ++i) {
+        if (d->queue[i].dir == starting) {
+            d->stats.tailgates++;
+            break;
+        }
+    }
+    if (d->count < BEAM_QUEUE_LEN) {
+        d->queue[d->count++] = (passage_t){ .dir = starting };
+    }
+}
+
+/**
+ * @brief Um feixe foi liberado.
+ *
+ * Quem ainda não tinha alcançado o outro feixe saiu deste para trás: desistiu.
+ * Quem estava neste feixe como fim da passagem terminou, a menos que o feixe
+ * do começo continue ocupado sem mais ninguém na fila: aí a pessoa pode ter
+ * recuado para ele ou passado com outra entrando colada atrás, encobrindo a
+ * borda. Fica provisória até a próxima borda decidir (beam_blocked no fim =
+ * a de trás chegou, recuo = desistência).
+ *
+ * @param d Estado da porta.
+ * @param s Sensor que mudou.
+ */
+static void beam_cleared(door_state_t *d, beam_sensor_t s) {
+    beam_sensor_t other = (s == BEAM_SENSOR_A) ? BEAM_SENSOR_B : BEAM_SENSOR_A;
+    beam_dir_t starting = dir_starting_at(s);
+    uint8_t i = 0;
+
+    while (i < d->count) {
+        passage_t *p = &d->queue[i];
+        if (p->dir == starting && !p->reached) {
+            d->stats.aborted++;
+            queue_remove(d, i);
+            continue;
+        }
+        if (p->dir != starting && p->reached) {
+            if (!d->blocked[other] || queue_has_after(d, i, p->dir)) {
+                count_passage(d, (beam_dir_t)p->dir);
+                queue_remove(d, i);
+                continue;
+            }
+            p->reached = false;
+            p->provisional = true;
+        }
+        ++i;
+    }
+
+    // Com os dois feixes livres não pode haver ninguém no vão da porta
+    if (!d->blocked[other]) {
+        d->count = 0;
+    }
+}
+
+/**
+ * @brief Processa uma borda de sensor, em tempo limitado (no máximo
+ *        BEAM_QUEUE_LEN passagens percorridas).
+ *
+ * Chamada pela ISR para cada borda; fora da ISR (reprodução de trace) deve
+ * ser chamada antes de beam_counter_init() ou com as interrupções desabilitadas.
+ *
+ * @param edge Borda a processar.
+ */
+void beam_counter_feed_edge(const beam_edge_t *edge) {
+    if (edge->door >= BEAM_NUM_DOORS || edge->sensor > BEAM_SENSOR_B) return;
+
+    door_state_t *d = &doors[edge->door];
+    beam_sensor_t s = (beam_sensor_t)edge->sensor;
+    bool blocked = edge->blocked != 0;
+
+    // Borda sem mudança de nível (pulso curto já desfeito): ignora
+    if (d->blocked[s] == blocked) return;
+    d->blocked[s] = blocked;
+
+    if (blocked) {
+        beam_blocked(d, s);
+    } else {
+        beam_cleared(d, s);
+    }
+}
+
+/**
+ * @brief Handler bruto de GPIO para os sensores de feixe.
+ *
+ * Registrado só para os pinos dos sensores, convive com o callback dos botões.
+ * O custo é limitado: no máximo uma iteração O(1) por pino de sensor.
+ */
+static void beam_irq_handler(void) {
+    uint64_t now = time_us_64();
+
+    for (uint8_t door = 0; door < BEAM_NUM_DOORS; ++door) {
+        for (uint8_t sensor = 0; sensor < 2; ++sensor) {
+            uint pin = door_pins[door][sensor];
+            uint32_t events = gpio_get_irq_event_mask(pin) & (GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE);
+            if (!events) continue;
+            gpio_acknowledge_irq(pin, events);
+            TRACE(TRACE_EVT_BEAM_EDGE, door << 1 | sensor);
+
+            beam_edge_t *edge = &trace[trace_head & (BEAM_TRACE_LEN - 1)];
+            edge->t_us = now;
+            edge->door = door;
+            edge->sensor = sensor;
+            edge->blocked = (gpio_get(pin) == BEAM_BLOCKED_LEVEL);
+            trace_head++;
+
+            uint16_t entries_before = entries_pending;
+            uint16_t exits_before = exits_pending;
+            beam_counter_feed_edge(edge);
+
+            // Avisa o consumidor só nas passagens completas (a reprodução de trace não avisa)
+            if (listener && entries_pending != entries_before) listener(true);
+            if (listener && exits_pending != exits_before) listener(false);
+        }
+    }
+    profiler_isr_record(PROFILER_ISR_BEAM, (uint32_t)now);
+}
+
+/**
+ * @brief Registra a função avisada (na ISR) a cada entrada ou saída detectada.
+ *        Uma passagem anterior ao registro fica pendente, sem aviso, até
+ *        beam_counter_take_entry()/beam_counter_take_exit().
+ */
+void beam_counter_set_listener(beam_listener_t fn) {
+    listener = fn;
+}
+
+/**
+ * @brief Inicializa os pinos dos sensores de feixe e a interrupção nas duas bordas.
+ */
+void beam_counter_init(void) {
+    uint32_t mask = 0;
+
+    for (uint8_t door = 0; door < BEAM_NUM_DOORS; ++door) {
+        for (uint8_t sensor = 0; sensor < 2; ++sensor) {
+            uint pin = door_pins[door][sensor];
+            gpio_init(pin);
+            gpio_set_dir(pin, GPIO_IN);
+            gpio_pull_up(pin);
+            doors[door].blocked[sensor] = (gpio_get(pin) == BEAM_BLOCKED_LEVEL);
+            mask |= 1u << pin;
+        }
+    }
+
+    gpio_add_raw_irq_handler_masked(mask, beam_irq_handler);
+    for (uint8_t door = 0; door < BEAM_NUM_DOORS; ++door) {
+        for (uint8_t sensor = 0; sensor < 2; ++sensor) {
+            gpio_set_irq_enabled(door_pins[door][sensor], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+        }
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    printf("Contador por feixes inicializado (%u portas).\n", (unsigned)BEAM_NUM_DOORS);
+}
+
+/**
+ * @brief Consome uma entrada detectada pelos sensores.
+ *
+ * @return true se havia uma entrada ainda não processada. Caso contrário, false.
+ */
+bool beam_counter_take_entry(void) {
+    bool taken = false;
+    taskENTER_CRITICAL();
+    if (entries_pending > 0) {
+        entries_pending--;
+        taken = true;
+    }
+    taskEXIT_CRITICAL();
+    return taken;
+}
+
+/**
+ * @brief Consome uma saída detectada pelos sensores.
+ *
+ * @return true se havia uma saída ainda não processada. Caso contrário, false.
+ */
+bool beam_counter_take_exit(void) {
+    bool taken = false;
+    taskENTER_CRITICAL();
+    if (exits_pending > 0) {
+        exits_pending--;
+        taken = true;
+    }
+    taskEXIT_CRITICAL();
+    return taken;
+}
+
+bool beam_counter_get_stats(uint8_t door, beam_door_stats_t *stats) {
+    if (door >= BEAM_NUM_DOORS) return false;
+    taskENTER_CRITICAL();
+    *stats = doors[door].stats;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**
+ * @brief Imprime o trace de bordas, da mais antiga para a mais recente,
+ *        no formato "t_us,porta,sensor,bloqueado".
+ */
+void beam_counter_dump_trace(void) {
+    static beam_edge_t copy[BEAM_TRACE_LEN];
+    uint32_t head, count;
+
+    taskENTER_CRITICAL();
+    head = trace_head;
+    count = head < BEAM_TRACE_LEN ? head : BEAM_TRACE_LEN;
+    for (uint32_t i = 0; i < count; ++i) {
+        copy[i] = trace[(head - count + i) & (BEAM_TRACE_LEN - 1)];
+    }
+    taskEXIT_CRITICAL();
+
+    printf("# t_us,porta,sensor,bloqueado\n");
+    for (uint32_t i = 0; i < count; ++i) {
+        printf("%" PRIu64 ",%u,%u,%u\n", copy[i].t_us, copy[i].door, copy[i].sensor, copy[i].blocked);
+    }
+}
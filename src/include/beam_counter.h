@@ -0,0 +1,56 @@
+#ifndef BEAM_COUNTER_H
+#define BEAM_COUNTER_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sensores de cada porta: A fica do lado de fora, B do lado de dentro
+typedef enum {
+    BEAM_SENSOR_A = 0,
+    BEAM_SENSOR_B = 1,
+} beam_sensor_t;
+
+/**
+ * @struct beam_edge_t
+ * @brief Uma borda de sensor de feixe. É o formato do trace de bordas: cada
+ *        linha de beam_counter_dump_trace() é "t_us,porta,sensor,bloqueado"
+ *        e pode ser reinjetada, na mesma ordem, via beam_counter_feed_edge().
+ */
+typedef struct {
+    uint64_t t_us;     // Instante da borda (time_us_64)
+    uint8_t door;      // Índice da porta (posição em BEAM_DOOR_PINS)
+    uint8_t sensor;    // beam_sensor_t
+    uint8_t blocked;   // 1 = feixe interrompido, 0 = feixe livre
+} beam_edge_t;
+
+/**
+ * @struct beam_door_stats_t
+ * @brief Contadores acumulados de uma porta.
+ */
+typedef struct {
+    uint32_t entries;      // Passagens completas de A para B
+    uint32_t exits;        // Passagens completas de B para A
+    uint32_t tailgates;    // Segunda pessoa no vão, no mesmo sentido, antes da primeira terminar
+    uint32_t aborted;      // Passagens iniciadas e desfeitas (pessoa voltou)
+} beam_door_stats_t;
+
+// Inicializa os sensores de feixe e a interrupção de borda
+void beam_counter_init(void);
+
+// Função chamada pela ISR a cada passagem completa (contexto de interrupção)
+typedef void (*beam_listener_t)(bool entry);
+void beam_counter_set_listener(beam_listener_t listener);
+
+// Processa uma borda (chamada pela ISR; também usada para reproduzir um trace)
+void beam_counter_feed_edge(const beam_edge_t *edge);
+
+// Consome uma entrada/saída detectada, se houver (mesma semântica de buttons_a/b_pressed)
+bool beam_counter_take_entry(void);
+bool beam_counter_take_exit(void);
+
+// Leitura dos contadores (false para uma porta além de BEAM_DOOR_PINS) e do trace de bordas
+bool beam_counter_get_stats(uint8_t door, beam_door_stats_t *stats);
+void beam_counter_dump_trace(void);
+
+#endif // BEAM_COUNTER_H
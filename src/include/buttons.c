@@ -3,6 +3,8 @@
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
 #include "debouncer.h"
+#include "profiler.h"
+#include "trace.h"
 
 static volatile bool flag_button_a = false;
 static volatile bool flag_button_b = false;
@@ -12,6 +14,44 @@ static uint32_t last_time_a = 0;
 static uint32_t last_time_b = 0;
 static uint32_t last_time_joy = 0;
 
+static buttons_listener_t listener = NULL;
+static buttons_stats_t stats;
+
+/**
+ * @brief Estado de debounce e flag de um botão.
+ *
+ * @return false se o pino não é de um botão.
+ */
+static bool button_state(uint gpio, uint32_t **last_time, volatile bool **flag) {
+    if (gpio == BUTTON_A_PIN) {
+        *last_time = &last_time_a;
+        *flag = &flag_button_a;
+    } else if (gpio == BUTTON_B_PIN) {
+        *last_time = &last_time_b;
+        *flag = &flag_button_b;
+    } else if (gpio == JOYSTICK_BTN_PIN) {
+        *last_time = &last_time_joy;
+        *flag = &flag_joy_button;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Acionamento aceito (pela ISR ou injetado): define a flag e avisa
+ *        quem consome as flags, sem precisar de polling. Um acionamento cuja
+ *        flag ainda não foi consumida se funde com o anterior.
+ */
+static void accept(uint gpio, volatile bool *flag) {
+    if (*flag) stats.coalesced++;
+    *flag = true;
+    stats.accepted++;
+    if (listener) {
+        listener(gpio);
+    }
+}
+
 /**
  * @brief Callback interno de interrupção para todos os botões.
  *
@@ -23,21 +63,19 @@ static uint32_t last_time_joy = 0;
  * @param events Máscara com os eventos ocorridos (ex: GPIO_IRQ_EDGE_FALL).
  */
 static void gpio_callback_internal(uint gpio, uint32_t events) {
-    if (events & GPIO_IRQ_EDGE_FALL) {
-        if (gpio == BUTTON_A_PIN) {
-            if (check_debounce(&last_time_a, DEBOUNCE_TIME_US)) {
-                flag_button_a = true;
-            }
-        } else if (gpio == BUTTON_B_PIN) {
-            if (check_debounce(&last_time_b, DEBOUNCE_TIME_US)) {
-                flag_button_b = true;
-            }
-        } else if (gpio == JOYSTICK_BTN_PIN) {
-            if (check_debounce(&last_time_joy, DEBOUNCE_TIME_US)) {
-                flag_joy_button = true;
-            }
+    uint32_t start_us = time_us_32();
+    uint32_t *last_time;
+    volatile bool *flag;
+
+    TRACE(TRACE_EVT_BUTTON_EDGE, gpio);
+    if ((events & GPIO_IRQ_EDGE_FALL) && button_state(gpio, &last_time, &flag)) {
+        if (check_debounce(last_time, DEBOUNCE_TIME_US)) {
+            accept(gpio, flag);
+        } else {
+            stats.debounced++;
         }
     }
+    profiler_isr_record(PROFILER_ISR_BUTTONS, start_us);
 }
 
 /**
@@ -64,6 +102,35 @@ void buttons_init() {
     gpio_set_irq_enabled_with_callback(JOYSTICK_BTN_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_callback_internal);
 }
 
+/**
+ * @brief Registra a função avisada (na ISR) a cada acionamento aceito.
+ *
+ * @param fn Função que recebe o pino acionado.
+ */
+void buttons_set_listener(buttons_listener_t fn) {
+    listener = fn;
+}
+
+/**
+ * @brief Injeta um acionamento aceito, como se viesse da ISR depois do
+ *        debounce (gerador de carga). Chamar em contexto de interrupção.
+ *
+ * @param gpio Pino do botão (BUTTON_A_PIN, BUTTON_B_PIN ou JOYSTICK_BTN_PIN).
+ */
+void buttons_inject(uint gpio) {
+    uint32_t *last_time;
+    volatile bool *flag;
+
+    if (!button_state(gpio, &last_time, &flag)) return;
+    *last_time = time_us_32(); // Instante do acionamento, para a latência de admissão
+    stats.injected++;
+    accept(gpio, flag);
+}
+
+void buttons_get_stats(buttons_stats_t *out) {
+    *out = stats;
+}
+
 /**
  * @brief Verifica se o botão foi pressionado.
  *
@@ -93,3 +160,16 @@ bool buttons_joystick_pressed() {
     }
     return false;
 }
+
+/**
+ * @brief Instante do último acionamento aceito (após o debounce).
+ *
+ * @return Valor de time_us_32() registrado pela interrupção.
+ */
+uint32_t buttons_a_press_time_us() {
+    return last_time_a;
+}
+
+uint32_t buttons_b_press_time_us() {
+    return last_time_b;
+}
@@ -7,9 +7,34 @@
 // Inicializa os botões e configura as interrupções
 void buttons_init();
 
+// Função chamada pela ISR a cada acionamento aceito (contexto de interrupção)
+typedef void (*buttons_listener_t)(uint gpio);
+void buttons_set_listener(buttons_listener_t listener);
+
+/**
+ * @struct buttons_stats_t
+ * @brief Contadores dos acionamentos desde o boot. Escritos só em contexto de
+ *        interrupção; a leitura pode ver um campo defasado (diagnóstico).
+ */
+typedef struct {
+    uint32_t accepted;    // Acionamentos aceitos (ISR após o debounce e injetados)
+    uint32_t injected;    // Dos aceitos, injetados por buttons_inject()
+    uint32_t debounced;   // Bordas descartadas pelo debounce
+    uint32_t coalesced;   // Aceitos com a flag ainda pendente: fundidos com o anterior
+} buttons_stats_t;
+
+// Acionamento aceito sem borda nem debounce, pelo mesmo caminho da ISR
+// (flag + aviso ao listener). Chamar em contexto de interrupção.
+void buttons_inject(uint gpio);
+void buttons_get_stats(buttons_stats_t *out);
+
 // Verifica se o botão foi pressionado desde a última verificação
 bool buttons_a_pressed();
 bool buttons_b_pressed();
 bool buttons_joystick_pressed();
 
+// Instante (time_us_32) do último acionamento aceito
+uint32_t buttons_a_press_time_us();
+uint32_t buttons_b_press_time_us();
+
 #endif
\ No newline at end of file
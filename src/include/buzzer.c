@@ -3,8 +3,22 @@
 #include "hardware/clocks.h"
 #include "pico/stdlib.h"
 #include "buzzer.h"
+#include "rgb_led.h"
 #include "config.h"
 
+static uint tone_freq;   // Tom ligado sem duração (0 = PWM desligado), refeito a cada troca do clk_sys
+
+/**
+ * @brief Silencia o tom. O slice do buzzer também gera o verde do LED RGB
+ *        (canal B), então continua ligado: o canal do buzzer vai a 0 e o
+ *        período volta ao do LED.
+ */
+static void tone_off(void) {
+    pwm_set_gpio_level(BUZZER_PIN_MAIN, 0);
+    rgb_led_share_slice(0);
+    tone_freq = 0;
+}
+
 /**
  * @brief Inicializa o pino GPIO conectado ao buzzer como saída.
  *        Opcionalmente, pode tocar uma melodia de inicialização.
@@ -34,9 +48,8 @@ static void play_tone_internal(uint freq, uint duration_ms) {
             // substituir sleep_ms por vTaskDelay(pdMS_TO_TICKS(duration_ms));
             sleep_ms(duration_ms);
         }
-        // Desliga o PWM explicitamente se estava ligado antes
-        uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN_MAIN);
-        pwm_set_enabled(slice_num, false);
+        // Silencia o PWM explicitamente se estava ligado antes
+        tone_off();
         return; // Retorna após o silêncio
     }
 
@@ -65,6 +78,8 @@ static void play_tone_internal(uint freq, uint duration_ms) {
     pwm_set_wrap(slice_num, wrap_val);
     // Define o nível do canal para 50% do valor de wrap (duty cycle de 50%).
     pwm_set_chan_level(slice_num, channel, wrap_val / 2);
+    // O verde do LED RGB, no outro canal, passa a usar o wrap do tom
+    rgb_led_share_slice((uint16_t)wrap_val);
     // Habilita o PWM.
     pwm_set_enabled(slice_num, true);
 
@@ -72,8 +87,10 @@ static void play_tone_internal(uint freq, uint duration_ms) {
     if (duration_ms > 0) {
         // IMPORTANTE: Substituir por vTaskDelay se em contexto FreeRTOS.
         sleep_ms(duration_ms);
-        // Desabilita o PWM após a duração.
-        pwm_set_enabled(slice_num, false);
+        // Silencia o PWM após a duração.
+        tone_off();
+    } else {
+        tone_freq = freq;
     }
     // Se duration_ms for 0, o PWM permanece habilitado e a função retorna.
     // O chamador é responsável por desabilitá-lo depois, se necessário.
@@ -89,4 +106,16 @@ void buzzer_play_tone(uint freq, uint duration_ms) {
     // Chama a função interna que lida com a lógica do PWM.
     // A função interna já trata freq=0 e duration_ms=0/ >0.
     play_tone_internal(freq, duration_ms);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Ouvinte do clock_mgr: o divisor e o wrap do PWM saem do clk_sys,
+ *        então um tom ligado é recalculado para continuar na mesma frequência.
+ */
+bool buzzer_clock_listener(clock_phase_t phase, uint32_t sys_hz) {
+    (void)sys_hz;
+    if (phase == CLOCK_PHASE_RETIME && tone_freq) {
+        play_tone_internal(tone_freq, 0);
+    }
+    return true;
+}
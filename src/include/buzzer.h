@@ -2,8 +2,11 @@
 #define BUZZER_H
 
 #include <stdint.h>
+#include "clock_mgr.h"
 
 void buzzer_init();
 void buzzer_play_tone(uint freq, uint duration_ms);
+// Ouvinte do clock_mgr (registrado no main): refaz o PWM do tom ligado
+bool buzzer_clock_listener(clock_phase_t phase, uint32_t sys_hz);
 
 #endif // BUZZER_H
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "clock_mgr.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+#include "hardware/structs/systick.h"
+#include "pico/flash.h"
+
+static const uint32_t mode_khz[CLOCK_NUM_MODES] = {
+    [CLOCK_MODE_IDLE]   = CLOCK_IDLE_KHZ,
+    [CLOCK_MODE_NORMAL] = CLOCK_NORMAL_KHZ,
+    [CLOCK_MODE_BURST]  = CLOCK_BURST_KHZ,
+};
+
+static const char *const mode_names[CLOCK_NUM_MODES] = { "ocioso", "normal", "pico" };
+
+_Static_assert(CLOCK_IDLE_KHZ <= CLOCK_NORMAL_KHZ && CLOCK_NORMAL_KHZ <= CLOCK_BURST_KHZ,
+               "modos de clock fora de ordem");
+
+static clock_listener_t listeners[CLOCK_MAX_LISTENERS];
+static uint8_t n_listeners;
+static clock_mode_t current = CLOCK_MODE_NORMAL;   // O SDK sobe em CLOCK_NORMAL_KHZ
+static clock_stats_t stats;
+
+MEM_BUDGET_ENTRY(clock_mgr, "Clock",
+                 sizeof(listeners) + sizeof(n_listeners) + sizeof(current) + sizeof(stats), MEM_BUDGET_CLOCK_BYTES);
+
+bool clock_mgr_register(clock_listener_t fn) {
+    for (uint i = 0; i < n_listeners; ++i) {
+        if (listeners[i] == fn) return true;
+    }
+    if (n_listeners >= CLOCK_MAX_LISTENERS) return false;
+    listeners[n_listeners++] = fn;
+    return true;
+}
+
+// --- Troca (outro núcleo travado, IRQs desligadas) ---
+
+typedef enum { SWITCH_OK, SWITCH_DEFERRED, SWITCH_FAILED } switch_result_t;
+
+typedef struct {
+    uint32_t from_khz;
+    uint32_t to_khz;
+    switch_result_t result;
+} switch_op_t;
+
+/**
+ * @brief Pergunta aos ouvintes, ajusta a tensão do núcleo, troca o PLL e
+ *        recalcula o SysTick e os periféricos.
+ *
+ * A tensão sobe antes de um clock acima de CLOCK_VREG_BOOST_ABOVE_KHZ e só
+ * desce depois de o clock ter baixado: o núcleo nunca roda rápido com a
+ * tensão padrão.
+ */
+static void switch_op(void *param) {
+    switch_op_t *op = (switch_op_t *)param;
+
+    for (uint i = 0; i < n_listeners; ++i) {
+        if (!listeners[i](CLOCK_PHASE_PREPARE, op->from_khz * 1000)) {
+            op->result = SWITCH_DEFERRED;
+            return;
+        }
+    }
+
+    bool boost = op->to_khz > CLOCK_VREG_BOOST_ABOVE_KHZ;
+    bool was_boosted = op->from_khz > CLOCK_VREG_BOOST_ABOVE_KHZ;
+    if (boost && !was_boosted) {
+        vreg_set_voltage(CLOCK_BURST_VREG);
+        busy_wait_us(CLOCK_VREG_SETTLE_US);
+    }
+    if (!set_sys_clock_khz(op->to_khz, false)) {
+        if (boost && !was_boosted) vreg_set_voltage(VREG_VOLTAGE_DEFAULT);
+        op->result = SWITCH_FAILED;
+        return;
+    }
+    if (was_boosted && !boost) vreg_set_voltage(VREG_VOLTAGE_DEFAULT);
+
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+#if defined(configTICK_CORE)
+    // O tick do FreeRTOS conta ciclos do clk_sys neste núcleo
+    systick_hw->rvr = sys_hz / configTICK_RATE_HZ - 1;
+    systick_hw->cvr = 0;
+#endif
+    for (uint i = 0; i < n_listeners; ++i) {
+        listeners[i](CLOCK_PHASE_RETIME, sys_hz);
+    }
+    op->result = SWITCH_OK;
+}
+
+bool clock_mgr_set_mode(clock_mode_t mode) {
+    if (mode >= CLOCK_NUM_MODES) return false;
+    if (mode == current) return true;
+#if defined(configTICK_CORE)
+    if (get_core_num() != configTICK_CORE) {
+        stats.failed++;
+        return false;
+    }
+#endif
+
+    switch_op_t op = { mode_khz[current], mode_khz[mode], SWITCH_FAILED };
+    uint32_t start = time_us_32();
+    bool locked = flash_safe_execute(switch_op, &op, CLOCK_SWITCH_TIMEOUT_MS) == PICO_OK;
+    uint32_t elapsed = time_us_32() - start;
+
+    if (!locked || op.result == SWITCH_FAILED) {
+        stats.failed++;
+        return false;
+    }
+    if (op.result == SWITCH_DEFERRED) {
+        stats.deferred++;
+        return false;
+    }
+    current = mode;
+    stats.switches++;
+    stats.entered[mode]++;
+    if (elapsed > stats.max_us) stats.max_us = elapsed;
+    return true;
+}
+
+clock_mode_t clock_mgr_mode(void) {
+    return current;
+}
+
+const char *clock_mgr_mode_name(clock_mode_t mode) {
+    return mode < CLOCK_NUM_MODES ? mode_names[mode] : "?";
+}
+
+void clock_mgr_get_stats(clock_stats_t *out) {
+    *out = stats;
+}
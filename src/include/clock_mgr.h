@@ -0,0 +1,58 @@
+#ifndef CLOCK_MGR_H
+#define CLOCK_MGR_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Escala dinâmica do clk_sys entre CLOCK_IDLE_KHZ, CLOCK_NORMAL_KHZ e
+// CLOCK_BURST_KHZ. A troca roda via flash_safe_execute(): o outro núcleo fica
+// travado e as IRQs desligadas do PREPARE ao RETIME, então nenhum periférico
+// é usado com o divisor antigo no clock novo.
+//
+// Cada módulo cujo tempo deriva do clk_sys registra um ouvinte:
+//   CLOCK_PHASE_PREPARE  antes da troca; false adia a troca (ex.: I2C ou
+//                        quadro da matriz em curso, interrompidos no meio)
+//   CLOCK_PHASE_RETIME   depois da troca, com sys_hz novo: recalcula
+//                        divisores, baud e constantes de tempo
+// Os ouvintes não podem bloquear nem usar o FreeRTOS.
+
+typedef enum {
+    CLOCK_MODE_IDLE,
+    CLOCK_MODE_NORMAL,
+    CLOCK_MODE_BURST,
+    CLOCK_NUM_MODES
+} clock_mode_t;
+
+typedef enum {
+    CLOCK_PHASE_PREPARE,
+    CLOCK_PHASE_RETIME,
+} clock_phase_t;
+
+typedef bool (*clock_listener_t)(clock_phase_t phase, uint32_t sys_hz);
+
+/**
+ * @struct clock_stats_t
+ * @brief Contadores das trocas de clock.
+ */
+typedef struct {
+    uint32_t switches;              // Trocas concluídas
+    uint32_t deferred;              // Trocas adiadas por um ouvinte no PREPARE
+    uint32_t failed;                // PLL sem solução, trava do outro núcleo ou núcleo errado
+    uint32_t max_us;                // Maior tempo com o outro núcleo travado
+    uint32_t entered[CLOCK_NUM_MODES]; // Entradas em cada modo
+} clock_stats_t;
+
+// Registra um ouvinte (idempotente). false = tabela cheia (CLOCK_MAX_LISTENERS)
+bool clock_mgr_register(clock_listener_t fn);
+
+// Troca o clk_sys para o modo pedido. Chamar de uma tarefa no núcleo do tick
+// (configTICK_CORE): o SysTick é reprogramado no próprio núcleo.
+// false = adiada ou falhou (o modo atual continua valendo)
+bool clock_mgr_set_mode(clock_mode_t mode);
+
+clock_mode_t clock_mgr_mode(void);
+const char *clock_mgr_mode_name(clock_mode_t mode);
+void clock_mgr_get_stats(clock_stats_t *stats);
+
+#endif // CLOCK_MGR_H
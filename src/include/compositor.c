@@ -0,0 +1,163 @@
+#include "compositor.h"
+#include "config.h"
+#include "mem_budget.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+#define FRAME_US ((uint32_t)COMPOSITOR_FRAME_MS * 1000u)
+#define BIT(out) (1u << (out))
+
+_Static_assert(COMPOSITOR_DIV_DISPLAY >= 1 && COMPOSITOR_DIV_LED >= 1 && COMPOSITOR_DIV_MATRIX >= 1,
+               "divisores do compositor devem ser positivos");
+_Static_assert(MATRIX_DELAY_MS % COMPOSITOR_FRAME_MS == 0, "a animacao da matriz deve cair na grade de quadros");
+
+static const uint8_t divisor[COMPOSITOR_NUM_OUTPUTS] = {
+    COMPOSITOR_DIV_DISPLAY, COMPOSITOR_DIV_LED, COMPOSITOR_DIV_MATRIX,
+};
+static const char *const output_names[COMPOSITOR_NUM_OUTPUTS] = { "display", "led", "matriz" };
+
+static bool running;                // Há uma grade ancorada (um quadro agendado ou em curso)
+static uint32_t anchor_us;          // Posição na grade do último quadro iniciado
+static uint32_t anchor_frame;       // Índice desse quadro
+static uint32_t next_us;            // Posição agendada por compositor_schedule
+static uint32_t next_frame;
+static uint32_t begin_us;           // Início real do quadro corrente
+
+static uint32_t requested;                                  // Saídas pedidas para o próximo quadro
+static uint32_t animating;                                  // Saídas com redesenho periódico
+static uint32_t timed;                                      // Saídas com compositor_request_at pendente
+static uint32_t timed_us[COMPOSITOR_NUM_OUTPUTS];
+static uint32_t anim_frame[COMPOSITOR_NUM_OUTPUTS];         // Próximo quadro do redesenho periódico
+
+static compositor_stats_t stats;
+
+MEM_BUDGET_ENTRY(compositor, "Compositor",
+                 sizeof(running) + sizeof(anchor_us) + sizeof(anchor_frame) + sizeof(next_us) + sizeof(next_frame) +
+                     sizeof(begin_us) + sizeof(requested) + sizeof(animating) + sizeof(timed) + sizeof(timed_us) +
+                     sizeof(anim_frame) + sizeof(stats),
+                 MEM_BUDGET_COMPOSITOR_BYTES);
+
+void compositor_request(compositor_output_t out) {
+    requested |= BIT(out);
+}
+
+void compositor_request_at(compositor_output_t out, uint32_t at_us) {
+    timed |= BIT(out);
+    timed_us[out] = at_us;
+}
+
+void compositor_set_animating(compositor_output_t out, bool on) {
+    if (on && !(animating & BIT(out))) {
+        anim_frame[out] = anchor_frame + 1;  // Primeiro redesenho no próximo quadro
+    }
+    animating = on ? animating | BIT(out) : animating & ~BIT(out);
+}
+
+// Posições da grade de from_us até a primeira em ou depois de to_us
+static uint32_t slots_until(uint32_t from_us, uint32_t to_us) {
+    int32_t d = (int32_t)(to_us - from_us);
+    return d <= 0 ? 0 : ((uint32_t)d + FRAME_US - 1) / FRAME_US;
+}
+
+/**
+ * @brief Escolhe a primeira posição da grade com saída vencida: a seguinte
+ *        para um pedido, a do divisor para uma animação, a do prazo para um
+ *        pedido com hora. Posições que já passaram contam como perdidas.
+ */
+bool compositor_schedule(uint32_t now_us, uint32_t *delay_ms) {
+    if (!(requested | animating | timed)) {
+        running = false;
+        return false;
+    }
+    if (!running) {
+        *delay_ms = 0;  // compositor_frame_begin ancora a grade nesse quadro
+        return true;
+    }
+
+    uint32_t now_slot = slots_until(anchor_us, now_us);
+    uint32_t slot = UINT32_MAX;
+    if (now_slot == 0) now_slot = 1;
+    if (requested) slot = 1;
+    for (uint out = 0; out < COMPOSITOR_NUM_OUTPUTS; ++out) {
+        uint32_t s = UINT32_MAX;
+        if (animating & BIT(out)) {
+            int32_t d = (int32_t)(anim_frame[out] - anchor_frame);
+            s = d < 1 ? 1 : (uint32_t)d;
+        }
+        if (timed & BIT(out)) {
+            uint32_t t = slots_until(anchor_us, timed_us[out]);
+            if (t < s) s = t ? t : 1;
+        }
+        if (s < slot) slot = s;
+    }
+    if (slot < now_slot) {
+        stats.late += now_slot - slot;
+        slot = now_slot;
+    }
+
+    next_frame = anchor_frame + slot;
+    next_us = anchor_us + slot * FRAME_US;
+    *delay_ms = ((next_us - now_us) + 999) / 1000;
+    return true;
+}
+
+uint32_t compositor_frame_begin(uint32_t now_us) {
+    if (running) {
+        int32_t jitter = (int32_t)(now_us - next_us);
+        if (jitter < 0) jitter = 0;
+        stats.jitter_sum_us += (uint32_t)jitter;
+        stats.jitter_n++;
+        if ((uint32_t)jitter > stats.jitter_max_us) stats.jitter_max_us = (uint32_t)jitter;
+        anchor_us = next_us;
+        anchor_frame = next_frame;
+    } else {
+        // Relógio parado: a grade recomeça neste quadro
+        running = true;
+        anchor_us = now_us;
+        anchor_frame++;
+    }
+    begin_us = now_us;
+    stats.frames++;
+
+    uint32_t due = requested;
+    requested = 0;
+    for (uint out = 0; out < COMPOSITOR_NUM_OUTPUTS; ++out) {
+        if ((timed & BIT(out)) && (int32_t)(now_us - timed_us[out]) >= 0) {
+            timed &= ~BIT(out);
+            due |= BIT(out);
+        }
+        if ((animating & BIT(out)) && (int32_t)(anchor_frame - anim_frame[out]) >= 0) {
+            anim_frame[out] = anchor_frame + divisor[out];
+            due |= BIT(out);
+        }
+    }
+    return due;
+}
+
+void compositor_output_done(compositor_output_t out, uint32_t us) {
+    stats.renders[out]++;
+    if (us > stats.render_max_us[out]) stats.render_max_us[out] = us;
+}
+
+void compositor_frame_end(uint32_t now_us) {
+    uint32_t took = now_us - begin_us;
+    if (took > stats.max_frame_us) stats.max_frame_us = took;
+    if (took > COMPOSITOR_FRAME_BUDGET_US) stats.over_budget++;
+}
+
+void compositor_get_stats(compositor_stats_t *out) {
+    *out = stats;
+}
+
+void compositor_print(void) {
+    compositor_stats_t s = stats;
+
+    printf("Quadros: %" PRIu32 " de %u ms, %" PRIu32 " acima de %u us (pior %" PRIu32 " us), "
+           "%" PRIu32 " posicoes perdidas; atraso sobre a grade medio %" PRIu32 " us, pior %" PRIu32 " us\n",
+           s.frames, COMPOSITOR_FRAME_MS, s.over_budget, COMPOSITOR_FRAME_BUDGET_US, s.max_frame_us, s.late,
+           s.jitter_n ? s.jitter_sum_us / s.jitter_n : 0, s.jitter_max_us);
+    for (uint out = 0; out < COMPOSITOR_NUM_OUTPUTS; ++out) {
+        printf("  %-8s 1/%u  %" PRIu32 " desenhos, pior %" PRIu32 " us\n", output_names[out], divisor[out],
+               s.renders[out], s.render_max_us[out]);
+    }
+}
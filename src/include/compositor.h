@@ -0,0 +1,67 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Relógio de quadros das saídas do painel (display OLED, LED RGB e matriz).
+// O objeto de saídas (main.c) lê um único instantâneo da ocupação por quadro e
+// desenha as saídas que vencem nele. Os quadros ficam numa grade fixa de
+// COMPOSITOR_FRAME_MS ancorada no primeiro, como vTaskDelayUntil: o atraso de
+// um quadro não desloca os seguintes. Uma saída pedida vence no próximo
+// quadro; uma saída animada é redesenhada a cada COMPOSITOR_DIV_* quadros. Os
+// quadros sem saída vencida são pulados, e sem nada pendente o relógio para.
+
+typedef enum {
+    COMPOSITOR_OUT_DISPLAY,
+    COMPOSITOR_OUT_LED,
+    COMPOSITOR_OUT_MATRIX,
+    COMPOSITOR_NUM_OUTPUTS
+} compositor_output_t;
+
+/**
+ * @struct compositor_stats_t
+ * @brief Contadores do relógio de quadros (só o objeto de saídas escreve).
+ */
+typedef struct {
+    uint32_t frames;                                // Quadros executados
+    uint32_t late;                                  // Posições da grade perdidas por um quadro anterior longo
+    uint32_t over_budget;                           // Quadros acima de COMPOSITOR_FRAME_BUDGET_US
+    uint32_t max_frame_us;                          // Quadro mais longo
+    uint32_t jitter_max_us;                         // Maior atraso do início de um quadro sobre a grade
+    uint32_t jitter_sum_us;                         // Média = jitter_sum_us / jitter_n
+    uint32_t jitter_n;
+    uint32_t renders[COMPOSITOR_NUM_OUTPUTS];       // Desenhos por saída
+    uint32_t render_max_us[COMPOSITOR_NUM_OUTPUTS]; // Desenho mais longo por saída
+} compositor_stats_t;
+
+// Saída desenhada no próximo quadro
+void compositor_request(compositor_output_t out);
+
+// Saída desenhada no primeiro quadro em ou depois de at_us (time_us_32)
+void compositor_request_at(compositor_output_t out, uint32_t at_us);
+
+// Liga ou desliga o redesenho periódico da saída (a cada COMPOSITOR_DIV_* quadros)
+void compositor_set_animating(compositor_output_t out, bool animating);
+
+// Prazo do próximo quadro na grade, em ms a partir de now_us (0 = o relógio
+// estava parado e recomeça já). false = nada pendente: o relógio para
+bool compositor_schedule(uint32_t now_us, uint32_t *delay_ms);
+
+// Início do quadro: mede o atraso sobre a grade e devolve as saídas que vencem
+// nele (bit 1 << compositor_output_t)
+uint32_t compositor_frame_begin(uint32_t now_us);
+
+// Tempo de desenho de uma saída no quadro corrente
+void compositor_output_done(compositor_output_t out, uint32_t us);
+
+// Fim do quadro: contabiliza a duração contra o orçamento
+void compositor_frame_end(uint32_t now_us);
+
+void compositor_get_stats(compositor_stats_t *stats);
+
+// Imprime quadros, orçamento, atraso sobre a grade e desenhos por saída
+void compositor_print(void);
+
+#endif // COMPOSITOR_H
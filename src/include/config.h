@@ -19,6 +19,11 @@
 // --- Constantes do Sistema ---
 #define MAX_USERS 16 // Capacidade máxima do espaço (ex: 5 para facilitar teste)
 
+// Faixas de ocupação (occupancy_band.c), em % da capacidade
+#define OCCUPANCY_BAND_ALMOST_FULL_PCT 80   // Quase cheio a partir daqui
+#define OCCUPANCY_BAND_FULL_PCT        100  // Lotado a partir daqui
+#define OCCUPANCY_BAND_HYSTERESIS_PCT  5    // Descer de faixa exige ficar essa fração abaixo do limiar
+
 // --- Definições de Pinos ---
 #define BUTTON_A_PIN     5  // Entrada de usuário
 #define BUTTON_B_PIN     6  // Saída de usuário
@@ -28,6 +33,14 @@
 #define LED_RED_PIN     13
 #define LED_GREEN_PIN     11
 #define LED_BLUE_PIN     12
+#define RGB_PWM_HZ       1000   // PWM dos três canais (sem cintilação visível)
+#define RGB_PWM_WRAP     4095   // 12 bits: degraus finos no escuro com a gama 2
+#define RGB_TIMER_SLICE  7      // Slice só de temporizador dos passos (GPIO 14/15 ficam no I2C)
+#define RGB_TIMER_DIV    64     // Divisor inteiro do temporizador (wrap cabe em 16 bits até 200 MHz)
+#define RGB_STEP_HZ      100    // Passos por segundo de uma animação
+#define RGB_FADE_MS      400    // Transição entre cores de ocupação
+#define RGB_BLINK_MS     150    // Meio período do pisca ao lotar
+#define RGB_FULL_BLINKS  3
 
 // Matriz de LEDs
 #define MATRIX_WS2812_PIN 7
@@ -35,18 +48,76 @@
 #define MATRIX_DIM     5
 #define MATRIX_PIO_INSTANCE pio0
 #define MATRIX_PIO_SM   0
+#define MATRIX_LED_US   30     // 24 bits a 800 kHz por LED (led_matrix.pio; tools/pio_sim.py)
+#define MATRIX_FIFO_WORDS 8    // FIFO TX juntada com a RX
+#define MATRIX_RESET_US 300    // Linha baixa que trava o quadro (WS2812B atual: > 280 us)
 
 // Buzzer
 #define BUZZER_PIN_MAIN  10
 
+// Leitores de crachá Wiegand (PIO dedicado, uma máquina de estados por leitor)
+// Cada entrada é o pino D0 de um leitor; D1 deve ser o pino seguinte (D0 + 1).
+#define WIEGAND_PIO_INSTANCE    pio1
+#define WIEGAND_READER_D0_PINS  { 8 }   // Até 4 leitores, ex: { 8, 16, 18, 20 }
+#define WIEGAND_BADGE_QUEUE_LEN 8
+
+// Sensores de feixe (contador direcional): { A (lado de fora), B (lado de dentro) } por porta
+#define BEAM_DOOR_PINS       { {16, 17} }  // Até 4 portas, ex: { {16, 17}, {18, 19}, {20, 21}, {26, 27} }
+#define BEAM_BLOCKED_LEVEL   0             // Nível lido no pino com o feixe interrompido
+#define BEAM_TRACE_LEN       128           // Bordas guardadas para dump (potência de 2)
+#define BEAM_QUEUE_LEN       4             // Pessoas ao mesmo tempo no vão de uma porta
+
 // Display OLED
 #define I2C_PORT        i2c1
 #define I2C_SDA_PIN     14
 #define I2C_SCL_PIN     15
 #define DISPLAY_ADDR    0x3C
+#define DISPLAY_I2C_HZ  400000   // Fast-mode: velocidade de reserva do link
+#define DISPLAY_I2C_FMP_HZ 1000000 // Fast-mode Plus, sondado no display_init (0 = só DISPLAY_I2C_HZ)
+#define DISPLAY_I2C_FMP_MAX_ERRORS 3  // Falhas seguidas em FM+ antes de ficar em DISPLAY_I2C_HZ
+#define DISPLAY_I2C_RETRIES        2  // Novas tentativas de um quadro, cada uma após recuperar o barramento
+#define DISPLAY_I2C_RECOVERY_HALF_US 5 // Meio período dos pulsos de SCL da recuperação (100 kHz)
 #define DISPLAY_WIDTH   128
 #define DISPLAY_HEIGHT  64
 
+// Diário de eventos na flash (região reservada no fim da flash)
+#define JOURNAL_NUM_SECTORS      16    // 16 setores de 4KB usados em anel
+#define JOURNAL_RAM_RING_LEN     64    // Registros aguardando gravação (potência de 2)
+#define JOURNAL_FLASH_TIMEOUT_MS 100   // Espera máxima pelo acesso exclusivo à flash
+#define JOURNAL_ERASE_IDLE_MS    5000  // Pré-apaga o próximo setor só após esse tempo sem eventos
+
+// Estatísticas de ocupação (janelas deslizantes e histograma de permanência)
+#define ANALYTICS_RAM_BUDGET_BYTES 4096  // Verificado em tempo de compilação
+
+// Política de admissão (regras compactas compiladas em tabela de decisão por policy.c)
+#define POLICY_MAX_GROUPS      4      // Grupos de acesso (0 = padrão)
+#define POLICY_MAX_FACILITIES  8      // Mapeamentos código de instalação -> grupo
+#define POLICY_SLOT_MINUTES    5      // Resolução das janelas de horário
+#define POLICY_CLOCK_START_MIN (8 * 60) // Hora do dia assumida no boot (sem RTC)
+#define POLICY_EVAL_BUDGET_US  20     // Orçamento de tempo por avaliação
+// { tipo, grupo/porta, a, b } - ver policy_rule_t
+#define POLICY_DEFAULT_RULES { \
+    { POLICY_RULE_LIMITS,  0, MAX_USERS - 2, MAX_USERS }, /* Aviso nas 2 últimas vagas */ \
+    { POLICY_RULE_GROUP,   1, 100, 0 },                   /* Instalação 100: equipe */ \
+    { POLICY_RULE_RESERVE, 1, 2, 0 },                     /* 2 vagas reservadas para a equipe */ \
+    { POLICY_RULE_GROUP,   2, 200, 0 },                   /* Instalação 200: visitantes */ \
+    { POLICY_RULE_HOURS,   2, 8 * 60, 18 * 60 },          /* Visitantes das 8h às 18h */ \
+}
+
+// --- Núcleos (SMP) ---
+// Máscaras de afinidade: o caminho de admissão fica sozinho em um núcleo
+#define CORE_AFFINITY_ACESSO    (1 << 0) // Entrada, saída, reset (e as ISRs dos sensores)
+#define CORE_AFFINITY_INTERFACE (1 << 1) // Display, buzzer, LED RGB, matriz e diário
+#define UI_EVENT_QUEUE_LEN      8        // Eventos por fila entre os núcleos (potência de 2)
+#define LATENCY_SAMPLES         256      // Amostras por canal para os percentis de latência
+#define LATENCY_HIST_BINS       24       // Histograma log2 de 1 us a 8 s
+
+// --- Boot ---
+#define FAST_BOOT_ENABLED    1     // 1 = não aguarda USB e mostra a tela inicial sem bloquear admissões
+#define USB_STDIO_WAIT_MS    1000  // Espera pelo terminal USB no boot normal
+#define DISPLAY_SPLASH_MS    2500  // Tempo da tela de inicialização
+#define WATCHDOG_TIMEOUT_MS  2000  // Alimentado pelo idle hook
+
 // --- Constantes de Tempo e Comportamento ---
 #define DEBOUNCE_TIME_US   200000 // 200ms para botões
 
@@ -57,31 +128,142 @@
 #define BUZZER_BEEP_RESET_ON_MS  150
 #define BUZZER_BEEP_RESET_OFF_MS  100
 
-// Delays das Tarefas (ms)
-#define BUTTON_POLL_DELAY_MS  50 // Se tarefas de botão fizerem polling
-#define RGB_UPDATE_DELAY_MS   200
-#define DISPLAY_UPDATE_DELAY_MS  500
-#define MATRIX_DELAY_MS 100
-#define RESET_TASK_CHECK_DELAY_MS 10 // Para loop de reset do semáforo
+// Temporizações dos Objetos Ativos (ms)
+#define DISPLAY_UPDATE_DELAY_MS  500  // Tempo de uma mensagem no display antes da tela padrão
+#define MATRIX_DELAY_MS 100           // Intervalo entre quadros da animação da matriz (múltiplo de COMPOSITOR_FRAME_MS)
+#define MATRIX_ANIMATION_MS 10000     // Duração da animação após uma mudança de ocupação
+#define MATRIX_STILL_STEP 25          // Passo de brilho máximo do pulso (quadro parado)
+#define JOURNAL_COMMIT_DELAY_MS 1000 // Lote de gravação do diário na flash após o primeiro evento
+
+// --- Compositor das saídas (compositor.c) ---
+// Display, LED RGB e matriz são desenhados pelo objeto de saídas em quadros de
+// uma grade fixa, a partir de um único instantâneo da ocupação: uma mudança de
+// faixa chega às três saídas no mesmo quadro.
+#define COMPOSITOR_FRAME_MS         20      // Período da grade de quadros
+#define COMPOSITOR_FRAME_BUDGET_US  12000   // Orçamento de um quadro (um framebuffer em FM+ leva ~10 ms)
+#define COMPOSITOR_DIV_DISPLAY      1       // Redesenho periódico a cada N quadros (saídas animadas)
+#define COMPOSITOR_DIV_LED          1
+#define COMPOSITOR_DIV_MATRIX       (MATRIX_DELAY_MS / COMPOSITOR_FRAME_MS)
+
+// --- Escala dinâmica do clk_sys (clock_mgr.c) ---
+// O governador (objeto Relogio, no núcleo do tick) escolhe o modo pelo movimento
+// de acesso. Cada troca roda com o outro núcleo travado e as IRQs desligadas; os
+// periféricos que dependem do clk_sys (PIO, PWM, I2C, SysTick) são recalculados
+// antes de liberar. Com uma transferência em curso a troca é adiada.
+#define CLOCK_SCALING_ENABLED      1
+#define CLOCK_IDLE_KHZ             48000   // Sem movimento (VCO 1440 MHz / 6 / 5)
+#define CLOCK_NORMAL_KHZ           125000  // Frequência de boot do SDK
+#define CLOCK_BURST_KHZ            200000  // Pico de movimento (flash a 100 MHz com o divisor 2 do boot2)
+#define CLOCK_VREG_BOOST_ABOVE_KHZ 133000  // Acima disso, o núcleo vai para CLOCK_BURST_VREG
+#define CLOCK_BURST_VREG           VREG_VOLTAGE_1_15
+#define CLOCK_VREG_SETTLE_US       1000    // Estabilização do regulador antes de subir o clock
+#define CLOCK_MAX_LISTENERS        8       // Periféricos recalculados a cada troca
+#define CLOCK_SWITCH_TIMEOUT_MS    10      // Espera pelo travamento do outro núcleo
+#define CLOCK_WINDOW_MS            10000   // Janela de contagem de movimento do governador
+#define CLOCK_BURST_EVENTS         8       // Acionamentos na janela que levam ao pico
+#define CLOCK_IDLE_AFTER_MS        60000   // Sem movimento por esse tempo: modo ocioso
+#define CLOCK_RETRY_MS             20      // Troca adiada por transferência em curso: nova tentativa
+
+// --- Baixo consumo (low_power.c) ---
+// Tickless idle no núcleo do tick: sem tarefa pronta, WFI até o próximo prazo
+// ou IRQ. No modo ocioso do clock a matriz apaga e o OLED escurece; o primeiro
+// acionamento devolve os dois e o clock normal.
+#define LOW_POWER_MAX_SLEEP_MS     500     // Teto de um sono: o idle hook alimenta o watchdog ao acordar
+#define LOW_POWER_IDLE_CONTRAST    0x08    // Contraste do OLED no modo ocioso (normal 0xFF)
+#define LOW_POWER_BASE_UA          4000    // Estimativa: regulador, XOSC, PLLs, USB e periféricos
+#define LOW_POWER_RUN_UA_PER_MHZ   90      // Estimativa por núcleo executando, por MHz do clk_sys
+#define LOW_POWER_WFI_UA_PER_MHZ   25      // Estimativa do núcleo do tick em WFI (clocks ligados)
+
+// --- Configuração dos Objetos Ativos e Workers FreeRTOS ---
+#define AO_MAX_PER_WORKER  8   // Objetos ativos por worker
+#define AO_QUEUE_LEN       8   // Eventos (4 bytes) por fila de objeto ativo
 
-// --- Configuração de Tarefas FreeRTOS ---
 // Prioridades
-#define PRIORITY_RESET_SYSTEM     (tskIDLE_PRIORITY + 4) // Alta para responder ao reset
-#define PRIORITY_ENTRADA_USUARIO  (tskIDLE_PRIORITY + 3)
-#define PRIORITY_SAIDA_USUARIO    (tskIDLE_PRIORITY + 3)
-#define PRIORITY_FEEDBACK_RGB     (tskIDLE_PRIORITY + 1)
-#define PRIORITY_MATRIX      (tskIDLE_PRIORITY + 1)
-#define PRIORITY_DISPLAY_INFO     (tskIDLE_PRIORITY + 0) // Mais baixa
+#define PRIORITY_AO_ACESSO        (tskIDLE_PRIORITY + 3) // Entrada, saída e reset
+#define PRIORITY_AO_INTERFACE     (tskIDLE_PRIORITY + 2) // Display, buzzer, LED RGB, matriz e diário
+
+// Tamanho das Stacks, em palavras. Alocadas estaticamente; para redimensionar,
+// compile com STACK_MEASURE_ENABLED, rode uma carga de estresse e use os valores
+// sugeridos impressos no reset.
+#define STACK_MEASURE_ENABLED     0     // 1 = stacks de STACK_MEASURE_WORDS e tamanho sugerido no reset
+#define STACK_MEASURE_WORDS       2048
+#define STACK_MEASURE_MARGIN_PCT  25    // Folga sobre o uso máximo medido
+#if defined(PANEL_HOST)
+#define STACK_SIZE_AO_ACESSO      configMINIMAL_STACK_SIZE  // Build nativa: pilha da thread POSIX
+#define STACK_SIZE_AO_INTERFACE   configMINIMAL_STACK_SIZE
+#elif STACK_MEASURE_ENABLED
+#define STACK_SIZE_AO_ACESSO      STACK_MEASURE_WORDS
+#define STACK_SIZE_AO_INTERFACE   STACK_MEASURE_WORDS
+#else
+#define STACK_SIZE_AO_ACESSO      512   // Entrada, saída e reset
+#define STACK_SIZE_AO_INTERFACE   1024  // Formatação do display e printf
+#endif
+#define STACK_SIZE_KERNEL_IDLE    configMINIMAL_STACK_SIZE  // Idle do núcleo 0 (alimenta o watchdog)
+#define STACK_SIZE_KERNEL_TIMER   configTIMER_TASK_STACK_DEPTH
+
+// --- Orçamento de RAM Estática (bytes) ---
+// Tudo é alocado estaticamente; cada módulo verifica seu uso em tempo de
+// compilação (MEM_BUDGET_ENTRY) e mem_budget_print() mostra a tabela no boot.
+#define MEM_BUDGET_KERNEL_BYTES     5120   // Idle e timer do kernel + heap dos queue sets
+#define MEM_BUDGET_AO_BYTES         ((STACK_SIZE_AO_ACESSO + STACK_SIZE_AO_INTERFACE) * 4 + 3584) // Stacks + TCBs e filas
+#define MEM_BUDGET_DISPLAY_BYTES    1280   // Framebuffer do SSD1306
+#define MEM_BUDGET_JOURNAL_BYTES    1280
+#define MEM_BUDGET_BEAM_BYTES       2560   // Trace de bordas
+#define MEM_BUDGET_LATENCY_BYTES    4096   // Amostras por canal + cópia ordenada + histogramas
+#define MEM_BUDGET_POLICY_BYTES     2048
+#define MEM_BUDGET_UI_EVENTS_BYTES  1536
+#define MEM_BUDGET_WIEGAND_BYTES    512
+#define MEM_BUDGET_MATRIX_BYTES     128
+#define MEM_BUDGET_PROFILER_BYTES   1024
+#define MEM_BUDGET_TRACE_BYTES      5120   // Anéis de trace dos dois núcleos + tabela de tarefas
+#define MEM_BUDGET_TLOG_BYTES       2048   // Anéis do log tokenizado
+#define MEM_BUDGET_USB_PROTO_BYTES  2560   // Quadro recebido, regras, resposta e quadros codificados
+#define MEM_BUDGET_MIRROR_BYTES     1280   // Referência do display e da matriz
+#define MEM_BUDGET_COMPOSITOR_BYTES 128    // Grade de quadros, prazos por saída e contadores
+#define MEM_BUDGET_RGB_LED_BYTES    64     // Animação em curso do LED RGB
+#define MEM_BUDGET_LOW_POWER_BYTES  128    // Contadores de sono e a consulta anterior
+#define MEM_BUDGET_CLOCK_BYTES      128    // Ouvintes das trocas de clock
+
+// --- Perfil de Execução ---
+#define PROFILER_MAX_TASKS  8   // Tarefas acompanhadas (workers, idle dos dois núcleos e timers)
+#define TRACE_ENABLED       1   // Trace de eventos em RAM (custo de algumas dezenas de ciclos por evento)
+#define TRACE_RING_LEN      256 // Registros de 8 bytes por núcleo (potência de 2)
+
+// --- Log Tokenizado (mensagens em log_messages.def) ---
+#define TLOG_RING_LEN       32  // Mensagens pendentes por núcleo (potência de 2)
+#define TLOG_MAX_ARGS       4   // Argumentos inteiros por mensagem
+#define TLOG_OUTPUT_BINARY  0   // 1 = envia registros crus (tools/tlog_decode.py), 0 = formata no painel
+
+// --- Protocolo USB (quadros COBS + CRC; cliente em tools/panel_client.py) ---
+#define USB_PROTO_MAX_PAYLOAD 512 // Bytes de um pedido ou de uma resposta (limita o lote por quadro)
+
+// Espelho do display e da matriz (ligado pelo cliente; tools/panel_mirror.py)
+#define MIRROR_INTERVAL_MS      100    // Agrupa as mudanças: no máximo uma varredura por intervalo
+#define MIRROR_MAX_BYTES_PER_S  16384  // Limite de banda do espelho no USB
+#define MIRROR_BURST_BYTES      2048   // Crédito máximo acumulado (um quadro completo cabe)
+
 
-// Tamanho das Stacks (configMINIMAL_STACK_SIZE é definido em FreeRTOSConfig.h)
-#define STACK_MULTIPLIER_DEFAULT  2
-#define STACK_MULTIPLIER_DISPLAY  4
-#define STACK_SIZE_DEFAULT        (configMINIMAL_STACK_SIZE * STACK_MULTIPLIER_DEFAULT)
-#define STACK_SIZE_DISPLAY        (configMINIMAL_STACK_SIZE * STACK_MULTIPLIER_DISPLAY)
+// --- Microbenchmarks dos kernels de desenho (kbench_main.c; tools/kbench_compare.py) ---
+// Cada medida cronometra KBENCH_BATCH chamadas seguidas e fica com a menor de
+// KBENCH_REPEATS rodadas. No RP2040 o SysTick conta ciclos em 24 bits: o lote
+// inteiro precisa caber em 2^24 ciclos (~134 ms a 125 MHz).
+#if defined(PANEL_HOST)
+#define KBENCH_BATCH            2000
+#define KBENCH_REPEATS          25
+#define KBENCH_STACK_PROBE_WORDS 4096  // O sprintf da glibc usa mais pilha que o da newlib
+#else
+#define KBENCH_BATCH            8
+#define KBENCH_REPEATS          16
+#define KBENCH_STACK_PROBE_WORDS 512   // Região pintada abaixo da pilha para medir o uso de cada kernel
+#endif
 
+// --- Quadros de referência e orçamento de barramento (host/frames.c; tools/frames_golden/) ---
+// Limites por atualização; uma mudança que os ultrapasse falha no panel_frames.
+#define DISPLAY_BUS_MAX_TRANSACTIONS 7     // Endereçamento (6 comandos) + o framebuffer
+#define DISPLAY_BUS_MAX_BYTES        1037  // 6 x 2 + SSD1306_BUFSIZE
+#define MATRIX_BUS_MAX_WORDS         MATRIX_SIZE // Palavras na FIFO do PIO
 
-// --- Handles para Semáforos e Mutex (Declarações Externas) ---
+// --- Handles para Semáforos (Declarações Externas) ---
 extern SemaphoreHandle_t xCountingSemaphoreUsers;
-extern SemaphoreHandle_t xMutexDisplay;
 
 #endif // HARDWARE_CONFIG_H
\ No newline at end of file
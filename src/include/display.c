@@ -1,38 +1,192 @@
 #include "display.h"
 #include "config.h"
+#include "clock_mgr.h"
+#include "mem_budget.h"
+#include "trace.h"
 #include <string.h>
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include <inttypes.h>
+
+MEM_BUDGET_ENTRY(display, "Display", SSD1306_BUFSIZE, MEM_BUDGET_DISPLAY_BYTES);
+
+static volatile bool sending;   // Framebuffer em curso no I2C (adia trocas do clk_sys)
+static bool i2c_ready;          // I2C inicializado (no boot rápido, pela tarefa do display)
+
+// --- Link I2C: Fast-mode Plus com queda para Fast-mode e recuperação do barramento ---
+
+static const uint32_t speed_hz[DISPLAY_NUM_SPEEDS] = {
+    [DISPLAY_SPEED_FMP] = DISPLAY_I2C_FMP_HZ,
+    [DISPLAY_SPEED_FM]  = DISPLAY_I2C_HZ,
+};
+static display_speed_t speed = DISPLAY_SPEED_FM;
+static uint8_t fmp_errors;      // Falhas seguidas em FM+
+static display_link_stats_t link;
+static uint8_t contrast = 0xFF; // Reaplicado depois de reconfigurar o SSD1306
+
+/**
+  * @brief Aplica uma velocidade ao I2C e o prazo por byte correspondente
+  *        (2x o tempo de 9 bits).
+  */
+static void link_set_speed(ssd1306_t *ssd, display_speed_t s) {
+    speed = s;
+    i2c_set_baudrate(I2C_PORT, speed_hz[s]);
+    ssd->char_timeout_us = 2 * 9 * 1000000u / speed_hz[s] + 1;
+}
+
+/**
+  * @brief Libera o barramento (I2C-bus, seção 3.1.16): com o bloco I2C
+  *        desligado, pulsa SCL até 9 vezes até o escravo soltar SDA, gera um
+  *        STOP e reinicia o I2C na velocidade atual. Leva no máximo 23
+  *        meios períodos de DISPLAY_I2C_RECOVERY_HALF_US.
+  * @return false se SDA ou SCL continuaram presos em nível baixo.
+  */
+static bool link_release_bus(void) {
+    if (i2c_ready) i2c_deinit(I2C_PORT);
+    // Dreno aberto emulado: saída em 0 puxa a linha, entrada a solta para o pull-up
+    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_SIO);
+    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_SIO);
+    gpio_put(I2C_SDA_PIN, 0);
+    gpio_put(I2C_SCL_PIN, 0);
+    gpio_set_dir(I2C_SDA_PIN, GPIO_IN);
+    gpio_set_dir(I2C_SCL_PIN, GPIO_IN);
+    busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+
+    for (uint i = 0; i < 9 && !gpio_get(I2C_SDA_PIN); ++i) {
+        gpio_set_dir(I2C_SCL_PIN, GPIO_OUT);
+        busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+        gpio_set_dir(I2C_SCL_PIN, GPIO_IN);
+        busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+    }
+    // STOP: SDA sobe com SCL alto
+    gpio_set_dir(I2C_SCL_PIN, GPIO_OUT);
+    busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+    gpio_set_dir(I2C_SDA_PIN, GPIO_OUT);
+    busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+    gpio_set_dir(I2C_SCL_PIN, GPIO_IN);
+    busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+    gpio_set_dir(I2C_SDA_PIN, GPIO_IN);
+    busy_wait_us(DISPLAY_I2C_RECOVERY_HALF_US);
+    bool released = gpio_get(I2C_SDA_PIN) && gpio_get(I2C_SCL_PIN);
+
+    i2c_init(I2C_PORT, speed_hz[speed]);
+    i2c_ready = true;
+    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
+    return released;
+}
+
+/**
+  * @brief Recupera o link depois de uma escrita com NAK ou prazo esgotado e
+  *        reconfigura o SSD1306, que pode ter reiniciado junto.
+  */
+static void link_recover(ssd1306_t *ssd) {
+    link.recoveries++;
+    if (!link_release_bus()) link.stuck++;
+    if (ssd1306_config(ssd) && contrast != 0xFF) {
+        ssd1306_command(ssd, SET_CONTRAST);
+        ssd1306_command(ssd, contrast);
+    }
+}
+
+/**
+  * @brief Conta uma falha na velocidade atual. DISPLAY_I2C_FMP_MAX_ERRORS
+  *        falhas seguidas em FM+ deixam o link em DISPLAY_I2C_HZ até o
+  *        próximo boot.
+  */
+static void link_error(ssd1306_t *ssd) {
+    link.errors[speed]++;
+    if (speed == DISPLAY_SPEED_FMP && ++fmp_errors >= DISPLAY_I2C_FMP_MAX_ERRORS) {
+        link.fallbacks++;
+        link_set_speed(ssd, DISPLAY_SPEED_FM);
+    }
+}
+
+/**
+  * @brief Envia o framebuffer marcando a transferência em curso. Cada escrita
+  *        tem prazo; uma falha recupera o barramento e tenta de novo, até
+  *        DISPLAY_I2C_RETRIES vezes, então um quadro ruim não prende o objeto
+  *        de interface por mais que alguns quadros.
+  */
+static void display_send(ssd1306_t *ssd) {
+    sending = true;
+    for (uint attempt = 0; ; ++attempt) {
+        if (ssd1306_send_data(ssd)) {
+            link.frames[speed]++;
+            if (speed == DISPLAY_SPEED_FMP) fmp_errors = 0;
+            break;
+        }
+        link_error(ssd);
+        if (attempt == DISPLAY_I2C_RETRIES) {
+            link.dropped++;
+            break;
+        }
+        link_recover(ssd);
+    }
+    sending = false;
+}
+
+/**
+  * @brief Escurece o OLED (LOW_POWER_IDLE_CONTRAST) no modo ocioso ou volta ao
+  *        contraste normal, sem redesenhar. Uma falha recupera o link, que
+  *        reaplica o contraste escolhido.
+  */
+void display_set_dimmed(ssd1306_t *ssd, bool dimmed) {
+    if (!ssd || !ssd->ram_buffer) return; // Display ainda não inicializado (boot rápido)
+
+    contrast = dimmed ? LOW_POWER_IDLE_CONTRAST : 0xFF;
+    sending = true;
+    if (!ssd1306_command(ssd, SET_CONTRAST) || !ssd1306_command(ssd, contrast)) {
+        link_error(ssd);
+        link_recover(ssd);
+    }
+    sending = false;
+}
+
+void display_get_link_stats(display_link_stats_t *stats) {
+    *stats = link;
+}
+
+uint32_t display_link_hz(void) {
+    return i2c_ready ? speed_hz[speed] : 0;
+}
 
 
 /**
   * @brief Inicializa a comunicação I2C e o display OLED SSD1306.
-  *        Configura os pinos SDA e SCL, inicializa o periférico I2C e
-  *        envia os comandos de configuração para o display.
+  *        Libera o barramento (um reset no meio de uma transferência deixa o
+  *        SSD1306 segurando SDA), sonda Fast-mode Plus com a sequência de
+  *        configuração e, sem ACK de todos os comandos, recupera o barramento
+  *        e fica em DISPLAY_I2C_HZ.
   *
   * @param ssd Ponteiro para a estrutura de controle do display SSD1306 a ser inicializada.
   */
  void display_init(ssd1306_t *ssd) {
-     // Inicializa I2C na porta e velocidade definidas
-     i2c_init(I2C_PORT, 400 * 1000);
-     // Configura os pinos GPIO para a função I2C
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
      // Habilita resistores de pull-up internos para os pinos I2C
     gpio_pull_up(I2C_SDA_PIN);
     gpio_pull_up(I2C_SCL_PIN);
      // Inicializa a estrutura do driver SSD1306 com os parâmetros do display
     ssd1306_init(ssd, WIDTH, HEIGHT, false, DISPLAY_ADDR, I2C_PORT);
+     // Inicializa o I2C na velocidade sondada, com os pinos na função I2C
+    speed = DISPLAY_I2C_FMP_HZ ? DISPLAY_SPEED_FMP : DISPLAY_SPEED_FM;
+    if (!link_release_bus()) link.stuck++;
+    link_set_speed(ssd, speed);
      // Envia a sequência de comandos de configuração para o display
-    ssd1306_config(ssd);
+    if (!ssd1306_config(ssd) && speed == DISPLAY_SPEED_FMP) {
+        link.errors[DISPLAY_SPEED_FMP]++;
+        link.fallbacks++;
+        link_set_speed(ssd, DISPLAY_SPEED_FM);
+        link_recover(ssd);
+    }
     ssd1306_fill(ssd, false);
-    ssd1306_send_data(ssd);
-    printf("Display inicializado.\n");
+    display_send(ssd);
+    printf("Display inicializado (I2C a %" PRIu32 " kHz).\n", speed_hz[speed] / 1000);
 }
 
 /**
   * @brief Exibe uma tela de inicialização no display OLED.
-  *        Mostra um texto de título e o ícone do semáforo por alguns segundos.
+  *        Mostra um texto de título e retorna sem bloquear; a tela permanece
+  *        até a próxima atualização do display.
   *
   * @param ssd Ponteiro para a estrutura de controle do display SSD1306.
   */
@@ -54,15 +208,26 @@
     ssd1306_draw_string(ssd, line2, center_x_approx - (strlen(line2)*8)/2, start_y + line_height);
     ssd1306_draw_string(ssd, line3, center_x_approx - (strlen(line3)*8)/2, start_y + 2*line_height);
     ssd1306_draw_string(ssd, line4, center_x_approx - (strlen(line4)*8)/2, start_y + 3*line_height);
-    ssd1306_send_data(ssd);
-    sleep_ms(2500);
-    ssd1306_fill(ssd, false);
-    ssd1306_send_data(ssd);
+    display_send(ssd);
 }
 
-void display_update(ssd1306_t *ssd, uint8_t actual_num_users, uint8_t max_users, const char* frase) {
-    if (!ssd) return;
-
+/**
+  * @brief Desenha a tela de ocupação no framebuffer, sem enviar ao display.
+  *
+  * @param ssd Display cujo framebuffer é desenhado.
+  * @param actual_num_users Ocupação atual.
+  * @param max_users Capacidade.
+  * @param band Faixa da ocupação, que escolhe a mensagem padrão.
+  * @param frase Mensagem de status; NULL ou vazia para a mensagem padrão da faixa.
+  */
+void display_render(ssd1306_t *ssd, uint16_t actual_num_users, uint16_t max_users, occupancy_band_t band,
+                    const char* frase) {
+    static const char *const band_status[OCCUPANCY_NUM_BANDS] = {
+        [OCCUPANCY_BAND_EMPTY]       = "Livre",
+        [OCCUPANCY_BAND_FREE]        = "Entrada Ok",
+        [OCCUPANCY_BAND_ALMOST_FULL] = "Quase Lotado",
+        [OCCUPANCY_BAND_FULL]        = "Lotado!",
+    };
     char contagem_str[25];   
     char vagas_str[20];       
     char status_str[32];  
@@ -80,7 +245,7 @@ void display_update(ssd1306_t *ssd, uint8_t actual_num_users, uint8_t max_users,
     sprintf(contagem_str, "Ocupado: %u/%u", actual_num_users, max_users);
     ssd1306_draw_string(ssd, contagem_str, 5, 19); 
 
-    uint8_t vagas = max_users > actual_num_users ? max_users - actual_num_users : 0;
+    uint16_t vagas = max_users > actual_num_users ? max_users - actual_num_users : 0;
     sprintf(vagas_str, "Vagas:   %u", vagas);
     ssd1306_draw_string(ssd, vagas_str, 5, 28); 
 
@@ -90,22 +255,32 @@ void display_update(ssd1306_t *ssd, uint8_t actual_num_users, uint8_t max_users,
         strncpy(status_str, frase, sizeof(status_str) - 1);
         status_str[sizeof(status_str) - 1] = '\0';
     } else {
-        if (actual_num_users >= max_users) {
-            strcpy(status_str, "Lotado!");
-        } else if (vagas == 1 && actual_num_users == max_users - 1) {
-            strcpy(status_str, "Ultima Vaga!");
-        } else if (actual_num_users == 0) {
-            strcpy(status_str, "Livre");
-        } else {
-            strcpy(status_str, "Entrada Ok");
-        }
+        strcpy(status_str, band < OCCUPANCY_NUM_BANDS ? band_status[band] : "");
     }
     uint8_t msg_len = strlen(status_str);
     uint8_t msg_x = (DISPLAY_WIDTH / 2) - (msg_len * 8 / 2);
     if (msg_x < 2) msg_x = 2;
     ssd1306_draw_string(ssd, status_str, msg_x, 45);
+}
 
+void display_update(ssd1306_t *ssd, uint16_t actual_num_users, uint16_t max_users, occupancy_band_t band,
+                    const char* frase) {
+    if (!ssd || !ssd->ram_buffer) return; // Display ainda não inicializado (boot rápido)
 
+    display_render(ssd, actual_num_users, max_users, band, frase);
+    TRACE(TRACE_EVT_DISPLAY_FLUSH_BEGIN, 0);
+    display_send(ssd);
+    TRACE(TRACE_EVT_DISPLAY_FLUSH_END, 0);
+}
 
-    ssd1306_send_data(ssd);
-}
\ No newline at end of file
+/**
+  * @brief Ouvinte do clock_mgr: adia a troca com um quadro no I2C (o outro
+  *        núcleo para no meio da transferência) e reaplica a velocidade do
+  *        link, cujo divisor o SDK calcula a partir do clk_sys.
+  */
+bool display_clock_listener(clock_phase_t phase, uint32_t sys_hz) {
+    (void)sys_hz;
+    if (phase == CLOCK_PHASE_PREPARE) return !sending;
+    if (i2c_ready) i2c_set_baudrate(I2C_PORT, speed_hz[speed]);
+    return true;
+}
@@ -4,10 +4,46 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "config.h"
+#include "clock_mgr.h"
+#include "occupancy_band.h"
 #include "lib/ssd1306/ssd1306.h"
 
+/**
+ * @brief Velocidades do link I2C do display, da mais rápida para a de reserva.
+ */
+typedef enum {
+    DISPLAY_SPEED_FMP,   // Fast-mode Plus (DISPLAY_I2C_FMP_HZ)
+    DISPLAY_SPEED_FM,    // Fast-mode (DISPLAY_I2C_HZ)
+    DISPLAY_NUM_SPEEDS
+} display_speed_t;
+
+/**
+ * @struct display_link_stats_t
+ * @brief Contadores do link I2C do display.
+ */
+typedef struct {
+    uint32_t frames[DISPLAY_NUM_SPEEDS];  // Quadros enviados em cada velocidade
+    uint32_t errors[DISPLAY_NUM_SPEEDS];  // Escritas com NAK ou prazo esgotado
+    uint32_t recoveries;                  // Recuperações do barramento
+    uint32_t stuck;                       // Recuperações com SDA ou SCL ainda presos
+    uint32_t fallbacks;                   // Quedas de FM+ para Fast-mode
+    uint32_t dropped;                     // Quadros abandonados após DISPLAY_I2C_RETRIES
+} display_link_stats_t;
+
 void display_init(ssd1306_t *ssd); 
 void display_startup_screen(ssd1306_t *ssd);
-void display_update(ssd1306_t *ssd, uint8_t current_users, uint8_t max_users, const char* message);
+void display_update(ssd1306_t *ssd, uint16_t current_users, uint16_t max_users, occupancy_band_t band,
+                    const char* message);
+// Só o desenho de display_update, sem o envio por I2C (kbench.c)
+void display_render(ssd1306_t *ssd, uint16_t current_users, uint16_t max_users, occupancy_band_t band,
+                    const char* message);
+// Contraste reduzido no modo ocioso do clock (low_power.h)
+void display_set_dimmed(ssd1306_t *ssd, bool dimmed);
+// Link I2C: contadores e velocidade atual (0 antes do display_init)
+void display_get_link_stats(display_link_stats_t *stats);
+uint32_t display_link_hz(void);
+
+// Ouvinte do clock_mgr (registrado no main): baud do I2C
+bool display_clock_listener(clock_phase_t phase, uint32_t sys_hz);
 
 #endif // DISPLAY_H
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "event_journal.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include <stddef.h>
+#include <inttypes.h>
+
+// Região reservada no fim da flash, dividida em setores usados em anel
+#define JOURNAL_REGION_SIZE   (JOURNAL_NUM_SECTORS * FLASH_SECTOR_SIZE)
+#define JOURNAL_REGION_OFFSET (PICO_FLASH_SIZE_BYTES - JOURNAL_REGION_SIZE)
+#define SLOTS_PER_SECTOR      (FLASH_SECTOR_SIZE / sizeof(journal_record_t)) // Slot 0 = cabeçalho
+#define SLOTS_PER_PAGE        (FLASH_PAGE_SIZE / sizeof(journal_record_t))
+#define JOURNAL_MAGIC         0x4C4E524Au // "JRNL"
+
+/**
+ * @struct journal_header_t
+ * @brief Cabeçalho no slot 0 de cada setor. O setor com maior sector_seq
+ *        válido é o setor corrente; os demais são histórico mais antigo.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t sector_seq;
+    uint32_t reserved;
+    uint16_t reserved2;
+    uint16_t crc;
+} journal_header_t;
+
+_Static_assert(sizeof(journal_record_t) == 16, "registro do diario deve ter 16 bytes");
+_Static_assert(sizeof(journal_header_t) == sizeof(journal_record_t), "cabecalho ocupa um slot");
+_Static_assert((JOURNAL_RAM_RING_LEN & (JOURNAL_RAM_RING_LEN - 1)) == 0, "anel deve ser potencia de 2");
+
+// Anel em RAM: journal_log() escreve em ring_head, journal_commit() consome em ring_tail
+static journal_record_t ring[JOURNAL_RAM_RING_LEN];
+static volatile uint32_t ring_head = 0;
+static volatile uint32_t ring_tail = 0;
+static uint32_t seq_counter = 0;
+static volatile uint32_t last_log_ms = 0;
+
+// Posição de escrita na flash
+static uint current_sector = 0;
+static uint32_t current_sector_seq = 0;
+static uint next_slot = 0;
+static bool header_pending = false;
+static bool next_sector_erased = false;
+
+static journal_record_t last_record;
+static bool has_last_record = false;
+static journal_stats_t stats;
+
+MEM_BUDGET_ENTRY(journal, "Diario", sizeof(ring) + sizeof(last_record) + sizeof(stats), MEM_BUDGET_JOURNAL_BYTES);
+
+/**
+ * @brief CRC-16/CCITT (polinômio 0x1021, valor inicial 0xFFFF).
+ * @param data Bytes de entrada.
+ * @param len Número de bytes.
+ * @return CRC calculado.
+ */
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static inline const uint8_t *sector_ptr(uint sector) {
+    return (const uint8_t *)(XIP_BASE + JOURNAL_REGION_OFFSET + sector * FLASH_SECTOR_SIZE);
+}
+
+static inline uint32_t sector_offset(uint sector) {
+    return JOURNAL_REGION_OFFSET + sector * FLASH_SECTOR_SIZE;
+}
+
+static bool slot_is_blank(const uint8_t *slot) {
+    for (size_t i = 0; i < sizeof(journal_record_t); ++i) {
+        if (slot[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static bool sector_is_blank(uint sector) {
+    const uint32_t *words = (const uint32_t *)sector_ptr(sector);
+    for (size_t i = 0; i < FLASH_SECTOR_SIZE / sizeof(uint32_t); ++i) {
+        if (words[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+static bool header_is_valid(const journal_header_t *hdr) {
+    return hdr->magic == JOURNAL_MAGIC &&
+           hdr->crc == crc16_ccitt((const uint8_t *)hdr, offsetof(journal_header_t, crc));
+}
+
+static bool record_is_valid(const journal_record_t *rec) {
+    return rec->crc == crc16_ccitt((const uint8_t *)rec, offsetof(journal_record_t, crc));
+}
+
+// --- Acesso à flash ---
+// As operações rodam via flash_safe_execute(), que suspende o XIP e coordena
+// com o outro núcleo/escalonador enquanto a flash está ocupada.
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+} flash_op_t;
+
+static void flash_erase_op(void *param) {
+    const flash_op_t *op = (const flash_op_t *)param;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void flash_program_op(void *param) {
+    const flash_op_t *op = (const flash_op_t *)param;
+    flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+static bool journal_erase_sector(uint sector) {
+    flash_op_t op = { sector_offset(sector), NULL };
+    return flash_safe_execute(flash_erase_op, &op, JOURNAL_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+static bool journal_program_page(uint sector, uint page, const uint8_t *data) {
+    flash_op_t op = { sector_offset(sector) + page * FLASH_PAGE_SIZE, data };
+    return flash_safe_execute(flash_program_op, &op, JOURNAL_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+/**
+ * @brief Avança para o próximo setor do anel (nivelamento de desgaste: cada
+ *        setor só é apagado uma vez por volta completa do anel).
+ *
+ * Um setor que não fica em branco depois do apagamento (falha da flash ou
+ * acesso exclusivo não obtido) é pulado nesta volta e contado em
+ * erase_failed: nunca se grava por cima de um setor sujo.
+ *
+ * @return true se um setor em branco foi aberto. false se nenhum apagou; o
+ *         setor corrente fica cheio e a próxima gravação tenta de novo.
+ */
+static bool journal_open_next_sector(void) {
+    uint sector = current_sector;
+    bool erased = next_sector_erased;
+
+    for (uint tries = 0; tries < JOURNAL_NUM_SECTORS - 1; ++tries) {
+        sector = (sector + 1) % JOURNAL_NUM_SECTORS;
+        if (!erased) {
+            erased = journal_erase_sector(sector) && sector_is_blank(sector);
+        }
+        if (erased) break;
+        stats.erase_failed++;
+    }
+    next_sector_erased = false;
+    if (!erased) return false;
+
+    current_sector = sector;
+    current_sector_seq++;
+    next_slot = 1;
+    header_pending = true; // O cabeçalho é gravado junto com a primeira página
+    return true;
+}
+
+/**
+ * @brief Recupera o estado do diário a partir da flash.
+ *
+ * Localiza o setor com o maior número de sequência válido, valida o CRC de
+ * cada registro e posiciona a escrita no primeiro slot em branco. Registros
+ * com CRC inválido (gravação interrompida) são contados e pulados.
+ */
+void journal_init(void) {
+    uint64_t start_us = time_us_64();
+    bool found = false;
+
+    memset(&stats, 0, sizeof(stats));
+    has_last_record = false;
+
+    for (uint s = 0; s < JOURNAL_NUM_SECTORS; ++s) {
+        const journal_header_t *hdr = (const journal_header_t *)sector_ptr(s);
+        if (!header_is_valid(hdr)) continue;
+
+        const journal_record_t *recs = (const journal_record_t *)sector_ptr(s);
+        bool newest = !found || hdr->sector_seq > current_sector_seq;
+        uint slot;
+        for (slot = 1; slot < SLOTS_PER_SECTOR; ++slot) {
+            if (slot_is_blank((const uint8_t *)&recs[slot])) break;
+            if (record_is_valid(&recs[slot])) {
+                stats.recovered++;
+                if (newest) {
+                    last_record = recs[slot];
+                    has_last_record = true;
+                }
+            } else {
+                stats.corrupt++;
+            }
+        }
+
+        if (newest) {
+            found = true;
+            current_sector = s;
+            current_sector_seq = hdr->sector_seq;
+            next_slot = slot;
+        }
+    }
+
+    if (!found) {
+        // Diário vazio: o primeiro commit abre o setor 0
+        current_sector = JOURNAL_NUM_SECTORS - 1;
+        current_sector_seq = 0;
+        next_slot = SLOTS_PER_SECTOR;
+    }
+    if (has_last_record) {
+        seq_counter = (uint32_t)last_record.seq + 1;
+    }
+    next_sector_erased = sector_is_blank((current_sector + 1) % JOURNAL_NUM_SECTORS);
+    stats.sector_seq = current_sector_seq;
+
+    printf("Diario recuperado: %" PRIu32 " registros (%" PRIu32 " corrompidos), setor %u, em %" PRIu32 " us.\n",
+           stats.recovered, stats.corrupt, current_sector, (uint32_t)(time_us_64() - start_us));
+}
+
+/**
+ * @brief Enfileira um evento para gravação.
+ *
+ * Executa apenas uma cópia em seção crítica: a gravação na flash fica a cargo
+ * de journal_commit(). Com o anel cheio o evento é descartado e contado.
+ *
+ * @param type Tipo do evento.
+ * @param zone Porta/leitor de origem ou JOURNAL_ZONE_BUTTON.
+ * @param badge Número do crachá (0 se não houver).
+ * @param count Ocupação resultante.
+ */
+void journal_log(journal_event_type_t type, uint8_t zone, uint32_t badge, uint16_t count) {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    taskENTER_CRITICAL();
+    if (ring_head - ring_tail >= JOURNAL_RAM_RING_LEN) {
+        stats.dropped++;
+    } else {
+        journal_record_t *rec = &ring[ring_head & (JOURNAL_RAM_RING_LEN - 1)];
+        rec->timestamp_ms = now_ms;
+        rec->badge = badge;
+        rec->count = count;
+        rec->type = (uint8_t)type;
+        rec->zone = zone;
+        rec->seq = (uint16_t)seq_counter++;
+        ring_head++;
+    }
+    last_log_ms = now_ms;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Grava na flash os registros pendentes no anel em RAM.
+ *
+ * Agrupa os registros por página de 256 bytes e programa cada página uma
+ * única vez, com 0xFF nos slots já gravados. Os registros só saem do anel
+ * depois que a página é gravada: numa falha eles ficam para a próxima
+ * chamada, que regrava os mesmos slots com os mesmos bytes (na NOR, gravar
+ * de novo o mesmo conteúdo é inofensivo). Quando o setor corrente passa da
+ * metade e não há eventos recentes, apaga o próximo setor antecipadamente
+ * para que a rotação não precise apagar durante um pico de movimento.
+ *
+ * @return true se o anel ficou vazio. false se a flash falhou e há
+ *         registros aguardando nova tentativa.
+ */
+bool journal_commit(void) {
+    static uint8_t page_buf[FLASH_PAGE_SIZE];
+
+    while (ring_head != ring_tail) {
+        if (next_slot >= SLOTS_PER_SECTOR && !journal_open_next_sector()) {
+            break;
+        }
+
+        uint page = next_slot / SLOTS_PER_PAGE;
+        uint page_end = (page + 1) * SLOTS_PER_PAGE;
+        journal_record_t *slots = (journal_record_t *)page_buf;
+        uint32_t tail = ring_tail;
+        uint written = 0;
+
+        memset(page_buf, 0xFF, sizeof(page_buf));
+
+        bool with_header = header_pending && page == 0;
+        if (with_header) {
+            journal_header_t *hdr = (journal_header_t *)&slots[0];
+            hdr->magic = JOURNAL_MAGIC;
+            hdr->sector_seq = current_sector_seq;
+            hdr->crc = crc16_ccitt((const uint8_t *)hdr, offsetof(journal_header_t, crc));
+        }
+
+        while (ring_head != tail + written && next_slot + written < page_end) {
+            journal_record_t *rec = &slots[(next_slot + written) % SLOTS_PER_PAGE];
+            *rec = ring[(tail + written) & (JOURNAL_RAM_RING_LEN - 1)];
+            rec->crc = crc16_ccitt((const uint8_t *)rec, offsetof(journal_record_t, crc));
+            written++;
+        }
+
+        if (!journal_program_page(current_sector, page, page_buf)) {
+            stats.program_failed++;
+            break;
+        }
+        if (with_header) header_pending = false;
+        last_record = slots[(next_slot + written - 1) % SLOTS_PER_PAGE];
+        has_last_record = true;
+        next_slot += written;
+        ring_tail = tail + written; // Libera as posições no anel só depois da gravação
+        stats.committed += written;
+    }
+
+    uint32_t idle_ms = to_ms_since_boot(get_absolute_time()) - last_log_ms;
+    if (!next_sector_erased && next_slot > SLOTS_PER_SECTOR / 2 && idle_ms > JOURNAL_ERASE_IDLE_MS) {
+        uint next = (current_sector + 1) % JOURNAL_NUM_SECTORS;
+        next_sector_erased = journal_erase_sector(next) && sector_is_blank(next);
+    }
+    stats.sector_seq = current_sector_seq;
+    return ring_head == ring_tail;
+}
+
+/**
+ * @brief Obtém o último registro válido do diário.
+ *
+ * @param record Saída com o registro.
+ * @return true se existe ao menos um registro. Caso contrário, false.
+ */
+bool journal_get_last(journal_record_t *record) {
+    if (!has_last_record) return false;
+    *record = last_record;
+    return true;
+}
+
+void journal_get_stats(journal_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
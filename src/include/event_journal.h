@@ -0,0 +1,65 @@
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Tipos de evento registrados no diário
+typedef enum {
+    JOURNAL_EVT_BOOT = 1,      // Sistema iniciado
+    JOURNAL_EVT_ENTRY,         // Entrada admitida
+    JOURNAL_EVT_REJECT,        // Entrada recusada (lotado)
+    JOURNAL_EVT_EXIT,          // Saída registrada
+    JOURNAL_EVT_RESET,         // Contagem resetada
+} journal_event_type_t;
+
+// Origem do evento (campo zone): índice do leitor para crachás
+#define JOURNAL_ZONE_BUTTON 0xFF
+#define JOURNAL_ZONE_BEAM   0xFE
+#define JOURNAL_ZONE_HOST   0xFD  // Comando do protocolo USB
+
+/**
+ * @struct journal_record_t
+ * @brief Registro de tamanho fixo (16 bytes) gravado na flash.
+ */
+typedef struct {
+    uint32_t timestamp_ms;  // Milissegundos desde o boot
+    uint32_t badge;         // Número do crachá (0 se não houver)
+    uint16_t count;         // Ocupação resultante após o evento
+    uint8_t type;           // journal_event_type_t
+    uint8_t zone;           // Leitor de origem ou JOURNAL_ZONE_*
+    uint16_t seq;           // 16 bits baixos do número de sequência
+    uint16_t crc;           // CRC-16/CCITT dos 14 bytes anteriores
+} journal_record_t;
+
+/**
+ * @struct journal_stats_t
+ * @brief Contadores do diário.
+ */
+typedef struct {
+    uint32_t committed;     // Registros gravados na flash desde o boot
+    uint32_t dropped;       // Registros descartados com o anel em RAM cheio
+    uint32_t recovered;     // Registros válidos encontrados na recuperação
+    uint32_t corrupt;       // Registros com CRC inválido na recuperação
+    uint32_t sector_seq;    // Sequência do setor corrente (conta as rotações)
+    uint32_t program_failed; // Páginas não gravadas (os registros ficam no anel para nova tentativa)
+    uint32_t erase_failed;  // Setores que não apagaram na rotação (pulados nesta volta)
+} journal_stats_t;
+
+// Recupera o diário da flash (chamar antes do escalonador)
+void journal_init(void);
+
+// Enfileira um evento no anel em RAM. Nunca bloqueia nem acessa a flash.
+void journal_log(journal_event_type_t type, uint8_t zone, uint32_t badge, uint16_t count);
+
+// Grava na flash os registros pendentes (chamada pela tarefa de baixa prioridade).
+// false = a flash falhou e ainda há registros no anel (tentar de novo mais tarde)
+bool journal_commit(void);
+
+// Último registro válido (recuperado ou gravado)
+bool journal_get_last(journal_record_t *record);
+
+void journal_get_stats(journal_stats_t *stats);
+
+#endif // EVENT_JOURNAL_H
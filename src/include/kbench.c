@@ -0,0 +1,288 @@
+#include "kbench.h"
+#include "config.h"
+#include "display.h"
+#include "led_matrix.h"
+#include <inttypes.h>
+
+#if defined(PANEL_HOST)
+#include "analytics.h"
+#include "policy.h"
+#include <time.h>
+#else
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#endif
+
+// Padrão da região de pilha pintada antes de cada kernel
+#define KBENCH_STACK_PAINT  0x6B62656Eu
+
+// Display só para o benchmark: framebuffer próprio, nunca enviado por I2C
+static uint8_t bench_fb[SSD1306_BUFSIZE];
+static ssd1306_t bench_ssd;
+static uint32_t bench_pixels[MATRIX_SIZE];
+static uint32_t bench_color;
+static uint8_t prefill_zero[SSD1306_BUFSIZE];  // Saída do kernel sobre uma região zerada
+
+// --- Relógio ---
+
+#if defined(PANEL_HOST)
+static const char *const platform = "host";
+static const char *const unit = "ns";
+
+static inline uint64_t kbench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static inline uint64_t kbench_elapsed(uint64_t start, uint64_t end) {
+    return end - start;
+}
+#else
+static const char *const platform = "rp2040";
+static const char *const unit = "cycles";
+
+// SysTick: contador decrescente de 24 bits no clock do processador. Sem o
+// scheduler, o benchmark é o único usuário e a interrupção fica desligada.
+static void kbench_clock_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+static inline uint64_t kbench_now(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint64_t kbench_elapsed(uint64_t start, uint64_t end) {
+    return (start - end) & 0x00FFFFFF;
+}
+#endif
+
+/**
+ * @brief Cronometra KBENCH_BATCH chamadas seguidas (no RP2040, com as
+ *        interrupções desligadas).
+ */
+static uint64_t time_batch(const kbench_kernel_t *k) {
+#if !defined(PANEL_HOST)
+    uint32_t irq = save_and_disable_interrupts();
+#endif
+    uint64_t start = kbench_now();
+    for (uint i = 0; i < KBENCH_BATCH; ++i) {
+        k->run(k->ctx);
+    }
+    uint64_t elapsed = kbench_elapsed(start, kbench_now());
+#if !defined(PANEL_HOST)
+    restore_interrupts(irq);
+#endif
+    return elapsed;
+}
+
+// --- Pilha ---
+// stack_paint() e stack_untouched() têm o mesmo quadro e são chamadas da
+// mesma profundidade que o kernel: area[] ocupa a região onde a pilha do
+// kernel cresce. area[0] é o endereço mais fundo.
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+static void __attribute__((noinline)) stack_paint(void) {
+    volatile uint32_t area[KBENCH_STACK_PROBE_WORDS];
+    for (uint i = 0; i < KBENCH_STACK_PROBE_WORDS; ++i) {
+        area[i] = KBENCH_STACK_PAINT;
+    }
+}
+
+static uint32_t __attribute__((noinline)) stack_untouched(void) {
+    volatile uint32_t area[KBENCH_STACK_PROBE_WORDS];   // Lida sem inicializar: é a pintura
+    uint32_t n = 0;
+    while (n < KBENCH_STACK_PROBE_WORDS && area[n] == KBENCH_STACK_PAINT) n++;
+    return n;
+}
+#pragma GCC diagnostic pop
+
+static uint32_t __attribute__((noinline)) stack_depth(const kbench_kernel_t *k) {
+    stack_paint();
+    k->run(k->ctx);
+    return (KBENCH_STACK_PROBE_WORDS - stack_untouched()) * 4;
+}
+
+// --- Kernels ---
+
+static void run_nop(void *ctx) {
+    (void)ctx;
+    __asm volatile ("" ::: "memory");
+}
+
+static void run_fill(void *ctx) {
+    ssd1306_fill(ctx, false);
+}
+
+static void run_draw_string(void *ctx) {
+    ssd1306_draw_string(ctx, "Ocupado: 12/16", 5, 19);
+}
+
+static void run_display_render(void *ctx) {
+    display_render(ctx, 12, MAX_USERS, OCCUPANCY_BAND_FREE, NULL);
+}
+
+static void run_color(void *ctx) {
+    *(volatile uint32_t *)ctx = led_matrix_color_grb(1.0f, 0.8f, 0.0f, 0.2f);
+}
+
+static void run_matrix_render(void *ctx) {
+    led_matrix_render(ctx, MATRIX_STATE_VAGAS_LIVRES, 25);  // Quadro pulsante (sinf)
+}
+
+#if defined(PANEL_HOST)
+// Política e estatísticas só na build nativa: no RP2040 o pior caso é medido
+// pela própria policy_evaluate (policy_get_stats), e as seções críticas do
+// port SMP antes do escalonador deixariam as interrupções (e o USB) desligadas.
+// Pior caso da política: todos os grupos com reserva e horário, leitor com
+// limite de taxa e a tabela de instalações cheia (a busca não encontra o código)
+static const policy_rule_t bench_rules[] = {
+    { POLICY_RULE_LIMITS,  0, MAX_USERS - 2, MAX_USERS },
+    { POLICY_RULE_RESERVE, 1, 1, 0 }, { POLICY_RULE_RESERVE, 2, 1, 0 }, { POLICY_RULE_RESERVE, 3, 1, 0 },
+    { POLICY_RULE_HOURS,   1, 0, 24 * 60 }, { POLICY_RULE_HOURS, 2, 0, 24 * 60 }, { POLICY_RULE_HOURS, 3, 0, 24 * 60 },
+    { POLICY_RULE_RATE,    0, 30, 60 },
+    { POLICY_RULE_GROUP, 1, 101, 0 }, { POLICY_RULE_GROUP, 2, 102, 0 }, { POLICY_RULE_GROUP, 3, 103, 0 },
+    { POLICY_RULE_GROUP, 1, 104, 0 }, { POLICY_RULE_GROUP, 2, 105, 0 }, { POLICY_RULE_GROUP, 3, 106, 0 },
+    { POLICY_RULE_GROUP, 1, 107, 0 }, { POLICY_RULE_GROUP, 2, 108, 0 },
+};
+_Static_assert(POLICY_MAX_FACILITIES == 8, "bench_rules enche a tabela de instalacoes");
+
+static void run_policy_evaluate(void *ctx) {
+    volatile policy_decision_t d = policy_evaluate(2, 0, MAX_USERS / 2, 0);
+    (void)d;
+    (void)ctx;
+}
+
+static void run_policy_group_for_facility(void *ctx) {
+    volatile uint8_t g = policy_group_for_facility(999);
+    (void)g;
+    (void)ctx;
+}
+
+// Entrada e saída alternadas a cada 250 ms: um balde de 1 s vira a cada 4 chamadas
+static void run_analytics_record(void *ctx) {
+    uint64_t *t = ctx;
+    *t += 250000u;
+    bool entry = (*t / 250000u) & 1;
+    analytics_record(entry ? ANALYTICS_EVT_ENTRY : ANALYTICS_EVT_EXIT, entry, *t);
+}
+static uint64_t bench_analytics_us;
+#endif
+
+static const kbench_kernel_t nop_kernel = { "nop", run_nop, NULL, NULL, 0 };
+
+// Framebuffer sem o byte de controle I2C (bench_fb[0])
+static const kbench_kernel_t kernels[] = {
+    { "ssd1306_fill",            run_fill,           &bench_ssd,   bench_fb + 1,             SSD1306_BUFSIZE - 1 },
+    { "ssd1306_draw_string",     run_draw_string,    &bench_ssd,   bench_fb + 1,             SSD1306_BUFSIZE - 1 },
+    { "display_render",          run_display_render, &bench_ssd,   bench_fb + 1,             SSD1306_BUFSIZE - 1 },
+    { "color_to_pio_grb_format", run_color,          &bench_color, (uint8_t *)&bench_color,  sizeof(bench_color) },
+    { "led_matrix_render",       run_matrix_render,  bench_pixels, (uint8_t *)bench_pixels,  sizeof(bench_pixels) },
+#if defined(PANEL_HOST)
+    { "policy_evaluate",         run_policy_evaluate, NULL,       NULL, 0, POLICY_EVAL_BUDGET_US },
+    { "policy_group_for_facility", run_policy_group_for_facility, NULL, NULL, 0, POLICY_EVAL_BUDGET_US },
+    { "analytics_record",        run_analytics_record, &bench_analytics_us, NULL, 0 },
+#endif
+};
+
+/**
+ * @brief Bytes da saída escritos por uma chamada: roda o kernel sobre a
+ *        região zerada e sobre a região em 0xFF. Um byte escrito difere do
+ *        preenchimento em pelo menos uma das duas (escritas de bits também).
+ */
+static uint32_t bytes_written(const kbench_kernel_t *k) {
+    memset(k->out, 0x00, k->out_len);
+    k->run(k->ctx);
+    memcpy(prefill_zero, k->out, k->out_len);
+
+    memset(k->out, 0xFF, k->out_len);
+    k->run(k->ctx);
+
+    uint32_t n = 0;
+    for (size_t i = 0; i < k->out_len; ++i) {
+        if (prefill_zero[i] != 0x00 || k->out[i] != 0xFF) n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Tempo mínimo e médio por lote de um kernel, em unidades do relógio.
+ */
+static void time_kernel(const kbench_kernel_t *k, uint64_t *min, uint64_t *total) {
+    k->run(k->ctx);   // Aquece cache XIP e ramos
+    *min = UINT64_MAX;
+    *total = 0;
+    for (uint r = 0; r < KBENCH_REPEATS; ++r) {
+        uint64_t t = time_batch(k);
+        if (t < *min) *min = t;
+        *total += t;
+    }
+}
+
+void kbench_measure(const kbench_kernel_t *k, kbench_result_t *out) {
+    uint64_t nop_min, nop_total, min, total;
+    time_kernel(&nop_kernel, &nop_min, &nop_total);
+    time_kernel(k, &min, &total);
+
+    min = min > nop_min ? min - nop_min : 0;
+    total = total > nop_total ? total - nop_total : 0;
+    out->min = (uint32_t)(min / KBENCH_BATCH);
+    out->mean = (uint32_t)(total / ((uint64_t)KBENCH_BATCH * KBENCH_REPEATS));
+
+    uint32_t base = stack_depth(&nop_kernel);
+    uint32_t depth = stack_depth(k);
+    out->stack = depth > base ? depth - base : 0;
+
+    out->bytes = k->out_len ? bytes_written(k) : 0;
+}
+
+/**
+ * @brief Mede os kernels e confere os que têm teto: o custo médio de uma
+ *        chamada contra budget_us, em ns na build nativa e em ciclos no RP2040.
+ */
+uint kbench_run_all(void) {
+    uint over = 0;
+
+    bench_ssd.width = WIDTH;
+    bench_ssd.height = HEIGHT;
+    bench_ssd.pages = HEIGHT / 8;
+    bench_ssd.bufsize = SSD1306_BUFSIZE;
+    bench_ssd.ram_buffer = bench_fb;
+    bench_fb[0] = 0x40;
+
+#if defined(PANEL_HOST)
+    uint32_t clock_hz = 0;
+    policy_init(0);
+    policy_load(bench_rules, count_of(bench_rules));
+    analytics_init(0, 0);
+#else
+    kbench_clock_init();
+    uint32_t clock_hz = clock_get_hz(clk_sys);
+#endif
+
+    printf("{\"kbench\":1,\"platform\":\"%s\",\"unit\":\"%s\",\"clock_hz\":%" PRIu32 ","
+           "\"batch\":%u,\"repeats\":%u,\"kernels\":{",
+           platform, unit, clock_hz, KBENCH_BATCH, KBENCH_REPEATS);
+    for (uint i = 0; i < count_of(kernels); ++i) {
+        kbench_result_t r;
+        kbench_measure(&kernels[i], &r);
+#if defined(PANEL_HOST)
+        uint64_t budget = (uint64_t)kernels[i].budget_us * 1000u;
+#else
+        uint64_t budget = (uint64_t)kernels[i].budget_us * (clock_hz / 1000000u);
+#endif
+        bool late = budget && r.mean > budget;
+        over += late;
+        printf("%s\"%s\":{\"min\":%" PRIu32 ",\"mean\":%" PRIu32 ",\"bytes\":%" PRIu32 ",\"stack\":%" PRIu32 "%s}",
+               i ? "," : "", kernels[i].name, r.min, r.mean, r.bytes, r.stack, late ? ",\"over_budget\":true" : "");
+    }
+    printf("}}\n");
+    return over;
+}
@@ -0,0 +1,41 @@
+#ifndef KBENCH_H
+#define KBENCH_H
+
+#include "pico/stdlib.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @struct kbench_kernel_t
+ * @brief Kernel medido: uma chamada com argumentos fixos e a região que ela escreve.
+ */
+typedef struct {
+    const char *name;
+    void (*run)(void *ctx);
+    void *ctx;
+    uint8_t *out;       // Saída do kernel, para contar os bytes escritos
+    size_t out_len;
+    uint32_t budget_us; // Teto do custo médio de uma chamada (0 = sem teto)
+} kbench_kernel_t;
+
+/**
+ * @struct kbench_result_t
+ * @brief Custo de uma chamada, descontada uma chamada vazia. Tempo em ciclos
+ *        no RP2040 (SysTick) e em nanossegundos na build nativa.
+ */
+typedef struct {
+    uint32_t min;       // Menor lote de KBENCH_REPEATS, por chamada
+    uint32_t mean;      // Média de todos os lotes, por chamada
+    uint32_t bytes;     // Bytes da saída escritos por uma chamada
+    uint32_t stack;     // Pilha usada além da chamada vazia (resolução de 4 bytes;
+                        // perto de KBENCH_STACK_PROBE_WORDS * 4, a sonda saturou)
+} kbench_result_t;
+
+// Mede um kernel (tempo, bytes escritos e pilha)
+void kbench_measure(const kbench_kernel_t *k, kbench_result_t *out);
+
+// Mede os kernels do painel e imprime uma linha JSON (formato em
+// tools/kbench_compare.py). Retorna quantos kernels passaram do budget_us
+uint kbench_run_all(void);
+
+#endif // KBENCH_H
@@ -0,0 +1,80 @@
+#include "latency.h"
+#include "config.h"
+#include "mem_budget.h"
+#include <inttypes.h>
+
+static const char *const channel_names[LATENCY_NUM_CHANNELS] = {
+    "Acionamento -> admissao",
+    "Admissao -> display",
+};
+
+// Janela circular das últimas amostras e histograma log2 desde o boot
+// (bin n: [2^n, 2^(n+1)) us; o último bin acumula o restante)
+static uint32_t samples[LATENCY_NUM_CHANNELS][LATENCY_SAMPLES];
+static uint32_t head[LATENCY_NUM_CHANNELS];
+static uint32_t histogram[LATENCY_NUM_CHANNELS][LATENCY_HIST_BINS];
+
+MEM_BUDGET_ENTRY(latency, "Latencia",
+                 sizeof(samples) + sizeof(samples[0]) + sizeof(histogram), // + cópia ordenada
+                 MEM_BUDGET_LATENCY_BYTES);
+
+void latency_record(latency_channel_t channel, uint32_t us) {
+    uint bin = us ? 31 - __builtin_clz(us) : 0;
+    if (bin >= LATENCY_HIST_BINS) bin = LATENCY_HIST_BINS - 1;
+
+    taskENTER_CRITICAL();
+    samples[channel][head[channel] % LATENCY_SAMPLES] = us;
+    head[channel]++;
+    histogram[channel][bin]++;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Ordena a cópia das amostras (inserção: poucas amostras, sem recursão
+ *        nem alocação) e lê os percentis pelo método do posto mais próximo.
+ *
+ * @param channel Canal de latência.
+ * @param out Saída com os percentis. Sem amostras, todos os campos são 0.
+ */
+void latency_get_percentiles(latency_channel_t channel, latency_percentiles_t *out) {
+    static uint32_t sorted[LATENCY_SAMPLES];
+    uint32_t n;
+
+    taskENTER_CRITICAL();
+    n = head[channel] < LATENCY_SAMPLES ? head[channel] : LATENCY_SAMPLES;
+    memcpy(sorted, samples[channel], n * sizeof(uint32_t));
+    taskEXIT_CRITICAL();
+
+    for (uint32_t i = 1; i < n; ++i) {
+        uint32_t v = sorted[i];
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    memset(out, 0, sizeof(*out));
+    if (n == 0) return;
+    out->samples = n;
+    out->p50 = sorted[(n * 50 + 99) / 100 - 1];
+    out->p90 = sorted[(n * 90 + 99) / 100 - 1];
+    out->p99 = sorted[(n * 99 + 99) / 100 - 1];
+    out->max = sorted[n - 1];
+}
+
+void latency_print(void) {
+    for (uint c = 0; c < LATENCY_NUM_CHANNELS; ++c) {
+        latency_percentiles_t p;
+        latency_get_percentiles((latency_channel_t)c, &p);
+        printf("Latencia %s (%" PRIu32 " amostras): p50 %" PRIu32 " us, p90 %" PRIu32 " us, p99 %" PRIu32
+               " us, max %" PRIu32 " us\n",
+               channel_names[c], p.samples, p.p50, p.p90, p.p99, p.max);
+        for (uint b = 0; b < LATENCY_HIST_BINS; ++b) {
+            if (histogram[c][b]) {
+                printf("  >= %7" PRIu32 " us: %" PRIu32 "\n", b ? (uint32_t)1 << b : 0, histogram[c][b]);
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+// Latências medidas (cada uma com sua janela de amostras e histograma)
+typedef enum {
+    LATENCY_ADMIT,     // Acionamento do Botão A até a decisão de admissão
+    LATENCY_DISPLAY,   // Decisão até o display mostrar o resultado
+    LATENCY_NUM_CHANNELS,
+} latency_channel_t;
+
+/**
+ * @struct latency_percentiles_t
+ * @brief Percentis das últimas LATENCY_SAMPLES amostras, em microssegundos.
+ */
+typedef struct {
+    uint32_t samples;   // Amostras consideradas
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+} latency_percentiles_t;
+
+// Registra uma latência em microssegundos
+void latency_record(latency_channel_t channel, uint32_t us);
+
+// Calcula os percentis sobre uma cópia das amostras
+void latency_get_percentiles(latency_channel_t channel, latency_percentiles_t *out);
+
+// Imprime os percentis e o histograma de cada canal no terminal serial
+void latency_print(void);
+
+#endif // LATENCY_H
@@ -1,5 +1,8 @@
 #include "led_matrix.h"
 #include "config.h"
+#include "clock_mgr.h"
+#include "mem_budget.h"
+#include "trace.h"
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
@@ -11,6 +14,10 @@
 static PIO pio_instance = MATRIX_PIO_INSTANCE;
 static uint pio_sm = MATRIX_PIO_SM;
 static uint32_t pixel_buffer[MATRIX_SIZE];
+static uint32_t latch_until_us;   // Fim do reset do último quadro (time_us_32)
+static volatile bool sending;     // Dentro do laço de put (adia trocas do clk_sys)
+
+MEM_BUDGET_ENTRY(led_matrix, "Matriz", sizeof(pixel_buffer), MEM_BUDGET_MATRIX_BYTES);
 
 #define MATRIX_GLOBAL_BRIGHTNESS 0.2f 
 
@@ -85,27 +92,40 @@ static inline uint32_t color_to_pio_grb_format(ws2812b_color_t color, float brig
     return ((uint32_t)(G_val) << 24) | ((uint32_t)(R_val) << 16) | ((uint32_t)(B_val) << 8);
 }
 
+uint32_t led_matrix_color_grb(float r, float g, float b, float brightness) {
+    return color_to_pio_grb_format((ws2812b_color_t){ r, g, b }, brightness);
+}
+
 /**
  * @brief Atualiza a matriz enviando o buffer atual para o PIO.
+ *        O último put retorna com a FIFO ainda cheia: o quadro termina
+ *        MATRIX_FIFO_WORDS + 1 LEDs depois, e o reset corre a partir daí.
+ *        Só um quadro seguinte que chegue antes do fim do reset espera.
  */
 static void matrix_update() {
+    while ((int32_t)(latch_until_us - time_us_32()) > 0) {
+        tight_loop_contents();
+    }
+    sending = true;
     for (int i = 0; i < MATRIX_SIZE; ++i) {
         pio_sm_put_blocking(pio_instance, pio_sm, pixel_buffer[i]);
     }
-    busy_wait_us(300);
+    sending = false;
+    latch_until_us = time_us_32() + (MATRIX_FIFO_WORDS + 1) * MATRIX_LED_US + MATRIX_RESET_US;
 }
 
 /**
  * @brief Ativa um pixel individual na matriz com cor e brilho ajustado.
+ * @param pixels Buffer de MATRIX_SIZE pixels
  * @param row Linha do pixel
  * @param col Coluna do pixel
  * @param color Cor desejada
  * @param brightness_modulator Modificador adicional ao brilho global
  */
-static void led_activate_position(int row_0_based, int col_0_based, ws2812b_color_t color, float brightness_modulator) {
+static void led_activate_position(uint32_t *pixels, int row_0_based, int col_0_based, ws2812b_color_t color, float brightness_modulator) {
     int index = get_pixel_index(row_0_based, col_0_based);
     if (index != -1) {
-        pixel_buffer[index] = color_to_pio_grb_format(color, MATRIX_GLOBAL_BRIGHTNESS * brightness_modulator);
+        pixels[index] = color_to_pio_grb_format(color, MATRIX_GLOBAL_BRIGHTNESS * brightness_modulator);
     }
 }
 
@@ -118,6 +138,24 @@ void led_matrix_init() {
     led_matrix_clear();
 }
 
+/**
+ * @brief Ouvinte do clock_mgr. A troca espera o quadro sair inteiro: o outro
+ *        núcleo parado no laço de put esvaziaria a FIFO e um bit com o
+ *        divisor antigo no clock novo sai fora da janela do WS2812. No reset
+ *        o pino já está baixo e o SM parado no pull, então o divisor pode mudar.
+ */
+bool led_matrix_clock_listener(clock_phase_t phase, uint32_t sys_hz) {
+    if (phase == CLOCK_PHASE_PREPARE) {
+        return !sending && (int32_t)(latch_until_us - MATRIX_RESET_US - time_us_32()) <= 0;
+    }
+    pio_sm_set_clkdiv(pio_instance, pio_sm, led_matrix_program_clkdiv(sys_hz));
+    return true;
+}
+
+const uint32_t *led_matrix_pixels(void) {
+    return pixel_buffer;
+}
+
 /**
  * @brief Limpa todos os pixels da matriz (define como preto) e atualiza a exibição.
  */
@@ -143,29 +181,31 @@ static void pulsa_leds(ws2812b_color_t color, float brightness_modulator) {
 
 /**
  * @brief Desenha um frame binário na matriz com a cor e brilho especificados.
+ * @param pixels Buffer de MATRIX_SIZE pixels
  * @param frame Frame de 5x5 representando a imagem
  * @param base_color Cor base
  * @param brightness_modulator Brilho ajustável
  */
-static void desenha_frame(const char frame[MATRIX_DIM][MATRIX_DIM + 1], ws2812b_color_t base_color, float brightness_modulator) {
+static void desenha_frame(uint32_t *pixels, const char frame[MATRIX_DIM][MATRIX_DIM + 1], ws2812b_color_t base_color, float brightness_modulator) {
     for (int r = 0; r < MATRIX_DIM; ++r) {
         for (int c = 0; c < MATRIX_DIM; ++c) {
             if (frame[r][c] == '1') {
-                led_activate_position(r, c, base_color, brightness_modulator);
+                led_activate_position(pixels, r, c, base_color, brightness_modulator);
             }
         }
     }
 }
 
 /**
- * @brief Atualiza a exibição da matriz de LEDs com base no estado atual e passo de animação.
- * 
+ * @brief Desenha o quadro de ocupação em um buffer, sem enviar ao PIO.
+ *
+ * @param pixels Buffer de MATRIX_SIZE pixels
  * @param state Estado lógico atual da matriz (vazio, normal, cheio, etc.)
  * @param animation_step Passo atual da animação (incrementado periodicamente)
  */
-void led_matrix_ocupacao(MatrixOccupationState_t state, uint8_t animation_step) {
+void led_matrix_render(uint32_t *pixels, MatrixOccupationState_t state, uint8_t animation_step) {
     for (int i = 0; i < MATRIX_SIZE; ++i) {
-        pixel_buffer[i] = color_to_pio_grb_format(COLOR_BLACK, 1.0f);
+        pixels[i] = color_to_pio_grb_format(COLOR_BLACK, 1.0f);
     }
 
     float angle = (float)animation_step * (2.0f * (float)M_PI / 100.0f);
@@ -198,7 +238,7 @@ void led_matrix_ocupacao(MatrixOccupationState_t state, uint8_t animation_step)
         case MATRIX_STATE_QUASE_CHEIO:
             apply_standard_pulsing = false;
             if ((animation_step / 10) % 2 == 0) {
-                desenha_frame(FRAME_WARN_ICON, COLOR_YELLOW_WARN, 1.0f);
+                desenha_frame(pixels, FRAME_WARN_ICON, COLOR_YELLOW_WARN, 1.0f);
             }
             break;
 
@@ -214,8 +254,18 @@ void led_matrix_ocupacao(MatrixOccupationState_t state, uint8_t animation_step)
     }
 
     if (selected_frame_ptr && apply_standard_pulsing) {
-        desenha_frame(selected_frame_ptr, selected_color, current_pulse_brightness_factor);
+        desenha_frame(pixels, selected_frame_ptr, selected_color, current_pulse_brightness_factor);
     }
+}
 
+/**
+ * @brief Atualiza a exibição da matriz de LEDs com base no estado atual e passo de animação.
+ * 
+ * @param state Estado lógico atual da matriz (vazio, normal, cheio, etc.)
+ * @param animation_step Passo atual da animação (incrementado periodicamente)
+ */
+void led_matrix_ocupacao(MatrixOccupationState_t state, uint8_t animation_step) {
+    led_matrix_render(pixel_buffer, state, animation_step);
+    TRACE(TRACE_EVT_MATRIX_FRAME, animation_step);
     matrix_update();
 }
\ No newline at end of file
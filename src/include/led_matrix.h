@@ -2,6 +2,7 @@
 #define LED_MATRIX_H
 
 #include <stdint.h>
+#include "clock_mgr.h"
 typedef enum {
     MATRIX_STATE_VAZIO,         // Livre
     MATRIX_STATE_VAGAS_LIVRES,  // Ocupação média
@@ -13,4 +14,15 @@ void led_matrix_init(void);
 void led_matrix_clear(void);
 void led_matrix_ocupacao(MatrixOccupationState_t state, uint8_t animation_step);
 
+// Kernels de desenho sem envio ao PIO (kbench.c): quadro de ocupação em um
+// buffer de MATRIX_SIZE pixels e conversão de uma cor RGB (0.0 a 1.0) para GRB
+void led_matrix_render(uint32_t *pixels, MatrixOccupationState_t state, uint8_t animation_step);
+uint32_t led_matrix_color_grb(float r, float g, float b, float brightness);
+
+// Ouvinte do clock_mgr (registrado no main): divisor do SM
+bool led_matrix_clock_listener(clock_phase_t phase, uint32_t sys_hz);
+
+// Buffer de pixels enviado ao PIO (GRB em 32 bits, ordem física dos LEDs), só leitura
+const uint32_t *led_matrix_pixels(void);
+
 #endif // LED_MATRIX_H
\ No newline at end of file
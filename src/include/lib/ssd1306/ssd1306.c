@@ -1,5 +1,10 @@
 #include "ssd1306.h"
 #include "font.h"
+#include <assert.h>
+#include <string.h>
+
+// Framebuffer estático (um display por placa): nada vem do heap
+static uint8_t ram_buffer[SSD1306_BUFSIZE];
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,64 +13,65 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  assert(ssd->bufsize <= sizeof(ram_buffer));
+  memset(ram_buffer, 0, sizeof(ram_buffer));
+  ssd->ram_buffer = ram_buffer;
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->char_timeout_us = SSD1306_CHAR_TIMEOUT_US;
 }
 
-void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+bool ssd1306_config(ssd1306_t *ssd) {
+  static const uint8_t config[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, HEIGHT - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, 0x14,
+    SET_DISP | 0x01,
+  };
+  for (size_t i = 0; i < sizeof(config); ++i) {
+    if (!ssd1306_command(ssd, config[i])) return false;
+  }
+  return true;
 }
 
-void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
-  ssd->port_buffer[1] = command;
-  i2c_write_blocking(
+// Escrita com prazo proporcional ao tamanho (mais um byte para o endereço)
+static bool ssd1306_write(ssd1306_t *ssd, const uint8_t *src, size_t len) {
+  int written = i2c_write_timeout_us(
     ssd->i2c_port,
     ssd->address,
-    ssd->port_buffer,
-    2,
-    false
+    src,
+    len,
+    false,
+    (len + 1) * ssd->char_timeout_us
   );
+  return written == (int)len;
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+bool ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd->port_buffer[1] = command;
+  return ssd1306_write(ssd, ssd->port_buffer, 2);
+}
+
+bool ssd1306_send_data(ssd1306_t *ssd) {
+  return ssd1306_command(ssd, SET_COL_ADDR) &&
+         ssd1306_command(ssd, 0) &&
+         ssd1306_command(ssd, ssd->width - 1) &&
+         ssd1306_command(ssd, SET_PAGE_ADDR) &&
+         ssd1306_command(ssd, 0) &&
+         ssd1306_command(ssd, ssd->pages - 1) &&
+         ssd1306_write(ssd, ssd->ram_buffer, ssd->bufsize);
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
@@ -4,6 +4,8 @@
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_BUFSIZE (WIDTH * HEIGHT / 8 + 1) // Framebuffer + byte de controle
+#define SSD1306_CHAR_TIMEOUT_US 50               // Prazo padrão por byte (~2x um byte a 400 kHz)
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -32,14 +34,17 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint32_t char_timeout_us; // Prazo por byte de cada escrita (ajustar ao trocar o baud)
 } ssd1306_t;
 
 // === Protótipos de Funções ===
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
-void ssd1306_config(ssd1306_t *ssd);
-void ssd1306_command(ssd1306_t *ssd, uint8_t command);
-void ssd1306_send_data(ssd1306_t *ssd);
+// Escritas com prazo (i2c_write_timeout_us): false = NAK ou prazo esgotado;
+// a sequência para na primeira falha
+bool ssd1306_config(ssd1306_t *ssd);
+bool ssd1306_command(ssd1306_t *ssd, uint8_t command);
+bool ssd1306_send_data(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
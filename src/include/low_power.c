@@ -0,0 +1,215 @@
+#include "low_power.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hardware/clocks.h"
+#include <inttypes.h>
+#if !defined(PANEL_HOST)
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/regs/m0plus.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#endif
+
+static const char *const wake_names[LOW_POWER_NUM_WAKES] = { "timer", "gpio", "pio", "usb", "nucleo", "outra" };
+
+static low_power_stats_t stats;
+static low_power_stats_t last;      // Consulta anterior (low_power_print)
+static uint32_t last_print_us;
+
+MEM_BUDGET_ENTRY(low_power, "Baixo consumo", sizeof(stats) + sizeof(last) + sizeof(last_print_us),
+                 MEM_BUDGET_LOW_POWER_BYTES);
+
+void low_power_record_sleep(uint32_t slept_us, low_power_wake_t source) {
+    stats.sleeps++;
+    stats.slept_us += slept_us;
+    stats.wakeups[source < LOW_POWER_NUM_WAKES ? source : LOW_POWER_WAKE_OTHER]++;
+}
+
+void low_power_get_stats(low_power_stats_t *out) {
+    *out = stats;
+}
+
+#if !defined(PANEL_HOST)
+
+static int alarm_num = -1;  // Alarme de hardware do tickless (-1: sem alarme livre, sem tickless)
+
+static void alarm_callback(uint alarm) {
+    (void)alarm;    // Só acorda o núcleo; o tempo dormido é contado ao retomar
+}
+
+void low_power_init(void) {
+    alarm_num = hardware_alarm_claim_unused(false);
+    if (alarm_num >= 0) hardware_alarm_set_callback((uint)alarm_num, alarm_callback);
+}
+
+/**
+ * @brief Fonte do despertar pelas IRQs pendentes no NVIC. Com PRIMASK ligado
+ *        o WFI retorna sem atender a IRQ, então ela ainda está pendente aqui.
+ *        Um evento de periférico tem precedência sobre o alarme que venceu junto.
+ */
+static low_power_wake_t wake_source(uint32_t pending) {
+    if (pending & (1u << IO_IRQ_BANK0)) return LOW_POWER_WAKE_GPIO;
+    if (pending & ((1u << PIO0_IRQ_0) | (1u << PIO0_IRQ_1) | (1u << PIO1_IRQ_0) | (1u << PIO1_IRQ_1))) {
+        return LOW_POWER_WAKE_PIO;
+    }
+    if (pending & (1u << USBCTRL_IRQ)) return LOW_POWER_WAKE_USB;
+    if (pending & (1u << SIO_IRQ_PROC0)) return LOW_POWER_WAKE_CORE;
+    if (pending & (0xfu << TIMER_IRQ_0)) return LOW_POWER_WAKE_TIMER;
+    return LOW_POWER_WAKE_OTHER;
+}
+
+/**
+ * @brief Tickless idle do núcleo do tick; substitui a versão fraca do port.
+ *
+ * A do port calcula as contagens do SysTick uma vez, a partir de
+ * configCPU_CLOCK_HZ, e erra depois de qualquer troca do clock_mgr. Aqui o
+ * prazo vai para um alarme do timer de 1 MHz e só a fração do tick corrente
+ * é lida do SysTick, com o clk_sys do momento. Cada sono dura no máximo
+ * LOW_POWER_MAX_SLEEP_MS, para que o idle hook alimente o watchdog.
+ *
+ * Ao acordar, os ticks inteiros dormidos vão para vTaskStepTick(); se o
+ * alarme venceu, o último fica para a ISR do SysTick, disparada logo em
+ * seguida, que é quem desbloqueia a tarefa.
+ */
+void vPortSuppressTicksAndSleep(TickType_t expected) {
+    // O outro núcleo não tem SysTick do kernel: dorme pelo idle hook (low_power_idle_wfi)
+    if (get_core_num() != configTICK_CORE || alarm_num < 0) return;
+    if (expected > pdMS_TO_TICKS(LOW_POWER_MAX_SLEEP_MS)) expected = pdMS_TO_TICKS(LOW_POWER_MAX_SLEEP_MS);
+
+    const uint32_t tick_us = 1000000 / configTICK_RATE_HZ;
+    uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    uint32_t irq = save_and_disable_interrupts();
+
+    systick_hw->csr &= ~M0PLUS_SYST_CSR_ENABLE_BITS;
+    bool tick_pending = scb_hw->icsr & M0PLUS_ICSR_PENDSTSET_BITS;
+    if (tick_pending || eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+        stats.aborted++;
+        restore_interrupts(irq);
+        return;
+    }
+
+    // Início do tick corrente, pela contagem regressiva do SysTick
+    uint32_t reload = systick_hw->rvr;
+    uint64_t tick_start = time_us_64() - (reload - systick_hw->cvr) / cycles_per_us;
+    bool missed = hardware_alarm_set_target((uint)alarm_num, from_us_since_boot(tick_start + expected * tick_us));
+    if (!missed) {
+        __dsb();
+        __wfi();
+        __isb();
+    }
+    uint32_t pending = *(io_ro_32 *)(PPB_BASE + M0PLUS_NVIC_ISPR_OFFSET);
+    hardware_alarm_cancel((uint)alarm_num);
+
+    uint64_t elapsed = time_us_64() - tick_start;
+    TickType_t ticks = (TickType_t)(elapsed / tick_us);
+    uint32_t remaining = (tick_us - (uint32_t)(elapsed % tick_us)) * cycles_per_us;
+    if (ticks >= expected) {
+        ticks = expected - 1;
+        remaining = cycles_per_us;  // A ISR do SysTick conta o último tick em 1 us
+    }
+
+    // Termina o tick parcial e volta ao período normal na recarga seguinte
+    systick_hw->rvr = remaining - 1;
+    systick_hw->cvr = 0;
+    systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+    systick_hw->rvr = reload;
+    vTaskStepTick(ticks);
+
+    if (!missed) low_power_record_sleep((uint32_t)elapsed, wake_source(pending));
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief WFI com as interrupções mascaradas: uma IRQ que chegue entre a
+ *        decisão de dormir e o WFI continua pendente e o acorda na hora. Ela
+ *        é atendida ao restaurar, e a troca de tarefa que ela pedir acontece
+ *        na saída da ISR.
+ */
+void low_power_idle_wfi(void) {
+    uint core = get_core_num();
+    uint32_t irq = save_and_disable_interrupts();
+    uint64_t start = time_us_64();
+
+    __dsb();
+    __wfi();
+    __isb();
+    stats.wfi_us[core] += (uint32_t)(time_us_64() - start);
+    restore_interrupts(irq);
+}
+
+#else
+
+void low_power_init(void) {
+    // Build nativa: o sono é o salto do relógio virtual (sim_idle_skip)
+}
+
+void low_power_idle_wfi(void) {
+    // Build nativa: um núcleo, e a idle cede a vez ao relógio virtual
+}
+
+#endif // !PANEL_HOST
+
+// Fração (por mil) de elapsed_us em que um núcleo esteve em WFI
+static uint32_t permille_of(uint32_t us, uint32_t elapsed_us) {
+    if (us > elapsed_us) us = elapsed_us;
+    return (uint32_t)((uint64_t)us * 1000 / elapsed_us);
+}
+
+/**
+ * @brief Corrente estimada do RP2040, em uA, no clock dado: cada núcleo
+ *        conta como executando fora da sua fração de WFI (sleep_permille, por
+ *        núcleo). Os coeficientes de LOW_POWER_*_UA são estimativas para
+ *        calibrar com um amperímetro.
+ */
+static uint32_t estimate_ua(uint32_t sys_hz, const uint32_t sleep_permille[configNUM_CORES]) {
+    uint32_t mhz = sys_hz / 1000000;
+    uint32_t cores = 0;
+
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        cores += (LOW_POWER_RUN_UA_PER_MHZ * (1000 - sleep_permille[c]) +
+                  LOW_POWER_WFI_UA_PER_MHZ * sleep_permille[c]) / 1000;
+    }
+    return LOW_POWER_BASE_UA + mhz * cores;
+}
+
+void low_power_print(void) {
+    low_power_stats_t now = stats;
+    uint32_t now_us = time_us_32();
+    uint32_t elapsed = now_us - last_print_us;
+    uint32_t sleeps = now.sleeps - last.sleeps;
+    uint32_t slept = now.slept_us - last.slept_us;
+
+    if (elapsed == 0) elapsed = 1;
+    uint32_t permille = permille_of(slept, elapsed);
+    uint32_t core_permille[configNUM_CORES];
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        uint32_t wfi = now.wfi_us[c] - last.wfi_us[c];
+        core_permille[c] = permille_of(wfi + (c == configTICK_CORE ? slept : 0), elapsed);
+    }
+    uint32_t rate_x10 = (uint32_t)((uint64_t)sleeps * 10000000 / elapsed);
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t ua = estimate_ua(sys_hz, core_permille);
+
+    printf("Energia: %" PRIu32 ".%" PRIu32 " despertares/s, tickless %" PRIu32 ".%" PRIu32 "%% do tempo, "
+           "%" PRIu32 " desistencias; "
+           "corrente estimada %" PRIu32 ".%" PRIu32 " mA a %" PRIu32 " MHz\n",
+           rate_x10 / 10, rate_x10 % 10, permille / 10, permille % 10, now.aborted - last.aborted,
+           ua / 1000, ua % 1000 / 100, sys_hz / 1000000);
+    printf("Despertares:");
+    for (uint i = 0; i < LOW_POWER_NUM_WAKES; ++i) {
+        printf(" %s %" PRIu32, wake_names[i], now.wakeups[i] - last.wakeups[i]);
+    }
+    printf("; em WFI:");
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        printf(" nucleo %u %" PRIu32 ".%" PRIu32 "%%", c, core_permille[c] / 10, core_permille[c] % 10);
+    }
+    printf("\n");
+
+    last = now;
+    last_print_us = now_us;
+}
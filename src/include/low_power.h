@@ -0,0 +1,64 @@
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+// Tickless idle (configUSE_TICKLESS_IDLE): sem tarefa pronta, o núcleo do tick
+// desliga o SysTick e dorme em WFI até o próximo desbloqueio de tarefa (alarme
+// do timer de 1 MHz, que não depende do clk_sys) ou até a IRQ de um
+// periférico. O kernel chama vPortSuppressTicksAndSleep() (low_power.c) com o
+// escalonador suspenso. Na build nativa o relógio virtual de sim.c faz o papel
+// do sono e registra cada intervalo aqui.
+//
+// O tickless só existe no núcleo do tick. O outro núcleo não tem SysTick do
+// kernel e dorme em WFI na sua tarefa idle (low_power_idle_wfi, pelos idle
+// hooks do main.c) até a IRQ seguinte: o pedido de troca de tarefa do núcleo
+// do tick (FIFO entre núcleos), a trava da flash ou uma IRQ dele. Os dois
+// tempos são medidos e a corrente estimada usa a fração de cada núcleo; se o
+// kernel nunca chamar o tickless, o núcleo do tick aparece acordado.
+
+// Fonte que acordou o núcleo do tick
+typedef enum {
+    LOW_POWER_WAKE_TIMER,   // Alarme do tickless (prazo de uma tarefa) ou outro alarme do SDK
+    LOW_POWER_WAKE_GPIO,    // Botões e sensores de feixe
+    LOW_POWER_WAKE_PIO,     // Quadro dos leitores Wiegand
+    LOW_POWER_WAKE_USB,     // Terminal USB
+    LOW_POWER_WAKE_CORE,    // O outro núcleo (FIFO entre núcleos: yield, trava da flash)
+    LOW_POWER_WAKE_OTHER,
+    LOW_POWER_NUM_WAKES
+} low_power_wake_t;
+
+/**
+ * @struct low_power_stats_t
+ * @brief Contadores do tickless. Escritos só pela tarefa idle do núcleo do
+ *        tick; a leitura pode ver um campo defasado (diagnóstico).
+ */
+typedef struct {
+    uint32_t sleeps;                        // Sonos concluídos (um despertar cada)
+    uint32_t aborted;                       // Desistências: tarefa pronta ou tick pendente ao entrar
+    uint32_t slept_us;                      // Tempo dormindo (dá voltas a cada ~71 min)
+    uint32_t wakeups[LOW_POWER_NUM_WAKES];  // Despertares por fonte
+    uint32_t wfi_us[configNUM_CORES];       // Tempo em WFI nas tarefas idle, fora do tickless (por núcleo)
+} low_power_stats_t;
+
+// Reserva o alarme de hardware do tickless. Chamar no núcleo do tick
+// (configTICK_CORE) antes do escalonador: a IRQ do alarme é habilitada nele
+void low_power_init(void);
+
+// Registra um sono de slept_us encerrado por source
+void low_power_record_sleep(uint32_t slept_us, low_power_wake_t source);
+
+// Idle hooks: dorme em WFI até a próxima IRQ deste núcleo e soma o tempo em
+// wfi_us. No núcleo do tick só quando a tarefa idle não é a que entra no
+// tickless (ver main.c)
+void low_power_idle_wfi(void);
+
+void low_power_get_stats(low_power_stats_t *stats);
+
+// Imprime despertares por segundo e por fonte, fração do tempo dormindo e a
+// corrente estimada no clock atual, desde a consulta anterior
+void low_power_print(void);
+
+#endif // LOW_POWER_H
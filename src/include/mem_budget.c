@@ -0,0 +1,51 @@
+#include "mem_budget.h"
+#include "config.h"
+#include <inttypes.h>
+
+// Uma linha por subsistema, declarada com MEM_BUDGET_ENTRY no módulo dono da memória
+extern const mem_budget_entry_t mem_budget_kernel, mem_budget_active_objects, mem_budget_display,
+    mem_budget_analytics, mem_budget_journal, mem_budget_beam, mem_budget_latency,
+    mem_budget_policy, mem_budget_ui_events, mem_budget_wiegand, mem_budget_led_matrix,
+    mem_budget_profiler, mem_budget_trace, mem_budget_tlog, mem_budget_usb_protocol,
+    mem_budget_mirror, mem_budget_clock_mgr, mem_budget_low_power, mem_budget_rgb_led, mem_budget_compositor;
+
+static const mem_budget_entry_t *const entries[] = {
+    &mem_budget_kernel,
+    &mem_budget_active_objects,
+    &mem_budget_display,
+    &mem_budget_analytics,
+    &mem_budget_journal,
+    &mem_budget_beam,
+    &mem_budget_latency,
+    &mem_budget_policy,
+    &mem_budget_ui_events,
+    &mem_budget_wiegand,
+    &mem_budget_led_matrix,
+    &mem_budget_profiler,
+    &mem_budget_trace,
+    &mem_budget_tlog,
+    &mem_budget_usb_protocol,
+    &mem_budget_mirror,
+    &mem_budget_clock_mgr,
+    &mem_budget_low_power,
+    &mem_budget_rgb_led,
+    &mem_budget_compositor,
+};
+
+/**
+ * @brief Imprime a tabela de RAM estática por subsistema (usado/orçamento) e o
+ *        heap do FreeRTOS, que só guarda os queue sets dos workers.
+ */
+void mem_budget_print(void) {
+    uint32_t total = 0, total_budget = 0;
+
+    printf("Subsistema        Bytes  Orcamento\n");
+    for (uint i = 0; i < count_of(entries); ++i) {
+        printf("%-16s %6" PRIu32 " %10" PRIu32 "\n", entries[i]->name, entries[i]->bytes, entries[i]->budget);
+        total += entries[i]->bytes;
+        total_budget += entries[i]->budget;
+    }
+    printf("%-16s %6" PRIu32 " %10" PRIu32 "\n", "Total", total, total_budget);
+    printf("Heap FreeRTOS: %u de %u bytes livres (minimo %u)\n", (unsigned)xPortGetFreeHeapSize(),
+           (unsigned)configTOTAL_HEAP_SIZE, (unsigned)xPortGetMinimumEverFreeHeapSize());
+}
@@ -0,0 +1,33 @@
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/**
+ * @struct mem_budget_entry_t
+ * @brief RAM estática de um subsistema, calculada com sizeof() no próprio módulo.
+ */
+typedef struct {
+    const char *name;
+    uint32_t bytes;
+    uint32_t budget;
+} mem_budget_entry_t;
+
+// Declara a linha do subsistema na tabela de orçamento. Deve vir depois das
+// variáveis estáticas do módulo; a compilação falha se bytes > budget.
+// Na build nativa (ponteiros de 64 bits, pilhas das threads POSIX) a tabela
+// só informa: o orçamento vale para o RP2040.
+#if defined(PANEL_HOST)
+#define MEM_BUDGET_ENTRY(id, label, bytes, budget) \
+    const mem_budget_entry_t mem_budget_##id = { label, (bytes), (budget) }
+#else
+#define MEM_BUDGET_ENTRY(id, label, bytes, budget) \
+    _Static_assert((bytes) <= (budget), label " excede o orcamento de RAM"); \
+    const mem_budget_entry_t mem_budget_##id = { label, (bytes), (budget) }
+#endif
+
+// Imprime a tabela de orçamento por subsistema e o uso do heap
+void mem_budget_print(void);
+
+#endif // MEM_BUDGET_H
@@ -0,0 +1,170 @@
+#include "mirror.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "usb_protocol.h"
+
+#define OLED_PAGES     (DISPLAY_HEIGHT / 8)
+#define NUM_PAGES      (OLED_PAGES + 1)            // Páginas do OLED + a matriz
+#define MATRIX_BYTES   (MATRIX_SIZE * 3)
+#define PAGE_MAX       DISPLAY_WIDTH
+#define RLE_MAX(n)     ((n) + ((n) + 127) / 128)   // Pior caso: só literais
+#define HEADER_LEN     5
+#define FRAME_COST(n)  ((n) + 2 + 4)               // + CRC, COBS e delimitadores (aprox.)
+
+_Static_assert(MATRIX_BYTES <= PAGE_MAX, "matriz nao cabe em uma pagina");
+_Static_assert(HEADER_LEN + RLE_MAX(PAGE_MAX) <= USB_PROTO_ASYNC_MAX, "pagina nao cabe no quadro");
+
+// Referência: o que o cliente tem (zeros até a página completa ser enviada)
+static uint8_t ref_oled[OLED_PAGES][DISPLAY_WIDTH];
+static uint8_t ref_matrix[MATRIX_BYTES];
+static uint16_t synced;          // Bit por página: cliente já recebeu a página completa
+static bool enabled;
+static uint8_t cursor;           // Próxima página a verificar (rodízio entre chamadas)
+static uint8_t seq;
+static uint32_t credit;          // Bytes disponíveis (balde de fichas)
+static uint32_t last_ms;
+static mirror_stats_t stats;
+
+MEM_BUDGET_ENTRY(mirror, "Espelho", sizeof(ref_oled) + sizeof(ref_matrix) + sizeof(stats), MEM_BUDGET_MIRROR_BYTES);
+
+void mirror_start(void) {
+    memset(ref_oled, 0, sizeof(ref_oled));
+    memset(ref_matrix, 0, sizeof(ref_matrix));
+    synced = 0;
+    credit = MIRROR_BURST_BYTES;
+    last_ms = to_ms_since_boot(get_absolute_time());
+    enabled = true;
+}
+
+void mirror_stop(void) {
+    enabled = false;
+}
+
+bool mirror_enabled(void) {
+    return enabled;
+}
+
+/**
+ * @brief RLE estilo PackBits (formato em mirror.h).
+ * @return Bytes escritos em out (até RLE_MAX(n)).
+ */
+static uint rle_encode(const uint8_t *in, uint n, uint8_t *out) {
+    uint i = 0, o = 0;
+
+    while (i < n) {
+        uint run = 1;
+        while (i + run < n && run < 129 && in[i + run] == in[i]) run++;
+        if (run >= 2) {
+            out[o++] = (uint8_t)(126 + run);
+            out[o++] = in[i];
+            i += run;
+        } else {
+            // Literais até o início da próxima repetição
+            uint lit = 1;
+            while (i + lit < n && lit < 128 && !(i + lit + 1 < n && in[i + lit] == in[i + lit + 1])) lit++;
+            out[o++] = (uint8_t)(lit - 1);
+            memcpy(&out[o], &in[i], lit);
+            o += lit;
+            i += lit;
+        }
+    }
+    return o;
+}
+
+/**
+ * @brief Calcula o XOR da página viva com a referência e atualiza a referência.
+ *        O OLED usa endereçamento vertical: a página p da coluna x está em
+ *        oled[x * OLED_PAGES + p].
+ * @return Tamanho da página, ou 0 se a superfície ainda não existe.
+ */
+static uint page_delta(uint page, const uint8_t *oled, const uint32_t *matrix, uint8_t *delta) {
+    if (page < OLED_PAGES) {
+        if (!oled) return 0;
+        uint8_t *ref = ref_oled[page];
+        for (uint x = 0; x < DISPLAY_WIDTH; ++x) {
+            uint8_t v = oled[x * OLED_PAGES + page];
+            delta[x] = v ^ ref[x];
+            ref[x] = v;
+        }
+        return DISPLAY_WIDTH;
+    }
+    for (uint i = 0; i < MATRIX_SIZE; ++i) {
+        uint32_t grb = matrix[i];
+        uint8_t rgb[3] = { (uint8_t)(grb >> 16), (uint8_t)(grb >> 24), (uint8_t)(grb >> 8) };
+        for (uint c = 0; c < 3; ++c) {
+            delta[3 * i + c] = rgb[c] ^ ref_matrix[3 * i + c];
+            ref_matrix[3 * i + c] = rgb[c];
+        }
+    }
+    return MATRIX_BYTES;
+}
+
+static bool page_changed(uint page, const uint8_t *oled, const uint32_t *matrix) {
+    if (page < OLED_PAGES) {
+        if (!oled) return false;
+        for (uint x = 0; x < DISPLAY_WIDTH; ++x) {
+            if (oled[x * OLED_PAGES + page] != ref_oled[page][x]) return true;
+        }
+        return false;
+    }
+    for (uint i = 0; i < MATRIX_SIZE; ++i) {
+        uint32_t grb = matrix[i];
+        if ((uint8_t)(grb >> 16) != ref_matrix[3 * i] || (uint8_t)(grb >> 24) != ref_matrix[3 * i + 1] ||
+            (uint8_t)(grb >> 8) != ref_matrix[3 * i + 2]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Varre as páginas a partir do cursor e envia as alteradas enquanto
+ *        houver crédito. O crédito cresce MIRROR_MAX_BYTES_PER_S por segundo,
+ *        até MIRROR_BURST_BYTES; uma página que não cabe fica para a próxima
+ *        chamada, sem bloquear.
+ */
+bool mirror_pump(const uint8_t *oled, const uint32_t *matrix, uint32_t now_ms) {
+    uint8_t delta[PAGE_MAX];
+    uint8_t frame[HEADER_LEN + RLE_MAX(PAGE_MAX) + 2];
+
+    if (!enabled) return false;
+
+    credit += (now_ms - last_ms) * MIRROR_MAX_BYTES_PER_S / 1000;
+    if (credit > MIRROR_BURST_BYTES) credit = MIRROR_BURST_BYTES;
+    last_ms = now_ms;
+
+    for (uint n = 0; n < NUM_PAGES; ++n) {
+        uint page = cursor;
+        bool key = !(synced & (1u << page));
+
+        if (!key && !page_changed(page, oled, matrix)) {
+            cursor = (cursor + 1) % NUM_PAGES;
+            continue;
+        }
+        if (credit < FRAME_COST(HEADER_LEN + RLE_MAX(PAGE_MAX))) {
+            stats.deferred++;
+            return true; // Continua desta página na próxima chamada
+        }
+        uint len = page_delta(page, oled, matrix, delta);
+        cursor = (cursor + 1) % NUM_PAGES;
+        if (len == 0) continue;
+
+        frame[0] = USB_PROTO_TYPE_MIRROR;
+        frame[1] = seq++;
+        frame[2] = page < OLED_PAGES ? MIRROR_SURFACE_OLED : MIRROR_SURFACE_MATRIX;
+        frame[3] = page < OLED_PAGES ? (uint8_t)page : 0;
+        frame[4] = key ? MIRROR_FLAG_KEY : 0;
+        uint size = HEADER_LEN + rle_encode(delta, len, &frame[HEADER_LEN]);
+        usb_proto_send_async(frame, size);
+
+        synced |= 1u << page;
+        credit -= FRAME_COST(size);
+        stats.pages++;
+        stats.bytes += size;
+    }
+    return false;
+}
+
+void mirror_get_stats(mirror_stats_t *out) {
+    *out = stats;
+}
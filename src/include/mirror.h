@@ -0,0 +1,43 @@
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Espelho do display OLED e da matriz de LEDs pelo protocolo USB. Cada
+// página alterada vai em um quadro USB_PROTO_TYPE_MIRROR:
+//   tipo, seq, superfície, página, flags, dados em RLE
+// Superfície MIRROR_SURFACE_OLED: página de 8 linhas do SSD1306, um byte por
+// coluna (bit 0 = linha de cima). MIRROR_SURFACE_MATRIX: página 0 com os
+// pixels da matriz em R, G, B, na ordem do buffer do PIO.
+// Os dados são o XOR com a página anterior; com MIRROR_FLAG_KEY, o XOR é com
+// zeros (página completa). RLE: n < 128 = n + 1 bytes literais;
+// n >= 128 = próximo byte repetido n - 126 vezes.
+#define MIRROR_SURFACE_OLED   0
+#define MIRROR_SURFACE_MATRIX 1
+#define MIRROR_FLAG_KEY       0x01
+
+/**
+ * @struct mirror_stats_t
+ * @brief Contadores do espelho.
+ */
+typedef struct {
+    uint32_t pages;       // Páginas enviadas
+    uint32_t bytes;       // Bytes de payload enviados
+    uint32_t deferred;    // Vezes em que o limite de banda adiou páginas
+} mirror_stats_t;
+
+// Liga o espelho; a próxima varredura envia todas as páginas completas
+void mirror_start(void);
+void mirror_stop(void);
+bool mirror_enabled(void);
+
+// Envia as páginas alteradas dentro do limite de banda, lendo os buffers no
+// lugar (oled = framebuffer sem o byte de controle, NULL antes do display_init).
+// Retorna true se ficaram páginas para a próxima chamada.
+bool mirror_pump(const uint8_t *oled, const uint32_t *matrix, uint32_t now_ms);
+
+void mirror_get_stats(mirror_stats_t *stats);
+
+#endif // MIRROR_H
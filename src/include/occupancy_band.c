@@ -0,0 +1,73 @@
+#include "occupancy_band.h"
+#include "config.h"
+
+_Static_assert(OCCUPANCY_BAND_ALMOST_FULL_PCT > 0 && OCCUPANCY_BAND_ALMOST_FULL_PCT < OCCUPANCY_BAND_FULL_PCT &&
+               OCCUPANCY_BAND_FULL_PCT <= 100, "faixas de ocupacao fora de ordem");
+_Static_assert(MAX_USERS < (1u << 12), "ocupacao e capacidade devem caber em 12 bits no instantaneo");
+
+static volatile uint8_t band = OCCUPANCY_BAND_EMPTY;   // Escrita só pelo núcleo de acesso
+static volatile uint32_t snapshot;                      // users | capacidade << 12 | faixa << 24: uma escrita atômica
+static uint16_t last_users = UINT16_MAX;                // Nenhuma ocupação classificada ainda
+static uint16_t last_capacity;
+static uint32_t transitions;
+
+// Menor ocupação que atinge pct da capacidade (arredonda para cima)
+static uint16_t threshold(uint16_t capacity, uint32_t pct) {
+    return (uint16_t)(((uint32_t)capacity * pct + 99) / 100);
+}
+
+/**
+ * @brief Classifica a ocupação. Subir de faixa é imediato; para descer, a
+ *        ocupação precisa ficar OCCUPANCY_BAND_HYSTERESIS_PCT abaixo do
+ *        limiar (ao menos uma pessoa), para que uma entrada e uma saída em
+ *        torno do limiar não façam os indicadores piscarem. Vazio é exato, e
+ *        lotado em 100% também: uma vaga aberta aparece na hora.
+ */
+occupancy_band_t occupancy_band_classify(occupancy_band_t current, uint16_t users, uint16_t capacity) {
+    uint16_t almost = threshold(capacity, OCCUPANCY_BAND_ALMOST_FULL_PCT);
+    uint16_t full = threshold(capacity, OCCUPANCY_BAND_FULL_PCT);
+    uint32_t hysteresis = threshold(capacity, OCCUPANCY_BAND_HYSTERESIS_PCT);
+
+    if (users == 0) return OCCUPANCY_BAND_EMPTY;
+    if (users >= full) return OCCUPANCY_BAND_FULL;
+    if (current == OCCUPANCY_BAND_FULL && OCCUPANCY_BAND_FULL_PCT < 100 && users + hysteresis >= full) {
+        return OCCUPANCY_BAND_FULL;
+    }
+    if (users >= almost) return OCCUPANCY_BAND_ALMOST_FULL;
+    if (current >= OCCUPANCY_BAND_ALMOST_FULL && users + hysteresis >= almost) return OCCUPANCY_BAND_ALMOST_FULL;
+    return OCCUPANCY_BAND_FREE;
+}
+
+bool occupancy_band_update(uint16_t users, uint16_t capacity, occupancy_band_t *out) {
+    occupancy_band_t current = (occupancy_band_t)band;
+
+    if (users != last_users || capacity != last_capacity) {
+        last_users = users;
+        last_capacity = capacity;
+        occupancy_band_t next = occupancy_band_classify(current, users, capacity);
+        snapshot = users | ((uint32_t)capacity << 12) | ((uint32_t)next << 24);
+        if (next != current) {
+            band = (uint8_t)next;
+            transitions++;
+            *out = next;
+            return true;
+        }
+    }
+    *out = current;
+    return false;
+}
+
+occupancy_band_t occupancy_band_current(void) {
+    return (occupancy_band_t)band;
+}
+
+occupancy_band_t occupancy_band_snapshot(uint16_t *users, uint16_t *capacity) {
+    uint32_t s = snapshot;
+    *users = (uint16_t)(s & 0xFFF);
+    *capacity = (uint16_t)((s >> 12) & 0xFFF);
+    return (occupancy_band_t)(s >> 24);
+}
+
+uint32_t occupancy_band_transitions(void) {
+    return transitions;
+}
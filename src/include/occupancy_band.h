@@ -0,0 +1,38 @@
+#ifndef OCCUPANCY_BAND_H
+#define OCCUPANCY_BAND_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Faixas de ocupação em porcentagem da capacidade, com histerese na descida
+// (OCCUPANCY_BAND_* em config.h). O núcleo de acesso classifica uma vez por
+// mudança de ocupação e publica ocupação e faixa juntas; o compositor das
+// saídas lê esse instantâneo uma vez por quadro em vez de refazer a conta.
+typedef enum {
+    OCCUPANCY_BAND_EMPTY,        // Ninguém
+    OCCUPANCY_BAND_FREE,         // Abaixo de OCCUPANCY_BAND_ALMOST_FULL_PCT
+    OCCUPANCY_BAND_ALMOST_FULL,  // Abaixo de OCCUPANCY_BAND_FULL_PCT
+    OCCUPANCY_BAND_FULL,
+    OCCUPANCY_NUM_BANDS
+} occupancy_band_t;
+
+// Faixa de users em capacity partindo de current (a histerese só segura a
+// descida). Pura: também usada pelos quadros de referência
+occupancy_band_t occupancy_band_classify(occupancy_band_t current, uint16_t users, uint16_t capacity);
+
+// Nova ocupação ou capacidade (só o núcleo de acesso; capacity = limite
+// rígido ativo da política). Sem mudança de nenhuma das duas não classifica.
+// true = a faixa mudou; *band recebe a faixa atual
+bool occupancy_band_update(uint16_t users, uint16_t capacity, occupancy_band_t *band);
+
+// Última faixa publicada (qualquer núcleo)
+occupancy_band_t occupancy_band_current(void);
+
+// Ocupação, capacidade e faixa da última publicação, lidas juntas (qualquer núcleo)
+occupancy_band_t occupancy_band_snapshot(uint16_t *users, uint16_t *capacity);
+
+// Transições publicadas desde o boot
+uint32_t occupancy_band_transitions(void);
+
+#endif // OCCUPANCY_BAND_H
@@ -0,0 +1,375 @@
+#include "policy.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#define MINUTES_PER_DAY   (24 * 60)
+#define HOUR_SLOTS        (MINUTES_PER_DAY / POLICY_SLOT_MINUTES)
+#define HOUR_SLOT_WORDS   ((HOUR_SLOTS + 31) / 32)
+
+_Static_assert(MINUTES_PER_DAY % POLICY_SLOT_MINUTES == 0, "fatia de horario deve dividir o dia");
+
+/**
+ * @struct policy_table_t
+ * @brief Tabela de decisão compilada: tudo que a avaliação consulta fica em
+ *        arrays planos indexados por grupo ou porta, sem percorrer as regras.
+ */
+typedef struct {
+    uint32_t hours[POLICY_MAX_GROUPS][HOUR_SLOT_WORDS]; // Um bit por fatia do dia
+    uint8_t reserve[POLICY_MAX_GROUPS];
+    uint32_t facility[POLICY_MAX_FACILITIES];
+    uint8_t facility_group[POLICY_MAX_FACILITIES];
+    uint8_t n_facilities;
+    uint32_t rate_interval_ms[POLICY_NUM_DOORS];        // 0 = porta sem limite de taxa
+    uint32_t rate_burst_ms[POLICY_NUM_DOORS];
+    uint16_t soft_limit;
+    uint16_t hard_limit;
+} policy_table_t;
+
+// Duas tabelas: policy_load() compila na inativa e troca o índice em seção
+// crítica. Todo leitor consulta tables[active] dentro da mesma seção crítica,
+// do índice ao último campo: a troca espera a leitura terminar, e a tabela em
+// leitura nunca é a inativa que a próxima atualização reescreve.
+static policy_table_t tables[2];
+static volatile uint8_t active = 0;
+static bool loading = false;
+
+// Estado dinâmico (não faz parte da tabela, sobrevive às trocas)
+static uint16_t group_occ[POLICY_MAX_GROUPS];
+static uint8_t group_fifo[MAX_USERS];      // Grupo de quem está dentro, em ordem de entrada
+static uint16_t fifo_head;
+static uint16_t fifo_count;
+static uint32_t rate_credit_ms[POLICY_NUM_DOORS];
+static uint32_t rate_last_ms[POLICY_NUM_DOORS];
+static uint16_t tod_base_min;
+static uint32_t tod_base_ms;
+static uint32_t budget_cycles;
+static policy_stats_t stats;
+
+MEM_BUDGET_ENTRY(policy, "Politica",
+                 sizeof(tables) + sizeof(group_occ) + sizeof(group_fifo) + sizeof(rate_credit_ms) +
+                 sizeof(rate_last_ms) + sizeof(stats),
+                 MEM_BUDGET_POLICY_BYTES);
+
+static const policy_rule_t default_rules[] = POLICY_DEFAULT_RULES;
+
+/**
+ * @brief Marca as fatias de [start, end) no mapa de horário, cruzando a meia-noite se end < start.
+ */
+static void hours_set(uint32_t *bits, uint16_t start, uint16_t end) {
+    uint slot = start / POLICY_SLOT_MINUTES;
+    uint end_slot = end / POLICY_SLOT_MINUTES;
+    do {
+        bits[slot / 32] |= 1u << (slot % 32);
+        slot = (slot + 1) % HOUR_SLOTS;
+    } while (slot != end_slot);
+}
+
+/**
+ * @brief Compila as regras compactas em uma tabela de decisão.
+ *
+ * @param rules Regras de entrada.
+ * @param n_rules Número de regras.
+ * @param t Tabela de saída.
+ * @return true se todas as regras são válidas. Caso contrário, false.
+ */
+static bool policy_compile(const policy_rule_t *rules, size_t n_rules, policy_table_t *t) {
+    uint8_t groups_with_hours = 0;
+    uint reserve_total = 0;
+
+    memset(t, 0, sizeof(*t));
+    t->soft_limit = MAX_USERS;
+    t->hard_limit = MAX_USERS;
+
+    for (size_t i = 0; i < n_rules; ++i) {
+        const policy_rule_t *r = &rules[i];
+        switch (r->type) {
+            case POLICY_RULE_LIMITS:
+                if (r->b == 0 || r->b > MAX_USERS || r->a > r->b) return false;
+                t->soft_limit = r->a;
+                t->hard_limit = r->b;
+                break;
+            case POLICY_RULE_GROUP:
+                if (r->target >= POLICY_MAX_GROUPS || t->n_facilities >= POLICY_MAX_FACILITIES) return false;
+                t->facility[t->n_facilities] = r->a;
+                t->facility_group[t->n_facilities] = r->target;
+                t->n_facilities++;
+                break;
+            case POLICY_RULE_HOURS:
+                if (r->target >= POLICY_MAX_GROUPS || r->a >= MINUTES_PER_DAY || r->b > MINUTES_PER_DAY) return false;
+                hours_set(t->hours[r->target], r->a, r->b % MINUTES_PER_DAY);
+                groups_with_hours |= 1u << r->target;
+                break;
+            case POLICY_RULE_RESERVE:
+                if (r->target >= POLICY_MAX_GROUPS) return false;
+                t->reserve[r->target] = (uint8_t)r->a;
+                break;
+            case POLICY_RULE_RATE:
+                if (r->target >= POLICY_NUM_DOORS || r->a == 0 || r->b == 0) return false;
+                t->rate_burst_ms[r->target] = (uint32_t)r->b * 1000;
+                t->rate_interval_ms[r->target] = t->rate_burst_ms[r->target] / r->a;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    for (uint g = 0; g < POLICY_MAX_GROUPS; ++g) {
+        if (!(groups_with_hours & (1u << g))) {
+            memset(t->hours[g], 0xFF, sizeof(t->hours[g]));
+        }
+        reserve_total += t->reserve[g];
+    }
+    return reserve_total <= t->hard_limit;
+}
+
+/**
+ * @brief Compila e ativa um novo conjunto de regras.
+ *
+ * A compilação acontece na tabela inativa, fora de seção crítica; a troca é
+ * a escrita de um único índice. Uma avaliação em andamento termina com a tabela
+ * antiga e a próxima já usa a nova.
+ *
+ * @param rules Regras no formato compacto.
+ * @param n_rules Número de regras.
+ * @return true se as regras foram ativadas. Com regras inválidas (ou outra carga
+ *         em andamento) a tabela ativa é mantida e retorna false.
+ */
+bool policy_load(const policy_rule_t *rules, size_t n_rules) {
+    taskENTER_CRITICAL();
+    bool busy = loading;
+    loading = true;
+    taskEXIT_CRITICAL();
+    if (busy) return false;
+
+    uint8_t next = active ^ 1;
+    bool ok = policy_compile(rules, n_rules, &tables[next]);
+    if (ok) {
+        taskENTER_CRITICAL();
+        active = next;
+        stats.table_version++;
+        // Taxa recomeça com o crédito cheio da nova regra
+        for (uint d = 0; d < POLICY_NUM_DOORS; ++d) {
+            rate_credit_ms[d] = tables[next].rate_burst_ms[d];
+        }
+        taskEXIT_CRITICAL();
+    }
+    loading = false;
+    return ok;
+}
+
+/**
+ * @brief Troca os limites suave e rígido (capacidade) sem recompilar as regras:
+ *        copia a tabela ativa para a inativa, altera os limites e troca o
+ *        índice, como em policy_load().
+ *
+ * @param soft_limit Ocupação a partir da qual a admissão vem com aviso.
+ * @param hard_limit Capacidade (1..MAX_USERS, o tamanho do semáforo de vagas).
+ * @return true se os limites foram ativados.
+ */
+bool policy_set_limits(uint16_t soft_limit, uint16_t hard_limit) {
+    if (hard_limit == 0 || hard_limit > MAX_USERS || soft_limit > hard_limit) return false;
+
+    taskENTER_CRITICAL();
+    bool busy = loading;
+    loading = true;
+    taskEXIT_CRITICAL();
+    if (busy) return false;
+
+    uint8_t next = active ^ 1;
+    uint reserve_total = 0;
+    tables[next] = tables[active];
+    for (uint g = 0; g < POLICY_MAX_GROUPS; ++g) {
+        reserve_total += tables[next].reserve[g];
+    }
+    bool ok = reserve_total <= hard_limit;
+    if (ok) {
+        tables[next].soft_limit = soft_limit;
+        tables[next].hard_limit = hard_limit;
+        taskENTER_CRITICAL();
+        active = next;
+        stats.table_version++;
+        taskEXIT_CRITICAL();
+    }
+    loading = false;
+    return ok;
+}
+
+void policy_get_limits(uint16_t *soft_limit, uint16_t *hard_limit) {
+    taskENTER_CRITICAL();
+    const policy_table_t *t = &tables[active];
+    *soft_limit = t->soft_limit;
+    *hard_limit = t->hard_limit;
+    taskEXIT_CRITICAL();
+}
+
+void policy_init(uint16_t occupancy) {
+    memset(group_occ, 0, sizeof(group_occ));
+    memset(group_fifo, POLICY_GROUP_DEFAULT, sizeof(group_fifo));
+    memset(&stats, 0, sizeof(stats));
+    fifo_head = 0;
+    fifo_count = occupancy < MAX_USERS ? occupancy : MAX_USERS;
+    group_occ[POLICY_GROUP_DEFAULT] = fifo_count;
+
+    tod_base_min = POLICY_CLOCK_START_MIN;
+    tod_base_ms = to_ms_since_boot(get_absolute_time());
+    budget_cycles = POLICY_EVAL_BUDGET_US * (clock_get_hz(clk_sys) / 1000000);
+
+    if (!policy_load(default_rules, sizeof(default_rules) / sizeof(default_rules[0]))) {
+        printf("Politica: regras padrao invalidas, usando apenas o limite de %u.\n", MAX_USERS);
+        policy_load(NULL, 0);
+    }
+}
+
+bool policy_clock_listener(clock_phase_t phase, uint32_t sys_hz) {
+    if (phase == CLOCK_PHASE_RETIME) {
+        budget_cycles = POLICY_EVAL_BUDGET_US * (sys_hz / 1000000);
+    }
+    return true;
+}
+
+/**
+ * @brief Grupo do código de instalação na tabela ativa. A busca percorre no
+ *        máximo POLICY_MAX_FACILITIES entradas, dentro da seção crítica.
+ */
+uint8_t policy_group_for_facility(uint32_t facility) {
+    uint8_t group = POLICY_GROUP_DEFAULT;
+
+    taskENTER_CRITICAL();
+    const policy_table_t *t = &tables[active];
+    for (uint i = 0; i < t->n_facilities; ++i) {
+        if (t->facility[i] == facility) group = t->facility_group[i];
+    }
+    taskEXIT_CRITICAL();
+    return group;
+}
+
+void policy_set_time_of_day(uint16_t minute) {
+    taskENTER_CRITICAL();
+    tod_base_min = minute % MINUTES_PER_DAY;
+    tod_base_ms = to_ms_since_boot(get_absolute_time());
+    taskEXIT_CRITICAL();
+}
+
+uint16_t policy_time_of_day(uint32_t now_ms) {
+    return (uint16_t)((tod_base_min + (now_ms - tod_base_ms) / 60000) % MINUTES_PER_DAY);
+}
+
+/**
+ * @brief Ciclos decorridos entre duas leituras do SysTick (contador
+ *        decrescente de 24 bits, recarregado pelo FreeRTOS a cada tick).
+ */
+static inline uint32_t systick_elapsed(uint32_t start, uint32_t end) {
+    return start >= end ? start - end : start + (systick_hw->rvr + 1) - end;
+}
+
+/**
+ * @brief Avalia uma tentativa de entrada contra a tabela ativa.
+ *
+ * Todas as condições são calculadas sempre, com custo fixo (um laço de
+ * POLICY_MAX_GROUPS iterações); a recusa de maior precedência é escolhida
+ * pelo bit menos significativo da máscara de falhas.
+ *
+ * @param group Grupo de quem tenta entrar.
+ * @param door Porta de origem (leitor, POLICY_DOOR_BEAM, POLICY_DOOR_BUTTON ou POLICY_DOOR_HOST).
+ * @param occupancy Ocupação total atual.
+ * @param now_ms Instante da tentativa.
+ * @return Decisão.
+ */
+policy_decision_t policy_evaluate(uint8_t group, uint8_t door, uint16_t occupancy, uint32_t now_ms) {
+    if (group >= POLICY_MAX_GROUPS) group = POLICY_GROUP_DEFAULT;
+    if (door >= POLICY_NUM_DOORS) door = POLICY_DOOR_BUTTON;
+
+    taskENTER_CRITICAL();
+    uint32_t start = systick_hw->cvr;
+    const policy_table_t *t = &tables[active];
+
+    uint slot = policy_time_of_day(now_ms) / POLICY_SLOT_MINUTES;
+    bool ok_hours = (t->hours[group][slot / 32] >> (slot % 32)) & 1u;
+
+    // Crédito da porta em ms, limitado à rajada configurada
+    uint32_t credit = rate_credit_ms[door] + (now_ms - rate_last_ms[door]);
+    if (credit > t->rate_burst_ms[door]) credit = t->rate_burst_ms[door];
+    rate_credit_ms[door] = credit;
+    rate_last_ms[door] = now_ms;
+    bool ok_rate = credit >= t->rate_interval_ms[door];
+
+    // Vagas reservadas ainda livres dos outros grupos
+    uint reserved_free = 0;
+    for (uint g = 0; g < POLICY_MAX_GROUPS; ++g) {
+        int free = (int)t->reserve[g] - (int)group_occ[g];
+        reserved_free += (free > 0 ? (uint)free : 0) * (g != group);
+    }
+    bool ok_full = occupancy < t->hard_limit;
+    bool ok_reserve = occupancy + reserved_free < t->hard_limit;
+
+    uint32_t fail = (uint32_t)!ok_hours | (uint32_t)!ok_rate << 1 | (uint32_t)!ok_full << 2 | (uint32_t)!ok_reserve << 3;
+    policy_decision_t decision;
+    if (fail) {
+        decision = (policy_decision_t)(POLICY_DENY_SCHEDULE + __builtin_ctz(fail));
+        stats.denied++;
+    } else {
+        decision = occupancy >= t->soft_limit ? POLICY_ALLOW_WARN : POLICY_ALLOW;
+        rate_credit_ms[door] = credit - t->rate_interval_ms[door];
+    }
+
+    uint32_t cycles = systick_elapsed(start, systick_hw->cvr);
+    stats.evaluations++;
+    if (cycles > stats.worst_cycles) stats.worst_cycles = cycles;
+    if (cycles > budget_cycles) stats.over_budget++;
+    taskEXIT_CRITICAL();
+
+    return decision;
+}
+
+void policy_commit_entry(uint8_t group) {
+    if (group >= POLICY_MAX_GROUPS) group = POLICY_GROUP_DEFAULT;
+    taskENTER_CRITICAL();
+    if (fifo_count < MAX_USERS) {
+        group_fifo[(fifo_head + fifo_count) % MAX_USERS] = group;
+        fifo_count++;
+        group_occ[group]++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Registra uma saída. As saídas não identificam a pessoa, então são
+ *        atribuídas ao grupo da entrada mais antiga ainda dentro.
+ */
+void policy_commit_exit(void) {
+    taskENTER_CRITICAL();
+    if (fifo_count > 0) {
+        group_occ[group_fifo[fifo_head]]--;
+        fifo_head = (fifo_head + 1) % MAX_USERS;
+        fifo_count--;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void policy_reset(void) {
+    taskENTER_CRITICAL();
+    memset(group_occ, 0, sizeof(group_occ));
+    fifo_head = 0;
+    fifo_count = 0;
+    taskEXIT_CRITICAL();
+}
+
+void policy_get_stats(policy_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+const char *policy_decision_str(policy_decision_t decision) {
+    switch (decision) {
+        case POLICY_ALLOW:         return "admitido";
+        case POLICY_ALLOW_WARN:    return "admitido (quase lotado)";
+        case POLICY_DENY_SCHEDULE: return "fora do horario";
+        case POLICY_DENY_RATE:     return "limite de taxa da porta";
+        case POLICY_DENY_FULL:     return "lotado";
+        case POLICY_DENY_RESERVED: return "vagas reservadas";
+        default:                   return "?";
+    }
+}
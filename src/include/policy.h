@@ -0,0 +1,97 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "pico/stdlib.h"
+#include "clock_mgr.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Portas avaliadas pela política: leitores de crachá 0..POLICY_MAX_READERS-1,
+// mais os sensores de feixe, o botão local e as entradas do protocolo USB
+#define POLICY_MAX_READERS 4
+#define POLICY_DOOR_BEAM   POLICY_MAX_READERS
+#define POLICY_DOOR_BUTTON (POLICY_MAX_READERS + 1)
+#define POLICY_DOOR_HOST   (POLICY_MAX_READERS + 2)
+#define POLICY_NUM_DOORS   (POLICY_MAX_READERS + 3)
+
+#define POLICY_GROUP_DEFAULT 0  // Grupo de quem entra sem crachá ou com instalação não mapeada
+
+// Tipos de regra do formato compacto
+typedef enum {
+    POLICY_RULE_LIMITS = 1,  // a = limite suave (aviso), b = limite rígido
+    POLICY_RULE_GROUP,       // target = grupo, a = código de instalação do crachá
+    POLICY_RULE_HOURS,       // target = grupo, a = minuto inicial, b = minuto final (pode cruzar a meia-noite)
+    POLICY_RULE_RESERVE,     // target = grupo, a = vagas reservadas para o grupo
+    POLICY_RULE_RATE,        // target = porta, a = admissões, b = período em segundos
+} policy_rule_type_t;
+
+/**
+ * @struct policy_rule_t
+ * @brief Regra no formato compacto (6 bytes), compilada por policy_load().
+ *
+ * Um grupo sem regra POLICY_RULE_HOURS pode entrar a qualquer hora; várias
+ * regras de horário para o mesmo grupo se somam.
+ */
+typedef struct {
+    uint8_t type;    // policy_rule_type_t
+    uint8_t target;  // Grupo ou porta, conforme o tipo
+    uint16_t a;
+    uint16_t b;
+} policy_rule_t;
+
+// Resultado da avaliação, em ordem de precedência das recusas
+typedef enum {
+    POLICY_ALLOW,            // Admitido
+    POLICY_ALLOW_WARN,       // Admitido dentro da faixa de aviso (acima do limite suave)
+    POLICY_DENY_SCHEDULE,    // Fora do horário do grupo
+    POLICY_DENY_RATE,        // Limite de admissões por minuto da porta
+    POLICY_DENY_FULL,        // Limite rígido atingido
+    POLICY_DENY_RESERVED,    // Vagas restantes reservadas para outros grupos
+} policy_decision_t;
+
+/**
+ * @struct policy_stats_t
+ * @brief Contadores e tempo de avaliação.
+ */
+typedef struct {
+    uint32_t evaluations;
+    uint32_t denied;
+    uint32_t worst_cycles;     // Pior tempo de uma avaliação, em ciclos de CPU
+    uint32_t over_budget;      // Avaliações acima de POLICY_EVAL_BUDGET_US
+    uint32_t table_version;    // Incrementado a cada policy_load() aceito
+} policy_stats_t;
+
+// Carrega as regras padrão de config.h e a ocupação restaurada (atribuída ao grupo padrão)
+void policy_init(uint16_t occupancy);
+
+// Compila e ativa um novo conjunto de regras de forma atômica (false = regras inválidas, tabela mantida)
+bool policy_load(const policy_rule_t *rules, size_t n_rules);
+
+// Troca só os limites da tabela ativa, mantendo as demais regras
+// (false = limites inválidos ou menores que as reservas, tabela mantida)
+bool policy_set_limits(uint16_t soft_limit, uint16_t hard_limit);
+void policy_get_limits(uint16_t *soft_limit, uint16_t *hard_limit);
+
+// Grupo de um crachá pelo código de instalação
+uint8_t policy_group_for_facility(uint32_t facility);
+
+// Avalia uma tentativa de entrada; em caso de admissão consome o limite de taxa da porta
+policy_decision_t policy_evaluate(uint8_t group, uint8_t door, uint16_t occupancy, uint32_t now_ms);
+
+// Registra a admissão, a saída (casada com a entrada mais antiga) e o reset
+void policy_commit_entry(uint8_t group);
+void policy_commit_exit(void);
+void policy_reset(void);
+
+// Hora do dia (minutos desde a meia-noite); sem RTC, parte de POLICY_CLOCK_START_MIN no boot
+void policy_set_time_of_day(uint16_t minute);
+uint16_t policy_time_of_day(uint32_t now_ms);
+
+void policy_get_stats(policy_stats_t *stats);
+
+// Ouvinte do clock_mgr (registrado no main): orçamento da avaliação em ciclos
+bool policy_clock_listener(clock_phase_t phase, uint32_t sys_hz);
+
+const char *policy_decision_str(policy_decision_t decision);
+
+#endif // POLICY_H
@@ -0,0 +1,93 @@
+#include "profiler.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "hardware/timer.h"
+#include <inttypes.h>
+
+/**
+ * @struct isr_stats_t
+ * @brief Tempo de uma ISR. Escrito só pela própria ISR (um núcleo); a leitura
+ *        pode ver um campo defasado, o que é aceitável para diagnóstico.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+} isr_stats_t;
+
+static const char *const isr_names[PROFILER_NUM_ISRS] = { "Botoes", "Feixes", "Wiegand" };
+
+volatile uint32_t profiler_context_switches[configNUM_CORES];
+static isr_stats_t isr_stats[PROFILER_NUM_ISRS];
+
+// Leitura anterior, para a CPU de cada tarefa no intervalo entre consultas
+static TaskStatus_t status[PROFILER_MAX_TASKS];
+static uint32_t last_task_runtime[PROFILER_MAX_TASKS];  // Indexado por xTaskNumber
+static uint32_t last_total_runtime;
+static uint32_t last_switches[configNUM_CORES];
+
+MEM_BUDGET_ENTRY(profiler, "Perfil",
+                 sizeof(isr_stats) + sizeof(status) + sizeof(last_task_runtime) + sizeof(last_switches),
+                 MEM_BUDGET_PROFILER_BYTES);
+
+uint32_t profiler_run_time_counter(void) {
+    return time_us_32();
+}
+
+void profiler_isr_record(profiler_isr_t isr, uint32_t start_us) {
+    uint32_t us = time_us_32() - start_us;
+    isr_stats_t *s = &isr_stats[isr];
+
+    s->count++;
+    s->total_us += us;
+    if (us > s->max_us) s->max_us = us;
+}
+
+/**
+ * @brief Imprime o perfil de execução.
+ *
+ * A CPU de cada tarefa é a fração do intervalo desde a consulta anterior em
+ * que ela esteve executando, em porcentagem de um núcleo (a soma das tarefas
+ * dá 100% por núcleo, incluindo as tarefas idle). Os contadores de 32 bits em
+ * microssegundos dão voltas a cada ~71 min; as diferenças continuam corretas
+ * desde que as consultas sejam mais frequentes que isso.
+ */
+void profiler_print(void) {
+    uint32_t total;
+    UBaseType_t n = uxTaskGetSystemState(status, PROFILER_MAX_TASKS, &total);
+    uint32_t elapsed = total - last_total_runtime;
+
+    last_total_runtime = total;
+    if (elapsed == 0) elapsed = 1;
+
+    printf("Tarefa       Nucleos  CPU%%   Folga(palavras)\n");
+    for (UBaseType_t i = 0; i < n; ++i) {
+        const TaskStatus_t *t = &status[i];
+        uint32_t run = t->ulRunTimeCounter;
+        if (t->xTaskNumber < PROFILER_MAX_TASKS) {
+            run -= last_task_runtime[t->xTaskNumber];
+            last_task_runtime[t->xTaskNumber] = t->ulRunTimeCounter;
+        }
+        uint32_t pct_x10 = (uint32_t)((uint64_t)run * 1000 / elapsed);
+#if configUSE_CORE_AFFINITY
+        uint32_t nucleos = (uint32_t)t->uxCoreAffinityMask;
+#else
+        uint32_t nucleos = 1; // Build nativa (um núcleo)
+#endif
+        printf("%-12s %7" PRIx32 " %3" PRIu32 ".%" PRIu32 " %8" PRIu32 "\n", t->pcTaskName, nucleos,
+               pct_x10 / 10, pct_x10 % 10, (uint32_t)t->usStackHighWaterMark);
+    }
+
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        uint32_t sw = profiler_context_switches[c];
+        printf("Nucleo %u: %" PRIu32 " trocas de contexto (%" PRIu32
+               " desde a ultima consulta)\n", c, sw, sw - last_switches[c]);
+        last_switches[c] = sw;
+    }
+
+    for (uint i = 0; i < PROFILER_NUM_ISRS; ++i) {
+        const isr_stats_t *s = &isr_stats[i];
+        printf("ISR %-8s %" PRIu32 " execucoes, media %" PRIu32 " us, max %" PRIu32 " us\n", isr_names[i], s->count,
+               s->count ? s->total_us / s->count : 0, s->max_us);
+    }
+}
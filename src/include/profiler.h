@@ -0,0 +1,28 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+// Rotinas de interrupção cronometradas
+typedef enum {
+    PROFILER_ISR_BUTTONS,   // gpio_callback_internal (botões)
+    PROFILER_ISR_BEAM,      // Sensores de feixe
+    PROFILER_ISR_WIEGAND,   // Fim de quadro dos leitores de crachá
+    PROFILER_NUM_ISRS,
+} profiler_isr_t;
+
+// Trocas de contexto por núcleo, incrementadas por traceTASK_SWITCHED_IN (FreeRTOSConfig.h)
+extern volatile uint32_t profiler_context_switches[];
+
+// Contador de tempo de execução do kernel: timer de 1 MHz do RP2040
+uint32_t profiler_run_time_counter(void);
+
+// Registra a duração de uma execução da ISR (medida com time_us_32)
+void profiler_isr_record(profiler_isr_t isr, uint32_t start_us);
+
+// Imprime CPU por tarefa desde a última consulta, trocas de contexto,
+// folga de stack e tempo das ISRs
+void profiler_print(void);
+
+#endif // PROFILER_H
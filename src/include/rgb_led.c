@@ -1,41 +1,214 @@
-#include "config.h" 
+#include "config.h"
+#include "mem_budget.h"
 #include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
 #include <stdint.h>
-#include "rgb_led.h" 
+#include "rgb_led.h"
 
+#define SLICE_RG_B  pwm_gpio_to_slice_num(LED_RED_PIN)    // Vermelho e azul no mesmo slice
+#define SLICE_G     pwm_gpio_to_slice_num(LED_GREEN_PIN)  // Verde, junto com o buzzer
+
+_Static_assert(LED_RED_PIN / 2 == LED_BLUE_PIN / 2,
+               "vermelho e azul devem dividir um slice de PWM");
+
+static const rgb_color_t off = { 0, 0, 0 };
+
+/**
+ * @struct rgb_anim_t
+ * @brief Animação em curso, avançada pela IRQ de wrap de RGB_TIMER_SLICE.
+ *        Cada segmento é uma rampa linear from -> to em steps passos.
+ */
+typedef struct {
+    rgb_wave_t wave;
+    rgb_color_t target;
+    rgb_color_t from, to;       // Segmento corrente
+    uint16_t step, steps;
+    uint8_t segment, segments;
+} rgb_anim_t;
+
+static rgb_anim_t anim;
+static rgb_color_t shown;           // Última cor aplicada ao PWM
+static uint16_t green_top = RGB_PWM_WRAP;   // Wrap do slice do verde (o do tom, com o buzzer ligado)
+static bool borrowed;               // Slice do verde com o período do buzzer
+static bool ready;
+
+MEM_BUDGET_ENTRY(rgb_led, "LED RGB",
+                 sizeof(anim) + sizeof(shown) + sizeof(green_top) + sizeof(borrowed) + sizeof(ready),
+                 MEM_BUDGET_RGB_LED_BYTES);
+
+/**
+ * @brief Nível de PWM com gama 2 (c^2), proporcional ao wrap do slice.
+ */
+static uint16_t level(uint8_t c, uint16_t top) {
+    return (uint16_t)((uint32_t)c * c * ((uint32_t)top + 1) / (255u * 255u));
+}
+
+static void apply(rgb_color_t c) {
+    shown = c;
+    pwm_set_gpio_level(LED_RED_PIN, level(c.r, RGB_PWM_WRAP));
+    pwm_set_gpio_level(LED_BLUE_PIN, level(c.b, RGB_PWM_WRAP));
+    pwm_set_gpio_level(LED_GREEN_PIN, level(c.g, green_top));
+}
+
+static rgb_color_t lerp(rgb_color_t a, rgb_color_t b, uint16_t step, uint16_t steps) {
+    rgb_color_t c = {
+        (uint8_t)(a.r + ((int32_t)b.r - a.r) * step / steps),
+        (uint8_t)(a.g + ((int32_t)b.g - a.g) * step / steps),
+        (uint8_t)(a.b + ((int32_t)b.b - a.b) * step / steps),
+    };
+    return c;
+}
+
+/**
+ * @brief Extremos do segmento corrente. Piscar alterna trechos parados
+ *        (apagado, alvo); respirar alterna rampas até apagado e de volta.
+ */
+static void segment_start(void) {
+    bool odd = anim.segment & 1;
+
+    switch (anim.wave) {
+        case RGB_WAVE_FADE:
+            anim.from = shown;
+            anim.to = anim.target;
+            break;
+        case RGB_WAVE_BLINK:
+            anim.from = anim.to = odd ? anim.target : off;
+            break;
+        case RGB_WAVE_BREATHE:
+            anim.from = odd ? off : (anim.segment ? anim.target : shown);
+            anim.to = odd ? anim.target : off;
+            break;
+    }
+    anim.step = 0;
+}
+
+static void timer_stop(void) {
+    pwm_set_irq_enabled(RGB_TIMER_SLICE, false);
+    pwm_set_enabled(RGB_TIMER_SLICE, false);
+    pwm_clear_irq(RGB_TIMER_SLICE);
+}
+
+/**
+ * @brief Um passo da animação por wrap do temporizador. No último segmento
+ *        aplica o alvo e para o temporizador.
+ */
+static void rgb_led_step_isr(void) {
+    pwm_clear_irq(RGB_TIMER_SLICE);
+    if (++anim.step >= anim.steps) {
+        if (++anim.segment >= anim.segments) {
+            apply(anim.target);
+            timer_stop();
+            return;
+        }
+        segment_start();
+    }
+    apply(lerp(anim.from, anim.to, anim.step, anim.steps));
+}
 
 /**
- * @brief Inicializa os pinos do LED RGB como saídas digitais.
- *        Define os LEDs inicialmente como desligados.
+ * @brief Divisor de um slice do LED para RGB_PWM_HZ com wrap RGB_PWM_WRAP
+ *        (em 1/16, como o divisor fracionário do PWM).
+ */
+static void led_slice_timing(uint slice, uint32_t sys_hz) {
+    uint32_t div16 = (uint32_t)((uint64_t)sys_hz * 16 / ((RGB_PWM_WRAP + 1u) * RGB_PWM_HZ));
+    if (div16 < 16) div16 = 16;
+    if (div16 > 255 * 16) div16 = 255 * 16;
+    pwm_set_clkdiv_int_frac(slice, (uint8_t)(div16 / 16), (uint8_t)(div16 % 16));
+    pwm_set_wrap(slice, RGB_PWM_WRAP);
+}
+
+static void timer_slice_timing(uint32_t sys_hz) {
+    pwm_set_clkdiv_int_frac(RGB_TIMER_SLICE, RGB_TIMER_DIV, 0);
+    pwm_set_wrap(RGB_TIMER_SLICE, (uint16_t)(sys_hz / (RGB_TIMER_DIV * RGB_STEP_HZ) - 1));
+}
+
+/**
+ * @brief Coloca os pinos do LED RGB no PWM (apagados) e instala a IRQ de
+ *        wrap no núcleo atual. RGB_TIMER_SLICE só conta: os pinos dele
+ *        ficam com outra função.
  */
 void rgb_led_init() {
-    gpio_init(LED_RED_PIN);
-    gpio_set_dir(LED_RED_PIN, GPIO_OUT);
-    gpio_put(LED_RED_PIN, 0); // Desligado
-
-    gpio_init(LED_GREEN_PIN);
-    gpio_set_dir(LED_GREEN_PIN, GPIO_OUT);
-    gpio_put(LED_GREEN_PIN, 0); // Desligado
-
-    gpio_init(LED_BLUE_PIN);
-    gpio_set_dir(LED_BLUE_PIN, GPIO_OUT);
-    gpio_put(LED_BLUE_PIN, 0); // Desligado
-
-    printf("LED RGB (GPIO) inicializado.\n");
-}
-
-void rgb_led_set(uint8_t actual_num_users, uint8_t max_capacity) {
-    if (actual_num_users == 0) {
-        // Nenhum usuário logado: Azul
-        gpio_put(LED_RED_PIN, 0); gpio_put(LED_GREEN_PIN, 0); gpio_put(LED_BLUE_PIN, 1);
-    } else if (actual_num_users == max_capacity) {
-        // Capacidade máxima: Vermelho
-        gpio_put(LED_RED_PIN, 1); gpio_put(LED_GREEN_PIN, 0); gpio_put(LED_BLUE_PIN, 0);
-    } else if (actual_num_users == max_capacity - 1) {
-        // Apenas 1 vaga restante: Amarelo (R+G)
-        gpio_put(LED_RED_PIN, 1); gpio_put(LED_GREEN_PIN, 1); gpio_put(LED_BLUE_PIN, 0);
-    } else { // Usuários ativos (de 1 a MAX-2)
-        // Verde
-        gpio_put(LED_RED_PIN, 0); gpio_put(LED_GREEN_PIN, 1); gpio_put(LED_BLUE_PIN, 0);
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+
+    gpio_set_function(LED_RED_PIN, GPIO_FUNC_PWM);
+    gpio_set_function(LED_GREEN_PIN, GPIO_FUNC_PWM);
+    gpio_set_function(LED_BLUE_PIN, GPIO_FUNC_PWM);
+    led_slice_timing(SLICE_RG_B, sys_hz);
+    if (!borrowed) led_slice_timing(SLICE_G, sys_hz);
+    timer_slice_timing(sys_hz);
+    apply(off);
+    pwm_set_enabled(SLICE_RG_B, true);
+    pwm_set_enabled(SLICE_G, true);
+
+    timer_stop();
+    irq_set_exclusive_handler(PWM_IRQ_WRAP, rgb_led_step_isr);
+    irq_set_enabled(PWM_IRQ_WRAP, true);
+    ready = true;
+
+    printf("LED RGB (PWM) inicializado.\n");
+}
+
+void rgb_led_animate(rgb_color_t target, uint16_t duration_ms, rgb_wave_t wave, uint8_t repeats) {
+    if (!ready) return;
+
+    // Mesmo núcleo da IRQ: com ela desligada o passo não roda no meio da troca
+    timer_stop();
+    uint32_t steps = (uint32_t)duration_ms * RGB_STEP_HZ / 1000;
+    anim.wave = wave;
+    anim.target = target;
+    anim.steps = (uint16_t)(steps ? (steps > UINT16_MAX ? UINT16_MAX : steps) : 1);
+    anim.segment = 0;
+    anim.segments = wave == RGB_WAVE_FADE ? 1 : 2 * (repeats ? repeats : 1);
+    segment_start();
+    apply(anim.from);
+
+    pwm_set_irq_enabled(RGB_TIMER_SLICE, true);
+    pwm_set_enabled(RGB_TIMER_SLICE, true);
+}
+
+/**
+ * @brief Transição para a cor da faixa; ao lotar, o vermelho também pisca
+ *        RGB_FULL_BLINKS vezes. Chamada só nas mudanças de faixa.
+ */
+void rgb_led_show_band(occupancy_band_t band) {
+    static const rgb_color_t band_color[OCCUPANCY_NUM_BANDS] = {
+        [OCCUPANCY_BAND_EMPTY]       = { 0, 0, 255 },
+        [OCCUPANCY_BAND_FREE]        = { 0, 255, 0 },
+        [OCCUPANCY_BAND_ALMOST_FULL] = { 255, 110, 0 },
+        [OCCUPANCY_BAND_FULL]        = { 255, 0, 0 },
+    };
+    if (band >= OCCUPANCY_NUM_BANDS) return;
+
+    if (band == OCCUPANCY_BAND_FULL) {
+        rgb_led_animate(band_color[band], RGB_BLINK_MS, RGB_WAVE_BLINK, RGB_FULL_BLINKS);
+    } else {
+        rgb_led_animate(band_color[band], RGB_FADE_MS, RGB_WAVE_FADE, 1);
+    }
+}
+
+void rgb_led_share_slice(uint16_t buzzer_wrap) {
+    borrowed = buzzer_wrap != 0;
+    if (borrowed) {
+        green_top = buzzer_wrap;
+    } else {
+        green_top = RGB_PWM_WRAP;
+        led_slice_timing(SLICE_G, clock_get_hz(clk_sys));
     }
-}
\ No newline at end of file
+    if (ready) pwm_set_gpio_level(LED_GREEN_PIN, level(shown.g, green_top));
+}
+
+/**
+ * @brief Ouvinte do clock_mgr: refaz os divisores do LED e do temporizador
+ *        para o mesmo RGB_PWM_HZ e RGB_STEP_HZ. Com o tom ligado, o slice do
+ *        verde é do buzzer, que o recalcula no seu ouvinte.
+ */
+bool rgb_led_clock_listener(clock_phase_t phase, uint32_t sys_hz) {
+    if (phase == CLOCK_PHASE_RETIME && ready) {
+        led_slice_timing(SLICE_RG_B, sys_hz);
+        if (!borrowed) led_slice_timing(SLICE_G, sys_hz);
+        timer_slice_timing(sys_hz);
+    }
+    return true;
+}
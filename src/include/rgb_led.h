@@ -2,10 +2,42 @@
 #define RGB_LED_H
 
 #include "pico/stdlib.h"
-#include "config.h" 
+#include "config.h"
+#include "clock_mgr.h"
+#include "occupancy_band.h"
 #include <stdint.h>
 
+// LED RGB em PWM de hardware. Uma animação (cor alvo, duração e forma de onda)
+// avança na IRQ de wrap de um slice usado só como temporizador
+// (RGB_TIMER_SLICE, RGB_STEP_HZ passos por segundo); terminada a animação, o
+// temporizador para e o LED fica na cor final sem nenhuma IRQ. A IRQ é
+// habilitada no núcleo que chama rgb_led_init() e as animações devem ser
+// pedidas nesse mesmo núcleo.
+
+typedef struct {
+    uint8_t r, g, b;    // Intensidade linear; a correção de gama é aplicada no PWM
+} rgb_color_t;
+
+typedef enum {
+    RGB_WAVE_FADE,      // Rampa da cor atual até o alvo em duration_ms
+    RGB_WAVE_BLINK,     // Apagado e alvo alternados a cada duration_ms, repeats vezes; termina no alvo
+    RGB_WAVE_BREATHE,   // Rampas até apagado e de volta ao alvo em duration_ms cada, repeats vezes
+} rgb_wave_t;
+
 void rgb_led_init(void);
-void rgb_led_set(uint8_t actual_num_users, uint8_t max_capacity);
 
-#endif // RGB_LED_H
\ No newline at end of file
+// Transição para a cor da faixa de ocupação (azul vazio, verde com vagas,
+// âmbar quase cheio, vermelho lotado)
+void rgb_led_show_band(occupancy_band_t band);
+
+// Substitui a animação em curso
+void rgb_led_animate(rgb_color_t target, uint16_t duration_ms, rgb_wave_t wave, uint8_t repeats);
+
+// O verde divide o slice com o tom do buzzer (canal A): o buzzer informa o
+// wrap do tom ligado (0 = tom desligado, o slice volta ao período do LED)
+void rgb_led_share_slice(uint16_t buzzer_wrap);
+
+// Ouvinte do clock_mgr (registrado no main): divisores dos slices do LED e do temporizador
+bool rgb_led_clock_listener(clock_phase_t phase, uint32_t sys_hz);
+
+#endif // RGB_LED_H
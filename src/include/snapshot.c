@@ -0,0 +1,61 @@
+#include "snapshot.h"
+#include "config.h"
+#include "event_journal.h"
+#include "hardware/watchdog.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Scratch 0..2 sobrevivem a um reset por watchdog (4..7 são usados pelo bootrom)
+#define SNAPSHOT_SCRATCH_MAGIC  0
+#define SNAPSHOT_SCRATCH_COUNT  1
+#define SNAPSHOT_SCRATCH_CHECK  2
+#define SNAPSHOT_MAGIC          0x4F435550u // "OCUP"
+
+/**
+ * @brief Guarda a ocupação nos registradores scratch do watchdog.
+ *        São poucas escritas de registrador, baratas o bastante para cada admissão.
+ *
+ * Os dois núcleos chamam esta função, então as escritas ficam numa seção
+ * crítica. O magic é apagado antes e escrito por último: um reset por watchdog
+ * no meio da sequência deixa o snapshot inválido em vez de meio escrito.
+ *
+ * @param count Ocupação atual.
+ */
+void snapshot_save(uint16_t count) {
+    taskENTER_CRITICAL();
+    watchdog_hw->scratch[SNAPSHOT_SCRATCH_MAGIC] = 0;
+    watchdog_hw->scratch[SNAPSHOT_SCRATCH_COUNT] = count;
+    watchdog_hw->scratch[SNAPSHOT_SCRATCH_CHECK] = ~(uint32_t)count;
+    watchdog_hw->scratch[SNAPSHOT_SCRATCH_MAGIC] = SNAPSHOT_MAGIC;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Restaura a última ocupação conhecida.
+ *
+ * Após um reset por watchdog usa os registradores scratch (sempre atuais).
+ * Após uma queda de energia, os scratch se perdem e vale o último registro
+ * do diário na flash. O valor é limitado a MAX_USERS.
+ *
+ * @param count Saída com a ocupação restaurada (0 se não houver snapshot).
+ * @return Origem do valor restaurado.
+ */
+snapshot_source_t snapshot_restore(uint16_t *count) {
+    snapshot_source_t source = SNAPSHOT_SRC_NONE;
+    journal_record_t last;
+
+    *count = 0;
+    if (watchdog_caused_reboot() &&
+        watchdog_hw->scratch[SNAPSHOT_SCRATCH_MAGIC] == SNAPSHOT_MAGIC &&
+        watchdog_hw->scratch[SNAPSHOT_SCRATCH_CHECK] == ~watchdog_hw->scratch[SNAPSHOT_SCRATCH_COUNT]) {
+        *count = (uint16_t)watchdog_hw->scratch[SNAPSHOT_SCRATCH_COUNT];
+        source = SNAPSHOT_SRC_WATCHDOG;
+    } else if (journal_get_last(&last)) {
+        *count = last.count;
+        source = SNAPSHOT_SRC_FLASH;
+    }
+
+    if (*count > MAX_USERS) *count = MAX_USERS;
+    snapshot_save(*count);
+    return source;
+}
@@ -0,0 +1,20 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+// Origem da ocupação restaurada no boot
+typedef enum {
+    SNAPSHOT_SRC_NONE,      // Nenhum snapshot válido: começa vazio
+    SNAPSHOT_SRC_WATCHDOG,  // Registradores scratch do watchdog (reset por watchdog)
+    SNAPSHOT_SRC_FLASH,     // Último registro do diário na flash (queda de energia)
+} snapshot_source_t;
+
+// Guarda a ocupação atual nos registradores scratch do watchdog
+void snapshot_save(uint16_t count);
+
+// Restaura a última ocupação conhecida (chamar após journal_init)
+snapshot_source_t snapshot_restore(uint16_t *count);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,128 @@
+#include "tlog.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "hardware/sync.h"
+#include <inttypes.h>
+
+_Static_assert((TLOG_RING_LEN & (TLOG_RING_LEN - 1)) == 0, "anel deve ser potencia de 2");
+_Static_assert(TLOG_MAX_ARGS == 4, "output() passa exatamente 4 argumentos");
+
+/**
+ * @struct tlog_ring_t
+ * @brief Anel de um núcleo: um produtor (o próprio núcleo, com as interrupções
+ *        mascaradas para serializar tarefa e ISR) e um consumidor (o objeto de
+ *        log, no outro núcleo ou no mesmo). head só é escrito pelo produtor e
+ *        tail só pelo consumidor, como em ui_events.c.
+ */
+typedef struct {
+    tlog_record_t records[TLOG_RING_LEN];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+} tlog_ring_t;
+
+static tlog_ring_t rings[configNUM_CORES];
+static volatile uint32_t dropped[configNUM_CORES];
+static tlog_listener_t listener = NULL;
+
+MEM_BUDGET_ENTRY(tlog, "Log", sizeof(rings) + sizeof(dropped), MEM_BUDGET_TLOG_BYTES);
+
+void tlog_set_listener(tlog_listener_t fn) {
+    listener = fn;
+}
+
+/**
+ * @brief Copia id, instante e argumentos para o anel do núcleo atual: algumas
+ *        dezenas de ciclos, sem formatação nem espera pelo USB.
+ */
+void __not_in_flash_func(tlog_write)(tlog_id_t id, uint n_args, const uint32_t *args) {
+    uint core = get_core_num();
+    tlog_ring_t *r = &rings[core];
+    bool was_empty;
+
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t head = r->head;
+    if (head - r->tail >= TLOG_RING_LEN) {
+        dropped[core]++;
+        restore_interrupts(irq);
+        return;
+    }
+    tlog_record_t *rec = &r->records[head & (TLOG_RING_LEN - 1)];
+    rec->t_us = time_us_32();
+    rec->id = (uint16_t)id;
+    rec->n_args = (uint8_t)n_args;
+    rec->core = (uint8_t)core;
+    for (uint i = 0; i < n_args; ++i) {
+        rec->args[i] = args[i];
+    }
+    was_empty = (head == r->tail);
+    __dmb();
+    r->head = head + 1;
+    restore_interrupts(irq);
+
+    // Só a transição vazio -> não vazio acorda o consumidor
+    if (was_empty && listener) {
+        listener();
+    }
+}
+
+#if TLOG_OUTPUT_BINARY
+/**
+ * @brief Envia o registro cru: 0xA5, tamanho, t_us (4), id (2), argumentos
+ *        (4 cada), tudo little-endian. Decodificado por tools/tlog_decode.py.
+ */
+static void output(const tlog_record_t *rec) {
+    uint8_t frame[2 + 6 + 4 * TLOG_MAX_ARGS];
+    uint len = 6 + 4 * rec->n_args;
+
+    frame[0] = 0xA5;
+    frame[1] = (uint8_t)len;
+    memcpy(&frame[2], &rec->t_us, 4);
+    memcpy(&frame[6], &rec->id, 2);
+    memcpy(&frame[8], rec->args, 4 * rec->n_args);
+    for (uint i = 0; i < 2 + len; ++i) {
+        putchar_raw(frame[i]);
+    }
+}
+#else
+// Tabela de formatos, gerada em tempo de compilação a partir de log_messages.def
+static const char *const formats[TLOG_NUM_MESSAGES] = {
+#define LOG_MSG(id, fmt) fmt,
+#include "log_messages.def"
+#undef LOG_MSG
+};
+
+/**
+ * @brief Formata o registro no terminal, fora do caminho de quem registrou.
+ *        Argumentos não usados pelo formato são ignorados pelo printf.
+ */
+static void output(const tlog_record_t *rec) {
+    const uint32_t *a = rec->args;
+    printf("[%" PRIu32 "] ", rec->t_us);
+    printf(formats[rec->id], a[0], a[1], a[2], a[3]);
+    printf("\n");
+}
+#endif
+
+void tlog_drain(void) {
+    tlog_record_t rec;
+
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        tlog_ring_t *r = &rings[c];
+        uint32_t tail = r->tail;
+        while (tail != r->head) {
+            __dmb();
+            rec = r->records[tail & (TLOG_RING_LEN - 1)];
+            __dmb();
+            r->tail = ++tail;
+            output(&rec);
+        }
+    }
+}
+
+uint32_t tlog_dropped(void) {
+    uint32_t total = 0;
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        total += dropped[c];
+    }
+    return total;
+}
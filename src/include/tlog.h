@@ -0,0 +1,55 @@
+#ifndef TLOG_H
+#define TLOG_H
+
+#include "pico/stdlib.h"
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Identificadores das mensagens, na ordem de log_messages.def
+typedef enum {
+#define LOG_MSG(id, fmt) TLOG_##id,
+#include "log_messages.def"
+#undef LOG_MSG
+    TLOG_NUM_MESSAGES,
+} tlog_id_t;
+
+/**
+ * @struct tlog_record_t
+ * @brief Mensagem pendente: id, instante e argumentos crus (sem formatação).
+ */
+typedef struct {
+    uint32_t t_us;                    // time_us_32()
+    uint16_t id;                      // tlog_id_t
+    uint8_t n_args;
+    uint8_t core;
+    uint32_t args[TLOG_MAX_ARGS];
+} tlog_record_t;
+
+// Avisado quando o anel de um núcleo deixa de estar vazio (pode ser em ISR)
+typedef void (*tlog_listener_t)(void);
+void tlog_set_listener(tlog_listener_t listener);
+
+// Grava a mensagem no anel do núcleo atual; anel cheio = descartada e contada
+void tlog_write(tlog_id_t id, uint n_args, const uint32_t *args);
+
+/**
+ * @brief Registra uma mensagem de log_messages.def com argumentos inteiros.
+ *        Ex.: TLOG(ENTRADA_OK, usuarios, vagas);
+ */
+#define TLOG(id, ...)                                                       \
+    do {                                                                    \
+        const uint32_t tlog_args_[] = { 0, ##__VA_ARGS__ };                 \
+        _Static_assert(count_of(tlog_args_) - 1 <= TLOG_MAX_ARGS,           \
+                       "argumentos demais para TLOG");                      \
+        tlog_write(TLOG_##id, count_of(tlog_args_) - 1, tlog_args_ + 1);    \
+    } while (0)
+
+// Esvazia os anéis (só o objeto de log): formata no terminal ou envia em
+// binário, conforme TLOG_OUTPUT_BINARY
+void tlog_drain(void);
+
+// Mensagens descartadas com o anel cheio
+uint32_t tlog_dropped(void);
+
+#endif // TLOG_H
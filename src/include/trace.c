@@ -0,0 +1,86 @@
+#include "trace.h"
+#include "mem_budget.h"
+#include "hardware/sync.h"
+#include <inttypes.h>
+
+_Static_assert((TRACE_RING_LEN & (TRACE_RING_LEN - 1)) == 0, "anel deve ser potencia de 2");
+_Static_assert(sizeof(trace_record_t) == 8, "registro do trace deve ter 8 bytes");
+
+/**
+ * @struct trace_ring_t
+ * @brief Anel de um núcleo. Só o próprio núcleo escreve (tarefas e ISRs, com
+ *        as interrupções mascaradas durante a escrita), então não há trava
+ *        entre núcleos; o anel guarda os TRACE_RING_LEN registros mais recentes.
+ */
+typedef struct {
+    trace_record_t records[TRACE_RING_LEN];
+    volatile uint32_t head;   // Total de registros gravados
+} trace_ring_t;
+
+static trace_ring_t rings[configNUM_CORES];
+static TaskStatus_t tasks[PROFILER_MAX_TASKS];
+
+MEM_BUDGET_ENTRY(trace, "Trace", sizeof(rings) + sizeof(tasks), MEM_BUDGET_TRACE_BYTES);
+
+#if TRACE_ENABLED
+/**
+ * @brief Grava um evento. Roda da RAM (sem espera pelo cache da flash) e custa
+ *        algumas dezenas de ciclos: leitura do timer, do número do núcleo e
+ *        8 bytes escritos com as interrupções mascaradas.
+ */
+void __not_in_flash_func(trace_record)(trace_event_t event, uint16_t arg) {
+    uint core = get_core_num();
+    trace_ring_t *r = &rings[core];
+    uint32_t irq = save_and_disable_interrupts();
+    trace_record_t *rec = &r->records[r->head & (TRACE_RING_LEN - 1)];
+
+    rec->t_us = time_us_32();
+    rec->event = (uint8_t)event;
+    rec->core = (uint8_t)core;
+    rec->arg = arg;
+    r->head++;
+    restore_interrupts(irq);
+}
+#endif
+
+/**
+ * @brief Chamado pelo kernel em traceTASK_SWITCHED_IN (FreeRTOSConfig.h), já
+ *        no núcleo que está trocando de tarefa.
+ */
+void __not_in_flash_func(trace_task_switched_in)(uint32_t task_number) {
+#if TRACE_ENABLED
+    trace_record(TRACE_EVT_TASK_SWITCH, (uint16_t)task_number);
+#endif
+}
+
+/**
+ * @brief Envia o trace pelo terminal USB.
+ *
+ * Formato (uma linha por item):
+ *   #TRACE 1 <núcleos> <agora_us>
+ *   #TASK <número> <nome>        (uma por tarefa, para nomear os TASK_SWITCH)
+ *   #CORE <núcleo> <total> <descartados>
+ *   <16 dígitos hex>             (registro de 8 bytes, little-endian)
+ *   #END
+ * A gravação continua durante o envio; registros sobrescritos no meio do
+ * envio aparecem com tempo fora de ordem e são descartados pelo conversor.
+ */
+void trace_dump(void) {
+    uint32_t total_runtime;
+    UBaseType_t n = uxTaskGetSystemState(tasks, PROFILER_MAX_TASKS, &total_runtime);
+
+    printf("#TRACE 1 %u %" PRIu32 "\n", configNUM_CORES, time_us_32());
+    for (UBaseType_t i = 0; i < n; ++i) {
+        printf("#TASK %" PRIu32 " %s\n", (uint32_t)tasks[i].xTaskNumber, tasks[i].pcTaskName);
+    }
+    for (uint c = 0; c < configNUM_CORES; ++c) {
+        uint32_t head = rings[c].head;
+        uint32_t count = head < TRACE_RING_LEN ? head : TRACE_RING_LEN;
+        printf("#CORE %u %" PRIu32 " %" PRIu32 "\n", c, head, head - count);
+        for (uint32_t i = head - count; i != head; ++i) {
+            const uint8_t *b = (const uint8_t *)&rings[c].records[i & (TRACE_RING_LEN - 1)];
+            printf("%02x%02x%02x%02x%02x%02x%02x%02x\n", b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7]);
+        }
+    }
+    printf("#END\n");
+}
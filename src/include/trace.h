@@ -0,0 +1,47 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+#include "config.h"
+#include <stdint.h>
+
+// Eventos gravados no trace (o conversor tools/trace_to_perfetto.py usa os mesmos valores)
+typedef enum {
+    TRACE_EVT_TASK_SWITCH = 1,    // arg = número da tarefa que entra no núcleo
+    TRACE_EVT_BUTTON_EDGE,        // arg = GPIO do botão
+    TRACE_EVT_BEAM_EDGE,          // arg = porta << 1 | sensor
+    TRACE_EVT_BADGE_FRAME,        // arg = leitor
+    TRACE_EVT_SEM_TAKE,           // arg = vagas após tomar
+    TRACE_EVT_SEM_TAKE_FAIL,      // arg = vagas (0 = lotado)
+    TRACE_EVT_SEM_GIVE,           // arg = vagas após devolver
+    TRACE_EVT_DISPLAY_FLUSH_BEGIN,
+    TRACE_EVT_DISPLAY_FLUSH_END,
+    TRACE_EVT_MATRIX_FRAME,       // arg = passo da animação
+} trace_event_t;
+
+/**
+ * @struct trace_record_t
+ * @brief Registro de 8 bytes no anel do núcleo.
+ */
+typedef struct {
+    uint32_t t_us;     // time_us_32()
+    uint8_t event;     // trace_event_t
+    uint8_t core;
+    uint16_t arg;
+} trace_record_t;
+
+#if TRACE_ENABLED
+// Grava um registro no anel do núcleo atual (tarefa ou ISR; sobrescreve o mais antigo)
+void trace_record(trace_event_t event, uint16_t arg);
+#define TRACE(event, arg) trace_record((event), (uint16_t)(arg))
+#else
+#define TRACE(event, arg) ((void)0)
+#endif
+
+// Gancho do kernel a cada troca de tarefa (número da tarefa que entra)
+void trace_task_switched_in(uint32_t task_number);
+
+// Envia os anéis e a tabela de tarefas pelo terminal USB, em texto hexadecimal
+void trace_dump(void);
+
+#endif // TRACE_H
@@ -0,0 +1,69 @@
+#include "ui_events.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "hardware/sync.h"
+
+_Static_assert((UI_EVENT_QUEUE_LEN & (UI_EVENT_QUEUE_LEN - 1)) == 0, "fila deve ser potencia de 2");
+
+/**
+ * @struct ui_ring_t
+ * @brief Fila de um produtor e um consumidor, sem trava.
+ *
+ * O Cortex-M0+ não tem LDREX/STREX, então não há CAS para uma fila de vários
+ * produtores; cada tarefa de acesso tem a sua fila. head só é escrito pelo
+ * produtor e tail só pelo consumidor, e a barreira de memória garante que o
+ * evento esteja na RAM antes de o índice ser publicado ao outro núcleo.
+ */
+typedef struct {
+    ui_event_t events[UI_EVENT_QUEUE_LEN];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+} ui_ring_t;
+
+static ui_ring_t rings[UI_NUM_SOURCES];
+static uint next_source = 0;
+static volatile uint32_t dropped = 0;
+
+MEM_BUDGET_ENTRY(ui_events, "Filas de UI", sizeof(rings), MEM_BUDGET_UI_EVENTS_BYTES);
+
+/**
+ * @brief Publica um evento para a tarefa de interface.
+ *
+ * @param source Fila da tarefa produtora.
+ * @param event Evento a copiar.
+ * @return true se publicado. false se a fila está cheia (evento descartado).
+ */
+bool ui_events_post(ui_source_t source, const ui_event_t *event) {
+    ui_ring_t *r = &rings[source];
+    uint32_t head = r->head;
+
+    if (head - r->tail >= UI_EVENT_QUEUE_LEN) {
+        dropped++;
+        return false;
+    }
+    r->events[head & (UI_EVENT_QUEUE_LEN - 1)] = *event;
+    __dmb();
+    r->head = head + 1;
+    return true;
+}
+
+bool ui_events_take(ui_event_t *event) {
+    for (uint i = 0; i < UI_NUM_SOURCES; ++i) {
+        ui_ring_t *r = &rings[next_source];
+        next_source = (next_source + 1) % UI_NUM_SOURCES;
+
+        uint32_t tail = r->tail;
+        if (tail != r->head) {
+            __dmb();
+            *event = r->events[tail & (UI_EVENT_QUEUE_LEN - 1)];
+            __dmb();
+            r->tail = tail + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ui_events_dropped(void) {
+    return dropped;
+}
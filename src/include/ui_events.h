@@ -0,0 +1,45 @@
+#ifndef UI_EVENTS_H
+#define UI_EVENTS_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Tarefas que publicam eventos de interface (uma fila SPSC por produtora)
+typedef enum {
+    UI_SOURCE_ENTRADA,
+    UI_SOURCE_SAIDA,
+    UI_SOURCE_RESET,
+    UI_SOURCE_HOST,     // Lotes do protocolo USB
+    UI_NUM_SOURCES,
+} ui_source_t;
+
+// Sinal sonoro tocado pela tarefa de interface
+typedef enum {
+    UI_BEEP_NONE,
+    UI_BEEP_SHORT,   // Entrada recusada
+    UI_BEEP_RESET,   // Beep duplo de reset
+} ui_beep_t;
+
+/**
+ * @struct ui_event_t
+ * @brief Resultado de uma operação de acesso a ser mostrado pela interface.
+ */
+typedef struct {
+    uint16_t occupancy;   // Ocupação após a operação (até MAX_USERS)
+    uint8_t beep;         // ui_beep_t
+    char message[30];     // Mensagem de status do display
+    uint32_t decided_us;  // time_us_32() da decisão (latência até o display)
+} ui_event_t;
+
+// Publica um evento (só a tarefa dona de source). Não bloqueia nem acorda o
+// consumidor; false = fila cheia
+bool ui_events_post(ui_source_t source, const ui_event_t *event);
+
+// Retira o próximo evento, alternando entre as filas (só a tarefa de interface)
+bool ui_events_take(ui_event_t *event);
+
+// Eventos descartados com a fila cheia
+uint32_t ui_events_dropped(void);
+
+#endif // UI_EVENTS_H
@@ -0,0 +1,305 @@
+#include "usb_protocol.h"
+#include "mem_budget.h"
+
+// Payload + CRC codificados em COBS: no máximo 1 byte extra a cada 254
+#define COBS_MAX(n)        ((n) + (n) / 254 + 1)
+#define FRAME_MAX          COBS_MAX(USB_PROTO_MAX_PAYLOAD + 2)
+#define WIRE_MAX(n)        (COBS_MAX(n) + 2)  // Com os dois delimitadores
+#define REPLY_HEADER_LEN   4
+#define RESULT_MAX         (4 + sizeof(usb_proto_stats_t))
+#define RULE_WIRE_LEN      6
+#define MAX_RULES          ((USB_PROTO_MAX_PAYLOAD - 3) / RULE_WIRE_LEN)
+
+_Static_assert(USB_PROTO_MAX_PAYLOAD >= REPLY_HEADER_LEN + RESULT_MAX, "resposta nao comporta STATS");
+
+// Recepção: o quadro é decodificado no próprio buffer
+static uint8_t rx[FRAME_MAX];
+static uint16_t rx_len;
+static bool rx_in_frame;
+static bool rx_overflow;
+
+// Pedido em execução (dentro de rx, já decodificado)
+static uint16_t req_pos;
+static uint16_t req_end;
+static uint8_t last_code;
+static policy_rule_t rules[MAX_RULES];
+
+// Resposta: payload montado pelo objeto de acesso, codificado e guardado em tx
+// para reenvio se o cliente repetir o pedido
+static uint8_t reply[USB_PROTO_MAX_PAYLOAD + 2]; // + CRC
+static uint16_t reply_len;
+static uint16_t reply_done;
+static uint8_t tx[WIRE_MAX(USB_PROTO_MAX_PAYLOAD + 2)];
+static uint16_t tx_len;
+static bool tx_valid;
+static uint8_t tx_seq;
+
+static uint8_t tx_async[WIRE_MAX(USB_PROTO_ASYNC_MAX + 2)];
+static uint8_t event_seq;
+static uint32_t frames;
+static uint32_t frame_errors;
+
+MEM_BUDGET_ENTRY(usb_protocol, "Protocolo USB",
+                 sizeof(rx) + sizeof(rules) + sizeof(reply) + sizeof(tx) + sizeof(tx_async),
+                 MEM_BUDGET_USB_PROTO_BYTES);
+
+/**
+ * @brief CRC-16/CCITT (polinômio 0x1021, valor inicial 0xFFFF), o mesmo do diário.
+ */
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Codifica em COBS (sem o delimitador).
+ * @return Bytes escritos em out (até COBS_MAX(len)).
+ */
+static size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_pos = 0, o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; ++i) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+/**
+ * @brief Decodifica COBS no próprio buffer (a saída nunca passa a entrada).
+ * @return Bytes decodificados, ou 0 se a codificação é inválida.
+ */
+static size_t cobs_decode(uint8_t *buf, size_t len) {
+    size_t i = 0, o = 0;
+
+    while (i < len) {
+        uint8_t code = buf[i++];
+        if (code == 0 || i + code - 1 > len) return 0;
+        for (uint k = 1; k < code; ++k) {
+            buf[o++] = buf[i++];
+        }
+        if (code != 0xFF && i < len) {
+            buf[o++] = 0;
+        }
+    }
+    return o;
+}
+
+/**
+ * @brief Codifica o payload para envio: delimitador, COBS e delimitador.
+ * @return Bytes escritos em out (até WIRE_MAX(len)).
+ */
+static size_t frame_encode(const uint8_t *payload, size_t len, uint8_t *out) {
+    size_t n = cobs_encode(payload, len, &out[1]);
+    out[0] = 0;
+    out[1 + n] = 0;
+    return n + 2;
+}
+
+/**
+ * @brief Envia um quadro pronto numa única escrita do stdio. O stdio do SDK
+ *        serializa cada chamada (printf inteiro ou stdio_put_string) entre os
+ *        núcleos, então o texto que o outro núcleo imprime cai antes ou
+ *        depois do quadro, nunca no meio dele. Sem tradução de \n em \r\n
+ *        (o COBS só elimina os zeros).
+ */
+static void send_frame(const uint8_t *frame, size_t len) {
+    stdio_put_string((const char *)frame, (int)len, false, false);
+}
+
+static size_t append_crc(uint8_t *payload, size_t len) {
+    uint16_t crc = crc16_ccitt(payload, len);
+    payload[len] = (uint8_t)crc;
+    payload[len + 1] = (uint8_t)(crc >> 8);
+    return len + 2;
+}
+
+/**
+ * @brief Valida o quadro recebido e prepara a execução do pedido.
+ */
+static usb_proto_rx_t rx_frame_done(void) {
+    size_t n = rx_overflow ? 0 : cobs_decode(rx, rx_len);
+
+    if (n < 3 || n - 2 > USB_PROTO_MAX_PAYLOAD ||
+        crc16_ccitt(rx, n - 2) != (uint16_t)(rx[n - 2] | (rx[n - 1] << 8))) {
+        frame_errors++;
+        return USB_PROTO_RX_PENDING;
+    }
+
+    // seq 0 abre uma sessão (cliente novo): a resposta guardada é de outra
+    // sessão e não vale para nenhum seq dela
+    if (rx[0] == USB_PROTO_SEQ_OPEN) {
+        tx_valid = false;
+    } else if (tx_valid && rx[0] == tx_seq) {
+        // Pedido repetido: a resposta anterior se perdeu, reenvia sem reexecutar
+        send_frame(tx, tx_len);
+        return USB_PROTO_RX_PENDING;
+    }
+
+    frames++;
+    req_pos = 1;
+    req_end = (uint16_t)(n - 2);
+    reply[0] = USB_PROTO_TYPE_REPLY;
+    reply[1] = rx[0];
+    reply_len = REPLY_HEADER_LEN;
+    reply_done = 0;
+    return USB_PROTO_RX_REQUEST;
+}
+
+usb_proto_rx_t usb_proto_rx(uint8_t byte) {
+    if (!rx_in_frame) {
+        if (byte != 0) return USB_PROTO_RX_TEXT;
+        rx_in_frame = true;
+        rx_len = 0;
+        rx_overflow = false;
+        return USB_PROTO_RX_PENDING;
+    }
+
+    if (byte != 0) {
+        if (rx_len < sizeof(rx)) {
+            rx[rx_len++] = byte;
+        } else {
+            rx_overflow = true;
+        }
+        return USB_PROTO_RX_PENDING;
+    }
+
+    // Delimitadores seguidos (fim de um quadro e início do próximo) não fecham quadro vazio
+    if (rx_len == 0 && !rx_overflow) return USB_PROTO_RX_PENDING;
+    rx_in_frame = false;
+    return rx_frame_done();
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief Tamanho dos argumentos do comando em p, ou -1 se o código é desconhecido.
+ */
+static int args_len(const uint8_t *p, uint16_t avail) {
+    switch (p[0]) {
+        case USB_PROTO_CMD_PING:
+        case USB_PROTO_CMD_RELEASE:
+        case USB_PROTO_CMD_RESET:
+        case USB_PROTO_CMD_STATS:       return 0;
+        case USB_PROTO_CMD_SUBSCRIBE:
+        case USB_PROTO_CMD_MIRROR:      return 1;
+        case USB_PROTO_CMD_SET_TIME:    return 2;
+        case USB_PROTO_CMD_SET_LIMITS:  return 4;
+        case USB_PROTO_CMD_ADMIT:       return 6;
+        case USB_PROTO_CMD_LOAD_POLICY: return avail >= 2 ? 1 + RULE_WIRE_LEN * p[1] : 1;
+        default:                        return -1;
+    }
+}
+
+bool usb_proto_next(usb_proto_cmd_t *cmd) {
+    if (req_pos >= req_end || reply_len + RESULT_MAX > USB_PROTO_MAX_PAYLOAD) return false;
+
+    const uint8_t *p = &rx[req_pos];
+    uint16_t avail = req_end - req_pos;
+    int len = args_len(p, avail);
+
+    last_code = p[0];
+    if (len < 0 || 1 + len > avail) {
+        // Comando desconhecido ou truncado: encerra o pedido com o erro
+        req_pos = req_end;
+        usb_proto_result(USB_PROTO_ERR_UNKNOWN, 0, NULL, 0);
+        return false;
+    }
+
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->code = p[0];
+    switch (cmd->code) {
+        case USB_PROTO_CMD_SUBSCRIBE:
+        case USB_PROTO_CMD_MIRROR:
+            cmd->a = p[1];
+            break;
+        case USB_PROTO_CMD_SET_TIME:
+            cmd->a = get_u16(&p[1]);
+            break;
+        case USB_PROTO_CMD_SET_LIMITS:
+            cmd->a = get_u16(&p[1]);
+            cmd->b = get_u16(&p[3]);
+            break;
+        case USB_PROTO_CMD_ADMIT:
+            cmd->a = get_u16(&p[1]);
+            cmd->card = get_u16(&p[3]) | ((uint32_t)get_u16(&p[5]) << 16);
+            break;
+        case USB_PROTO_CMD_LOAD_POLICY:
+            // O quadro não garante alinhamento: copia campo a campo
+            cmd->n_rules = p[1];
+            cmd->rules = rules;
+            for (uint i = 0; i < p[1]; ++i) {
+                const uint8_t *w = &p[2 + RULE_WIRE_LEN * i];
+                rules[i].type = w[0];
+                rules[i].target = w[1];
+                rules[i].a = get_u16(&w[2]);
+                rules[i].b = get_u16(&w[4]);
+            }
+            break;
+    }
+    req_pos += 1 + len;
+    return true;
+}
+
+void usb_proto_result(uint8_t status, uint16_t value, const void *data, uint8_t len) {
+    uint8_t *r = &reply[reply_len];
+
+    r[0] = last_code;
+    r[1] = status;
+    r[2] = (uint8_t)value;
+    r[3] = (uint8_t)(value >> 8);
+    if (len) memcpy(&r[4], data, len);
+    reply_len += 4 + len;
+    reply_done++;
+}
+
+void usb_proto_send_reply(void) {
+    reply[2] = (uint8_t)reply_done;
+    reply[3] = (uint8_t)(reply_done >> 8);
+    tx_len = (uint16_t)frame_encode(reply, append_crc(reply, reply_len), tx);
+    tx_seq = reply[1];
+    tx_valid = true;
+    send_frame(tx, tx_len);
+}
+
+void usb_proto_send_async(uint8_t *payload, size_t len) {
+    if (len > USB_PROTO_ASYNC_MAX) return;
+    send_frame(tx_async, frame_encode(payload, append_crc(payload, len), tx_async));
+}
+
+void usb_proto_send_event(uint16_t occupancy, int16_t delta) {
+    uint8_t payload[6 + 2];
+
+    payload[0] = USB_PROTO_TYPE_EVENT;
+    payload[1] = event_seq++;
+    payload[2] = (uint8_t)occupancy;
+    payload[3] = (uint8_t)(occupancy >> 8);
+    payload[4] = (uint8_t)delta;
+    payload[5] = (uint8_t)((uint16_t)delta >> 8);
+    usb_proto_send_async(payload, 6);
+}
+
+void usb_proto_get_counters(uint32_t *frames_out, uint32_t *frame_errors_out) {
+    *frames_out = frames;
+    *frame_errors_out = frame_errors;
+}
@@ -0,0 +1,113 @@
+#ifndef USB_PROTOCOL_H
+#define USB_PROTOCOL_H
+
+#include "pico/stdlib.h"
+#include "config.h"
+#include "policy.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Quadros binários no terminal USB (CDC): payload + CRC-16/CCITT, codificados
+// em COBS e delimitados por 0x00 antes e depois. Fora de um quadro, os bytes
+// recebidos continuam sendo os comandos de uma letra do terminal.
+//
+// Pedido:   seq, comandos...         (cada comando: código + argumentos LE)
+//           seq 0 abre uma sessão: nunca é tomado por repetição e descarta a
+//           resposta guardada. O cliente abre com um PING em seq 0 e segue
+//           em 1..255, voltando a 1
+// Resposta: USB_PROTO_TYPE_REPLY, seq, executados (u16), resultados...
+//           (cada resultado: código, status, valor (u16), dados de STATS)
+// Evento:   USB_PROTO_TYPE_EVENT, seq do evento, ocupação (u16), delta (i16)
+// Espelho:  USB_PROTO_TYPE_MIRROR, ver mirror.h
+#define USB_PROTO_VERSION     1
+#define USB_PROTO_TYPE_REPLY  0x01
+#define USB_PROTO_TYPE_EVENT  0x02
+#define USB_PROTO_TYPE_MIRROR 0x03
+#define USB_PROTO_ASYNC_MAX   160  // Payload de eventos e quadros do espelho
+#define USB_PROTO_SEQ_OPEN    0x00
+
+// Códigos de comando (argumentos little-endian entre parênteses)
+typedef enum {
+    USB_PROTO_CMD_PING        = 0x01,  // -> valor = USB_PROTO_VERSION
+    USB_PROTO_CMD_ADMIT       = 0x10,  // (instalação u16, cartão u32) -> status = policy_decision_t
+    USB_PROTO_CMD_RELEASE     = 0x11,  // -> status 0 = saída registrada, 1 = espaço vazio
+    USB_PROTO_CMD_RESET       = 0x12,  // Zera a contagem (sem os relatórios do botão)
+    USB_PROTO_CMD_SET_LIMITS  = 0x20,  // (limite suave u16, capacidade u16)
+    USB_PROTO_CMD_SET_TIME    = 0x21,  // (minuto do dia u16)
+    USB_PROTO_CMD_LOAD_POLICY = 0x22,  // (n u8, n x policy_rule_t de 6 bytes)
+    USB_PROTO_CMD_STATS       = 0x30,  // -> valor = tamanho, seguido de usb_proto_stats_t
+    USB_PROTO_CMD_SUBSCRIBE   = 0x31,  // (1 = envia eventos de ocupação, 0 = para)
+    USB_PROTO_CMD_MIRROR      = 0x32,  // (1 = espelha display e matriz, 0 = para)
+} usb_proto_cmd_code_t;
+
+// Status genéricos (ADMIT usa os valores de policy_decision_t)
+#define USB_PROTO_OK           0
+#define USB_PROTO_ERR_REJECTED 1  // Comando válido, mas recusado (limites ou regras inválidos, espaço vazio)
+#define USB_PROTO_ERR_UNKNOWN  0xFE
+
+/**
+ * @struct usb_proto_cmd_t
+ * @brief Comando decodificado de um pedido.
+ */
+typedef struct {
+    uint8_t code;                 // usb_proto_cmd_code_t
+    uint16_t a;                   // Instalação, limite suave, minuto ou liga/desliga
+    uint16_t b;                   // Capacidade
+    uint32_t card;                // Cartão (ADMIT)
+    uint8_t n_rules;              // LOAD_POLICY
+    const policy_rule_t *rules;   // LOAD_POLICY (copiadas do quadro, alinhadas)
+} usb_proto_cmd_t;
+
+/**
+ * @struct usb_proto_stats_t
+ * @brief Dados da resposta de STATS (campos u32 little-endian).
+ */
+typedef struct {
+    uint32_t occupancy;
+    uint32_t soft_limit;
+    uint32_t hard_limit;
+    uint32_t policy_evaluations;
+    uint32_t policy_denied;
+    uint32_t journal_committed;
+    uint32_t journal_dropped;
+    uint32_t ui_dropped;
+    uint32_t log_dropped;
+    uint32_t frames;          // Pedidos válidos recebidos
+    uint32_t frame_errors;    // Quadros descartados (CRC, COBS ou tamanho)
+    uint32_t policy_worst_cycles;  // Pior avaliação da política, em ciclos de CPU
+    uint32_t policy_over_budget;   // Avaliações acima de POLICY_EVAL_BUDGET_US
+} usb_proto_stats_t;
+
+// Resultado de usb_proto_rx() para cada byte recebido
+typedef enum {
+    USB_PROTO_RX_TEXT,     // Fora de um quadro: comando de texto do terminal
+    USB_PROTO_RX_PENDING,  // Consumido pelo quadro em andamento
+    USB_PROTO_RX_REQUEST,  // Pedido completo e válido, pronto para usb_proto_next()
+} usb_proto_rx_t;
+
+// Alimenta o receptor com um byte do terminal. Um pedido repetido (mesmo seq
+// do anterior, depois de uma resposta perdida) é respondido de novo sem
+// reexecutar os comandos, exceto em seq 0 (USB_PROTO_SEQ_OPEN).
+usb_proto_rx_t usb_proto_rx(uint8_t byte);
+
+// Próximo comando do pedido recebido. false no fim do pedido, em comando
+// inválido ou quando a resposta não comporta mais um resultado (o restante
+// fica para o cliente reenviar, conforme o número de executados).
+bool usb_proto_next(usb_proto_cmd_t *cmd);
+
+// Resultado do último comando retornado por usb_proto_next()
+void usb_proto_result(uint8_t status, uint16_t value, const void *data, uint8_t len);
+
+// Codifica e envia a resposta do pedido (só o objeto do terminal)
+void usb_proto_send_reply(void);
+
+// Envia um evento de ocupação (assinatura ativa)
+void usb_proto_send_event(uint16_t occupancy, int16_t delta);
+
+// Envia um quadro não solicitado de até USB_PROTO_ASYNC_MAX bytes. O payload
+// precisa de 2 bytes livres depois de len, onde o CRC é escrito.
+void usb_proto_send_async(uint8_t *payload, size_t len);
+
+void usb_proto_get_counters(uint32_t *frames, uint32_t *frame_errors);
+
+#endif // USB_PROTOCOL_H
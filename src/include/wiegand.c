@@ -0,0 +1,212 @@
+#include "wiegand.h"
+#include "config.h"
+#include "mem_budget.h"
+#include "profiler.h"
+#include "trace.h"
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+#include "wiegand.pio.h"
+
+static PIO pio_instance = WIEGAND_PIO_INSTANCE;
+static const uint reader_d0_pins[] = WIEGAND_READER_D0_PINS;
+#define WIEGAND_NUM_READERS (sizeof(reader_d0_pins) / sizeof(reader_d0_pins[0]))
+
+// Um quadro de até 64 bits ocupa no máximo 2 blocos + restante + contagem
+#define WIEGAND_MAX_FRAME_WORDS 4
+
+static QueueHandle_t badge_queue = NULL;
+static StaticQueue_t badge_queue_cb;
+static wiegand_badge_t badge_queue_storage[WIEGAND_BADGE_QUEUE_LEN];
+static volatile uint32_t frame_errors = 0;
+static wiegand_listener_t listener = NULL;
+
+MEM_BUDGET_ENTRY(wiegand, "Wiegand", sizeof(badge_queue_cb) + sizeof(badge_queue_storage), MEM_BUDGET_WIEGAND_BYTES);
+
+/**
+ * @struct wiegand_format_t
+ * @brief Descreve um formato Wiegand suportado. Os bits são numerados a partir
+ *        de 0 na ordem de recepção: o bit 0 é a paridade par e o último bit
+ *        é a paridade ímpar.
+ */
+typedef struct {
+    uint8_t bits;           // Tamanho total do quadro
+    uint8_t even_last;      // Paridade par cobre os bits 1..even_last
+    uint8_t odd_first;      // Paridade ímpar cobre os bits odd_first..bits-2
+    uint8_t facility_bits;  // Bits do código de instalação (a partir do bit 1)
+    uint8_t card_bits;      // Bits do número do cartão (logo após a instalação)
+} wiegand_format_t;
+
+static const wiegand_format_t WIEGAND_FORMATS[] = {
+    {26, 12, 13,  8, 16},  // H10301
+    {34, 16, 17, 16, 16},  // 34 bits genérico
+    {37, 18, 18, 16, 19},  // H10304
+};
+
+/**
+ * @brief Extrai um campo de bits do quadro.
+ * @param frame Quadro alinhado à direita (o bit 0 recebido é o mais significativo).
+ * @param bits Tamanho total do quadro.
+ * @param first Índice do primeiro bit do campo (ordem de recepção).
+ * @param len Número de bits do campo.
+ * @return Valor do campo.
+ */
+static inline uint64_t frame_field(uint64_t frame, uint8_t bits, uint8_t first, uint8_t len) {
+    uint64_t mask = (len >= 64) ? ~0ULL : ((1ULL << len) - 1);
+    return (frame >> (bits - first - len)) & mask;
+}
+
+/**
+ * @brief Reconstrói, valida e decodifica um quadro lido do FIFO RX do PIO.
+ *
+ * O programa PIO envia cada bloco completo de 32 bits (autopush), depois os bits
+ * restantes alinhados à direita e, por fim, a contagem total de bits.
+ *
+ * @param words Palavras do quadro na ordem em que saíram do FIFO.
+ * @param n_words Número de palavras.
+ * @param reader Índice do leitor de origem.
+ * @param badge Saída com os campos do crachá.
+ * @return true se o formato é conhecido e as duas paridades conferem.
+ */
+bool wiegand_decode_frame(const uint32_t *words, uint n_words, uint8_t reader, wiegand_badge_t *badge) {
+    if (n_words < 2) return false;
+
+    uint32_t bit_count = words[n_words - 1];
+    uint32_t full_words = bit_count / 32;
+    uint32_t rem_bits = bit_count % 32;
+    if (bit_count == 0 || bit_count > 64 || n_words != full_words + 2) return false;
+
+    uint64_t frame = 0;
+    for (uint32_t i = 0; i < full_words; ++i) {
+        frame = (frame << 32) | words[i];
+    }
+    if (rem_bits > 0) {
+        frame = (frame << rem_bits) | (words[full_words] & ((1u << rem_bits) - 1));
+    }
+
+    const wiegand_format_t *fmt = NULL;
+    for (uint i = 0; i < sizeof(WIEGAND_FORMATS) / sizeof(WIEGAND_FORMATS[0]); ++i) {
+        if (WIEGAND_FORMATS[i].bits == bit_count) {
+            fmt = &WIEGAND_FORMATS[i];
+            break;
+        }
+    }
+    if (!fmt) return false;
+
+    // Paridade par: bit 0 + bits 1..even_last devem somar um número par de uns
+    uint64_t even_span = frame_field(frame, fmt->bits, 0, fmt->even_last + 1);
+    // Paridade ímpar: bits odd_first..último devem somar um número ímpar de uns
+    uint64_t odd_span = frame_field(frame, fmt->bits, fmt->odd_first, fmt->bits - fmt->odd_first);
+    if ((__builtin_popcountll(even_span) & 1) != 0 || (__builtin_popcountll(odd_span) & 1) != 1) {
+        return false;
+    }
+
+    badge->reader = reader;
+    badge->bit_count = fmt->bits;
+    badge->facility = (uint32_t)frame_field(frame, fmt->bits, 1, fmt->facility_bits);
+    badge->card_number = (uint32_t)frame_field(frame, fmt->bits, 1 + fmt->facility_bits, fmt->card_bits);
+    return true;
+}
+
+/**
+ * @brief Handler da interrupção do PIO dos leitores.
+ *
+ * Executado uma vez por quadro (não por bit): o programa PIO só levanta a
+ * flag de IRQ da máquina de estados depois que o quadro inteiro está no FIFO.
+ */
+static void wiegand_irq_handler(void) {
+    uint32_t start_us = time_us_32();
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    for (uint sm = 0; sm < WIEGAND_NUM_READERS; ++sm) {
+        if (!pio_interrupt_get(pio_instance, sm)) continue;
+
+        uint32_t words[WIEGAND_MAX_FRAME_WORDS];
+        uint n_words = 0;
+        while (!pio_sm_is_rx_fifo_empty(pio_instance, sm)) {
+            uint32_t word = pio_sm_get(pio_instance, sm);
+            if (n_words < WIEGAND_MAX_FRAME_WORDS) {
+                words[n_words] = word;
+            }
+            n_words++;
+        }
+        pio_interrupt_clear(pio_instance, sm);
+        TRACE(TRACE_EVT_BADGE_FRAME, sm);
+
+        wiegand_badge_t badge;
+        if (n_words <= WIEGAND_MAX_FRAME_WORDS && wiegand_decode_frame(words, n_words, sm, &badge)) {
+            if (xQueueSendFromISR(badge_queue, &badge, &higher_priority_task_woken) != pdTRUE) {
+                frame_errors++; // Fila cheia: crachá descartado
+            } else if (listener) {
+                listener();
+            }
+        } else {
+            frame_errors++;
+        }
+    }
+
+    profiler_isr_record(PROFILER_ISR_WIEGAND, start_us);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/**
+ * @brief Inicializa os leitores Wiegand.
+ *
+ * Carrega o programa no offset 0 do PIO dedicado e inicia uma máquina de
+ * estados por leitor (SM n atende o leitor n). Toda a desserialização ocorre
+ * no PIO; a CPU só é interrompida ao final de cada quadro.
+ */
+void wiegand_init(void) {
+    badge_queue = xQueueCreateStatic(WIEGAND_BADGE_QUEUE_LEN, sizeof(wiegand_badge_t),
+                                     (uint8_t *)badge_queue_storage, &badge_queue_cb);
+
+    uint offset = pio_add_program(pio_instance, &wiegand_program);
+    for (uint sm = 0; sm < WIEGAND_NUM_READERS; ++sm) {
+        pio_sm_claim(pio_instance, sm);
+        wiegand_program_init(pio_instance, sm, offset, reader_d0_pins[sm]);
+        pio_set_irq0_source_enabled(pio_instance, (enum pio_interrupt_source)(pis_interrupt0 + sm), true);
+    }
+
+    uint irq_num = (pio_instance == pio0) ? PIO0_IRQ_0 : PIO1_IRQ_0;
+    irq_set_exclusive_handler(irq_num, wiegand_irq_handler);
+    irq_set_enabled(irq_num, true);
+
+    printf("Leitores Wiegand inicializados (%u).\n", (unsigned)WIEGAND_NUM_READERS);
+}
+
+/**
+ * @brief Ouvinte do clock_mgr: mantém a amostragem em 1 MHz. Não adia a
+ *        troca; um quadro cortado por ela falha na paridade e é contado em
+ *        wiegand_get_error_count().
+ */
+bool wiegand_clock_listener(clock_phase_t phase, uint32_t sys_hz) {
+    if (phase == CLOCK_PHASE_RETIME) {
+        for (uint sm = 0; sm < WIEGAND_NUM_READERS; ++sm) {
+            pio_sm_set_clkdiv(pio_instance, sm, wiegand_program_clkdiv(sys_hz));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Registra a função avisada (na ISR) a cada crachá enfileirado.
+ *        Pode vir depois de wiegand_init(): um crachá lido antes disso fica
+ *        na fila, sem aviso, até o consumidor a esvaziar.
+ */
+void wiegand_set_listener(wiegand_listener_t fn) {
+    listener = fn;
+}
+
+/**
+ * @brief Retira o próximo crachá decodificado da fila.
+ *
+ * @param badge Saída com o crachá lido.
+ * @return true se havia um crachá pendente. Caso contrário, false.
+ */
+bool wiegand_get_badge(wiegand_badge_t *badge) {
+    if (badge_queue == NULL) return false;
+    return xQueueReceive(badge_queue, badge, 0) == pdTRUE;
+}
+
+uint32_t wiegand_get_error_count(void) {
+    return frame_errors;
+}
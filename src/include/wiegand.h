@@ -0,0 +1,39 @@
+#ifndef WIEGAND_H
+#define WIEGAND_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "clock_mgr.h"
+
+/**
+ * @struct wiegand_badge_t
+ * @brief Crachá decodificado de um quadro Wiegand com paridade válida.
+ */
+typedef struct {
+    uint8_t reader;        // Índice do leitor (posição em WIEGAND_READER_D0_PINS)
+    uint8_t bit_count;     // Formato do quadro (26, 34 ou 37 bits)
+    uint32_t facility;     // Código de instalação
+    uint32_t card_number;  // Número do cartão
+} wiegand_badge_t;
+
+// Inicializa o PIO e uma máquina de estados por leitor configurado
+void wiegand_init(void);
+
+// Função chamada pela ISR a cada crachá enfileirado (contexto de interrupção)
+typedef void (*wiegand_listener_t)(void);
+void wiegand_set_listener(wiegand_listener_t listener);
+
+// Retira o próximo crachá lido, se houver (não bloqueante)
+bool wiegand_get_badge(wiegand_badge_t *badge);
+
+// Ouvinte do clock_mgr (registrado no main): divisor das máquinas de estados
+bool wiegand_clock_listener(clock_phase_t phase, uint32_t sys_hz);
+
+// Quadros descartados por paridade inválida ou formato desconhecido
+uint32_t wiegand_get_error_count(void);
+
+// Decodifica as palavras de um quadro vindas do FIFO RX ([blocos de 32 bits][restante][contagem])
+bool wiegand_decode_frame(const uint32_t *words, uint n_words, uint8_t reader, wiegand_badge_t *badge);
+
+#endif // WIEGAND_H
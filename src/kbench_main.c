@@ -0,0 +1,26 @@
+// src/kbench_main.c
+
+#include "pico/stdlib.h"
+#include "kbench.h"     // Microbenchmarks dos kernels de desenho
+
+/**
+ * @brief Firmware de benchmark (alvo panel_kbench): só os kernels de desenho,
+ *        sem scheduler nem periféricos. No RP2040 espera o terminal USB e
+ *        repete a medida a cada 5 s; na build nativa mede uma vez e termina,
+ *        com erro se algum kernel passou do seu teto de tempo.
+ *        A linha JSON vai para tools/kbench_compare.py.
+ */
+int main(void) {
+#if defined(PANEL_HOST)
+    return kbench_run_all() ? 1 : 0;   // Algum kernel passou do teto: falha no ctest
+#else
+    stdio_init_all();
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    for (;;) {
+        kbench_run_all();
+        sleep_ms(5000);
+    }
+#endif
+}
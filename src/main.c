@@ -2,81 +2,261 @@
 
 #include "config.h"      // Assume que este é o seu hardware_config.h principal
 #include "buttons.h"     // Funções de botões
+#include "beam_counter.h" // Contador direcional por sensores de feixe
 #include "buzzer.h"      // Funções do buzzer
 #include "rgb_led.h"     // Funções do LED RGB
 #include "display.h"     // Funções do display OLED
 #include "led_matrix.h"  // Funções da matriz de LEDs
+#include "wiegand.h"     // Leitores de crachá Wiegand (PIO)
+#include "event_journal.h" // Diário de eventos na flash
+#include "snapshot.h"    // Snapshot da ocupação entre resets
+#include "analytics.h"   // Estatísticas de ocupação em janelas deslizantes
+#include "policy.h"      // Política de admissão
+#include "ui_events.h"   // Filas sem trava entre os núcleos de acesso e de interface
+#include "latency.h"     // Percentis de latência de admissão
+#include "active_object.h" // Objetos ativos multiplexados em workers
+#include "mem_budget.h"  // Orçamento de RAM estática por subsistema
+#include "profiler.h"    // CPU por tarefa, trocas de contexto e tempo das ISRs
+#include "trace.h"       // Trace de eventos em RAM para a linha do tempo
+#include "tlog.h"        // Log tokenizado, formatado fora do caminho de admissão
+#include "usb_protocol.h" // Comandos e telemetria binários pelo terminal USB
+#include "mirror.h"      // Espelho do display e da matriz pelo USB
+#include "clock_mgr.h"   // Escala dinâmica do clk_sys
+#include "low_power.h"   // Tickless idle e contagem de despertares
+#include "occupancy_band.h" // Faixas de ocupação com histerese
+#include "compositor.h"  // Relógio de quadros das saídas
+#include "hardware/watchdog.h"
+#include "hardware/sync.h"
+#include <inttypes.h>
 
 // --- Definição dos Handles Globais ---
 // Os handles são declarados como extern em config.h e definidos aqui.
 SemaphoreHandle_t xCountingSemaphoreUsers;
-SemaphoreHandle_t xMutexDisplay;
+static StaticSemaphore_t semaforo_vagas_buffer;
 
-ssd1306_t ssd; // Objeto global para o display OLED
+ssd1306_t ssd; // Objeto global para o display OLED (acessado só pelo objeto de interface)
 
-// --- Protótipos das Tarefas ---
-void vTaskEntradaUsuarios(void *pvParameters);
-void vTaskSaidaUsuarios(void *pvParameters);
-void vTaskResetSistema(void *pvParameters);
-void vTaskFeedbackVisualLedRgb(void *pvParameters);
-void vTaskDisplayInfoOled(void *pvParameters);
-void vTaskLedMatrixControl(void *pvParameters);
+// --- Sinais da Aplicação ---
+enum {
+    SIG_INPUT = AO_SIG_USER,  // Uma ISR registrou um acionamento (botão, feixe ou crachá)
+    SIG_OCCUPANCY,            // Nova ocupação (arg = usuários ativos)
+    SIG_UI_EVENT,             // Há eventos nas filas de ui_events
+    SIG_BEEP,                 // Tocar um sinal sonoro (arg = ui_beep_t)
+    SIG_JOURNAL,              // Há registros do diário aguardando gravação
+    SIG_CONSOLE,              // Chegaram caracteres no terminal USB
+    SIG_LOG,                  // Há mensagens no log tokenizado
+    SIG_HOST_BATCH,           // Pedido do protocolo USB pronto para execução
+    SIG_HOST_REPLY,           // Resposta do pedido pronta para envio
+    SIG_MIRROR_FRAME,         // O display ou a matriz foram redesenhados
+    SIG_MIRROR_CTRL,          // Liga (arg = 1) ou desliga o espelho
+    SIG_ACTIVITY,             // Houve uma operação de acesso (governador do clock)
+    SIG_IDLE,                 // Modo ocioso do clock: arg = 1 apaga a matriz e escurece o OLED, 0 devolve
+    SIG_SHIFT_SUMMARY,        // Imprimir o resumo do turno e o perfil (pedido pelo reset)
+};
+
+// --- Objetos Ativos ---
+// Núcleo de acesso: entrada, saída, reset, comandos remotos e o governador do clock (as
+// ISRs dos sensores também atendem neste núcleo, onde foram habilitadas; o tick também). Núcleo de interface: saídas
+// (display, LED RGB e matriz), buzzer, diário, terminal, log e espelho.
+static ao_t ao_entrada, ao_saida, ao_reset, ao_remoto;
+static ao_t ao_diario, ao_console, ao_log, ao_espelho;
+
+/**
+ * @struct saidas_ao_t
+ * @brief Objeto ativo das saídas (display OLED, LED RGB e matriz), desenhadas
+ *        nos quadros do compositor: a tela do display, a faixa mostrada em
+ *        cada LED e o passo da animação da matriz.
+ */
+typedef struct {
+    ao_t super;
+    uint8_t tela;                 // TELA_INICIAL, TELA_MENSAGEM ou TELA_PADRAO
+    uint32_t fim_tela_us;         // Fim da tela inicial ou da mensagem (time_us_32)
+    uint8_t faixa_led;            // Faixa mostrada (OCCUPANCY_NUM_BANDS = nenhuma ainda)
+    uint8_t faixa_matriz;
+    MatrixOccupationState_t estado;
+    uint8_t passo;
+    uint32_t fim_animacao_us;
+    bool apagada;                 // Modo ocioso: matriz desligada até o próximo movimento
+} saidas_ao_t;
+static saidas_ao_t ao_saidas = { .faixa_led = OCCUPANCY_NUM_BANDS, .faixa_matriz = OCCUPANCY_NUM_BANDS };
+
+/**
+ * @struct buzzer_ao_t
+ * @brief Objeto ativo do buzzer: toca os sinais sem bloquear o worker.
+ */
+typedef struct {
+    ao_t super;
+    const uint16_t (*fases)[2];  // { frequência (0 = silêncio), duração em ms }
+    uint8_t n_fases;
+    uint8_t fase;
+} buzzer_ao_t;
+static buzzer_ao_t ao_buzzer;
+
+/**
+ * @struct relogio_ao_t
+ * @brief Governador do clk_sys: conta o movimento de acesso em janelas de
+ *        CLOCK_WINDOW_MS e escolhe o modo do clock_mgr.
+ */
+typedef struct {
+    ao_t super;
+    TickType_t inicio_janela;
+    TickType_t ultimo_movimento;
+    uint16_t movimentos;          // Na janela corrente
+    uint16_t movimentos_anterior; // Na janela anterior (histerese do pico)
+    bool ocioso;                  // Matriz e OLED avisados do modo ocioso
+} relogio_ao_t;
+static relogio_ao_t ao_relogio;
+
+static ao_worker_t worker_acesso, worker_interface;
+static StackType_t pilha_acesso[STACK_SIZE_AO_ACESSO];
+static StackType_t pilha_interface[STACK_SIZE_AO_INTERFACE];
+
+MEM_BUDGET_ENTRY(active_objects, "Objetos ativos",
+                 sizeof(ao_entrada) * 8 + sizeof(ao_saidas) + sizeof(ao_buzzer) + sizeof(ao_relogio) +
+                 sizeof(worker_acesso) * 2 + sizeof(pilha_acesso) + sizeof(pilha_interface),
+                 MEM_BUDGET_AO_BYTES);
+
+static void aoEntradaUsuarios(ao_t *me, const ao_event_t *e);
+static void aoSaidaUsuarios(ao_t *me, const ao_event_t *e);
+static void aoResetSistema(ao_t *me, const ao_event_t *e);
+static void aoSaidas(ao_t *me, const ao_event_t *e);
+static void aoBuzzer(ao_t *me, const ao_event_t *e);
+static void aoDiarioFlash(ao_t *me, const ao_event_t *e);
+static void aoConsole(ao_t *me, const ao_event_t *e);
+static void aoLog(ao_t *me, const ao_event_t *e);
+static void aoRemoto(ao_t *me, const ao_event_t *e);
+static void aoEspelho(ao_t *me, const ao_event_t *e);
+static void aoRelogio(ao_t *me, const ao_event_t *e);
+static void aviso_botao(uint gpio);
+static void aviso_feixe(bool entrada);
+static void aviso_cracha(void);
+static void aviso_console(void *param);
+static void aviso_log(void);
+static uint16_t capacidade_ativa(void);
+
+static uint32_t admissoes_prontas_us; // Instante (desde o reset) em que as admissões ficam disponíveis
+
+// Assinatura de eventos de ocupação do protocolo USB (ligada pelo objeto remoto)
+static volatile bool assinatura_ocupacao = false;
+static uint16_t ocupacao_assinada;     // Última ocupação informada ao cliente
+static volatile bool resposta_pronta = false; // Pedido executado, resposta aguardando envio
 
 // --- Inicialização do Sistema ---
 /**
  * @brief Inicializa todos os periféricos e subsistemas necessários para o painel de controle.
- * Configura STDIO, botões, buzzer, LED RGB, matriz de LEDs e o display OLED.
- * Exibe uma tela de inicialização no display.
+ * Configura STDIO, botões, buzzer, matriz de LEDs e o display OLED.
+ * No modo de boot rápido não aguarda o terminal USB e deixa o display
+ * (I2C + tela de inicialização) para a própria tarefa do display. O LED RGB
+ * é inicializado pelo seu objeto ativo, no núcleo de interface.
  */
 void system_init_panel() {
     stdio_init_all();
-    sleep_ms(1000); // Aguarda estabilização do terminal serial
+#if !FAST_BOOT_ENABLED
+    sleep_ms(USB_STDIO_WAIT_MS); // Aguarda estabilização do terminal serial
+#endif
 
     buttons_init();     // Inicializa botões e suas interrupções/flags
+    beam_counter_init(); // Inicializa os sensores de feixe das portas
     buzzer_init();      // Inicializa o pino do buzzer
-    rgb_led_init();     // Inicializa os pinos do LED RGB
     led_matrix_init();  // Inicializa o PIO e a matriz de LEDs
+#if !FAST_BOOT_ENABLED
     display_init(&ssd); // Inicializa o I2C e o controlador do display OLED
+#endif
+    wiegand_init();     // Inicializa os leitores de crachá no PIO
+    journal_init();     // Recupera o diário de eventos da flash
 }
 
 // --- Função Principal ---
 /**
  * @brief Ponto de entrada do programa.
- * Inicializa o sistema, cria os semáforos e mutexes do FreeRTOS,
- * exibe uma tela de inicialização, cria as tarefas da aplicação e
- * inicia o escalonador do FreeRTOS.
+ * Inicializa o sistema, restaura a última ocupação conhecida, cria o
+ * semáforo de vagas do FreeRTOS, cria os objetos ativos e os dois workers
+ * que os executam, habilita o watchdog e inicia o escalonador do FreeRTOS.
  *
  * @return int Código de retorno.
  */
 int main() {
     system_init_panel(); // Inicializa todo o hardware
 
+    // Restaura a ocupação anterior ao reset (watchdog scratch ou diário na flash)
+    uint16_t ocupacao_restaurada = 0;
+    snapshot_source_t origem_snapshot = snapshot_restore(&ocupacao_restaurada);
+    printf("Ocupacao restaurada: %u (%s)\n", ocupacao_restaurada,
+           origem_snapshot == SNAPSHOT_SRC_WATCHDOG ? "watchdog" :
+           origem_snapshot == SNAPSHOT_SRC_FLASH ? "flash" : "nenhuma");
+
     // Cria o semáforo de contagem para controlar as vagas
     // MAX_USERS é o número máximo de "vagas" que o semáforo pode contar
-    // MAX_USERS é também a contagem inicial, significando que todas as vagas estão disponíveis
-    xCountingSemaphoreUsers = xSemaphoreCreateCounting(MAX_USERS, MAX_USERS);
+    // A contagem inicial são as vagas livres após restaurar a ocupação
+    xCountingSemaphoreUsers = xSemaphoreCreateCountingStatic(MAX_USERS, MAX_USERS - ocupacao_restaurada,
+                                                             &semaforo_vagas_buffer);
 
-    // Cria o mutex para proteger o acesso ao display OLED
-    xMutexDisplay = xSemaphoreCreateMutex();
-
-    if (xCountingSemaphoreUsers == NULL || xMutexDisplay == NULL) {
-        printf("FATAL: Failed to create semaphore/mutex!\n");
+    if (xCountingSemaphoreUsers == NULL) {
+        printf("FATAL: Failed to create semaphore!\n");
         while(1); // Trava se a criação falhar
     }
-    printf("mutex e contador iniciados.\n");
+    printf("contador iniciado.\n");
+    journal_log(JOURNAL_EVT_BOOT, JOURNAL_ZONE_BUTTON, 0, ocupacao_restaurada);
+    analytics_init(time_us_64(), ocupacao_restaurada);
+    policy_init(ocupacao_restaurada);
+    printf("Estatisticas iniciadas (%u bytes de RAM).\n", (unsigned)analytics_ram_bytes());
 
-    // Exibe a tela de startup no display APÓS criar o mutex
+#if !FAST_BOOT_ENABLED
+    // Exibe a tela de startup no display antes do escalonador
     display_startup_screen(&ssd);
+    sleep_ms(DISPLAY_SPLASH_MS);
+#endif
+
+    printf("Creating active objects...\n");
+    size_t heap_antes = xPortGetFreeHeapSize();
+    ao_init(&ao_entrada, "Entrada", aoEntradaUsuarios);
+    ao_init(&ao_saida, "Saida", aoSaidaUsuarios);
+    ao_init(&ao_reset, "Reset", aoResetSistema);
+    ao_init(&ao_remoto, "Remoto", aoRemoto);
+    ao_init(&ao_saidas.super, "Saidas", aoSaidas);
+    ao_init(&ao_buzzer.super, "Buzzer", aoBuzzer);
+    ao_init(&ao_diario, "Diario", aoDiarioFlash);
+    ao_init(&ao_console, "Console", aoConsole);
+    ao_init(&ao_log, "Log", aoLog);
+    ao_init(&ao_espelho, "Espelho", aoEspelho);
+    ao_init(&ao_relogio.super, "Relogio", aoRelogio);
 
+    // As ISRs passam a acordar os objetos de acesso em vez de esperar polling.
+    // Só depois de ao_init (os avisos postam nas filas dos objetos): o que os
+    // periféricos enfileiraram desde system_init_panel() é consumido no
+    // AO_SIG_START de cada objeto de acesso
+    buttons_set_listener(aviso_botao);
+    beam_counter_set_listener(aviso_feixe);
+    wiegand_set_listener(aviso_cracha);
+    stdio_set_chars_available_callback(aviso_console, NULL); // Consultas de perfil pelo terminal USB
+    tlog_set_listener(aviso_log);
 
-    printf("Creating tasks...\n");
-    // Cria as tarefas da aplicação, passando prioridades e tamanhos de stack definidos em config.h
-    xTaskCreate(vTaskEntradaUsuarios, "EntradaUser", STACK_SIZE_DEFAULT, NULL, PRIORITY_ENTRADA_USUARIO, NULL);
-    xTaskCreate(vTaskSaidaUsuarios, "SaidaUser", STACK_SIZE_DEFAULT, NULL, PRIORITY_SAIDA_USUARIO, NULL);
-    xTaskCreate(vTaskResetSistema, "ResetSystem", STACK_SIZE_DEFAULT, NULL, PRIORITY_RESET_SYSTEM, NULL);
-    xTaskCreate(vTaskFeedbackVisualLedRgb, "LedFeedback", STACK_SIZE_DEFAULT, NULL, PRIORITY_FEEDBACK_RGB, NULL);
-    xTaskCreate(vTaskDisplayInfoOled, "DisplayInfo", STACK_SIZE_DISPLAY, &ssd, PRIORITY_DISPLAY_INFO, NULL);
-    xTaskCreate(vTaskLedMatrixControl, "MatrixCtrl", STACK_SIZE_DEFAULT, NULL, PRIORITY_MATRIX, NULL); // Prioridade da matriz
+    // Periféricos recalculados a cada troca do clk_sys (objeto Relogio)
+    clock_mgr_register(display_clock_listener);
+    clock_mgr_register(led_matrix_clock_listener);
+    clock_mgr_register(buzzer_clock_listener);
+    clock_mgr_register(wiegand_clock_listener);
+    clock_mgr_register(policy_clock_listener);
+    clock_mgr_register(rgb_led_clock_listener);
+    low_power_init(); // Alarme do tickless, com a IRQ neste núcleo (o do tick)
+
+    // Faixa da ocupação restaurada: o primeiro quadro das saídas já a mostra
+    occupancy_band_t faixa_inicial;
+    occupancy_band_update(ocupacao_restaurada, capacidade_ativa(), &faixa_inicial);
+
+    // Workers: um por núcleo, com prioridades, stacks estáticas e afinidades definidos em config.h
+    ao_t *const objetos_acesso[] = { &ao_entrada, &ao_saida, &ao_reset, &ao_remoto, &ao_relogio.super };
+    ao_t *const objetos_interface[] = { &ao_saidas.super, &ao_buzzer.super, &ao_diario, &ao_console, &ao_log,
+                                         &ao_espelho };
+    ao_worker_start(&worker_acesso, "Acesso", objetos_acesso, 5, pilha_acesso,
+                    STACK_SIZE_AO_ACESSO, PRIORITY_AO_ACESSO, CORE_AFFINITY_ACESSO);
+    ao_worker_start(&worker_interface, "Interface", objetos_interface, 6, pilha_interface,
+                    STACK_SIZE_AO_INTERFACE, PRIORITY_AO_INTERFACE, CORE_AFFINITY_INTERFACE);
+    printf("Objetos ativos e workers: %u bytes de heap (queue sets).\n", (unsigned)(heap_antes - xPortGetFreeHeapSize()));
+    mem_budget_print();
+
+    // Watchdog de hardware: alimentado pelo idle hook, reinicia se alguma tarefa monopolizar a CPU
+    watchdog_enable(WATCHDOG_TIMEOUT_MS, true);
 
     printf("Inicializacao do FreeRTOS...\n"); // Corrigido para "Inicialização"
     vTaskStartScheduler(); // Inicia o escalonador do FreeRTOS
@@ -86,247 +266,1066 @@ int main() {
     while(1);
 }
 
-// --- Implementações das Tarefas ---
+// --- Avisos das ISRs ---
+// Executados em contexto de interrupção: apenas acordam o objeto ativo, que
+// consome as flags/filas dos módulos de entrada como antes.
+
+static void aviso_botao(uint gpio) {
+    BaseType_t acordou = pdFALSE;
+    ao_t *destino = (gpio == BUTTON_A_PIN) ? &ao_entrada : (gpio == BUTTON_B_PIN) ? &ao_saida : &ao_reset;
+    ao_post_from_isr(destino, SIG_INPUT, 0, &acordou);
+    portYIELD_FROM_ISR(acordou);
+}
+
+static void aviso_feixe(bool entrada) {
+    BaseType_t acordou = pdFALSE;
+    ao_post_from_isr(entrada ? &ao_entrada : &ao_saida, SIG_INPUT, 0, &acordou);
+    portYIELD_FROM_ISR(acordou);
+}
+
+static void aviso_cracha(void) {
+    BaseType_t acordou = pdFALSE;
+    ao_post_from_isr(&ao_entrada, SIG_INPUT, 0, &acordou);
+    portYIELD_FROM_ISR(acordou);
+}
+
+static void aviso_console(void *param) {
+    BaseType_t acordou = pdFALSE;
+    ao_post_from_isr(&ao_console, SIG_CONSOLE, 0, &acordou);
+    portYIELD_FROM_ISR(acordou);
+}
+
+// O log pode ser escrito de tarefas ou de ISRs
+static void aviso_log(void) {
+    if (portCHECK_IF_IN_ISR()) {
+        BaseType_t acordou = pdFALSE;
+        ao_post_from_isr(&ao_log, SIG_LOG, 0, &acordou);
+        portYIELD_FROM_ISR(acordou);
+    } else {
+        ao_post(&ao_log, SIG_LOG, 0);
+    }
+}
 
 /**
- * @brief Tarefa responsável por processar a entrada de usuários.
- * Monitora o Botão A. Se pressionado, tenta "ocupar" uma vaga decrementando
- * o semáforo de contagem. Se o espaço estiver lotado (semáforo não pôde ser tomado),
- * emite um beep de aviso. Atualiza o display OLED com o status da operação e
- * a contagem atual de usuários/vagas, protegendo o acesso com um mutex.
+ * @brief Imprime o perfil de execução: CPU e stack por tarefa, trocas de
+ *        contexto, ISRs, latências e estatísticas dos objetos ativos.
  */
-void vTaskEntradaUsuarios(void *pvParameters) {
-    printf("Task da Entrada de Usuarios iniciada.\n");
-    char display_msg[30] = "";
+static void imprime_perfil(void) {
+    const ao_worker_t *const workers[] = { &worker_acesso, &worker_interface };
 
-    while (true) {
-        if (buttons_a_pressed()) { // Verifica se o Botão A foi acionado
-            printf("Botao A pressionado - Tentando entrada.\n");
-            // Tenta tomar uma "vaga" do semáforo (decrementar a contagem de vagas disponíveis)
-            if (xSemaphoreTake(xCountingSemaphoreUsers, pdMS_TO_TICKS(50)) == pdTRUE) {
-                // Sucesso: vaga ocupada
-                uint32_t vagas_atuais = uxSemaphoreGetCount(xCountingSemaphoreUsers);
-                uint8_t usuarios_ativos = MAX_USERS - vagas_atuais;
-                printf("Entrada OK! Usuarios: %u, Vagas: %lu\n", usuarios_ativos, vagas_atuais);
-                sprintf(display_msg, "Entrada (%u/%u)", usuarios_ativos, MAX_USERS);
-            } else {
-                // Falha: semáforo em 0 (sem vagas) - capacidade máxima atingida
-                printf("Capacidade Maxima Atingida!\n");
-                buzzer_play_tone(BUZZER_BEEP_SHORT_FREQ, BUZZER_BEEP_SHORT_MS); // Beep de lotado
-                strcpy(display_msg, "Lotado!");
-            }
+    profiler_print();
+    latency_print();
+    ao_print_stats(workers, 2);
 
-            // Atualiza o display (operação protegida por mutex)
-            if (xSemaphoreTake(xMutexDisplay, portMAX_DELAY) == pdTRUE) {
-                uint32_t vagas = uxSemaphoreGetCount(xCountingSemaphoreUsers); 
-                display_update(&ssd, MAX_USERS - vagas, MAX_USERS, display_msg);
-                xSemaphoreGive(xMutexDisplay);
-            }
+    buttons_stats_t botoes;
+    buttons_get_stats(&botoes);
+    printf("Botoes: %" PRIu32 " aceitos (%" PRIu32 " injetados), %" PRIu32 " no debounce, %" PRIu32
+           " fundidos com um pendente\n",
+           botoes.accepted, botoes.injected, botoes.debounced, botoes.coalesced);
+    beam_door_stats_t feixe;
+    for (uint8_t porta = 0; beam_counter_get_stats(porta, &feixe); ++porta) {
+        printf("Feixes, porta %u: %" PRIu32 " entradas, %" PRIu32 " saidas, %" PRIu32 " caronas, %" PRIu32
+               " desistencias\n", porta, feixe.entries, feixe.exits, feixe.tailgates, feixe.aborted);
+    }
+    printf("Interface: %" PRIu32 " eventos descartados (fila cheia), %" PRIu32 " trocas de faixa de ocupacao\n",
+           ui_events_dropped(), occupancy_band_transitions());
+    printf("Log: %" PRIu32 " mensagens descartadas (anel cheio)\n", tlog_dropped());
+
+    policy_stats_t politica;
+    policy_get_stats(&politica);
+    printf("Politica: %" PRIu32 " avaliacoes, %" PRIu32 " recusas, pior %" PRIu32 " ciclos (%" PRIu32
+           " us), %" PRIu32 " acima do orcamento de %u us\n",
+           politica.evaluations, politica.denied, politica.worst_cycles,
+           politica.worst_cycles / (clock_get_hz(clk_sys) / 1000000), politica.over_budget, POLICY_EVAL_BUDGET_US);
+
+    journal_stats_t diario;
+    journal_get_stats(&diario);
+    printf("Diario: %" PRIu32 " gravados, %" PRIu32 " descartados (anel cheio), %" PRIu32
+           " paginas com falha (regravadas), %" PRIu32 " setores que nao apagaram\n",
+           diario.committed, diario.dropped, diario.program_failed, diario.erase_failed);
+
+    display_link_stats_t link;
+    display_get_link_stats(&link);
+    printf("Display: I2C a %" PRIu32 " kHz; FM+: %" PRIu32 " quadros, %" PRIu32 " erros; FM: %" PRIu32
+           " quadros, %" PRIu32 " erros; "
+           "%" PRIu32 " recuperacoes (%" PRIu32 " com o barramento preso), %" PRIu32
+           " quedas para FM, %" PRIu32 " quadros perdidos\n",
+           display_link_hz() / 1000, link.frames[DISPLAY_SPEED_FMP], link.errors[DISPLAY_SPEED_FMP],
+           link.frames[DISPLAY_SPEED_FM], link.errors[DISPLAY_SPEED_FM], link.recoveries, link.stuck,
+           link.fallbacks, link.dropped);
+
+    clock_stats_t relogio;
+    clock_mgr_get_stats(&relogio);
+    printf("Clock: %s a %" PRIu32 " kHz; %" PRIu32 " trocas (ocioso %" PRIu32 ", normal %" PRIu32
+           ", pico %" PRIu32 "), %" PRIu32 " adiadas, %" PRIu32 " falhas, pior %" PRIu32 " us\n",
+           clock_mgr_mode_name(clock_mgr_mode()), clock_get_hz(clk_sys) / 1000, relogio.switches,
+           relogio.entered[CLOCK_MODE_IDLE], relogio.entered[CLOCK_MODE_NORMAL], relogio.entered[CLOCK_MODE_BURST],
+           relogio.deferred, relogio.failed, relogio.max_us);
+    low_power_print();
+    compositor_print();
+    if (mirror_enabled()) {
+        mirror_stats_t espelho;
+        mirror_get_stats(&espelho);
+        printf("Espelho: %" PRIu32 " paginas, %" PRIu32 " bytes, %" PRIu32 " adiamentos por banda\n",
+               espelho.pages, espelho.bytes, espelho.deferred);
+    }
+}
+
+// Capacidade em vigor: o limite rígido da tabela ativa da política (SET_LIMITS
+// muda em tempo de execução; MAX_USERS é só o tamanho do semáforo de vagas)
+static uint16_t capacidade_ativa(void) {
+    uint16_t suave, rigido;
+    policy_get_limits(&suave, &rigido);
+    return rigido;
+}
+
+/**
+ * @brief Publica o resultado de uma operação de acesso para o núcleo de interface:
+ *        ocupação e faixa no instantâneo de occupancy_band (lido uma vez por
+ *        quadro pelo objeto de saídas), mensagem e beep pela fila de ui_events.
+ *        Marca o instante da decisão para a latência até o display e conta o
+ *        movimento para o governador do clock.
+ */
+static void publicar_interface(ui_source_t origem, ui_event_t *ui) {
+    occupancy_band_t faixa;
+
+    occupancy_band_update(ui->occupancy, capacidade_ativa(), &faixa); // Antes do evento: o quadro que o mostra já vê a faixa
+    ui->decided_us = time_us_32();
+    ui_events_post(origem, ui);
+    ao_post(&ao_saidas.super, SIG_UI_EVENT, 0);
+    ao_post(&ao_relogio.super, SIG_ACTIVITY, 0);
+    if (assinatura_ocupacao) {
+        ao_post(&ao_console, SIG_OCCUPANCY, ui->occupancy);
+    }
+}
+
+/**
+ * @brief Registra um evento no diário e avisa o objeto que grava na flash.
+ */
+static void registrar_diario(journal_event_type_t tipo, uint8_t zona, uint32_t cracha, uint16_t ocupacao) {
+    journal_log(tipo, zona, cracha, ocupacao);
+    ao_post(&ao_diario, SIG_JOURNAL, 0);
+}
+
+// --- Objetos Ativos de Acesso ---
+
+/**
+ * @brief Tenta admitir uma pessoa: avalia a política (horário, reservas, taxa
+ * da porta e limites) e, se admitida, "ocupa" uma vaga decrementando o
+ * semáforo de contagem. Registra o resultado no diário, no snapshot, nas
+ * estatísticas e no log. Usada pelos acionamentos locais e pelo protocolo USB.
+ *
+ * @param grupo Grupo de acesso de quem entra.
+ * @param porta Porta avaliada pela política (POLICY_DOOR_BEAM nunca é recusada por ela).
+ * @param origem Zona registrada no diário.
+ * @param cartao Número do crachá (0 se não houver).
+ * @param ocupacao_final Saída: ocupação após a tentativa.
+ * @return Decisão final (POLICY_DENY_FULL se o semáforo não tinha vaga).
+ */
+static policy_decision_t admite(uint8_t grupo, uint8_t porta, uint8_t origem, uint32_t cartao,
+                                uint16_t *ocupacao_final) {
+    static bool primeira_admissao = true;
+
+    uint16_t ocupacao = MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers);
+    policy_decision_t decisao = policy_evaluate(grupo, porta, ocupacao, to_ms_since_boot(get_absolute_time()));
+
+    // Quem cruzou os feixes já está dentro: a política só marca a faixa de aviso,
+    // e a passagem é contada enquanto o semáforo tiver vaga
+    if (porta == POLICY_DOOR_BEAM && decisao > POLICY_ALLOW_WARN) decisao = POLICY_ALLOW_WARN;
+
+    // Se admitido, tenta tomar uma "vaga" do semáforo (sem bloquear: o worker atende outros objetos)
+    if (decisao <= POLICY_ALLOW_WARN && xSemaphoreTake(xCountingSemaphoreUsers, 0) == pdTRUE) {
+        // Sucesso: vaga ocupada
+        uint32_t vagas_atuais = uxSemaphoreGetCount(xCountingSemaphoreUsers);
+        uint16_t usuarios_ativos = MAX_USERS - vagas_atuais;
+        TRACE(TRACE_EVT_SEM_TAKE, vagas_atuais);
+        TLOG(ENTRADA_OK, usuarios_ativos, vagas_atuais);
+        registrar_diario(JOURNAL_EVT_ENTRY, origem, cartao, usuarios_ativos);
+        snapshot_save(usuarios_ativos);
+        policy_commit_entry(grupo);
+        analytics_record(ANALYTICS_EVT_ENTRY, usuarios_ativos, time_us_64());
+        if (primeira_admissao) {
+            // Reportado aqui (e não no boot) para que o terminal USB já esteja conectado
+            TLOG(PRIMEIRA_ADMISSAO, admissoes_prontas_us, time_us_32());
+            primeira_admissao = false;
         }
-        vTaskDelay(pdMS_TO_TICKS(BUTTON_POLL_DELAY_MS)); // Pausa para polling do botão
-    }
-}
-
-/**
- * @brief Tarefa responsável por processar a saída de usuários.
- * Monitora o Botão B. Se pressionado e houver usuários no espaço
- * (ou seja, o semáforo de vagas não está no máximo), "libera" uma vaga
- * incrementando o semáforo de contagem. Atualiza o display OLED
- * com o status e a contagem, protegendo o acesso com um mutex.
- */
-void vTaskSaidaUsuarios(void *pvParameters) {
-    printf("Task Saida Usuarios iniciada.\n");
-    char display_msg[30] = "";
-
-    while (true) {
-        if (buttons_b_pressed()) { // Verifica se o Botão B foi acionado
-            printf("Botao B pressionado - Tentando saida.\n");
-            // Verifica se há usuários para sair (ou seja, se nem todas as vagas estão disponíveis)
-            if (uxSemaphoreGetCount(xCountingSemaphoreUsers) < MAX_USERS) {
-                // Libera uma vaga, incrementando a contagem de vagas disponíveis no semáforo
-                if (xSemaphoreGive(xCountingSemaphoreUsers) == pdTRUE) {
-                    // Sucesso: vaga liberada
-                    uint32_t vagas_atuais = uxSemaphoreGetCount(xCountingSemaphoreUsers);
-                    uint8_t usuarios_ativos = MAX_USERS - vagas_atuais;
-                    printf("Saida OK! Usuarios: %u, Vagas: %lu\n", usuarios_ativos, vagas_atuais);
-                    sprintf(display_msg, "Saida (%u/%u)", usuarios_ativos, MAX_USERS);
-                } else {
-                    // Esta condição (falha ao dar give em semáforo de contagem abaixo do max)
-                    // não deveria ocorrer se a lógica estiver correta.
-                    strcpy(display_msg, "Erro Saida!");
-                }
-            } else {
-                // Todas as vagas já estão disponíveis (ninguém para sair)
-                printf("Espaco Vazio. Ninguem para sair.\n");
-                strcpy(display_msg, "Vazio");
-            }
+        *ocupacao_final = usuarios_ativos;
+        return decisao;
+    }
 
-            // Atualiza o display (operação protegida por mutex)
-            if (xSemaphoreTake(xMutexDisplay, portMAX_DELAY) == pdTRUE) {
-                uint32_t vagas = uxSemaphoreGetCount(xCountingSemaphoreUsers); // Re-lê para consistência
-                display_update(&ssd, MAX_USERS - vagas, MAX_USERS, display_msg); // Assumindo que display_update é sua função
-                xSemaphoreGive(xMutexDisplay);
-            }
+    // Falha: recusado pela política ou semáforo em 0 (sem vagas)
+    TRACE(TRACE_EVT_SEM_TAKE_FAIL, MAX_USERS - ocupacao);
+    if (decisao <= POLICY_ALLOW_WARN) decisao = POLICY_DENY_FULL;
+    registrar_diario(JOURNAL_EVT_REJECT, origem, cartao, ocupacao);
+    analytics_record(ANALYTICS_EVT_REJECT, ocupacao, time_us_64());
+    switch (decisao) {
+        case POLICY_DENY_SCHEDULE: TLOG(RECUSA_HORARIO); break;
+        case POLICY_DENY_RATE:     TLOG(RECUSA_TAXA); break;
+        case POLICY_DENY_RESERVED: TLOG(RECUSA_RESERVA); break;
+        default:                   TLOG(RECUSA_LOTADO); break;
+    }
+    *ocupacao_final = MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers);
+    return decisao;
+}
+
+/**
+ * @brief Processa uma tentativa de entrada pendente, se houver.
+ * Verifica o Botão A, os sensores de feixe e os leitores de crachá (nessa
+ * ordem) e tenta a admissão. Se recusada (política ou espaço lotado), pede um
+ * beep de aviso. O status da operação e a contagem atual de usuários/vagas
+ * são publicados para o núcleo de interface.
+ *
+ * @return true se uma tentativa foi processada. Caso contrário, false.
+ */
+static bool processa_entrada(void) {
+    static ui_event_t ui;
+    wiegand_badge_t badge;
+
+    bool botao_a = buttons_a_pressed();                                  // Verifica se o Botão A foi acionado
+    bool feixe = !botao_a && beam_counter_take_entry();                  // Ou se os feixes detectaram uma entrada
+    bool cracha_lido = !botao_a && !feixe && wiegand_get_badge(&badge);  // Ou se um crachá foi lido
+
+    if (!botao_a && !feixe && !cracha_lido) return false;
+
+    uint8_t origem = feixe ? JOURNAL_ZONE_BEAM : (cracha_lido ? badge.reader : JOURNAL_ZONE_BUTTON);
+    uint32_t cartao = cracha_lido ? badge.card_number : 0;
+    if (feixe) {
+        TLOG(ENTRADA_FEIXE);
+    } else if (cracha_lido) {
+        TLOG(ENTRADA_CRACHA, badge.reader, badge.bit_count, badge.facility, badge.card_number);
+    } else {
+        TLOG(ENTRADA_BOTAO);
+    }
+    uint8_t grupo = cracha_lido ? policy_group_for_facility(badge.facility) : POLICY_GROUP_DEFAULT;
+    uint8_t porta = feixe ? POLICY_DOOR_BEAM : (cracha_lido ? badge.reader : POLICY_DOOR_BUTTON);
+    uint16_t usuarios_ativos;
+    policy_decision_t decisao = admite(grupo, porta, origem, cartao, &usuarios_ativos);
+
+    ui.beep = decisao <= POLICY_ALLOW_WARN ? UI_BEEP_NONE : UI_BEEP_SHORT; // Beep de recusa
+    switch (decisao) {
+        case POLICY_ALLOW:         sprintf(ui.message, "Entrada (%u/%u)", usuarios_ativos, capacidade_ativa()); break;
+        case POLICY_ALLOW_WARN:    sprintf(ui.message, "Quase lotado (%u/%u)", usuarios_ativos, capacidade_ativa()); break;
+        case POLICY_DENY_SCHEDULE: strcpy(ui.message, "Fora do horario"); break;
+        case POLICY_DENY_RATE:     strcpy(ui.message, "Aguarde"); break;
+        case POLICY_DENY_RESERVED: strcpy(ui.message, "Vaga reservada"); break;
+        default:                   strcpy(ui.message, "Lotado!"); break;
+    }
+
+    // Latência do acionamento do botão até a decisão (os demais acionamentos não têm instante da ISR)
+    if (botao_a) {
+        latency_record(LATENCY_ADMIT, time_us_32() - buttons_a_press_time_us());
+    }
+
+    // Publica o resultado para o núcleo de interface (display, buzzer, LED RGB e matriz)
+    ui.occupancy = usuarios_ativos;
+    publicar_interface(UI_SOURCE_ENTRADA, &ui);
+    return true;
+}
+
+/**
+ * @brief Objeto ativo da entrada de usuários.
+ * Acordado pelas ISRs do Botão A, dos feixes e dos leitores de crachá;
+ * processa todas as tentativas pendentes. No início consome o que chegou
+ * antes de os avisos das ISRs serem registrados.
+ */
+static void aoEntradaUsuarios(ao_t *me, const ao_event_t *e) {
+    if (e->sig == AO_SIG_START) {
+        admissoes_prontas_us = time_us_32();
+    }
+    if (e->sig == AO_SIG_START || e->sig == SIG_INPUT) {
+        while (processa_entrada()) {
         }
-        vTaskDelay(pdMS_TO_TICKS(BUTTON_POLL_DELAY_MS)); // Pausa para polling do botão
-    }
-}
-
-/**
- * @brief Tarefa responsável por resetar o sistema de contagem de usuários.
- * Monitora o botão do joystick (via `buttons_joystick_pressed()`, que consome
- * uma flag setada pela ISR). Se pressionado, emite um beep duplo de confirmação
- * e restaura o semáforo de contagem para seu estado inicial (todas as vagas
- * disponíveis), iterando `xSemaphoreGive`. Atualiza o display OLED,
- * protegendo o acesso com um mutex.
- */
-void vTaskResetSistema(void *pvParameters) {
-    printf("Task Reset Sistema iniciada.\n");
-    char display_msg[30] = "";
-
-    while (true) {
-        if (buttons_joystick_pressed()) { // Verifica se o botão do joystick foi acionado
-            printf("Botao Joystick pressionado - RESET SOLICITADO!\n");
-
-            // Emite beep duplo de reset
-            buzzer_play_tone(BUZZER_BEEP_RESET_FREQ, BUZZER_BEEP_RESET_ON_MS);
-            vTaskDelay(pdMS_TO_TICKS(BUZZER_BEEP_RESET_OFF_MS)); // Pausa entre beeps
-            buzzer_play_tone(BUZZER_BEEP_RESET_FREQ, BUZZER_BEEP_RESET_ON_MS);
-
-            printf("Resetando contagem de usuarios...\n");
-            // Entra em seção crítica para garantir que a manipulação do semáforo seja atômica
-            // em relação a outras tarefas que possam tentar usá-lo (embora aqui o objetivo seja "encher" as vagas).
-            taskENTER_CRITICAL();
-            // Libera todas as vagas dando "give" no semáforo até ele atingir MAX_USERS
-            while (uxSemaphoreGetCount(xCountingSemaphoreUsers) < MAX_USERS) {
-                if (xSemaphoreGive(xCountingSemaphoreUsers) != pdTRUE) {
-                    // Improvável
-                    printf("Erro critico ao encerrar o semaforo durante o reset!\n");
-                    break;
-                }
-            }
-            taskEXIT_CRITICAL(); // Sai da seção crítica
+    }
+}
 
-            uint32_t vagas_apos_reset = uxSemaphoreGetCount(xCountingSemaphoreUsers);
-            printf("Sistema Resetado! Vagas: %lu / %u\n", vagas_apos_reset, MAX_USERS);
-            strcpy(display_msg, "Sistema Resetado");
+// Resultado de libera()
+typedef enum {
+    SAIDA_REGISTRADA,
+    SAIDA_VAZIO,      // Ninguém para sair
+    SAIDA_FALHA,      // Give recusado abaixo do máximo (não deveria ocorrer)
+} saida_t;
 
-            // Atualiza o display (operação protegida por mutex)
-            if (xSemaphoreTake(xMutexDisplay, portMAX_DELAY) == pdTRUE) {
-                // Mostra 0 usuários ativos após o reset
-                display_update(&ssd, 0, MAX_USERS, display_msg);
-                xSemaphoreGive(xMutexDisplay);
-            }
+/**
+ * @brief Registra uma saída: se há usuários no espaço (ou seja, o semáforo de
+ * vagas não está no máximo), "libera" uma vaga incrementando o semáforo de
+ * contagem e registra no diário, no snapshot, nas estatísticas e no log.
+ *
+ * @param origem Zona registrada no diário.
+ * @param ocupacao_final Saída: ocupação após a tentativa.
+ * @return Resultado da saída.
+ */
+static saida_t libera(uint8_t origem, uint16_t *ocupacao_final) {
+    saida_t resultado = SAIDA_VAZIO;
+
+    // Verifica se há usuários para sair (ou seja, se nem todas as vagas estão disponíveis)
+    if (uxSemaphoreGetCount(xCountingSemaphoreUsers) < MAX_USERS) {
+        // Libera uma vaga, incrementando a contagem de vagas disponíveis no semáforo
+        if (xSemaphoreGive(xCountingSemaphoreUsers) == pdTRUE) {
+            // Sucesso: vaga liberada
+            uint32_t vagas_atuais = uxSemaphoreGetCount(xCountingSemaphoreUsers);
+            uint16_t usuarios_ativos = MAX_USERS - vagas_atuais;
+            TRACE(TRACE_EVT_SEM_GIVE, vagas_atuais);
+            TLOG(SAIDA_OK, usuarios_ativos, vagas_atuais);
+            registrar_diario(JOURNAL_EVT_EXIT, origem, 0, usuarios_ativos);
+            snapshot_save(usuarios_ativos);
+            policy_commit_exit();
+            analytics_record(ANALYTICS_EVT_EXIT, usuarios_ativos, time_us_64());
+            resultado = SAIDA_REGISTRADA;
+        } else {
+            // Esta condição (falha ao dar give em semáforo de contagem abaixo do max)
+            // não deveria ocorrer se a lógica estiver correta.
+            TLOG(SAIDA_ERRO, uxSemaphoreGetCount(xCountingSemaphoreUsers), MAX_USERS);
+            resultado = SAIDA_FALHA;
+        }
+    } else {
+        // Todas as vagas já estão disponíveis (ninguém para sair)
+        TLOG(SAIDA_VAZIO);
+    }
+    *ocupacao_final = MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers); // Re-lê para consistência
+    return resultado;
+}
+
+/**
+ * @brief Processa uma saída pendente, se houver.
+ * Verifica o Botão B e os sensores de feixe e registra a saída. O status e a
+ * contagem são publicados para o núcleo de interface.
+ *
+ * @return true se uma saída foi processada. Caso contrário, false.
+ */
+static bool processa_saida(void) {
+    static ui_event_t ui;
+
+    bool botao_b = buttons_b_pressed();                  // Verifica se o Botão B foi acionado
+    bool feixe = !botao_b && beam_counter_take_exit();  // Ou se os feixes detectaram uma saída
+
+    if (!botao_b && !feixe) return false;
+
+    if (feixe) {
+        TLOG(SAIDA_FEIXE);
+    } else {
+        TLOG(SAIDA_BOTAO);
+    }
+    uint16_t usuarios_ativos;
+    switch (libera(feixe ? JOURNAL_ZONE_BEAM : JOURNAL_ZONE_BUTTON, &usuarios_ativos)) {
+        case SAIDA_REGISTRADA: sprintf(ui.message, "Saida (%u/%u)", usuarios_ativos, capacidade_ativa()); break;
+        case SAIDA_VAZIO:      strcpy(ui.message, "Vazio"); break;
+        default:               strcpy(ui.message, "Erro Saida!"); break;
+    }
+
+    // Publica o resultado para o núcleo de interface
+    ui.beep = UI_BEEP_NONE;
+    ui.occupancy = usuarios_ativos;
+    publicar_interface(UI_SOURCE_SAIDA, &ui);
+    return true;
+}
+
+/**
+ * @brief Objeto ativo da saída de usuários, acordado pelas ISRs do Botão B e dos feixes.
+ */
+static void aoSaidaUsuarios(ao_t *me, const ao_event_t *e) {
+    if (e->sig == AO_SIG_START || e->sig == SIG_INPUT) {
+        while (processa_saida()) {
+        }
+    }
+}
+
+/**
+ * @brief Zera a contagem: restaura o semáforo de contagem para seu estado
+ * inicial (todas as vagas disponíveis), iterando `xSemaphoreGive`, e registra
+ * o reset no diário, no snapshot, na política e nas estatísticas.
+ *
+ * @param origem Zona registrada no diário.
+ * @return Vagas livres após o reset.
+ */
+static uint32_t zera_contagem(uint8_t origem) {
+    bool falhou = false;
+
+    // Entra em seção crítica para garantir que a manipulação do semáforo seja atômica
+    // em relação a outras tarefas que possam tentar usá-lo (embora aqui o objetivo seja "encher" as vagas).
+    taskENTER_CRITICAL();
+    // Libera todas as vagas dando "give" no semáforo até ele atingir MAX_USERS
+    while (uxSemaphoreGetCount(xCountingSemaphoreUsers) < MAX_USERS) {
+        if (xSemaphoreGive(xCountingSemaphoreUsers) != pdTRUE) {
+            falhou = true; // Improvável; registrado fora da seção crítica
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(); // Sai da seção crítica
+    if (falhou) {
+        TLOG(RESET_ERRO, uxSemaphoreGetCount(xCountingSemaphoreUsers), MAX_USERS);
+    }
+
+    uint32_t vagas_apos_reset = uxSemaphoreGetCount(xCountingSemaphoreUsers);
+    TRACE(TRACE_EVT_SEM_GIVE, vagas_apos_reset);
+    registrar_diario(JOURNAL_EVT_RESET, origem, 0, 0);
+    snapshot_save(0);
+    policy_reset();
+    analytics_record(ANALYTICS_EVT_RESET, 0, time_us_64());
+    return vagas_apos_reset;
+}
+
+/**
+ * @brief Objeto ativo do reset da contagem de usuários.
+ * Acordado pela ISR do botão do joystick (`buttons_joystick_pressed()` consome
+ * a flag). Restaura o semáforo de contagem para seu estado inicial (todas as
+ * vagas disponíveis), iterando `xSemaphoreGive`, e pede ao núcleo de interface
+ * o resumo do turno, o beep duplo de confirmação e a tela de reset. Nada aqui
+ * espera pelo terminal: as mensagens vão para o log tokenizado e o resumo é
+ * formatado pelo objeto do console.
+ */
+static void aoResetSistema(ao_t *me, const ao_event_t *e) {
+    static ui_event_t ui = { .occupancy = 0, .beep = UI_BEEP_RESET, .message = "Sistema Resetado" };
+
+    if ((e->sig != AO_SIG_START && e->sig != SIG_INPUT) || !buttons_joystick_pressed()) return;
+
+    TLOG(RESET_PEDIDO);
+
+    // Resumo do turno, formatado no núcleo de interface (as janelas não são zeradas pelo reset)
+    ao_post(&ao_console, SIG_SHIFT_SUMMARY, 0);
+
+    uint32_t vagas_apos_reset = zera_contagem(JOURNAL_ZONE_BUTTON);
+    TLOG(RESET_OK, vagas_apos_reset, MAX_USERS);
+
+    // Beep duplo e 0 usuários ativos no display, pelo núcleo de interface
+    publicar_interface(UI_SOURCE_RESET, &ui);
+}
+
+/**
+ * @brief Executa um comando do protocolo USB e registra o resultado na resposta.
+ * @return true se o comando pode ter mudado a ocupação ou a capacidade.
+ */
+static bool executa_comando(const usb_proto_cmd_t *cmd) {
+    uint16_t ocupacao = MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers);
+
+    switch (cmd->code) {
+        case USB_PROTO_CMD_PING:
+            usb_proto_result(USB_PROTO_OK, USB_PROTO_VERSION, NULL, 0);
+            return false;
+
+        case USB_PROTO_CMD_ADMIT: {
+            uint8_t grupo = cmd->a ? policy_group_for_facility(cmd->a) : POLICY_GROUP_DEFAULT;
+            policy_decision_t decisao = admite(grupo, POLICY_DOOR_HOST, JOURNAL_ZONE_HOST, cmd->card, &ocupacao);
+            usb_proto_result((uint8_t)decisao, ocupacao, NULL, 0);
+            return true;
+        }
+
+        case USB_PROTO_CMD_RELEASE: {
+            saida_t resultado = libera(JOURNAL_ZONE_HOST, &ocupacao);
+            usb_proto_result(resultado == SAIDA_REGISTRADA ? USB_PROTO_OK : USB_PROTO_ERR_REJECTED, ocupacao, NULL, 0);
+            return true;
+        }
+
+        case USB_PROTO_CMD_RESET:
+            zera_contagem(JOURNAL_ZONE_HOST);
+            usb_proto_result(USB_PROTO_OK, 0, NULL, 0);
+            return true;
+
+        case USB_PROTO_CMD_SET_LIMITS: {
+            bool ok = policy_set_limits(cmd->a, cmd->b);
+            usb_proto_result(ok ? USB_PROTO_OK : USB_PROTO_ERR_REJECTED, ocupacao, NULL, 0);
+            return ok; // Nova capacidade: faixa e display reclassificados no fim do lote
+        }
+
+        case USB_PROTO_CMD_SET_TIME:
+            policy_set_time_of_day(cmd->a);
+            usb_proto_result(USB_PROTO_OK, ocupacao, NULL, 0);
+            return false;
+
+        case USB_PROTO_CMD_LOAD_POLICY: {
+            bool ok = policy_load(cmd->rules, cmd->n_rules);
+            usb_proto_result(ok ? USB_PROTO_OK : USB_PROTO_ERR_REJECTED, ocupacao, NULL, 0);
+            return ok; // A tabela nova pode trazer outro limite rígido
         }
-        vTaskDelay(pdMS_TO_TICKS(BUTTON_POLL_DELAY_MS)); // Pausa para polling do botão
+
+        case USB_PROTO_CMD_STATS: {
+            usb_proto_stats_t st;
+            policy_stats_t politica;
+            journal_stats_t diario;
+            uint16_t suave, rigido;
+
+            policy_get_stats(&politica);
+            policy_get_limits(&suave, &rigido);
+            journal_get_stats(&diario);
+            st.occupancy = ocupacao;
+            st.soft_limit = suave;
+            st.hard_limit = rigido;
+            st.policy_evaluations = politica.evaluations;
+            st.policy_denied = politica.denied;
+            st.policy_worst_cycles = politica.worst_cycles;
+            st.policy_over_budget = politica.over_budget;
+            st.journal_committed = diario.committed;
+            st.journal_dropped = diario.dropped;
+            st.ui_dropped = ui_events_dropped();
+            st.log_dropped = tlog_dropped();
+            usb_proto_get_counters(&st.frames, &st.frame_errors);
+            usb_proto_result(USB_PROTO_OK, sizeof(st), &st, sizeof(st));
+            return false;
+        }
+
+        case USB_PROTO_CMD_MIRROR:
+            // O espelho lê os buffers do display e da matriz: roda no núcleo de interface
+            ao_post(&ao_espelho, SIG_MIRROR_CTRL, cmd->a != 0);
+            usb_proto_result(USB_PROTO_OK, ocupacao, NULL, 0);
+            return false;
+
+        case USB_PROTO_CMD_SUBSCRIBE:
+            // A resposta leva a ocupação de partida; os eventos trazem a diferença a partir dela
+            ocupacao_assinada = ocupacao;
+            assinatura_ocupacao = cmd->a != 0;
+            usb_proto_result(USB_PROTO_OK, ocupacao, NULL, 0);
+            return false;
+    }
+    return false;
+}
+
+/**
+ * @brief Objeto ativo dos comandos remotos: executa no núcleo de acesso, como
+ * os botões, os pedidos recebidos pelo objeto do terminal. Um pedido pode
+ * trazer centenas de comandos; a interface recebe um único evento no fim do
+ * lote, em vez de um por comando.
+ */
+static void aoRemoto(ao_t *me, const ao_event_t *e) {
+    static ui_event_t ui = { .beep = UI_BEEP_NONE };
+    usb_proto_cmd_t cmd;
+    uint32_t comandos = 0;
+    bool mudou = false;
+
+    if (e->sig != SIG_HOST_BATCH) return;
+
+    while (usb_proto_next(&cmd)) {
+        mudou |= executa_comando(&cmd);
+        comandos++;
+    }
+    if (mudou) {
+        ui.occupancy = MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers);
+        sprintf(ui.message, "Remoto (%u/%u)", ui.occupancy, capacidade_ativa());
+        publicar_interface(UI_SOURCE_HOST, &ui);
     }
+    TLOG(LOTE_REMOTO, comandos, MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers));
+
+    // A flag garante a resposta mesmo com a fila do terminal cheia: qualquer
+    // evento seguinte do terminal a encontra
+    __dmb();
+    resposta_pronta = true;
+    ao_post(&ao_console, SIG_HOST_REPLY, 0);
 }
 
 /**
- * @brief Tarefa responsável por fornecer feedback visual sobre a ocupação
- * do espaço através do LED RGB. Periodicamente, lê a contagem de usuários
- * (indiretamente, pelo número de vagas no semáforo) e atualiza a cor do LED
- * (Azul: vazio, Verde: com vagas, Amarelo: quase lotado, Vermelho: lotado).
+ * @brief Modo de clock para o movimento recente: pico com CLOCK_BURST_EVENTS
+ *        acionamentos na janela corrente ou na anterior, ocioso após
+ *        CLOCK_IDLE_AFTER_MS sem nenhum, normal no restante.
  */
-void vTaskFeedbackVisualLedRgb(void *pvParameters) {
-    printf("Task Feedback LED RGB iniciada.\n");
-    uint8_t usuarios_ativos;
-    uint32_t vagas_atuais_disponiveis;
+static clock_mode_t modo_relogio(const relogio_ao_t *r, TickType_t agora) {
+    if (r->movimentos >= CLOCK_BURST_EVENTS || r->movimentos_anterior >= CLOCK_BURST_EVENTS) {
+        return CLOCK_MODE_BURST;
+    }
+    if (agora - r->ultimo_movimento >= pdMS_TO_TICKS(CLOCK_IDLE_AFTER_MS)) {
+        return CLOCK_MODE_IDLE;
+    }
+    return CLOCK_MODE_NORMAL;
+}
+
+/**
+ * @brief Objeto ativo governador do clk_sys. Roda no núcleo de acesso, que é
+ * o do tick (o clock_mgr reprograma o SysTick no núcleo que troca o clock).
+ * Um acionamento no modo ocioso sobe o clock na hora; uma troca adiada por
+ * uma transferência em curso no outro núcleo é tentada de novo em
+ * CLOCK_RETRY_MS. No modo ocioso o temporizador fica desarmado até o próximo
+ * movimento, a matriz apaga e o OLED escurece; o primeiro movimento os
+ * devolve mesmo que a subida do clock seja adiada.
+ */
+static void aoRelogio(ao_t *me, const ao_event_t *e) {
+    relogio_ao_t *r = (relogio_ao_t *)me;
+    TickType_t agora = xTaskGetTickCount();
+
+    if (!CLOCK_SCALING_ENABLED) return;
+
+    if (e->sig == AO_SIG_START) {
+        r->inicio_janela = r->ultimo_movimento = agora;
+    } else if (e->sig != SIG_ACTIVITY && e->sig != AO_SIG_TIMEOUT) {
+        return;
+    }
 
-    while (true) {
-        // Obtém o número atual de vagas disponíveis do semáforo de contagem
-        vagas_atuais_disponiveis = uxSemaphoreGetCount(xCountingSemaphoreUsers);
-        // Calcula o número de usuários ativos
-        usuarios_ativos = MAX_USERS - vagas_atuais_disponiveis;
+    if (agora - r->inicio_janela >= pdMS_TO_TICKS(CLOCK_WINDOW_MS)) {
+        // Uma janela inteira sem eventos também zera a anterior
+        bool seguida = agora - r->inicio_janela < pdMS_TO_TICKS(2 * CLOCK_WINDOW_MS);
+        r->movimentos_anterior = seguida ? r->movimentos : 0;
+        r->movimentos = 0;
+        r->inicio_janela = agora;
+    }
+    if (e->sig == SIG_ACTIVITY) {
+        r->movimentos++;
+        r->ultimo_movimento = agora;
+    }
 
-        // Atualiza a cor do LED RGB com base na ocupação
-        rgb_led_set(usuarios_ativos, MAX_USERS);
+    clock_mode_t modo = modo_relogio(r, agora);
+    if (modo != clock_mgr_mode() && !clock_mgr_set_mode(modo)) {
+        ao_arm_timer(me, CLOCK_RETRY_MS);
+    } else if (modo == CLOCK_MODE_IDLE) {
+        ao_disarm_timer(me);
+    } else {
+        ao_arm_timer(me, CLOCK_WINDOW_MS);
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(RGB_UPDATE_DELAY_MS)); // Pausa antes da próxima atualização do LED
+    bool ocioso = modo == CLOCK_MODE_IDLE && clock_mgr_mode() == CLOCK_MODE_IDLE;
+    if (ocioso != r->ocioso) {
+        r->ocioso = ocioso;
+        ao_post(&ao_saidas.super, SIG_IDLE, ocioso);
     }
 }
 
+// --- Objetos Ativos de Interface ---
+
 /**
- * @brief Tarefa responsável por atualizar as informações no display OLED.
- * Periodicamente, lê a contagem de usuários (indiretamente, pelo número
- * de vagas no semáforo) e atualiza o display com o número de usuários ativos,
- * vagas disponíveis e uma mensagem de status padrão. O acesso ao display
- * é protegido por um mutex.
+ * @brief Avisa o espelho de que o display ou a matriz podem ter mudado (só
+ *        com o espelho ligado; os objetos estão todos no worker de interface).
  */
-void vTaskDisplayInfoOled(void *pvParameters) {
-    ssd1306_t *disp = (ssd1306_t *)pvParameters; // Handle do display passado como parâmetro
-    printf("Task Display Info OLED iniciada.\n");
+static void avisa_espelho(void) {
+    if (mirror_enabled()) {
+        ao_post(&ao_espelho, SIG_MIRROR_FRAME, 0);
+    }
+}
 
-    while (true) {
-        uint32_t vagas_atuais_disponiveis;
-        uint8_t usuarios_ativos;
+enum { TELA_INICIAL, TELA_MENSAGEM, TELA_PADRAO };
 
-        // Obtém o número atual de vagas e calcula usuários ativos
-        vagas_atuais_disponiveis = uxSemaphoreGetCount(xCountingSemaphoreUsers);
-        usuarios_ativos = MAX_USERS - vagas_atuais_disponiveis;
+/**
+ * @brief Display no quadro: mostra a última mensagem dos eventos pendentes
+ *        (até UI_EVENT_QUEUE_LEN por quadro; o resto fica para o seguinte) e
+ *        pede os beeps; vencida a mensagem, volta à tela padrão. Durante a
+ *        tela inicial os eventos aguardam nas filas.
+ * @return true se o display foi redesenhado.
+ */
+static bool saidas_display(saidas_ao_t *s, uint16_t ocupacao, uint16_t capacidade, occupancy_band_t faixa,
+                           uint32_t agora) {
+    ui_event_t evento;
+    char mensagem[sizeof(evento.message)];
+    uint32_t decididos[UI_EVENT_QUEUE_LEN];
+    uint n = 0;
 
-        // Pede o mutex para ter acesso exclusivo ao display
-        if (xSemaphoreTake(xMutexDisplay, portMAX_DELAY) == pdTRUE) {
-            // Atualiza o display. Passar NULL para a mensagem faz com que
-            // a função display_update gere uma mensagem padrão baseada na contagem.
-            display_update(disp, usuarios_ativos, MAX_USERS, NULL);
+    if (s->tela == TELA_INICIAL && (int32_t)(agora - s->fim_tela_us) < 0) return false;
 
-            xSemaphoreGive(xMutexDisplay); // Libera o mutex
+    while (n < UI_EVENT_QUEUE_LEN && ui_events_take(&evento)) {
+        decididos[n++] = evento.decided_us;
+        memcpy(mensagem, evento.message, sizeof(mensagem));
+        if (evento.beep != UI_BEEP_NONE) {
+            ao_post(&ao_buzzer.super, SIG_BEEP, evento.beep);
         }
-        vTaskDelay(pdMS_TO_TICKS(DISPLAY_UPDATE_DELAY_MS)); // Pausa antes da próxima atualização do display
     }
+
+    if (n > 0) {
+        display_update(&ssd, ocupacao, capacidade, faixa, mensagem);
+        uint32_t mostrado = time_us_32();
+        for (uint i = 0; i < n; ++i) {
+            latency_record(LATENCY_DISPLAY, mostrado - decididos[i]);
+        }
+        s->tela = TELA_MENSAGEM;
+        s->fim_tela_us = agora + DISPLAY_UPDATE_DELAY_MS * 1000u;
+        compositor_request_at(COMPOSITOR_OUT_DISPLAY, s->fim_tela_us);
+        if (n == UI_EVENT_QUEUE_LEN) {
+            compositor_request(COMPOSITOR_OUT_DISPLAY); // Pode haver mais eventos nas filas
+        }
+        return true;
+    }
+
+    if (s->tela != TELA_PADRAO && (int32_t)(agora - s->fim_tela_us) >= 0) {
+        // Tela padrão: passar NULL para a mensagem faz com que
+        // a função display_update gere uma mensagem padrão baseada na faixa.
+        s->tela = TELA_PADRAO;
+        display_update(&ssd, ocupacao, capacidade, faixa, NULL);
+        return true;
+    }
+    return false;
 }
 
 /**
- * @brief Tarefa responsável por controlar as animações na matriz de LEDs.
- * Periodicamente, lê a contagem de usuários (indiretamente, pelo semáforo de vagas)
- * e atualiza a matriz com um ícone animado (pulsante) que reflete o estado de
- * ocupação do espaço (livre, com vagas, quase cheio, lotado) ou uma animação
- * especial durante o reset do sistema.
+ * @brief Matriz no quadro: apagada no modo ocioso; senão, o pulso do ícone
+ *        até fim_animacao_us (a cada COMPOSITOR_DIV_MATRIX quadros) e depois
+ *        o quadro parado, que desliga o redesenho periódico.
  */
-void vTaskLedMatrixControl(void *pvParameters) {
-    printf("Task da matriz de leds iniciada.\n");
-    uint8_t animation_step = 0; // Contador para controlar os frames da animação
-    MatrixOccupationState_t determined_matrix_state = MATRIX_STATE_VAZIO; // Estado visual da matriz
+static void saidas_matriz(saidas_ao_t *s, uint32_t agora) {
+    if (s->apagada) {
+        compositor_set_animating(COMPOSITOR_OUT_MATRIX, false);
+        led_matrix_clear();
+    } else if ((int32_t)(agora - s->fim_animacao_us) < 0) {
+        compositor_set_animating(COMPOSITOR_OUT_MATRIX, true);
+        led_matrix_ocupacao(s->estado, s->passo++); // Avança o passo da animação
+    } else {
+        compositor_set_animating(COMPOSITOR_OUT_MATRIX, false);
+        led_matrix_ocupacao(s->estado, MATRIX_STILL_STEP); // Quadro parado
+    }
+}
 
-    // Variáveis para controle da animação de reset na matriz
-    bool matrix_currently_in_reset_animation = false;
-    uint8_t matrix_reset_animation_step_count = 0;
+/**
+ * @brief Um quadro do compositor. A ocupação e a faixa são lidas uma única
+ *        vez; uma faixa nova entra no LED e na matriz neste mesmo quadro,
+ *        junto com a mensagem do display que a trouxe.
+ */
+static void saidas_quadro(saidas_ao_t *s) {
+    static const MatrixOccupationState_t icone_da_faixa[OCCUPANCY_NUM_BANDS] = {
+        [OCCUPANCY_BAND_EMPTY]       = MATRIX_STATE_VAZIO,
+        [OCCUPANCY_BAND_FREE]        = MATRIX_STATE_VAGAS_LIVRES,
+        [OCCUPANCY_BAND_ALMOST_FULL] = MATRIX_STATE_QUASE_CHEIO,
+        [OCCUPANCY_BAND_FULL]        = MATRIX_STATE_CHEIO,
+    };
+    uint32_t agora = time_us_32();
+    uint32_t vencidas = compositor_frame_begin(agora);
+    uint16_t ocupacao, capacidade;
+    occupancy_band_t faixa = occupancy_band_snapshot(&ocupacao, &capacidade);
+    uint32_t t;
 
-    uint8_t prev_active_users_matrix = 0; // Para ajudar a detectar o evento de reset
+    if (faixa != s->faixa_led) {
+        vencidas |= 1u << COMPOSITOR_OUT_LED;
+    }
+    if (faixa != s->faixa_matriz) {
+        s->faixa_matriz = faixa;
+        s->estado = icone_da_faixa[faixa];
+        s->fim_animacao_us = agora + MATRIX_ANIMATION_MS * 1000u;
+        s->apagada = false;
+        vencidas |= 1u << COMPOSITOR_OUT_MATRIX;
+    }
 
+    if (vencidas & (1u << COMPOSITOR_OUT_DISPLAY)) {
+        t = time_us_32();
+        if (saidas_display(s, ocupacao, capacidade, faixa, agora)) {
+            compositor_output_done(COMPOSITOR_OUT_DISPLAY, time_us_32() - t);
+        } else {
+            vencidas &= ~(1u << COMPOSITOR_OUT_DISPLAY);
+        }
+    }
+    if (vencidas & (1u << COMPOSITOR_OUT_LED)) {
+        t = time_us_32();
+        rgb_led_show_band(faixa);
+        s->faixa_led = faixa;
+        compositor_output_done(COMPOSITOR_OUT_LED, time_us_32() - t);
+    }
+    if (vencidas & (1u << COMPOSITOR_OUT_MATRIX)) {
+        t = time_us_32();
+        saidas_matriz(s, agora);
+        compositor_output_done(COMPOSITOR_OUT_MATRIX, time_us_32() - t);
+    }
+    compositor_frame_end(time_us_32());
 
-    while (true) {
-        uint32_t current_available_slots = uxSemaphoreGetCount(xCountingSemaphoreUsers);
-        uint8_t current_active_users = MAX_USERS - current_available_slots;
+    if (vencidas & ((1u << COMPOSITOR_OUT_DISPLAY) | (1u << COMPOSITOR_OUT_MATRIX))) {
+        avisa_espelho();
+    }
+}
 
-        // Heurística para detectar um reset (contagem cai para 0 vindo de >0)
-        // e disparar a animação de reset na matriz.
-        // Uma flag global setada por vTaskResetSistema seria mais explícita.
-        if (prev_active_users_matrix > 0 && current_active_users == 0 && !matrix_currently_in_reset_animation) {
-            //printf("Matrix: Reset detectado, iniciando animacao de reset.\n");
-            matrix_currently_in_reset_animation = true;
-            matrix_reset_animation_step_count = 0;
+/**
+ * @brief Arma o temporizador para o próximo quadro da grade, ou o desarma
+ *        sem nada pendente: sem movimento o objeto não acorda o núcleo.
+ */
+static void saidas_agenda(saidas_ao_t *s) {
+    uint32_t espera_ms;
+
+    if (compositor_schedule(time_us_32(), &espera_ms)) {
+        ao_arm_timer(&s->super, espera_ms);
+    } else {
+        ao_disarm_timer(&s->super);
+    }
+}
+
+/**
+ * @brief Objeto ativo das saídas: único dono do display OLED, do LED RGB e
+ * da matriz, desenhados nos quadros do compositor (COMPOSITOR_FRAME_MS).
+ * Cada evento das tarefas de acesso fica DISPLAY_UPDATE_DELAY_MS no display,
+ * que depois volta à tela padrão; uma faixa nova muda o LED (transição no
+ * PWM) e o ícone da matriz, que pulsa por MATRIX_ANIMATION_MS e congela no
+ * quadro de brilho máximo. No modo ocioso do clock o OLED escurece e a
+ * matriz fica apagada até uma nova faixa ou a saída do modo. O LED é
+ * inicializado aqui para que a IRQ dos passos fique neste núcleo.
+ */
+static void aoSaidas(ao_t *me, const ao_event_t *e) {
+    saidas_ao_t *s = (saidas_ao_t *)me;
+
+    switch (e->sig) {
+        case AO_SIG_START:
+            rgb_led_init();
+#if FAST_BOOT_ENABLED
+            // Boot rápido: o display é inicializado aqui, com as admissões já rodando.
+            // A tela de inicialização fica visível sem bloquear os demais objetos;
+            // os eventos publicados nesse meio-tempo aguardam nas filas.
+            display_init(&ssd);
+            display_startup_screen(&ssd);
+            s->tela = TELA_INICIAL;
+            s->fim_tela_us = time_us_32() + DISPLAY_SPLASH_MS * 1000u;
+            compositor_request_at(COMPOSITOR_OUT_DISPLAY, s->fim_tela_us);
+#else
+            s->tela = TELA_MENSAGEM;
+            s->fim_tela_us = time_us_32();
+            compositor_request(COMPOSITOR_OUT_DISPLAY);
+#endif
+            compositor_request(COMPOSITOR_OUT_LED); // Primeiro quadro: LED e matriz com a faixa restaurada
+            break;
+
+        case SIG_UI_EVENT:
+            compositor_request(COMPOSITOR_OUT_DISPLAY);
+            break;
+
+        case SIG_IDLE:
+            display_set_dimmed(&ssd, e->arg != 0);
+            s->apagada = e->arg != 0; // Na saída do modo, redesenha o estado atual
+            compositor_request(COMPOSITOR_OUT_MATRIX);
+            break;
+
+        case AO_SIG_TIMEOUT:
+            saidas_quadro(s);
+            break;
+
+        default:
+            return;
+    }
+    saidas_agenda(s);
+}
+
+/**
+ * @brief Objeto ativo do buzzer. Cada sinal é uma sequência de fases tom/silêncio
+ *        temporizadas pelo worker, sem bloquear os demais objetos do núcleo.
+ */
+static void aoBuzzer(ao_t *me, const ao_event_t *e) {
+    static const uint16_t beep_curto[][2] = {
+        { BUZZER_BEEP_SHORT_FREQ, BUZZER_BEEP_SHORT_MS },
+    };
+    static const uint16_t beep_reset[][2] = {
+        { BUZZER_BEEP_RESET_FREQ, BUZZER_BEEP_RESET_ON_MS },
+        { 0, BUZZER_BEEP_RESET_OFF_MS }, // Pausa entre beeps
+        { BUZZER_BEEP_RESET_FREQ, BUZZER_BEEP_RESET_ON_MS },
+    };
+    buzzer_ao_t *b = (buzzer_ao_t *)me;
+
+    if (e->sig == SIG_BEEP) {
+        // Um novo sinal substitui o que estiver tocando
+        if (e->arg == UI_BEEP_RESET) {
+            b->fases = beep_reset;
+            b->n_fases = 3;
+        } else {
+            b->fases = beep_curto;
+            b->n_fases = 1;
         }
-            // Caso contrário, determina o estado normal da matriz baseado na ocupação
-            if (current_active_users == 0) {
-                determined_matrix_state = MATRIX_STATE_VAZIO; 
-            }
-            else if (current_active_users >= MAX_USERS) {
-                determined_matrix_state = MATRIX_STATE_CHEIO;
+        b->fase = 0;
+    } else if (e->sig == AO_SIG_TIMEOUT) {
+        b->fase++;
+    } else {
+        return;
+    }
+
+    if (b->fase < b->n_fases) {
+        buzzer_play_tone(b->fases[b->fase][0], 0); // Duração 0: liga o PWM e retorna
+        ao_arm_timer(me, b->fases[b->fase][1]);
+    } else {
+        buzzer_play_tone(0, 0); // Desliga o PWM
+    }
+}
+
+/**
+ * @brief Objeto ativo do diário na flash.
+ * As tarefas de acesso apenas enfileiram os eventos em RAM (journal_log); o
+ * primeiro aviso arma um lote de JOURNAL_COMMIT_DELAY_MS. Depois de gravar,
+ * uma última verificação após JOURNAL_ERASE_IDLE_MS deixa journal_commit()
+ * pré-apagar o próximo setor em um momento ocioso. Se a flash falhar, os
+ * registros continuam no anel e um novo lote é armado para tentar de novo.
+ */
+static void aoDiarioFlash(ao_t *me, const ao_event_t *e) {
+    enum { DIARIO_OCIOSO, DIARIO_LOTE, DIARIO_PRE_APAGAR };
+
+    switch (e->sig) {
+        case AO_SIG_START: // Registro de boot
+        case SIG_JOURNAL:
+            if (me->state != DIARIO_LOTE) {
+                me->state = DIARIO_LOTE;
+                ao_arm_timer(me, JOURNAL_COMMIT_DELAY_MS);
             }
-            else if (current_active_users == MAX_USERS - 1) {
-                determined_matrix_state = MATRIX_STATE_QUASE_CHEIO;
+            break;
+
+        case AO_SIG_TIMEOUT:
+            if (!journal_commit()) {
+                me->state = DIARIO_LOTE;
+                ao_arm_timer(me, JOURNAL_COMMIT_DELAY_MS);
+            } else if (me->state == DIARIO_LOTE) {
+                me->state = DIARIO_PRE_APAGAR;
+                ao_arm_timer(me, JOURNAL_ERASE_IDLE_MS + JOURNAL_COMMIT_DELAY_MS);
+            } else {
+                me->state = DIARIO_OCIOSO;
             }
-            else {
-                determined_matrix_state = MATRIX_STATE_VAGAS_LIVRES;
+            break;
+    }
+}
+
+/**
+ * @brief Comandos de uma letra do terminal USB.
+ *   p - perfil de execução (CPU por tarefa desde a consulta anterior)
+ *   m - tabela de orçamento de RAM
+ *   t - trace de eventos (converter com tools/trace_to_perfetto.py)
+ */
+static void comando_texto(int c) {
+    switch (c) {
+        case 'p': imprime_perfil(); break;
+        case 'm': mem_budget_print(); break;
+        case 't': trace_dump(); break;
+        case 'f': beam_counter_dump_trace(); break;
+        case '\r':
+        case '\n': break;
+        default: printf("Comandos: p = perfil, m = memoria, t = trace, f = bordas dos feixes\n"); break;
+    }
+}
+
+/**
+ * @brief Objeto ativo do terminal USB, acordado pelo callback de caracteres
+ * disponíveis do stdio (sem polling). Os bytes fora de um quadro são comandos
+ * de uma letra (comando_texto); um quadro do protocolo USB completo é
+ * entregue ao objeto remoto, no núcleo de acesso, e a leitura para até a
+ * resposta voltar: o buffer do CDC segura os pedidos seguintes (controle de
+ * fluxo do próprio USB). Com a assinatura ativa, envia também os eventos de
+ * ocupação.
+ */
+static void aoConsole(ao_t *me, const ao_event_t *e) {
+    enum { CONSOLE_LIVRE, CONSOLE_PEDIDO };
+    bool ler = (e->sig == SIG_CONSOLE);
+    int c;
+
+    if (me->state == CONSOLE_PEDIDO && resposta_pronta) {
+        resposta_pronta = false;
+        usb_proto_send_reply();
+        me->state = CONSOLE_LIVRE;
+        ler = true; // Continua com o que chegou enquanto o pedido executava
+    }
+
+    if (e->sig == SIG_SHIFT_SUMMARY) {
+        analytics_print_summary(time_us_64());
+        imprime_perfil();
+    }
+
+    if (e->sig == SIG_OCCUPANCY) {
+        // Lê a ocupação atual: um aviso perdido com a fila cheia não deixa o cliente defasado
+        uint16_t ocupacao = MAX_USERS - uxSemaphoreGetCount(xCountingSemaphoreUsers);
+        if (assinatura_ocupacao && ocupacao != ocupacao_assinada) {
+            usb_proto_send_event(ocupacao, (int16_t)(ocupacao - ocupacao_assinada));
+            ocupacao_assinada = ocupacao;
+        }
+    }
+
+    if (!ler || me->state == CONSOLE_PEDIDO) return;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        switch (usb_proto_rx((uint8_t)c)) {
+            case USB_PROTO_RX_TEXT:
+                comando_texto(c);
+                break;
+            case USB_PROTO_RX_REQUEST:
+                me->state = CONSOLE_PEDIDO;
+                ao_post(&ao_remoto, SIG_HOST_BATCH, 0);
+                return;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Objeto ativo do log tokenizado: formata (ou envia em binário) as
+ * mensagens registradas com TLOG, no núcleo de interface e na prioridade
+ * dele, fora do caminho de admissão. Acordado só quando um anel deixa de
+ * estar vazio.
+ */
+static void aoLog(ao_t *me, const ao_event_t *e) {
+    if (e->sig == SIG_LOG) {
+        tlog_drain();
+    }
+}
+
+/**
+ * @brief Objeto ativo do espelho do display e da matriz. Os redesenhos
+ * armam uma varredura após MIRROR_INTERVAL_MS (várias mudanças viram uma só
+ * varredura); páginas adiadas pelo limite de banda rearmam o temporizador.
+ * Roda no núcleo de interface, na prioridade dele: nunca atrasa uma admissão.
+ */
+static void aoEspelho(ao_t *me, const ao_event_t *e) {
+    switch (e->sig) {
+        case SIG_MIRROR_CTRL:
+            if (e->arg) {
+                mirror_start();
+                ao_arm_timer(me, 0); // Quadro completo
+            } else {
+                mirror_stop();
+                ao_disarm_timer(me);
             }
-            // Chama a função que atualiza a matriz com o estado e o passo da animação
-            led_matrix_ocupacao(determined_matrix_state, animation_step);
+            break;
 
-        prev_active_users_matrix = current_active_users; // Guarda o estado atual para a próxima detecção de reset
-        animation_step++; // Avança o passo da animação
+        case SIG_MIRROR_FRAME:
+            if (!me->timer_armed) {
+                ao_arm_timer(me, MIRROR_INTERVAL_MS);
+            }
+            break;
 
-        vTaskDelay(pdMS_TO_TICKS(MATRIX_DELAY_MS)); // Pausa antes da próxima atualização da matriz
+        case AO_SIG_TIMEOUT:
+            if (mirror_pump(ssd.ram_buffer ? ssd.ram_buffer + 1 : NULL, led_matrix_pixels(),
+                            to_ms_since_boot(get_absolute_time()))) {
+                ao_arm_timer(me, MIRROR_INTERVAL_MS);
+            }
+            break;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Idle hook do FreeRTOS: alimenta o watchdog de hardware.
+ * Se alguma tarefa deixar de ceder a CPU, a tarefa idle não roda e o
+ * watchdog reinicia o sistema (a ocupação volta pelo snapshot).
+ * No SMP a tarefa idle que chama o tickless pode estar no outro núcleo, que
+ * não tem tickless: lá ela dorme em WFI.
+ */
+void vApplicationIdleHook(void) {
+    watchdog_update();
+    if (get_core_num() != configTICK_CORE) low_power_idle_wfi();
+}
+
+/**
+ * @brief Idle hook das demais tarefas idle do SMP (configUSE_PASSIVE_IDLE_HOOK
+ * no kernel V11, configUSE_MINIMAL_IDLE_HOOK no ramo smp anterior): sem
+ * tickless, o núcleo dorme em WFI até a próxima IRQ.
+ */
+void vApplicationPassiveIdleHook(void) {
+    low_power_idle_wfi();
+}
+
+void vApplicationMinimalIdleHook(void) {
+    low_power_idle_wfi();
+}
+
+// --- Memória Estática do Kernel ---
+// Com configSUPPORT_STATIC_ALLOCATION o kernel pede à aplicação a memória da
+// tarefa idle do núcleo 0 e da tarefa de timers (a idle do núcleo 1 é
+// estática dentro do próprio kernel).
+static StaticTask_t idle_tcb, timer_tcb;
+static StackType_t idle_stack[STACK_SIZE_KERNEL_IDLE];
+static StackType_t timer_stack[STACK_SIZE_KERNEL_TIMER];
+
+MEM_BUDGET_ENTRY(kernel, "Kernel",
+                 sizeof(idle_tcb) + sizeof(idle_stack) + sizeof(timer_tcb) + sizeof(timer_stack) +
+                 configTOTAL_HEAP_SIZE,
+                 MEM_BUDGET_KERNEL_BYTES);
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *stack_words) {
+    *tcb = &idle_tcb;
+    *stack = idle_stack;
+    *stack_words = STACK_SIZE_KERNEL_IDLE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *stack_words) {
+    *tcb = &timer_tcb;
+    *stack = timer_stack;
+    *stack_words = STACK_SIZE_KERNEL_TIMER;
+}
+
+/**
+ * @brief O heap só atende os queue sets criados no boot; uma falha aqui
+ * significa configTOTAL_HEAP_SIZE pequeno demais.
+ */
+void vApplicationMallocFailedHook(void) {
+    panic("Heap do FreeRTOS esgotado (configTOTAL_HEAP_SIZE)");
+}
+
+/**
+ * @brief Chamado pelo kernel (configCHECK_FOR_STACK_OVERFLOW = 2) ao detectar o
+ * padrão de fim de stack sobrescrito; a stack da tarefa está corrompida.
+ */
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name) {
+    panic("Estouro de stack na tarefa %s", name);
+}
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Compara os microbenchmarks dos kernels de desenho com a linha de base.
+
+O alvo panel_kbench (src/kbench_main.c) imprime uma linha JSON por rodada:
+
+    {"kbench":1,"platform":"rp2040","unit":"cycles","clock_hz":125000000,
+     "batch":8,"repeats":16,"kernels":{"ssd1306_fill":{"min":..,"mean":..,
+     "bytes":..,"stack":..},...}}
+
+min e mean são o custo de uma chamada (ciclos do SysTick no RP2040, ns na
+build nativa), bytes é quanto da saída uma chamada escreve e stack a pilha
+além de uma chamada vazia. A linha de base guarda um resultado por
+plataforma; os números da build nativa só valem na máquina em que foram
+medidos (refaça com --update).
+
+Uso:
+    ./build-host/panel_kbench > kbench.json
+    python3 tools/kbench_compare.py kbench.json
+    python3 tools/kbench_compare.py --port /dev/ttyACM0     # requer pyserial
+    python3 tools/kbench_compare.py kbench.json --update    # grava a linha de base
+
+Sai com 1 se algum kernel ficou mais lento que a tolerância (no min) ou passou
+a escrever mais bytes ou a usar mais pilha.
+"""
+import argparse
+import json
+import os
+import sys
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "kbench_baseline.json")
+
+
+def parse_result(lines):
+    """Último resultado JSON entre as linhas (o terminal mistura outras)."""
+    result = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith('{"kbench"'):
+            result = json.loads(line)
+    return result
+
+
+def read_port(port):
+    import serial  # pyserial
+    with serial.Serial(port, 115200, timeout=10) as s:
+        while True:
+            line = s.readline().decode("utf-8", "replace")
+            if not line:
+                sys.exit("sem resultado em %s" % port)
+            result = parse_result([line])
+            if result:
+                return result
+
+
+def compare(result, base, tolerance):
+    regressions = 0
+    unit = result["unit"]
+    print("%-26s %12s %12s %8s %7s %7s" % ("kernel", "min (" + unit + ")", "base", "delta", "bytes", "stack"))
+    for name, r in result["kernels"].items():
+        b = base.get(name)
+        if b is None:
+            print("%-26s %12d %12s %8s %7d %7d  (novo)" % (name, r["min"], "-", "-", r["bytes"], r["stack"]))
+            continue
+        delta = (r["min"] - b["min"]) * 100.0 / b["min"] if b["min"] else 0.0
+        flags = []
+        if delta > tolerance:
+            flags.append("mais lento")
+        if r["bytes"] > b["bytes"]:
+            flags.append("bytes %d -> %d" % (b["bytes"], r["bytes"]))
+        if r["stack"] > b["stack"]:
+            flags.append("pilha %d -> %d" % (b["stack"], r["stack"]))
+        regressions += bool(flags)
+        print("%-26s %12d %12d %+7.1f%% %7d %7d  %s" %
+              (name, r["min"], b["min"], delta, r["bytes"], r["stack"], ", ".join(flags)))
+    return regressions
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("result", nargs="?", help="saída do panel_kbench (padrão: stdin)")
+    ap.add_argument("--port", help="lê uma rodada do terminal USB do panel_kbench no RP2040")
+    ap.add_argument("--baseline", default=DEFAULT_BASELINE)
+    ap.add_argument("--tolerance", type=float, default=5.0, help="piora aceita no min, em %% (padrão 5)")
+    ap.add_argument("--update", action="store_true", help="grava o resultado como linha de base da plataforma")
+    args = ap.parse_args()
+
+    if args.port:
+        result = read_port(args.port)
+    elif args.result:
+        with open(args.result) as f:
+            result = parse_result(f)
+    else:
+        result = parse_result(sys.stdin)
+    if not result:
+        sys.exit("nenhuma linha {\"kbench\":...} na entrada")
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    platform = result["platform"]
+
+    if args.update:
+        baseline[platform] = {"unit": result["unit"], "clock_hz": result["clock_hz"], "kernels": result["kernels"]}
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("linha de base de %s gravada em %s" % (platform, args.baseline))
+        return
+
+    if platform not in baseline:
+        sys.exit("sem linha de base para %s (use --update)" % platform)
+    base = baseline[platform]
+    if base.get("clock_hz") != result["clock_hz"]:
+        print("aviso: clock %s Hz na linha de base, %s Hz agora" % (base.get("clock_hz"), result["clock_hz"]))
+    regressions = compare(result, base["kernels"], args.tolerance)
+    if regressions:
+        print("%d kernel(s) piorou(aram)" % regressions)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
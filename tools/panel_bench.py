@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Mede a vazão do protocolo USB do painel: lotes de entradas e saídas
+alternadas (a ocupação volta ao valor inicial a cada par), enviados em
+sequência pelo tempo pedido.
+
+Uso:
+    python3 tools/panel_bench.py /dev/ttyACM0 [--batch 100] [--seconds 10]
+
+Imprime operações por segundo e a latência de ida e volta por quadro
+(p50/p99/máx). Os comandos passam pela política e pelo diário como uma
+entrada real: use uma política sem limite de taxa para a porta do protocolo.
+"""
+import argparse
+import time
+
+from panel_client import CMD_STATS, Batch, PanelClient, parse_stats
+
+
+def percentile(sorted_values, p):
+    return sorted_values[max(0, (len(sorted_values) * p + 99) // 100 - 1)]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("port")
+    ap.add_argument("--batch", type=int, default=100, help="comandos por lote (pares entrada/saida)")
+    ap.add_argument("--seconds", type=float, default=10.0)
+    args = ap.parse_args()
+
+    with PanelClient(args.port, on_text=lambda text: None) as painel:
+        lote = Batch()
+        for _ in range(args.batch // 2):
+            lote.admit()
+            lote.release()
+
+        ops, rtts = 0, []
+        inicio = time.monotonic()
+        while time.monotonic() - inicio < args.seconds:
+            t0 = time.monotonic()
+            ops += len(painel.execute(lote))
+            rtts.append((time.monotonic() - t0) * 1000)
+        duracao = time.monotonic() - inicio
+
+        rtts.sort()
+        print("%d operacoes em %.1f s: %.0f ops/s (%d lotes de %d)" %
+              (ops, duracao, ops / duracao, len(rtts), len(lote)))
+        print("lote ida e volta: p50 %.2f ms, p99 %.2f ms, max %.2f ms" %
+              (percentile(rtts, 50), percentile(rtts, 99), rtts[-1]))
+        print("quadros: %d pedidos, %d reenvios" % (painel.stats["requests"], painel.stats["retries"]))
+        st = [r for r in painel.execute(Batch().stats()) if r.code == CMD_STATS]
+        if st:
+            s = parse_stats(st[0])
+            print("painel: ocupacao %d, %d quadros recebidos, %d descartados, %d registros do diario perdidos" %
+                  (s["occupancy"], s["frames"], s["frame_errors"], s["journal_dropped"]))
+
+
+if __name__ == "__main__":
+    main()
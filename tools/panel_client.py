@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+"""Cliente do protocolo binário do painel pelo terminal USB (CDC).
+
+Quadros: payload + CRC-16/CCITT, codificados em COBS e delimitados por 0x00
+(src/include/usb_protocol.h). Os comandos são agrupados em lotes: um quadro
+carrega dezenas de comandos e a resposta traz um resultado por comando.
+
+Uso como biblioteca (requer pyserial):
+    from panel_client import PanelClient, Batch
+    with PanelClient("/dev/ttyACM0") as painel:
+        b = Batch()
+        b.admit(facility=100, card=1234)
+        b.release()
+        b.stats()
+        for r in painel.execute(b):
+            print(r)
+
+Uso direto:
+    python3 tools/panel_client.py /dev/ttyACM0 stats
+    python3 tools/panel_client.py /dev/ttyACM0 limits 14 16
+    python3 tools/panel_client.py /dev/ttyACM0 watch
+"""
+import struct
+import sys
+import time
+from collections import namedtuple
+
+# Deve acompanhar src/include/usb_protocol.h
+VERSION = 1
+TYPE_REPLY = 0x01
+TYPE_EVENT = 0x02
+TYPE_MIRROR = 0x03
+MAX_PAYLOAD = 512
+SEQ_OPEN = 0x00  # Abre a sessão: o painel esquece a resposta guardada de outro cliente
+
+CMD_PING = 0x01
+CMD_ADMIT = 0x10
+CMD_RELEASE = 0x11
+CMD_RESET = 0x12
+CMD_SET_LIMITS = 0x20
+CMD_SET_TIME = 0x21
+CMD_LOAD_POLICY = 0x22
+CMD_STATS = 0x30
+CMD_SUBSCRIBE = 0x31
+CMD_MIRROR = 0x32
+
+STATUS_OK = 0
+STATUS_REJECTED = 1
+STATUS_UNKNOWN = 0xFE
+
+# policy_decision_t (src/include/policy.h), status de CMD_ADMIT
+DECISIONS = ["admitido", "admitido (quase lotado)", "fora do horario",
+             "limite de taxa da porta", "lotado", "vagas reservadas"]
+
+# usb_proto_stats_t
+STATS_FIELDS = ("occupancy", "soft_limit", "hard_limit", "policy_evaluations", "policy_denied",
+                "journal_committed", "journal_dropped", "ui_dropped", "log_dropped",
+                "frames", "frame_errors", "policy_worst_cycles", "policy_over_budget")
+
+Result = namedtuple("Result", "code status value data")
+Event = namedtuple("Event", "seq occupancy delta")
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_pos] = code
+                code_pos, code = len(out), 1
+                out.append(0)
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frame(payload):
+    """Quadro pronto para envio: 0x00, COBS(payload + CRC), 0x00."""
+    return b"\0" + cobs_encode(payload + struct.pack("<H", crc16_ccitt(payload))) + b"\0"
+
+
+def unframe(chunk):
+    """Payload de um trecho entre delimitadores, ou None se não é um quadro válido."""
+    data = cobs_decode(chunk)
+    if data is None or len(data) < 3:
+        return None
+    payload, crc = data[:-2], struct.unpack("<H", data[-2:])[0]
+    return payload if crc16_ccitt(payload) == crc else None
+
+
+class Batch:
+    """Lote de comandos; cada método acrescenta um comando codificado."""
+
+    def __init__(self):
+        self.commands = []
+
+    def __len__(self):
+        return len(self.commands)
+
+    def _add(self, code, args=b""):
+        self.commands.append(bytes([code]) + args)
+        return self
+
+    def ping(self):
+        return self._add(CMD_PING)
+
+    def admit(self, facility=0, card=0):
+        return self._add(CMD_ADMIT, struct.pack("<HI", facility, card))
+
+    def release(self):
+        return self._add(CMD_RELEASE)
+
+    def reset(self):
+        return self._add(CMD_RESET)
+
+    def set_limits(self, soft, capacity):
+        return self._add(CMD_SET_LIMITS, struct.pack("<HH", soft, capacity))
+
+    def set_time(self, minute_of_day):
+        return self._add(CMD_SET_TIME, struct.pack("<H", minute_of_day))
+
+    def load_policy(self, rules):
+        """rules: lista de (tipo, alvo, a, b), como policy_rule_t."""
+        body = b"".join(struct.pack("<BBHH", *r) for r in rules)
+        return self._add(CMD_LOAD_POLICY, bytes([len(rules)]) + body)
+
+    def stats(self):
+        return self._add(CMD_STATS)
+
+    def subscribe(self, on=True):
+        return self._add(CMD_SUBSCRIBE, bytes([1 if on else 0]))
+
+    def mirror(self, on=True):
+        return self._add(CMD_MIRROR, bytes([1 if on else 0]))
+
+
+def parse_stats(result):
+    n = len(result.data) // 4
+    return dict(zip(STATS_FIELDS, struct.unpack("<%dI" % n, result.data[:4 * n])))
+
+
+class PanelClient:
+    """Conexão com o painel. transport pode ser qualquer objeto com read(n),
+    write(data) e timeout (ex.: serial.Serial); sem ele, abre a porta dada."""
+
+    def __init__(self, port=None, transport=None, timeout=1.0, retries=3, on_text=None, on_event=None,
+                 on_mirror=None):
+        if transport is None:
+            import serial  # pyserial
+            transport = serial.Serial(port, 115200, timeout=0.05)
+        self.io = transport
+        self.timeout = timeout
+        self.retries = retries
+        self.on_text = on_text or (lambda text: sys.stderr.write(text))
+        self.on_event = on_event
+        self.on_mirror = on_mirror
+        self.events = []
+        self.seq = None  # Sessão aberta no primeiro pedido (_open)
+        self.rx = bytearray()
+        self.stats = {"requests": 0, "retries": 0, "text_chunks": 0}
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def close(self):
+        if hasattr(self.io, "close"):
+            self.io.close()
+
+    def _chunks(self):
+        """Trechos completos entre delimitadores recebidos até agora."""
+        data = self.io.read(max(1, getattr(self.io, "in_waiting", 0) or 1))
+        self.rx += data
+        while True:
+            end = self.rx.find(b"\0")
+            if end < 0:
+                return
+            chunk, self.rx = bytes(self.rx[:end]), self.rx[end + 1:]
+            if chunk:
+                yield chunk
+
+    def _handle(self, chunk):
+        payload = unframe(chunk)
+        if payload is None:
+            # Texto do terminal (printf do painel) entre os quadros
+            self.stats["text_chunks"] += 1
+            self.on_text(chunk.decode("utf-8", "replace"))
+            return None
+        if payload[0] == TYPE_EVENT and len(payload) >= 6:
+            occ, delta = struct.unpack_from("<Hh", payload, 2)
+            ev = Event(payload[1], occ, delta)
+            if self.on_event:
+                self.on_event(ev)
+            else:
+                self.events.append(ev)
+            return None
+        if payload[0] == TYPE_MIRROR and len(payload) >= 5:
+            # Página do espelho (tools/panel_mirror.py reconstrói as telas)
+            if self.on_mirror:
+                self.on_mirror(payload)
+            return None
+        if payload[0] == TYPE_REPLY and len(payload) >= 4:
+            return payload
+        return None
+
+    def _open(self):
+        """PING em SEQ_OPEN: o painel descarta a resposta guardada, que pode ser
+        de um processo anterior com o mesmo seq. Os pedidos seguem de 1 a 255."""
+        self.seq = SEQ_OPEN
+        self._send(bytes([CMD_PING]))
+
+    def _request(self, body):
+        if self.seq is None:
+            self._open()
+        self.seq = self.seq % 0xFF + 1
+        return self._send(body)
+
+    def _send(self, body):
+        """Envia um quadro e espera a resposta com o mesmo seq. Em timeout reenvia
+        o mesmo seq: o painel responde de novo sem reexecutar."""
+        data = frame(bytes([self.seq]) + body)
+        self.stats["requests"] += 1
+        for attempt in range(self.retries + 1):
+            if attempt:
+                self.stats["retries"] += 1
+            self.io.write(data)
+            deadline = time.monotonic() + self.timeout
+            while time.monotonic() < deadline:
+                for chunk in self._chunks():
+                    payload = self._handle(chunk)
+                    if payload is not None and payload[1] == self.seq:
+                        return payload
+        raise TimeoutError("sem resposta do painel (seq %d)" % self.seq)
+
+    def execute(self, batch):
+        """Executa o lote, dividido em quantos quadros forem necessários, e
+        retorna um Result por comando, na ordem."""
+        results = []
+        pending = list(batch.commands)
+        while pending:
+            body, n = b"", 0
+            while n < len(pending) and 1 + len(body) + len(pending[n]) <= MAX_PAYLOAD:
+                body += pending[n]
+                n += 1
+            if n == 0:
+                raise ValueError("comando maior que o quadro")
+            reply = self._request(body)
+            done = struct.unpack_from("<H", reply, 2)[0]
+            pos = 4
+            for _ in range(done):
+                code, status, value = struct.unpack_from("<BBH", reply, pos)
+                pos += 4
+                size = value if code == CMD_STATS else 0
+                results.append(Result(code, status, value, bytes(reply[pos:pos + size])))
+                pos += size
+                if status == STATUS_UNKNOWN:
+                    raise ValueError("comando 0x%02x recusado pelo painel" % code)
+            # A resposta pode ter ficado cheia antes do fim: reenvia o restante
+            pending = pending[done:]
+        return results
+
+    def poll(self, duration):
+        """Recebe eventos e texto por duration segundos."""
+        deadline = time.monotonic() + duration
+        while time.monotonic() < deadline:
+            for chunk in self._chunks():
+                self._handle(chunk)
+        events, self.events = self.events, []
+        return events
+
+
+def main():
+    if len(sys.argv) < 3:
+        raise SystemExit(__doc__)
+    port, cmd, args = sys.argv[1], sys.argv[2], [int(a) for a in sys.argv[3:]]
+    with PanelClient(port) as painel:
+        b = Batch()
+        if cmd == "watch":
+            occ = painel.execute(b.subscribe(True))[0].value
+            print("ocupacao: %d" % occ)
+            painel.on_event = lambda ev: print("ocupacao: %d (%+d)" % (ev.occupancy, ev.delta))
+            try:
+                while True:
+                    painel.poll(1.0)
+            except KeyboardInterrupt:
+                painel.execute(Batch().subscribe(False))
+            return
+        if cmd == "stats":
+            b.stats()
+        elif cmd == "admit":
+            b.admit(*args)
+        elif cmd == "release":
+            b.release()
+        elif cmd == "reset":
+            b.reset()
+        elif cmd == "limits":
+            b.set_limits(*args)
+        elif cmd == "time":
+            b.set_time(args[0] * 60 + (args[1] if len(args) > 1 else 0))
+        elif cmd == "ping":
+            b.ping()
+        else:
+            raise SystemExit("comando desconhecido: " + cmd)
+        for r in painel.execute(b):
+            if r.code == CMD_STATS:
+                for k, v in parse_stats(r).items():
+                    print("%-20s %d" % (k, v))
+            elif r.code == CMD_ADMIT:
+                print("%s, ocupacao %d" % (DECISIONS[r.status] if r.status < len(DECISIONS) else r.status, r.value))
+            else:
+                print("status %d, valor %d" % (r.status, r.value))
+
+
+if __name__ == "__main__":
+    main()
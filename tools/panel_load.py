@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""Gerador de carga e reprodução de traces para o caminho de admissão.
+
+Gera um roteiro da build nativa (src/host/sim.h) com entradas, saídas e
+resets injetados no mesmo caminho que a ISR dos botões alimenta
+(buttons_inject: flag + aviso ao objeto ativo, sem debounce) e, com --run,
+roda o panel_host no relógio virtual (PANEL_SIM_VIRTUAL=1): o tempo ocioso
+não custa tempo real, então 24 h de tráfego rodam em segundos.
+
+Formas de carga (combináveis):
+    chegadas de Poisson a --rate entradas/h; cada pessoa fica --dwell min
+    (exponencial) e sai
+    --rush H      pico de abertura a partir da hora H: --rush-rate entradas/h
+                  por --rush-minutes
+    --drill H     simulado de incêndio na hora H: quem está dentro sai em
+                  --drill-seconds e volta após --drill-return min
+    --reset H     reset da contagem (joystick) na hora H
+    --replay F    reproduz um trace gravado em vez de gerar: o diário de
+                  eventos (imagem da flash inteira ou só da região do diário,
+                  ex.: picotool save) ou CSV "ms,entry|exit|reset"
+
+Uso:
+    python3 tools/panel_load.py --hours 24 --rush 8 --drill 14 -o carga.txt
+    python3 tools/panel_load.py --hours 24 --rush 8 --drill 14 --run build-host/panel_host
+    python3 tools/panel_load.py --replay diario.bin --run build-host/panel_host
+
+O relatório (com --run) traz vazão, acionamentos perdidos (fundidos com um
+ainda pendente, debounce, fila da interface), percentis da latência de
+admissão e do atraso até o display: os da janela final (LATENCY_SAMPLES
+amostras) e os limites pelo histograma log2 da execução inteira.
+"""
+import argparse
+import os
+import random
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# Deve acompanhar src/include/config.h e src/include/event_journal.h
+BUTTON_A_PIN = 5
+BUTTON_B_PIN = 6
+JOYSTICK_BTN_PIN = 22
+PINS = {"entry": BUTTON_A_PIN, "exit": BUTTON_B_PIN, "reset": JOYSTICK_BTN_PIN}
+FLASH_SIZE = 2 * 1024 * 1024
+SECTOR_SIZE = 4096
+JOURNAL_SECTORS = 16
+JOURNAL_MAGIC = 0x4C4E524A
+JOURNAL_TYPES = {1: "boot", 2: "entry", 3: "entry", 4: "exit", 5: "reset"}  # Recusa = tentativa de entrada
+
+BOOT_MS = 3000        # Espera pela inicialização antes do primeiro evento
+DRAIN_MS = 2000       # Depois do último evento, antes do relatório
+
+
+def generate(args, rng):
+    """Eventos (ms, tipo) das formas pedidas, em ordem."""
+    end_ms = int(args.hours * 3600000)
+    events = []
+    visits = []     # [entrada, saída] de cada pessoa
+
+    def arrive(t_ms):
+        visits.append([t_ms, t_ms + int(rng.expovariate(1.0 / (args.dwell * 60000)))])
+
+    def poisson(start_ms, stop_ms, per_hour):
+        if per_hour <= 0:
+            return
+        t = start_ms
+        while True:
+            t += rng.expovariate(per_hour / 3600000.0)
+            if t >= stop_ms:
+                return
+            arrive(int(t))
+
+    poisson(0, end_ms, args.rate)
+    for h in args.rush:
+        start = int(h * 3600000)
+        poisson(start, min(end_ms, start + args.rush_minutes * 60000), args.rush_rate)
+
+    for h in sorted(args.drill):
+        at = int(h * 3600000)
+        back = at + args.drill_return * 60000
+        inside = [v for v in visits if v[0] <= at < v[1]]
+        for i, v in enumerate(inside):
+            v[1] = at + rng.randrange(max(1, args.drill_seconds * 1000))
+            arrive(back + i * 1000)     # Voltam em fila, um por segundo
+
+    for h in args.reset:
+        events.append((int(h * 3600000), "reset"))
+
+    for entry, leave in visits:
+        events.append((entry, "entry"))
+        events.append((leave, "exit"))
+    return sorted(e for e in events if e[0] < end_ms)
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def read_journal(data):
+    """Eventos do diário (event_journal.c), do setor mais antigo ao corrente.
+    Os tempos recomeçam a cada boot: os trechos são concatenados."""
+    region = JOURNAL_SECTORS * SECTOR_SIZE
+    if len(data) == FLASH_SIZE:
+        data = data[-region:]
+    if len(data) != region:
+        sys.exit("imagem do diario deve ter %d bytes (ou a flash inteira)" % region)
+
+    sectors = []
+    for s in range(JOURNAL_SECTORS):
+        sector = data[s * SECTOR_SIZE:(s + 1) * SECTOR_SIZE]
+        magic, seq = struct.unpack_from("<II", sector)
+        if magic == JOURNAL_MAGIC and struct.unpack_from("<H", sector, 14)[0] == crc16_ccitt(sector[:14]):
+            sectors.append((seq, sector))
+
+    events, offset, last = [], 0, 0
+    for _, sector in sorted(sectors):
+        for slot in range(1, SECTOR_SIZE // 16):
+            rec = sector[slot * 16:(slot + 1) * 16]
+            ts, _badge, _count, typ, _zone, _seq, crc = struct.unpack("<IIHBBHH", rec)
+            if crc != crc16_ccitt(rec[:14]) or typ not in JOURNAL_TYPES:
+                continue
+            if JOURNAL_TYPES[typ] == "boot":
+                offset = last - ts
+                continue
+            last = ts + offset
+            events.append((last, JOURNAL_TYPES[typ]))
+    if not events:
+        sys.exit("nenhum registro valido no diario")
+    t0 = events[0][0]
+    return [(t - t0, k) for t, k in events]
+
+
+def read_replay(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if path.endswith(".csv") or data[:1].isdigit():
+        events = []
+        for line in data.decode().splitlines():
+            line = line.split("#")[0].strip()
+            if line:
+                ms, kind = line.split(",")[:2]
+                if kind.strip() not in PINS:
+                    sys.exit("tipo invalido no trace: %s" % line)
+                events.append((int(ms), kind.strip()))
+        return sorted(events)
+    return read_journal(data)
+
+
+def write_script(events, out, debounced):
+    verb = "press" if debounced else "inject"
+    end = BOOT_MS + (events[-1][0] if events else 0) + DRAIN_MS
+    out.write("# Gerado por tools/panel_load.py: %d eventos\n" % len(events))
+    for t, kind in events:
+        out.write("%d %s %d\n" % (BOOT_MS + t, verb, PINS[kind]))
+    out.write("%d text p\n" % end)
+    out.write("%d quit 0\n" % (end + 500))
+    return end
+
+
+def hist_bound(hist, p):
+    """Limite superior do percentil p pelo histograma log2 (bins [2^n, 2^(n+1)))."""
+    total = sum(n for _, n in hist)
+    if not total:
+        return 0
+    need, acc = (total * p + 99) // 100, 0
+    for lower, n in hist:
+        acc += n
+        if acc >= need:
+            return lower * 2 if lower else 1
+    return hist[-1][0] * 2
+
+
+def report(output, events, sim_ms, wall_s):
+    counts = {k: sum(1 for _, kind in events if kind == k) for k in PINS}
+    print("Simulado: %.2f h em %.1f s de tempo real (%.0fx)" % (sim_ms / 3600000.0, wall_s, sim_ms / 1000.0 / wall_s))
+    print("Injetados: %d entradas, %d saidas, %d resets" % (counts["entry"], counts["exit"], counts["reset"]))
+
+    m = re.search(r"Botoes: (\d+) aceitos \((\d+) injetados\), (\d+) no debounce, (\d+) fundidos", output)
+    if m:
+        accepted, _injected, debounced, coalesced = map(int, m.groups())
+        handled = accepted - coalesced
+        print("Processados: %d (%.2f/s simulado, %.0f/s real)" % (handled, handled * 1000.0 / sim_ms, handled / wall_s))
+        print("Perdidos: %d fundidos com um acionamento pendente, %d no debounce" % (coalesced, debounced))
+    m = re.search(r"Interface: (\d+) eventos descartados", output)
+    if m:
+        print("Interface: %s eventos descartados (fila cheia)" % m.group(1))
+
+    for name, label in (("Acionamento -> admissao", "Latencia de admissao"), ("Admissao -> display", "Atraso ate o display")):
+        m = re.search(re.escape("Latencia " + name) +
+                      r" \((\d+) amostras\): p50 (\d+) us, p90 (\d+) us, p99 (\d+) us, max (\d+) us\n((?:  >= .*\n)*)", output)
+        if not m:
+            print("%s: sem dados" % label)
+            continue
+        hist = [tuple(map(int, h)) for h in re.findall(r">=\s+(\d+) us: (\d+)", m.group(6))]
+        print("%s: janela final (%s amostras) p50 %s us, p90 %s us, p99 %s us, max %s us" % ((label,) + m.groups()[:5]))
+        print("  execucao inteira (%d): p50 <= %d us, p99 <= %d us" %
+              (sum(n for _, n in hist), hist_bound(hist, 50), hist_bound(hist, 99)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--hours", type=float, default=24.0, help="duracao da carga gerada")
+    ap.add_argument("--rate", type=float, default=30.0, help="entradas por hora fora dos picos")
+    ap.add_argument("--dwell", type=float, default=20.0, help="permanencia media, em minutos")
+    ap.add_argument("--rush", type=float, action="append", default=[], metavar="H")
+    ap.add_argument("--rush-rate", type=float, default=600.0)
+    ap.add_argument("--rush-minutes", type=int, default=15)
+    ap.add_argument("--drill", type=float, action="append", default=[], metavar="H")
+    ap.add_argument("--drill-seconds", type=int, default=60)
+    ap.add_argument("--drill-return", type=int, default=10)
+    ap.add_argument("--reset", type=float, action="append", default=[], metavar="H")
+    ap.add_argument("--replay", metavar="F")
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--debounced", action="store_true",
+                    help="bordas reais nos pinos (press): passa pela ISR e pelo debounce")
+    ap.add_argument("-o", "--output", help="grava o roteiro (padrao: stdout, sem --run)")
+    ap.add_argument("--run", metavar="PANEL_HOST", help="roda o roteiro no relogio virtual e imprime o relatorio")
+    args = ap.parse_args()
+
+    events = read_replay(args.replay) if args.replay else generate(args, random.Random(args.seed))
+
+    if not args.run:
+        if args.output:
+            with open(args.output, "w") as f:
+                write_script(events, f, args.debounced)
+        else:
+            write_script(events, sys.stdout, args.debounced)
+        return
+
+    if args.output:
+        with open(args.output, "w") as f:
+            sim_ms = write_script(events, f, args.debounced)
+        script = args.output
+    else:
+        with tempfile.NamedTemporaryFile("w", suffix=".txt", delete=False) as f:
+            sim_ms = write_script(events, f, args.debounced)
+        script = f.name
+    env = dict(os.environ, PANEL_SIM_SCRIPT=script, PANEL_SIM_VIRTUAL="1")
+    env.pop("PANEL_SIM_FLASH", None)  # Flash apagada: ocupação começa em 0
+    start = time.monotonic()
+    proc = subprocess.run([args.run], env=env, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE)
+    wall_s = time.monotonic() - start
+    if not args.output:
+        os.unlink(script)
+    if proc.returncode != 0:
+        sys.stdout.write(proc.stdout.decode("utf-8", "replace")[-2000:])
+        sys.exit("panel_host terminou com codigo %d" % proc.returncode)
+    report(proc.stdout.decode("utf-8", "replace"), events, sim_ms, wall_s)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Visualizador do espelho do display OLED e da matriz de LEDs pelo USB.
+
+Liga o espelho (comando MIRROR do protocolo, src/include/mirror.h) e
+reconstrói as duas telas a partir das páginas recebidas: cada página vem em
+RLE e é o XOR com a anterior (ou a página completa, com a flag KEY).
+
+Uso (requer pyserial):
+    python3 tools/panel_mirror.py /dev/ttyACM0            # ASCII no terminal
+    python3 tools/panel_mirror.py /dev/ttyACM0 --save tela # tela.pgm e tela.ppm a cada quadro
+"""
+import argparse
+import sys
+
+from panel_client import Batch, PanelClient
+
+# Deve acompanhar src/include/config.h e src/include/mirror.h
+OLED_WIDTH = 128
+OLED_PAGES = 8
+MATRIX_DIM = 5
+SURFACE_OLED = 0
+SURFACE_MATRIX = 1
+FLAG_KEY = 0x01
+HEADER_LEN = 5
+
+# Leds_Matrix_position (src/include/led_matrix.c): índice no buffer de cada
+# posição lógica (linha 0 = topo)
+MATRIX_POSITION = [[24, 23, 22, 21, 20],
+                   [15, 16, 17, 18, 19],
+                   [14, 13, 12, 11, 10],
+                   [5, 6, 7, 8, 9],
+                   [4, 3, 2, 1, 0]]
+
+
+def rle_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        n = data[i]
+        if n < 128:
+            out += data[i + 1:i + 2 + n]
+            i += 2 + n
+        else:
+            out += bytes([data[i + 1]]) * (n - 126)
+            i += 2
+    return bytes(out)
+
+
+class Mirror:
+    """Estado reconstruído das duas telas."""
+
+    def __init__(self):
+        self.oled = [bytearray(OLED_WIDTH) for _ in range(OLED_PAGES)]
+        self.matrix = bytearray(MATRIX_DIM * MATRIX_DIM * 3)  # R, G, B na ordem do buffer
+        self.last_seq = None
+        self.lost = 0
+        self.pages = 0
+
+    def apply(self, payload):
+        """Aplica um quadro TYPE_MIRROR. Retorna False se a página é inválida."""
+        seq, surface, page, flags = payload[1], payload[2], payload[3], payload[4]
+        if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFF:
+            # Um delta perdido deixa a página errada até o próximo quadro completo
+            self.lost += 1
+        self.last_seq = seq
+        data = rle_decode(payload[HEADER_LEN:])
+        if surface == SURFACE_OLED and page < OLED_PAGES and len(data) == OLED_WIDTH:
+            target = self.oled[page]
+        elif surface == SURFACE_MATRIX and len(data) == len(self.matrix):
+            target = self.matrix
+        else:
+            return False
+        for i, b in enumerate(data):
+            target[i] = b if flags & FLAG_KEY else target[i] ^ b
+        self.pages += 1
+        return True
+
+    def pixel(self, x, y):
+        return (self.oled[y // 8][x] >> (y % 8)) & 1
+
+    def led(self, row, col):
+        i = MATRIX_POSITION[row][col] * 3
+        return tuple(self.matrix[i:i + 3])
+
+    def ascii(self):
+        """OLED em meios-blocos (duas linhas por caractere) e a matriz ao lado."""
+        halves = {(0, 0): " ", (1, 0): "▀", (0, 1): "▄", (1, 1): "█"}
+        lines = []
+        for y in range(0, OLED_PAGES * 8, 2):
+            lines.append("".join(halves[self.pixel(x, y), self.pixel(x, y + 1)] for x in range(OLED_WIDTH)))
+        for row in range(MATRIX_DIM):
+            cells = " ".join("%02x%02x%02x" % self.led(row, col) for col in range(MATRIX_DIM))
+            lines[row] += "   " + cells
+        return "\n".join(lines)
+
+    def save(self, prefix):
+        height = OLED_PAGES * 8
+        with open(prefix + ".pgm", "wb") as f:
+            f.write(b"P5 %d %d 255\n" % (OLED_WIDTH, height))
+            f.write(bytes(255 * self.pixel(x, y) for y in range(height) for x in range(OLED_WIDTH)))
+        with open(prefix + ".ppm", "wb") as f:
+            f.write(b"P6 %d %d 255\n" % (MATRIX_DIM, MATRIX_DIM))
+            f.write(b"".join(bytes(self.led(r, c)) for r in range(MATRIX_DIM) for c in range(MATRIX_DIM)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port")
+    parser.add_argument("--save", metavar="PREFIXO", help="grava PREFIXO.pgm (OLED) e PREFIXO.ppm (matriz)")
+    parser.add_argument("--quiet", action="store_true", help="não desenha no terminal")
+    args = parser.parse_args()
+
+    mirror = Mirror()
+
+    def on_mirror(payload):
+        if not mirror.apply(payload):
+            return
+        if args.save:
+            mirror.save(args.save)
+        if not args.quiet:
+            sys.stdout.write("\x1b[H" + mirror.ascii() + "\npaginas %d, perdidas %d\n" % (mirror.pages, mirror.lost))
+            sys.stdout.flush()
+
+    with PanelClient(args.port, on_text=lambda text: None, on_mirror=on_mirror) as painel:
+        if not args.quiet:
+            sys.stdout.write("\x1b[2J")
+        painel.execute(Batch().mirror(True))
+        try:
+            while True:
+                painel.poll(1.0)
+        except KeyboardInterrupt:
+            painel.execute(Batch().mirror(False))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,431 @@
+#!/usr/bin/env python3
+"""Simulador ciclo a ciclo do programa PIO da matriz WS2812 (led_matrix.pio).
+
+Monta o programa (subconjunto do pioasm: jmp, out, set, mov, pull, nop, com
+[atraso], rótulos e .wrap), lê a configuração que o bloco c-sdk do próprio
+.pio aplica (divisor a partir do clk_sys, autopull e limiar, junção da FIFO,
+pino do set) e executa a máquina de estados em ciclos do clk_sys, com o
+divisor fracionário 16.8 do RP2040 (períodos alternando entre int e int+1).
+A CPU é o laço de matrix_update(): pio_sm_put_blocking() de cada pixel e o
+fim do quadro estimado a partir do último put (MATRIX_FIFO_WORDS + 1 LEDs de
+MATRIX_LED_US, mais MATRIX_RESET_US, de src/include/config.h).
+
+Da forma de onda no pino:
+  - mede T0H, T0L, T1H e T1L e o tempo baixo do reset até o próximo quadro
+    poder começar e confere com as janelas do WS2812 (--part);
+  - decodifica os bits de volta e confere com os pixels enviados;
+  - calcula quantos LEDs cabem por quadro a cada taxa de atualização e
+    quanto tempo a CPU pode se ausentar sem esvaziar a FIFO.
+
+Uso:
+    python3 tools/pio_sim.py
+    python3 tools/pio_sim.py --clk-sys 200e6 --part ws2812b-v5
+    python3 tools/pio_sim.py --clk-sys 48e6     # modo ocioso do clock_mgr
+    python3 tools/pio_sim.py --leds 256 --rates 30,60,100 --vcd matriz.vcd
+    python3 tools/pio_sim.py --list          # palavras montadas, como o pioasm
+
+Sai com 1 se algum tempo sair da janela ou a decodificação não bater.
+"""
+import argparse
+import os
+import random
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "include")
+DEFAULT_PIO = os.path.join(ROOT, "pio", "led_matrix.pio")
+
+# Janelas em ns (mín, máx). ws2812b: folha de dados clássica (±150 ns, reset
+# > 50 us); ws2812b-v5: revisão atual (reset > 280 us)
+PARTS = {
+    "ws2812b": {"T0H": (250, 550), "T1H": (650, 950), "T0L": (700, 1000), "T1L": (300, 600), "RES": (50000, None)},
+    "ws2812b-v5": {"T0H": (220, 380), "T1H": (580, 1000), "T0L": (580, 1000), "T1L": (220, 420), "RES": (280000, None)},
+}
+
+JMP_COND = {"": 0, "!x": 1, "x--": 2, "!y": 3, "y--": 4, "x!=y": 5, "pin": 6, "!osre": 7}
+OUT_DEST = {"pins": 0, "x": 1, "y": 2, "null": 3, "pindirs": 4, "pc": 5, "isr": 6, "exec": 7}
+SET_DEST = {"pins": 0, "x": 1, "y": 2, "pindirs": 4}
+MOV_DEST = {"pins": 0, "x": 1, "y": 2, "exec": 4, "pc": 5, "isr": 6, "osr": 7}
+MOV_SRC = {"pins": 0, "x": 1, "y": 2, "null": 3, "status": 5, "isr": 6, "osr": 7}
+MOV_OP = {"": 0, "!": 1, "~": 1, "::": 2}
+
+
+class PioError(Exception):
+    pass
+
+
+# --- Montador ---
+
+def assemble(text):
+    """Instruções (op, args, atraso, linha) do primeiro .program, rótulos
+    resolvidos, e os limites de wrap. O bloco c-sdk vai para parse_config."""
+    body = text.split("% c-sdk")[0]
+    prog, labels, wrap_target, wrap = [], {}, 0, None
+    for n, raw in enumerate(body.splitlines(), 1):
+        line = raw.split(";")[0].split("//")[0].strip()
+        if not line or line.startswith(".program"):
+            continue
+        if line == ".wrap_target":
+            wrap_target = len(prog)
+            continue
+        if line == ".wrap":
+            wrap = len(prog) - 1
+            continue
+        if line.startswith("."):
+            raise PioError("linha %d: diretiva nao suportada: %s" % (n, line))
+        m = re.match(r"(public\s+)?(\w+):\s*(.*)", line)
+        if m:
+            labels[m.group(2)] = len(prog)
+            line = m.group(3)
+            if not line:
+                continue
+        delay = 0
+        m = re.search(r"\[(\d+)\]\s*$", line)
+        if m:
+            delay = int(m.group(1))
+            line = line[:m.start()].strip()
+        if delay > 31:
+            raise PioError("linha %d: atraso maior que 31" % n)
+        op, _, rest = line.partition(" ")
+        if op.lower() == "jmp":
+            args = rest.replace(",", " ").split()      # jmp [cond] alvo
+        else:
+            args = [a.strip() for a in rest.split(",")] if rest.strip() else []
+        prog.append([op.lower(), args, delay, n])
+    if wrap is None:
+        wrap = len(prog) - 1
+    for ins in prog:
+        if ins[0] == "jmp":
+            target = ins[1][-1]
+            ins[1][-1] = labels[target] if target in labels else int(target, 0)
+    return prog, wrap_target, wrap
+
+
+def encode(ins):
+    """Palavra de 16 bits da instrução (sem side-set), como o pioasm."""
+    op, args, delay, n = ins
+    d = delay << 8
+    try:
+        if op == "jmp":
+            cond = args[0] if len(args) == 2 else ""
+            return 0x0000 | d | JMP_COND[cond] << 5 | args[-1]
+        if op == "out":
+            return 0x6000 | d | OUT_DEST[args[0]] << 5 | (int(args[1], 0) & 31)
+        if op == "set":
+            return 0xE000 | d | SET_DEST[args[0]] << 5 | int(args[1], 0)
+        if op == "nop":
+            return 0xA042 | d
+        if op == "mov":
+            m = re.match(r"(!|~|::)?\s*(\w+)", args[1])
+            return 0xA000 | d | MOV_DEST[args[0]] << 5 | MOV_OP[m.group(1) or ""] << 3 | MOV_SRC[m.group(2)]
+        if op == "pull":
+            words = args[0].split() if args else []
+            ifempty = "ifempty" in words
+            block = "noblock" not in words
+            return 0x8080 | d | ifempty << 6 | block << 5
+    except (KeyError, IndexError, ValueError):
+        pass
+    raise PioError("linha %d: instrucao nao suportada: %s %s" % (n, op, ", ".join(map(str, args))))
+
+
+def parse_config(text, clk_sys):
+    """Configuração aplicada por <programa>_program_init() no bloco c-sdk."""
+    sdk = text.split("% c-sdk", 1)[1] if "% c-sdk" in text else ""
+    cfg = {"shift_right": True, "autopull": False, "threshold": 32, "join_tx": False, "div": 1.0}
+    # Divisor a partir do clk_sys: direto no init ou no auxiliar <programa>_program_clkdiv(sys_hz)
+    m = re.search(r"(?:clock_get_hz\(clk_sys\)|sys_hz)\s*/\s*([0-9.eE]+)f?", sdk)
+    if m:
+        cfg["div"] = clk_sys / float(m.group(1))
+    m = re.search(r"sm_config_set_out_shift\(&c,\s*(\w+),\s*(\w+),\s*(\d+)\)", sdk)
+    if m:
+        cfg["shift_right"] = m.group(1) == "true"
+        cfg["autopull"] = m.group(2) == "true"
+        cfg["threshold"] = int(m.group(3)) or 32
+    cfg["join_tx"] = "PIO_FIFO_JOIN_TX" in sdk
+    return cfg
+
+
+# --- Máquina de estados ---
+
+def clock_enables(div):
+    """Ciclos do clk_sys em que a máquina de estados avança: divisor 16.8
+    (inteiro + fração/256), o acumulador da fração estica um período a cada
+    estouro."""
+    int_part = int(div)
+    frac = int(round((div - int_part) * 256))
+    if frac == 256:
+        int_part, frac = int_part + 1, 0
+    if int_part == 0 or int_part > 65535:
+        raise PioError("divisor fora da faixa: %.4f" % div)
+    t, acc = 0, 0
+    while True:
+        yield t
+        acc += frac
+        t += int_part + (acc >= 256)
+        acc &= 255
+
+
+def run(prog, wrap_target, wrap, cfg, words, clk_sys, settle_us):
+    """Executa um quadro: a CPU põe os pixels na FIFO (bloqueando se cheia);
+    o próximo quadro pode começar settle_us depois do último put, como em
+    matrix_update(). Retorna as bordas do pino [(ns, nível)], esse instante e
+    quando o último put retornou, em ns."""
+    ns = 1e9 / clk_sys
+    depth = 8 if cfg["join_tx"] else 4
+    fifo, pending = [], list(words)
+    last_put_ns = 0.0
+    osr, osr_count = 0, 32          # OSR vazio após o init
+    x = y = isr = 0
+    pc, pin = wrap_target, 0
+    edges = [(0.0, 0)]
+    delay = 0
+    end_ns = None
+
+    for t in clock_enables(cfg["div"]):
+        now = t * ns
+        # CPU: pio_sm_put_blocking() retorna assim que a palavra entra na FIFO
+        while pending and len(fifo) < depth:
+            fifo.append(pending.pop(0))
+            last_put_ns = now
+        if end_ns is None and not pending:
+            end_ns = last_put_ns + settle_us * 1000.0
+        if end_ns is not None and now >= end_ns:
+            return edges, end_ns, last_put_ns
+
+        if delay:
+            delay -= 1
+            continue
+
+        op, args, ins_delay, n = prog[pc]
+        next_pc = wrap_target if pc == wrap else pc + 1
+        stalled = False
+
+        if op == "out":
+            if cfg["autopull"] and osr_count >= cfg["threshold"]:
+                if not fifo:
+                    stalled = True
+                else:
+                    osr, osr_count = fifo.pop(0), 0
+            if not stalled:
+                bits = int(args[1], 0) or 32
+                mask = (1 << bits) - 1
+                if cfg["shift_right"]:
+                    value, osr = osr & mask, osr >> bits
+                else:
+                    value, osr = (osr >> (32 - bits)) & mask, (osr << bits) & 0xFFFFFFFF
+                osr_count = min(32, osr_count + bits)
+                dest = args[0]
+                if dest == "x":
+                    x = value
+                elif dest == "y":
+                    y = value
+                elif dest == "pins":
+                    pin = value & 1
+                elif dest == "pc":
+                    next_pc = value
+                elif dest == "isr":
+                    isr = value
+                elif dest != "null":
+                    raise PioError("linha %d: out %s nao suportado" % (n, dest))
+        elif op == "jmp":
+            cond = args[0] if len(args) == 2 else ""
+            taken = {"": True, "!x": x == 0, "x--": x != 0, "!y": y == 0, "y--": y != 0,
+                     "x!=y": x != y, "pin": pin == 1,
+                     "!osre": osr_count < cfg["threshold"]}[cond]
+            if cond == "x--":
+                x = (x - 1) & 0xFFFFFFFF
+            elif cond == "y--":
+                y = (y - 1) & 0xFFFFFFFF
+            if taken:
+                next_pc = args[-1]
+        elif op == "set":
+            value = int(args[1], 0)
+            if args[0] == "pins":
+                pin = value & 1
+            elif args[0] == "x":
+                x = value
+            elif args[0] == "y":
+                y = value
+        elif op == "mov":
+            m = re.match(r"(!|~|::)?\s*(\w+)", args[1])
+            value = {"x": x, "y": y, "null": 0, "isr": isr, "osr": osr, "pins": pin}[m.group(2)]
+            if m.group(1) in ("!", "~"):
+                value ^= 0xFFFFFFFF
+            elif m.group(1) == "::":
+                value = int("{:032b}".format(value)[::-1], 2)
+            if args[0] == "x":
+                x = value
+            elif args[0] == "y":
+                y = value
+            elif args[0] == "isr":
+                isr = value
+            elif args[0] == "osr":
+                osr, osr_count = value, 0
+            elif args[0] == "pins":
+                pin = value & 1
+        elif op == "pull":
+            words_ = args[0].split() if args else []
+            if "ifempty" in words_ and osr_count < cfg["threshold"]:
+                pass
+            elif fifo:
+                osr, osr_count = fifo.pop(0), 0
+            elif "noblock" in words_:
+                osr, osr_count = x, 0
+            else:
+                stalled = True
+        elif op != "nop":
+            raise PioError("linha %d: %s nao suportado" % (n, op))
+
+        if stalled:
+            continue                    # Parada: nem o atraso começa
+        if pin != edges[-1][1]:
+            edges.append((now, pin))
+        delay = ins_delay
+        pc = next_pc
+
+
+# --- Análise ---
+
+def measure(edges, end_ns):
+    """Pulsos [(alto, baixo)] em ns e o baixo final (o reset)."""
+    pulses = []
+    highs = [i for i, (_, level) in enumerate(edges) if level == 1]
+    for k, i in enumerate(highs):
+        rise = edges[i][0]
+        fall = edges[i + 1][0] if i + 1 < len(edges) else end_ns
+        nxt = edges[highs[k + 1]][0] if k + 1 < len(highs) else None
+        pulses.append((fall - rise, (nxt - fall) if nxt is not None else None))
+    tail = end_ns - edges[-1][0] if edges[-1][1] == 0 else 0.0
+    return pulses, tail
+
+
+def check(name, values, window, failures):
+    if not values:
+        return
+    lo, hi = min(values), max(values)
+    wmin, wmax = window
+    ok = lo >= wmin and (wmax is None or hi <= wmax)
+    print("  %-4s %8.0f .. %-8.0f ns   janela %s .. %s  %s" %
+          (name, lo, hi, wmin, wmax if wmax is not None else "-", "ok" if ok else "FORA"))
+    if not ok:
+        failures.append(name)
+
+
+def read_define(path, name, default):
+    try:
+        with open(path) as f:
+            m = re.search(r"#define\s+%s\s+(\d+)" % name, f.read())
+            return int(m.group(1)) if m else default
+    except OSError:
+        return default
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("pio", nargs="?", default=DEFAULT_PIO)
+    ap.add_argument("--clk-sys", type=float, default=125e6, help="clk_sys em Hz (padrao 125 MHz)")
+    ap.add_argument("--part", choices=sorted(PARTS), default="ws2812b")
+    config_h = os.path.join(ROOT, "config.h")
+    ap.add_argument("--leds", type=int, default=read_define(config_h, "MATRIX_SIZE", 25))
+    ap.add_argument("--reset-us", type=int, default=read_define(config_h, "MATRIX_RESET_US", 300))
+    ap.add_argument("--led-us", type=int, default=read_define(config_h, "MATRIX_LED_US", 30),
+                    help="tempo de um LED assumido pelo firmware (padrao: MATRIX_LED_US)")
+    ap.add_argument("--rates", default="10,30,60,100", help="taxas de atualizacao em Hz, separadas por virgula")
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--vcd", help="grava a forma de onda do pino em VCD (GTKWave)")
+    ap.add_argument("--list", action="store_true", help="imprime as palavras montadas")
+    args = ap.parse_args()
+
+    with open(args.pio) as f:
+        text = f.read()
+    try:
+        prog, wrap_target, wrap = assemble(text)
+        code = [encode(ins) for ins in prog]
+    except PioError as e:
+        sys.exit(str(e))
+    cfg = parse_config(text, args.clk_sys)
+    if args.list:
+        for i, (w, ins) in enumerate(zip(code, prog)):
+            print("%2d: 0x%04x  ; %s %s%s" % (i, w, ins[0], ", ".join(map(str, ins[1])),
+                                              " [%d]" % ins[2] if ins[2] else ""))
+        print("wrap_target %d, wrap %d" % (wrap_target, wrap))
+        return
+
+    # Pixels: todos os bits 0 e 1 e valores aleatórios, nos 24 bits altos (GRB)
+    rng = random.Random(args.seed)
+    words = [0x00000000, 0xFFFFFF00] + [rng.getrandbits(24) << 8 for _ in range(max(0, args.leds - 2))]
+    words = words[:args.leds]
+
+    try:
+        depth = 8 if cfg["join_tx"] else 4
+        settle_us = (depth + 1) * args.led_us + args.reset_us
+        edges, end_ns, last_put_ns = run(prog, wrap_target, wrap, cfg, words, args.clk_sys, settle_us)
+    except PioError as e:
+        sys.exit(str(e))
+    pulses, tail = measure(edges, end_ns)
+
+    period_ns = cfg["div"] * 1e9 / args.clk_sys
+    print("%s: %d instrucoes, clk_sys %.1f MHz, divisor %.4f (%.1f ns por ciclo do PIO), "
+          "autopull %s em %d bits, FIFO TX %d palavras" %
+          (os.path.basename(args.pio), len(prog), args.clk_sys / 1e6, cfg["div"], period_ns,
+           "ligado" if cfg["autopull"] else "desligado", cfg["threshold"], 8 if cfg["join_tx"] else 4))
+
+    # Decodifica: alto maior que o meio entre T0H e T1H é 1
+    part = PARTS[args.part]
+    cut = (part["T0H"][1] + part["T1H"][0]) / 2.0
+    bits = [1 if high > cut else 0 for high, _ in pulses]
+    bpw = cfg["threshold"]
+    decoded = [int("".join(map(str, bits[i:i + bpw])), 2) << (32 - bpw) for i in range(0, len(bits) - bpw + 1, bpw)]
+    mask = ((1 << bpw) - 1) << (32 - bpw)
+    expected = [w & mask for w in words]
+
+    failures = []
+    print("Tempos (%s), %d bits:" % (args.part, len(bits)))
+    check("T0H", [h for (h, _), b in zip(pulses, bits) if b == 0], part["T0H"], failures)
+    check("T1H", [h for (h, _), b in zip(pulses, bits) if b == 1], part["T1H"], failures)
+    check("T0L", [l for (_, l), b in zip(pulses, bits) if b == 0 and l is not None], part["T0L"], failures)
+    check("T1L", [l for (_, l), b in zip(pulses, bits) if b == 1 and l is not None], part["T1L"], failures)
+    check("RES", [tail], part["RES"], failures)
+    if decoded != expected:
+        print("  decodificacao: %d de %d pixels diferentes" %
+              (sum(a != b for a, b in zip(decoded, expected)) + abs(len(decoded) - len(expected)), len(expected)))
+        failures.append("decodificacao")
+    else:
+        print("  decodificacao: %d pixels iguais aos enviados" % len(expected))
+
+    bit_ns = [h + l for h, l in pulses if l is not None]
+    bit_avg = sum(bit_ns) / len(bit_ns) if bit_ns else 0
+    led_ns = bit_avg * bpw
+    last_bit_end = edges[-1][0]
+    print("Quadro de %d LEDs: bit %.0f ns (%.0f kHz), LED %.2f us, dados %.1f us, quadro %.1f us" %
+          (args.leds, bit_avg, 1e6 / bit_avg if bit_avg else 0, led_ns / 1000, last_bit_end / 1000, end_ns / 1000))
+    drain_ns = last_bit_end - last_put_ns
+    print("  a FIFO esvazia %.1f us depois do ultimo put (estimativa do firmware: %d us); reset de %.1f us" %
+          (drain_ns / 1000, (depth + 1) * args.led_us, tail / 1000))
+    if drain_ns > (depth + 1) * args.led_us * 1000:
+        print("  MATRIX_LED_US abaixo do tempo real de um LED (%.2f us)" % (led_ns / 1000))
+        failures.append("MATRIX_LED_US")
+    print("  a CPU pode se ausentar ate %.1f us com a FIFO cheia (%d palavras) sem interromper o quadro" %
+          (depth * led_ns / 1000, depth))
+
+    reset_ns = max(part["RES"][0], args.reset_us * 1000.0)
+    print("LEDs por quadro (reset de %.0f us no fim):" % (reset_ns / 1000))
+    for rate in (float(r) for r in args.rates.split(",")):
+        budget = 1e9 / rate - reset_ns
+        print("  %6.1f Hz: %d" % (rate, max(0, int(budget // led_ns)) if led_ns else 0))
+
+    if args.vcd:
+        with open(args.vcd, "w") as f:
+            f.write("$timescale 1ns $end\n$scope module pio $end\n$var wire 1 p ws2812 $end\n"
+                    "$upscope $end\n$enddefinitions $end\n")
+            for t, level in edges:
+                f.write("#%d\n%dp\n" % (round(t), level))
+            f.write("#%d\n" % round(end_ns))
+
+    if failures:
+        print("FALHOU: %s" % ", ".join(failures))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Decodifica o log tokenizado do painel capturado do terminal USB com
+TLOG_OUTPUT_BINARY = 1.
+
+Uso:
+    python3 tools/tlog_decode.py captura.bin [src/include/log_messages.def]
+
+Cada registro é enviado como 0xA5, tamanho, t_us (u32), id (u16) e os
+argumentos (u32 cada), little-endian (ver src/include/tlog.c). A tabela de
+formatos é lida do mesmo log_messages.def usado na compilação; o texto comum
+do terminal entre os registros é repassado sem alteração.
+"""
+import os
+import re
+import struct
+import sys
+
+DEF_PATH = os.path.join(os.path.dirname(__file__), "..", "src", "include", "log_messages.def")
+SYNC = 0xA5
+
+
+def load_formats(path):
+    formats = []
+    pattern = re.compile(r'^\s*LOG_MSG\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            m = pattern.match(line)
+            if m:
+                formats.append((m.group(1), m.group(2)))
+    return formats
+
+
+def c_to_python(fmt):
+    # Python não aceita os modificadores de tamanho do C (%lu, %hhu...)
+    return re.sub(r"%([-+ 0#]*\d*)(?:hh|h|ll|l|z)?([diuxXc])",
+                  lambda m: "%" + m.group(1) + ("d" if m.group(2) in "iu" else m.group(2)), fmt)
+
+
+def decode(data, formats, out):
+    i = 0
+    text = bytearray()
+    while i < len(data):
+        b = data[i]
+        if b == SYNC and i + 1 < len(data):
+            length = data[i + 1]
+            frame = data[i + 2:i + 2 + length]
+            if length >= 6 and (length - 6) % 4 == 0 and len(frame) == length:
+                t_us, msg_id = struct.unpack_from("<IH", frame)
+                args = struct.unpack_from("<%dI" % ((length - 6) // 4), frame, 6)
+                if text:
+                    out.write(text.decode("utf-8", "replace"))
+                    text.clear()
+                if msg_id < len(formats):
+                    name, fmt = formats[msg_id]
+                    try:
+                        msg = c_to_python(fmt) % args
+                    except (TypeError, ValueError):
+                        msg = "%s %r" % (fmt, args)
+                else:
+                    msg = "mensagem %d desconhecida %r" % (msg_id, args)
+                out.write("[%d] %s\n" % (t_us, msg))
+                i += 2 + length
+                continue
+        text.append(b)
+        i += 1
+    if text:
+        out.write(text.decode("utf-8", "replace"))
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        raise SystemExit(__doc__)
+    formats = load_formats(sys.argv[2] if len(sys.argv) == 3 else DEF_PATH)
+    with open(sys.argv[1], "rb") as f:
+        decode(f.read(), formats, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Converte o dump do trace do painel (comando 't' no terminal USB) em JSON
+do formato Chrome Trace Event, aberto em https://ui.perfetto.dev ou chrome://tracing.
+
+Uso:
+    python3 tools/trace_to_perfetto.py dump.txt > trace.json
+
+O dump pode conter outras linhas do terminal antes e depois; só o trecho entre
+#TRACE e #END é lido. Os eventos e o formato estão em src/include/trace.h.
+"""
+import json
+import struct
+import sys
+
+# Deve acompanhar trace_event_t (src/include/trace.h)
+EVT_TASK_SWITCH = 1
+EVT_NAMES = {
+    2: "Borda botao",
+    3: "Borda feixe",
+    4: "Quadro cracha",
+    5: "Semaforo take",
+    6: "Semaforo take (falha)",
+    7: "Semaforo give",
+    10: "Quadro matriz",
+}
+EVT_DISPLAY_BEGIN = 8
+EVT_DISPLAY_END = 9
+DISPLAY_TID = 100
+
+
+def parse(lines):
+    tasks, cores, now, core = {}, {}, None, None
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("#TRACE"):
+            _, version, _n_cores, now = line.split()
+            if version != "1":
+                raise SystemExit("versao de trace nao suportada: " + version)
+            now, inside, tasks, cores = int(now), True, {}, {}
+        elif not inside:
+            continue
+        elif line.startswith("#TASK"):
+            _, num, name = line.split(maxsplit=2)
+            tasks[int(num)] = name
+        elif line.startswith("#CORE"):
+            _, core, total, dropped = line.split()
+            core = int(core)
+            cores[core] = {"total": int(total), "dropped": int(dropped), "records": []}
+        elif line.startswith("#END"):
+            inside = False
+        elif core is not None and len(line) == 16:
+            t_us, event, rec_core, arg = struct.unpack("<IBBH", bytes.fromhex(line))
+            cores[core]["records"].append((t_us, event, rec_core, arg))
+    if now is None:
+        raise SystemExit("nenhum #TRACE encontrado")
+    return tasks, cores, now
+
+
+def unwrap(records, now):
+    """Converte os tempos de 32 bits em us relativos ao dump (negativos) e
+    descarta registros sobrescritos durante o envio (mais novos que os seguintes)."""
+    kept, last_age = [], -1
+    for t_us, event, core, arg in reversed(records):
+        age = (now - t_us) & 0xFFFFFFFF
+        if age < last_age:
+            continue
+        last_age = age
+        kept.append((-age, event, core, arg))
+    kept.reverse()
+    return kept
+
+
+def convert(tasks, cores, now):
+    events = [{"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "RP2040"}},
+              {"ph": "M", "pid": 1, "tid": DISPLAY_TID, "name": "thread_name", "args": {"name": "Display"}}]
+    timeline = []
+    for core, info in sorted(cores.items()):
+        events.append({"ph": "M", "pid": 1, "tid": core, "name": "thread_name",
+                       "args": {"name": "Nucleo %d (%d eventos, %d perdidos)" % (core, info["total"], info["dropped"])}})
+        timeline.extend(unwrap(info["records"], now))
+    if not timeline:
+        return {"traceEvents": events}
+
+    origin = min(r[0] for r in timeline)
+    current = {}  # núcleo -> (tarefa, início)
+    open_flush = False
+    for ts, event, core, arg in sorted(timeline, key=lambda r: r[0]):
+        ts -= origin
+        if event == EVT_TASK_SWITCH:
+            if core in current:
+                name, start = current[core]
+                events.append({"ph": "X", "pid": 1, "tid": core, "name": name, "ts": start, "dur": ts - start})
+            current[core] = (tasks.get(arg, "tarefa %d" % arg), ts)
+        elif event == EVT_DISPLAY_BEGIN:
+            events.append({"ph": "B", "pid": 1, "tid": DISPLAY_TID, "name": "Envio I2C", "ts": ts})
+            open_flush = True
+        elif event == EVT_DISPLAY_END and open_flush:
+            events.append({"ph": "E", "pid": 1, "tid": DISPLAY_TID, "ts": ts})
+            open_flush = False
+        else:
+            events.append({"ph": "i", "s": "t", "pid": 1, "tid": core, "ts": ts,
+                           "name": EVT_NAMES.get(event, "evento %d" % event), "args": {"arg": arg}})
+
+    end = max(r[0] for r in timeline) - origin
+    for core, (name, start) in current.items():
+        events.append({"ph": "X", "pid": 1, "tid": core, "name": name, "ts": start, "dur": end - start})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) > 2:
+        raise SystemExit(__doc__)
+    src = open(sys.argv[1], encoding="utf-8", errors="replace") if len(sys.argv) == 2 else sys.stdin
+    with src:
+        tasks, cores, now = parse(src)
+    json.dump(convert(tasks, cores, now), sys.stdout)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()